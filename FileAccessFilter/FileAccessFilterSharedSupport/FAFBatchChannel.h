@@ -0,0 +1,49 @@
+//
+//  FAFBatchChannel.h
+//  FileAccessFilterSharedSupport
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "FileAccessFilterSharedSupport.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+//
+// Requests read from the channel at once, valid only inside the batch handler.
+// Every request is allowed unless its verdict is changed.
+//
+@interface FAFRequestBatch : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+
+- (pid_t)pidAtIndex:(NSUInteger)index;
+- (FAFAccessType)accessTypeAtIndex:(NSUInteger)index;
+
+// Zero terminated path in file system representation, no copy is made
+- (const char *)fileSystemPathAtIndex:(NSUInteger)index NS_RETURNS_INNER_POINTER;
+
+- (void)setAllow:(BOOL)allow atIndex:(NSUInteger)index;
+
+@end
+
+//
+// Resolver side of the binary channel set up by -[FAFFileAccessFilter registerBatchResolutionWithCompletion:].
+// Handler is called on the channel thread for every batch of requests, verdicts of the batch
+// are sent together after it returns.
+//
+@interface FAFBatchChannel : NSObject
+
+- (nullable instancetype)initWithMemory:(NSFileHandle *const)memory doorbell:(NSFileHandle *const)doorbell;
+
+- (void)startWithHandler:(void (^)(FAFRequestBatch *const batch))handler;
+
+// Pending requests are allowed by the filter
+- (void)stop;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,225 @@
+//
+//  FAFBatchChannel.mm
+//  FileAccessFilterSharedSupport
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "FAFBatchChannel.h"
+
+#include "FAFChannel.h"
+
+#include <sys/stat.h>
+
+#include <vector>
+
+struct FAFBatchEntry
+{
+    const FAFRequestFrame *frame;
+    bool                   allow;
+};
+
+@interface FAFRequestBatch ()
+- (std::vector<FAFBatchEntry> &)entries;
+@end
+
+@implementation FAFRequestBatch
+{
+    std::vector<FAFBatchEntry> _entries;
+}
+
+- (std::vector<FAFBatchEntry> &)entries
+{
+    return _entries;
+}
+
+- (NSUInteger)count
+{
+    return _entries.size();
+}
+
+- (pid_t)pidAtIndex:(NSUInteger)index
+{
+    return _entries.at(index).frame->pid;
+}
+
+- (FAFAccessType)accessTypeAtIndex:(NSUInteger)index
+{
+    return (FAFAccessType)_entries.at(index).frame->accessType;
+}
+
+- (const char *)fileSystemPathAtIndex:(NSUInteger)index
+{
+    return reinterpret_cast<const char *>(_entries.at(index).frame + 1);
+}
+
+- (void)setAllow:(BOOL)allow atIndex:(NSUInteger)index
+{
+    _entries.at(index).allow = allow;
+}
+
+@end
+
+
+@interface FAFBatchChannel ()
+@property (atomic) BOOL stopping;
+@end
+
+@implementation FAFBatchChannel
+{
+    NSFileHandle *_doorbellHandle;
+    void         *_memory;
+    size_t        _memorySize;
+    FAFChannel    _channel;
+    FAFDoorbell   _doorbell;
+    NSThread     *_thread;
+}
+
+- (nullable instancetype)initWithMemory:(NSFileHandle *const)memory doorbell:(NSFileHandle *const)doorbell
+{
+    self = [super init];
+    if (!self)
+    {
+        return nil;
+    }
+
+    struct stat status = {};
+    if (0 != fstat(memory.fileDescriptor, &status) || status.st_size <= 0)
+    {
+        return nil;
+    }
+
+    _memorySize = static_cast<size_t>(status.st_size);
+    _memory = mmap(nullptr, _memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, memory.fileDescriptor, 0);
+    if (MAP_FAILED == _memory)
+    {
+        _memory = nullptr;
+        return nil;
+    }
+
+    if (!_channel.attach(_memory, _memorySize))
+    {
+        return nil;
+    }
+
+    _doorbellHandle = doorbell;
+    _doorbell = FAFDoorbell(doorbell.fileDescriptor);
+
+    return self;
+}
+
+- (void)dealloc
+{
+    if (_memory)
+    {
+        munmap(_memory, _memorySize);
+    }
+}
+
+- (void)startWithHandler:(void (^)(FAFRequestBatch *const))handler
+{
+    if (_thread)
+    {
+        return;
+    }
+
+    _thread = [[NSThread alloc] initWithBlock:^{
+        [self channelLoopWithHandler:handler];
+    }];
+    _thread.name = @"FAFBatchChannel";
+
+    [_thread start];
+}
+
+- (void)stop
+{
+    self.stopping = YES;
+    _doorbell.shutdown();
+}
+
+- (void)channelLoopWithHandler:(void (^)(FAFRequestBatch *const))handler
+{
+    FAFRequestBatch *const batch = [[FAFRequestBatch alloc] init];
+    std::vector<FAFBatchEntry> &entries = batch.entries;
+
+    FAFFrameRing &requests = _channel.requests();
+
+    while (!self.stopping)
+    {
+        requests.read([&](const void *data, uint32_t size) {
+            const FAFRequestFrame *const frame = static_cast<const FAFRequestFrame *>(data);
+
+            if (size < sizeof(FAFRequestFrame) ||
+                frame->pathLength >= size - sizeof(FAFRequestFrame) ||
+                '\0' != reinterpret_cast<const char *>(frame + 1)[frame->pathLength])
+            {
+                return;
+            }
+
+            entries.push_back({ frame, true });
+        });
+
+        if (entries.empty())
+        {
+            requests.release();
+
+            if (requests.prepareToWait() && !_doorbell.wait())
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        @autoreleasepool
+        {
+            handler(batch);
+        }
+
+        [self sendVerdicts:entries];
+
+        //
+        // Request frames are given back only after their ids were sent
+        //
+        requests.release();
+        entries.clear();
+    }
+}
+
+- (void)sendVerdicts:(const std::vector<FAFBatchEntry> &)entries
+{
+    FAFFrameRing &verdicts = _channel.verdicts();
+
+    size_t sent = 0;
+    while (sent < entries.size() && !self.stopping)
+    {
+        for (; sent < entries.size(); ++sent)
+        {
+            FAFVerdictFrame *const frame = static_cast<FAFVerdictFrame *>(verdicts.allocate(sizeof(FAFVerdictFrame)));
+            if (!frame)
+            {
+                break;
+            }
+
+            frame->id = entries[sent].frame->id;
+            frame->allow = entries[sent].allow;
+            frame->reserved = 0;
+        }
+
+        if (verdicts.commit())
+        {
+            _doorbell.ring();
+        }
+
+        //
+        // Filter is behind with reading verdicts of previous batches
+        //
+        if (sent < entries.size())
+        {
+            usleep(100);
+        }
+    }
+}
+
+@end
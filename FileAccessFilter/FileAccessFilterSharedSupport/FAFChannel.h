@@ -0,0 +1,454 @@
+//
+//  FAFChannel.h
+//  FileAccessFilterSharedSupport
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FAFChannel_h
+#define FAFChannel_h
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+//
+// Binary channel between fileaccessfilterd (filter) and the app (resolver).
+//
+// Requests and verdicts are framed into two single-producer/single-consumer rings
+// placed in memory shared by both processes. Producer writes any number of frames
+// and publishes them at once, consumer reads everything published and releases it
+// at once, so both sides work with whole batches. Sleeping consumer is woken by one
+// byte written to the socket doorbell, which is sent only if the consumer asked for
+// it. The peer is not trusted: cursors and frames read from shared memory are
+// validated before use.
+//
+
+constexpr uint32_t kFAFChannelMagic = 0x43464146; // 'FAFC'
+constexpr uint32_t kFAFChannelVersion = 1;
+constexpr uint32_t kFAFFrameAlignment = 8;
+
+constexpr uint32_t kFAFChannelRequestCapacity = 256 * 1024;
+constexpr uint32_t kFAFChannelVerdictCapacity = 256 * 1024;
+
+//
+// Request frame, zero terminated path follows the header
+//
+struct FAFRequestFrame
+{
+    uint64_t id;
+    int32_t  pid;
+    uint32_t accessType;
+    uint32_t pathLength;
+    uint32_t reserved;
+};
+
+struct FAFVerdictFrame
+{
+    uint64_t id;
+    uint32_t allow;
+    uint32_t reserved;
+};
+
+struct FAFFrameRingHeader
+{
+    alignas(64) uint64_t consumed;
+    alignas(64) uint64_t published;
+    alignas(64) uint32_t consumerWaiting;
+};
+
+struct FAFFrame
+{
+    uint32_t size;
+    uint32_t flags;
+};
+
+constexpr uint32_t kFAFFramePadding = 1;
+
+class FAFFrameRing
+{
+public:
+    static constexpr size_t memorySize(uint32_t capacity)
+    {
+        return sizeof(FAFFrameRingHeader) + capacity;
+    }
+
+    static constexpr uint32_t frameSize(uint32_t payloadSize)
+    {
+        return (sizeof(FAFFrame) + payloadSize + kFAFFrameAlignment - 1) & ~(kFAFFrameAlignment - 1);
+    }
+
+    bool attach(void *memory, size_t size, uint32_t capacity)
+    {
+        if (!memory || capacity < kFAFFrameAlignment || (capacity & (capacity - 1)) || size < memorySize(capacity))
+        {
+            return false;
+        }
+
+        m_header = static_cast<FAFFrameRingHeader *>(memory);
+        m_data = reinterpret_cast<uint8_t *>(m_header + 1);
+        m_capacity = capacity;
+        m_cursor = 0;
+
+        return true;
+    }
+
+    //
+    // Producer side, returns space for the payload of the next frame or null if ring is full.
+    // Frame is not visible to the consumer until commit
+    //
+    void * allocate(uint32_t payloadSize)
+    {
+        const uint32_t size = frameSize(payloadSize);
+        if (payloadSize > m_capacity || size > m_capacity)
+        {
+            return nullptr;
+        }
+
+        const uint64_t consumed = __atomic_load_n(&m_header->consumed, __ATOMIC_ACQUIRE);
+        if (m_cursor - consumed > m_capacity)
+        {
+            //
+            // Consumer cursor is corrupted, behave as full
+            //
+            return nullptr;
+        }
+
+        //
+        // Frame never wraps, tail of the ring is skipped by padding frame
+        //
+        const uint32_t contiguous = m_capacity - static_cast<uint32_t>(m_cursor & (m_capacity - 1));
+        const uint32_t padding = contiguous < size ? contiguous : 0;
+
+        if (m_cursor + padding + size - consumed > m_capacity)
+        {
+            return nullptr;
+        }
+
+        if (padding)
+        {
+            frameAt(m_cursor)->size = padding;
+            frameAt(m_cursor)->flags = kFAFFramePadding;
+            m_cursor += padding;
+        }
+
+        FAFFrame *frame = frameAt(m_cursor);
+        frame->size = size;
+        frame->flags = 0;
+        m_cursor += size;
+
+        return frame + 1;
+    }
+
+    //
+    // Producer side, publishes allocated frames, returns true if consumer
+    // asked to be notified about this publication, the flag is consumed
+    //
+    bool commit()
+    {
+        __atomic_store_n(&m_header->published, m_cursor, __ATOMIC_RELEASE);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (!__atomic_load_n(&m_header->consumerWaiting, __ATOMIC_RELAXED))
+        {
+            return false;
+        }
+
+        return 0 != __atomic_exchange_n(&m_header->consumerWaiting, 0, __ATOMIC_SEQ_CST);
+    }
+
+    //
+    // Consumer side, visitor is called for every published frame with pointer
+    // into the ring, frames stay valid until release. Returns number of frames
+    //
+    template <typename Visitor>
+    uint32_t read(Visitor visitor)
+    {
+        const uint64_t published = __atomic_load_n(&m_header->published, __ATOMIC_ACQUIRE);
+        if (published - m_cursor > m_capacity)
+        {
+            //
+            // Producer cursor is corrupted, nothing can be read
+            //
+            return 0;
+        }
+
+        uint32_t count = 0;
+        while (m_cursor < published)
+        {
+            const FAFFrame *frame = frameAt(m_cursor);
+
+            const uint32_t size = frame->size;
+            const uint32_t contiguous = m_capacity - static_cast<uint32_t>(m_cursor & (m_capacity - 1));
+            if (size < sizeof(FAFFrame) || size > contiguous || size > published - m_cursor || (size & (kFAFFrameAlignment - 1)))
+            {
+                //
+                // Malformed frame, the rest of the batch is dropped
+                //
+                m_cursor = published;
+                break;
+            }
+
+            if (!(frame->flags & kFAFFramePadding))
+            {
+                visitor(static_cast<const void *>(frame + 1), size - static_cast<uint32_t>(sizeof(FAFFrame)));
+                ++count;
+            }
+
+            m_cursor += size;
+        }
+
+        return count;
+    }
+
+    //
+    // Consumer side, gives space of all read frames back to the producer
+    //
+    void release()
+    {
+        __atomic_store_n(&m_header->consumed, m_cursor, __ATOMIC_RELEASE);
+    }
+
+    bool empty() const
+    {
+        return __atomic_load_n(&m_header->published, __ATOMIC_ACQUIRE) == m_cursor;
+    }
+
+    //
+    // Consumer side, returns true if it is safe to sleep until producer notification
+    //
+    bool prepareToWait()
+    {
+        __atomic_store_n(&m_header->consumerWaiting, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (!empty())
+        {
+            __atomic_store_n(&m_header->consumerWaiting, 0, __ATOMIC_RELAXED);
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    FAFFrame * frameAt(uint64_t position) const
+    {
+        return reinterpret_cast<FAFFrame *>(m_data + (position & (m_capacity - 1)));
+    }
+
+private:
+    FAFFrameRingHeader *m_header = nullptr;
+    uint8_t            *m_data = nullptr;
+    uint32_t            m_capacity = 0;
+
+    //
+    // Write cursor of the producer, read cursor of the consumer
+    //
+    uint64_t            m_cursor = 0;
+
+};
+
+struct FAFChannelHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t requestCapacity;
+    uint32_t verdictCapacity;
+};
+
+class FAFChannel
+{
+public:
+    static constexpr size_t memorySize(uint32_t requestCapacity, uint32_t verdictCapacity)
+    {
+        return RequestRingOffset() + FAFFrameRing::memorySize(requestCapacity) + FAFFrameRing::memorySize(verdictCapacity);
+    }
+
+    //
+    // Filter side, lays out zeroed memory of memorySize bytes
+    //
+    bool create(void *memory, size_t size, uint32_t requestCapacity, uint32_t verdictCapacity)
+    {
+        if (!memory || size < memorySize(requestCapacity, verdictCapacity))
+        {
+            return false;
+        }
+
+        FAFChannelHeader *header = static_cast<FAFChannelHeader *>(memory);
+        header->magic = kFAFChannelMagic;
+        header->version = kFAFChannelVersion;
+        header->requestCapacity = requestCapacity;
+        header->verdictCapacity = verdictCapacity;
+
+        return attach(memory, size);
+    }
+
+    //
+    // Resolver side, capacities are taken from the header written by the filter
+    //
+    bool attach(void *memory, size_t size)
+    {
+        if (!memory || size < sizeof(FAFChannelHeader))
+        {
+            return false;
+        }
+
+        FAFChannelHeader header;
+        memcpy(&header, memory, sizeof(header));
+
+        if (header.magic != kFAFChannelMagic || header.version != kFAFChannelVersion ||
+            size < memorySize(header.requestCapacity, header.verdictCapacity))
+        {
+            return false;
+        }
+
+        uint8_t *requestRing = static_cast<uint8_t *>(memory) + RequestRingOffset();
+        uint8_t *verdictRing = requestRing + FAFFrameRing::memorySize(header.requestCapacity);
+
+        return m_requests.attach(requestRing, FAFFrameRing::memorySize(header.requestCapacity), header.requestCapacity) &&
+               m_verdicts.attach(verdictRing, FAFFrameRing::memorySize(header.verdictCapacity), header.verdictCapacity);
+    }
+
+    FAFFrameRing & requests()
+    {
+        return m_requests;
+    }
+
+    FAFFrameRing & verdicts()
+    {
+        return m_verdicts;
+    }
+
+private:
+    static constexpr size_t RequestRingOffset()
+    {
+        return (sizeof(FAFChannelHeader) + alignof(FAFFrameRingHeader) - 1) & ~(alignof(FAFFrameRingHeader) - 1);
+    }
+
+private:
+    FAFFrameRing m_requests;
+    FAFFrameRing m_verdicts;
+
+};
+
+//
+// One end of the socket pair connecting the filter and the resolver
+//
+class FAFDoorbell
+{
+public:
+    //
+    // Both ends are non-blocking for writing, pending byte is enough to wake the peer
+    //
+    static bool createPair(int &filter, int &resolver)
+    {
+        int fds[2] = { -1, -1 };
+        if (0 != socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+        {
+            return false;
+        }
+
+        for (int fd : fds)
+        {
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fcntl(fd, F_SETFD, FD_CLOEXEC);
+        }
+
+        filter = fds[0];
+        resolver = fds[1];
+
+        return true;
+    }
+
+    explicit FAFDoorbell(int fd = -1)
+        : m_fd(fd)
+    {
+    }
+
+    int fd() const
+    {
+        return m_fd;
+    }
+
+    void ring() const
+    {
+        const uint8_t byte = 1;
+        while (-1 == write(m_fd, &byte, sizeof(byte)) && EINTR == errno)
+        {
+        }
+    }
+
+    //
+    // Returns false if the peer closed its end or the doorbell was shut down
+    //
+    bool wait() const
+    {
+        pollfd descriptor = { m_fd, POLLIN, 0 };
+        if (-1 == poll(&descriptor, 1, -1))
+        {
+            return EINTR == errno;
+        }
+
+        uint8_t bytes[64];
+        const ssize_t count = read(m_fd, bytes, sizeof(bytes));
+
+        return count > 0 || (-1 == count && (EAGAIN == errno || EINTR == errno));
+    }
+
+    //
+    // Wakes the thread blocked in wait, which then returns false
+    //
+    void shutdown() const
+    {
+        ::shutdown(m_fd, SHUT_RDWR);
+    }
+
+private:
+    int m_fd;
+};
+
+//
+// Anonymous shared memory which can be passed to the peer as file descriptor
+//
+inline int FAFCreateChannelMemory(size_t size)
+{
+    char name[64];
+    for (uint32_t attempt = 0; attempt < 16; ++attempt)
+    {
+        snprintf(name, sizeof(name), "/faf.%d.%u.%u", getpid(), attempt, static_cast<uint32_t>(reinterpret_cast<uintptr_t>(name)));
+
+        const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (-1 == fd)
+        {
+            if (EEXIST == errno)
+            {
+                continue;
+            }
+
+            return -1;
+        }
+
+        shm_unlink(name);
+
+        if (0 != ftruncate(fd, static_cast<off_t>(size)))
+        {
+            close(fd);
+            return -1;
+        }
+
+        return fd;
+    }
+
+    return -1;
+}
+
+#endif /* FAFChannel_h */
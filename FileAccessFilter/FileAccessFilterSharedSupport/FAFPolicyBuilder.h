@@ -0,0 +1,33 @@
+//
+//  FAFPolicyBuilder.h
+//  FileAccessFilterSharedSupport
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+#import "FileAccessFilterSharedSupport.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+//
+// Rules of the snapshot pushed by -[FAFFileAccessFilter loadPolicySnapshot:completion:].
+// Rule of the most specific path decides, access in neither of its masks is interactive.
+// Not thread safe.
+//
+@interface FAFPolicyBuilder : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+
+- (BOOL)setAllowedAccess:(FAFAccessMask)allowed deniedAccess:(FAFAccessMask)denied forPath:(NSString *const)path;
+- (BOOL)removeRuleForPath:(NSString *const)path;
+- (void)removeAllRules;
+
+// Generation should grow with every snapshot pushed through the same connection
+- (NSData *)snapshotWithGeneration:(uint64_t)generation;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,46 @@
+//
+//  FAFPolicyBuilder.mm
+//  FileAccessFilterSharedSupport
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "FAFPolicyBuilder.h"
+
+#include "FAFPolicySnapshot.h"
+
+static_assert(FAFAccessMaskAll == kFGActionMaskAll, "access types should match FSGuard actions");
+
+@implementation FAFPolicyBuilder
+{
+    FAFPolicySnapshotBuilder _builder;
+}
+
+- (NSUInteger)count
+{
+    return _builder.ruleCount();
+}
+
+- (BOOL)setAllowedAccess:(FAFAccessMask)allowed deniedAccess:(FAFAccessMask)denied forPath:(NSString *const)path
+{
+    return _builder.addRule(path.fileSystemRepresentation, static_cast<uint32_t>(allowed), static_cast<uint32_t>(denied));
+}
+
+- (BOOL)removeRuleForPath:(NSString *const)path
+{
+    return _builder.removeRule(path.fileSystemRepresentation);
+}
+
+- (void)removeAllRules
+{
+    _builder.clear();
+}
+
+- (NSData *)snapshotWithGeneration:(uint64_t)generation
+{
+    const std::vector<uint8_t> snapshot = _builder.build(generation);
+    return [NSData dataWithBytes:snapshot.data() length:snapshot.size()];
+}
+
+@end
@@ -0,0 +1,278 @@
+//
+//  FAFPolicySnapshot.h
+//  FileAccessFilterSharedSupport
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FAFPolicySnapshot_h
+#define FAFPolicySnapshot_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <FSGuardPolicyBuilder.h>
+
+//
+// Rules of the app pushed to fileaccessfilterd, so the daemon decides requests itself.
+//
+// Snapshot is FAFPolicySnapshotHeader followed by FSGuardPolicy blob. Access allowed or
+// denied by the matching rule is decided by the daemon, access the rule has in neither
+// mask is interactive and is asked from the app, access matching no rule is allowed.
+// Snapshots are numbered by the app, the daemon ignores one older than it already has.
+//
+// FileGuard rules allow or deny every access, so with its snapshot loaded nothing is
+// interactive and the app is asked only before the first snapshot arrives. The batch
+// channel stays for apps whose rules leave some access to the user.
+//
+constexpr uint32_t kFAFPolicySnapshotMagic = 0x53504146; // 'FAPS'
+constexpr uint16_t kFAFPolicySnapshotVersion = 1;
+
+struct FAFPolicySnapshotHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint64_t generation;
+};
+
+class FAFPolicySnapshot
+{
+public:
+    //
+    // Validates untrusted data and keeps its copy, null if data is malformed
+    //
+    static std::shared_ptr<const FAFPolicySnapshot> Load(const void *data, size_t size)
+    {
+        if (!data || size < sizeof(FAFPolicySnapshotHeader))
+        {
+            return nullptr;
+        }
+
+        FAFPolicySnapshotHeader header;
+        memcpy(&header, data, sizeof(header));
+
+        if (kFAFPolicySnapshotMagic != header.magic ||
+            kFAFPolicySnapshotVersion != header.version ||
+            header.headerSize < sizeof(FAFPolicySnapshotHeader) ||
+            header.headerSize % alignof(FSGuardPolicyRule) ||
+            header.headerSize > size ||
+            size - header.headerSize > kFGMaxPolicySize)
+        {
+            return nullptr;
+        }
+
+        std::shared_ptr<FAFPolicySnapshot> snapshot(new FAFPolicySnapshot);
+        snapshot->m_generation = header.generation;
+
+        //
+        // Vector storage is aligned enough for the rules of the policy
+        //
+        const uint8_t *const policy = static_cast<const uint8_t *>(data) + header.headerSize;
+        snapshot->m_blob.assign(policy, policy + (size - header.headerSize));
+
+        if (!snapshot->m_policy.load(snapshot->m_blob.data(), snapshot->m_blob.size()))
+        {
+            return nullptr;
+        }
+
+        return snapshot;
+    }
+
+    uint64_t generation() const
+    {
+        return m_generation;
+    }
+
+    const FSGuardPolicy & policy() const
+    {
+        return m_policy;
+    }
+
+    //
+    // Access is denied if the rule denies any of the actions, allowed if it allows all of them
+    //
+    FSGuardPolicyVerdict evaluate(const char *path, uint32_t length, uint32_t actionMask) const
+    {
+        const FSGuardPolicyRule *rule = m_policy.match(path, length);
+        if (!rule)
+        {
+            return FSGuardPolicyVerdict::NoMatch;
+        }
+
+        if (rule->denyMask & actionMask)
+        {
+            return FSGuardPolicyVerdict::Deny;
+        }
+
+        if (actionMask == (rule->allowMask & actionMask))
+        {
+            return FSGuardPolicyVerdict::Allow;
+        }
+
+        return FSGuardPolicyVerdict::Ask;
+    }
+
+private:
+    FAFPolicySnapshot() = default;
+
+private:
+    uint64_t             m_generation = 0;
+    std::vector<uint8_t> m_blob;
+    FSGuardPolicy        m_policy;
+
+};
+
+class FAFPolicySnapshotBuilder
+{
+public:
+    //
+    // Access present in neither mask is interactive
+    //
+    bool addRule(const std::string &path, uint32_t allowMask, uint32_t denyMask)
+    {
+        return m_builder.addRule(path, allowMask, denyMask);
+    }
+
+    bool removeRule(const std::string &path)
+    {
+        return m_builder.removeRule(path);
+    }
+
+    void clear()
+    {
+        m_builder.clear();
+    }
+
+    size_t ruleCount() const
+    {
+        return m_builder.ruleCount();
+    }
+
+    std::vector<uint8_t> build(uint64_t generation) const
+    {
+        const std::vector<uint8_t> policy = m_builder.build();
+
+        FAFPolicySnapshotHeader header {};
+        header.magic = kFAFPolicySnapshotMagic;
+        header.version = kFAFPolicySnapshotVersion;
+        header.headerSize = sizeof(FAFPolicySnapshotHeader);
+        header.generation = generation;
+
+        std::vector<uint8_t> snapshot(sizeof(header) + policy.size());
+        memcpy(snapshot.data(), &header, sizeof(header));
+        memcpy(snapshot.data() + sizeof(header), policy.data(), policy.size());
+
+        return snapshot;
+    }
+
+private:
+    FSGuardPolicyBuilder m_builder;
+
+};
+
+//
+// Snapshot currently used by the daemon, evaluated concurrently by resolver threads.
+// Readers take the snapshot with atomic shared_ptr access, only loading snapshots
+// is serialized, so a reader never waits for another reader or for the writer
+//
+class FAFPolicyEvaluator
+{
+public:
+    enum class Result
+    {
+        Allow,
+        Deny,
+        Interactive
+    };
+
+    //
+    // Returns false if the snapshot is malformed or older than the current one
+    //
+    bool load(const void *data, size_t size)
+    {
+        std::shared_ptr<const FAFPolicySnapshot> snapshot = FAFPolicySnapshot::Load(data, size);
+        if (!snapshot)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_loadLock);
+
+        const std::shared_ptr<const FAFPolicySnapshot> previous = current();
+        if (previous && previous->generation() > snapshot->generation())
+        {
+            return false;
+        }
+
+        //
+        // Readers may still evaluate the previous snapshot, it is freed by the last of them
+        //
+        std::atomic_store_explicit(&m_snapshot, std::move(snapshot), std::memory_order_release);
+
+        return true;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_loadLock);
+
+        std::atomic_store_explicit(&m_snapshot, std::shared_ptr<const FAFPolicySnapshot>(), std::memory_order_release);
+    }
+
+    bool isLoaded() const
+    {
+        return nullptr != current();
+    }
+
+    //
+    // Without snapshot every access is interactive, as before the snapshot was pushed
+    //
+    Result evaluate(const char *path, uint32_t length, FSGuardAction action) const
+    {
+        return evaluate(path, length, FSGuardActionMask(action));
+    }
+
+    Result evaluate(const char *path, uint32_t length, uint32_t actionMask) const
+    {
+        const std::shared_ptr<const FAFPolicySnapshot> snapshot = current();
+        if (!snapshot)
+        {
+            return Result::Interactive;
+        }
+
+        switch (snapshot->evaluate(path, length, actionMask))
+        {
+            case FSGuardPolicyVerdict::Deny:
+                return Result::Deny;
+
+            case FSGuardPolicyVerdict::Ask:
+                return Result::Interactive;
+
+            case FSGuardPolicyVerdict::NoMatch:
+            case FSGuardPolicyVerdict::Allow:
+                return Result::Allow;
+        }
+
+        return Result::Allow;
+    }
+
+private:
+    std::shared_ptr<const FAFPolicySnapshot> current() const
+    {
+        return std::atomic_load_explicit(&m_snapshot, std::memory_order_acquire);
+    }
+
+private:
+    std::mutex                               m_loadLock;
+    std::shared_ptr<const FAFPolicySnapshot> m_snapshot;
+
+};
+
+#endif /* FAFPolicySnapshot_h */
@@ -0,0 +1,37 @@
+//
+//  FAFRuleIndex.h
+//  FileAccessFilterSharedSupport
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+//
+// Longest-prefix index of objects by path, matches whole path components only.
+// Not thread safe, modifications should be serialized against lookups.
+//
+@interface FAFRuleIndex<ObjectType> : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+
+// Returns NO for path which is empty, relative or the root
+- (BOOL)setObject:(ObjectType)object forPath:(NSString *const)path;
+- (BOOL)removeObjectForPath:(NSString *const)path;
+- (void)removeAllObjects;
+
+// Object stored exactly for the path
+- (nullable ObjectType)objectForPath:(NSString *const)path;
+
+// Object of the most specific path that is the path itself or its parent directory
+- (nullable ObjectType)objectMatchingPath:(NSString *const)path;
+
+// The same for path in file system representation, no string is created
+- (nullable ObjectType)objectMatchingFileSystemPath:(const char *const)path;
+
+@end
+
+NS_ASSUME_NONNULL_END
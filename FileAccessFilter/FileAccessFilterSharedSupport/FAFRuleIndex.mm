@@ -0,0 +1,70 @@
+//
+//  FAFRuleIndex.mm
+//  FileAccessFilterSharedSupport
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#import "FAFRuleIndex.h"
+
+#include <FSGuardRuleIndex.h>
+
+static std::string_view FAFPathView(NSString *const path)
+{
+    return path.length ? path.fileSystemRepresentation : "";
+}
+
+@implementation FAFRuleIndex
+{
+    FSGuardRuleIndex<id> _index;
+}
+
+- (NSUInteger)count
+{
+    return _index.size();
+}
+
+- (BOOL)setObject:(id)object forPath:(NSString *const)path
+{
+    //
+    // fileSystemRepresentation raises for empty string, root would match every file
+    //
+    const std::string_view view = FAFPathView(path);
+    if (std::string_view::npos == view.find_first_not_of('/'))
+    {
+        return NO;
+    }
+
+    return _index.insert(view, object);
+}
+
+- (BOOL)removeObjectForPath:(NSString *const)path
+{
+    return _index.erase(FAFPathView(path));
+}
+
+- (void)removeAllObjects
+{
+    _index.clear();
+}
+
+- (id)objectForPath:(NSString *const)path
+{
+    const id *object = _index.find(FAFPathView(path));
+    return object ? *object : nil;
+}
+
+- (id)objectMatchingPath:(NSString *const)path
+{
+    const id *object = _index.match(FAFPathView(path));
+    return object ? *object : nil;
+}
+
+- (id)objectMatchingFileSystemPath:(const char *const)path
+{
+    const id *object = _index.match(path);
+    return object ? *object : nil;
+}
+
+@end
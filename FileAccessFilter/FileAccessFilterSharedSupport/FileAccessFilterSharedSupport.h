@@ -8,6 +8,8 @@
 
 #import <Foundation/Foundation.h>
 
+#import "FAFRuleIndex.h"
+
 NS_ASSUME_NONNULL_BEGIN
 
 extern NSString *const FAFFileAccessServiceMachName;
@@ -15,7 +17,22 @@ extern NSString *const FAFFileAccessServiceMachName;
 typedef NS_ENUM(NSUInteger, FAFAccessType) {
     FAFAccessTypeRead,
     FAFAccessTypeWrite,
-    FAFAccessTypeExecute
+    FAFAccessTypeExecute,
+    FAFAccessTypeDelete,
+    FAFAccessTypeAppend,
+    FAFAccessTypeReadMetadata,
+    FAFAccessTypeWriteMetadata
+};
+
+typedef NS_OPTIONS(NSUInteger, FAFAccessMask) {
+    FAFAccessMaskRead = 1 << FAFAccessTypeRead,
+    FAFAccessMaskWrite = 1 << FAFAccessTypeWrite,
+    FAFAccessMaskExecute = 1 << FAFAccessTypeExecute,
+    FAFAccessMaskDelete = 1 << FAFAccessTypeDelete,
+    FAFAccessMaskAppend = 1 << FAFAccessTypeAppend,
+    FAFAccessMaskReadMetadata = 1 << FAFAccessTypeReadMetadata,
+    FAFAccessMaskWriteMetadata = 1 << FAFAccessTypeWriteMetadata,
+    FAFAccessMaskAll = (1 << (FAFAccessTypeWriteMetadata + 1)) - 1
 };
 
 @interface FAFRequest : NSObject<NSSecureCoding>
@@ -32,6 +49,14 @@ typedef NS_ENUM(NSUInteger, FAFAccessType) {
 
 @protocol FAFFileAccessFilter
 - (void)registerResolutionDelegate:(id<FAFResolutionDelegate> const _Nullable)delegate completion:(void(^)(const BOOL success))handler;
+
+// Requests are resolved in batches through FAFBatchChannel attached to the memory and doorbell
+// instead of the resolution delegate. Registering nil resolution delegate stops the channel
+- (void)registerBatchResolutionWithCompletion:(void(^)(NSFileHandle *const _Nullable memory, NSFileHandle *const _Nullable doorbell))handler;
+
+// Rules serialized by FAFPolicyBuilder are evaluated by the filter itself, only access left
+// interactive by the matching rule is resolved by the app. Snapshot older than loaded one is rejected
+- (void)loadPolicySnapshot:(NSData *const)snapshot completion:(void(^)(const BOOL success))handler;
 @end
 
 
@@ -46,3 +71,6 @@ typedef NS_ENUM(NSUInteger, FAFAccessType) {
 NSXPCInterface * FAFCreateXPCFileAccessFilterInterface(void);
 
 NS_ASSUME_NONNULL_END
+
+#import "FAFBatchChannel.h"
+#import "FAFPolicyBuilder.h"
@@ -0,0 +1,124 @@
+//
+//  FAFChannelResolver.h
+//  fileaccessfilterd
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FAFChannelResolver_h
+#define FAFChannelResolver_h
+
+#include <FileAccessFilterSharedSupport/FAFChannel.h>
+#include <FileAccessFilterSharedSupport/FAFPolicySnapshot.h>
+#include <FSGuardResolver.h>
+
+#include <coroutine>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// Resolves FSGuard requests by the app connected through FAFChannel.
+//
+// Suspended request is identified in the channel by its pending slot and the slot
+// generation, so verdict sent by the app for unknown or finished request is ignored.
+// Verdicts are read in batches by the channel thread which resumes the requests.
+// Requests decided by the policy snapshot complete without suspension.
+//
+class FAFChannelResolver : public FSGuardResolver
+{
+public:
+    static constexpr uint32_t kPendingCapacity = 4096;
+
+    explicit FAFChannelResolver(const FAFPolicyEvaluator &policy)
+        : m_policy(policy)
+    {
+    }
+
+    ~FAFChannelResolver() override;
+
+    FAFChannelResolver(const FAFChannelResolver &) = delete;
+    FAFChannelResolver & operator=(const FAFChannelResolver &) = delete;
+
+    //
+    // Creates the channel, memory and doorbell descriptors are to be sent to the app
+    // and closed by the caller
+    //
+    bool start(int &memoryFd, int &doorbellFd);
+
+    //
+    // Pending requests are allowed, the app is not asked anymore. The same
+    // happens when the app closes the channel
+    //
+    void stop();
+
+    FSGuardVerdictTask resolve(const FSGuardRequest &request, FSGuardResolverExecutor &executor) override;
+
+private:
+    class VerdictAwaiter
+    {
+    public:
+        VerdictAwaiter(FAFChannelResolver &resolver, const FSGuardRequest &request)
+            : m_resolver(resolver)
+            , m_request(request)
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        //
+        // Request is not suspended if it could not be sent to the app
+        //
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            m_handle = handle;
+            return m_resolver.send(*this);
+        }
+
+        bool await_resume() const noexcept
+        {
+            return m_allow;
+        }
+
+    private:
+        friend class FAFChannelResolver;
+
+        FAFChannelResolver    &m_resolver;
+        const FSGuardRequest  &m_request;
+        std::coroutine_handle<> m_handle;
+        bool                    m_allow = true;
+    };
+
+    struct PendingSlot
+    {
+        VerdictAwaiter *awaiter = nullptr;
+        uint32_t        generation = 0;
+        uint32_t        nextFree = 0;
+    };
+
+    bool send(VerdictAwaiter &awaiter);
+    VerdictAwaiter * take(uint64_t id);
+    void channelLoop();
+    void resumeAll();
+
+private:
+    const FAFPolicyEvaluator &m_policy;
+
+    std::mutex               m_lock;
+    FAFChannel               m_channel;
+    FAFDoorbell              m_doorbell;
+    void                    *m_memory = nullptr;
+    size_t                   m_memorySize = 0;
+    bool                     m_connected = false;
+
+    std::vector<PendingSlot> m_pending;
+    uint32_t                 m_firstFree = 0;
+
+    std::thread              m_thread;
+};
+
+#endif /* FAFChannelResolver_h */
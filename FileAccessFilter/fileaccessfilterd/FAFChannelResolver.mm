@@ -0,0 +1,276 @@
+//
+//  FAFChannelResolver.mm
+//  fileaccessfilterd
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FAFChannelResolver.h"
+
+#include <sys/mman.h>
+
+static constexpr uint32_t kFAFInvalidSlot = UINT32_MAX;
+
+static uint64_t FAFMakeRequestId(uint32_t slot, uint32_t generation)
+{
+    return (static_cast<uint64_t>(generation) << 32) | slot;
+}
+
+FAFChannelResolver::~FAFChannelResolver()
+{
+    stop();
+}
+
+bool FAFChannelResolver::start(int &memoryFd, int &doorbellFd)
+{
+    if (m_thread.joinable())
+    {
+        return false;
+    }
+
+    const size_t memorySize = FAFChannel::memorySize(kFAFChannelRequestCapacity, kFAFChannelVerdictCapacity);
+
+    const int memory = FAFCreateChannelMemory(memorySize);
+    if (-1 == memory)
+    {
+        return false;
+    }
+
+    void *const mapping = mmap(nullptr, memorySize, PROT_READ | PROT_WRITE, MAP_SHARED, memory, 0);
+    int filterDoorbell = -1;
+    int resolverDoorbell = -1;
+
+    if (MAP_FAILED == mapping || !FAFDoorbell::createPair(filterDoorbell, resolverDoorbell))
+    {
+        if (MAP_FAILED != mapping)
+        {
+            munmap(mapping, memorySize);
+        }
+
+        close(memory);
+        return false;
+    }
+
+    m_memory = mapping;
+    m_memorySize = memorySize;
+    m_channel.create(m_memory, m_memorySize, kFAFChannelRequestCapacity, kFAFChannelVerdictCapacity);
+    m_doorbell = FAFDoorbell(filterDoorbell);
+
+    m_pending.assign(kPendingCapacity, PendingSlot());
+    for (uint32_t slot = 0; slot < kPendingCapacity; ++slot)
+    {
+        m_pending[slot].nextFree = slot + 1 < kPendingCapacity ? slot + 1 : kFAFInvalidSlot;
+    }
+
+    m_firstFree = 0;
+    m_connected = true;
+    m_thread = std::thread(&FAFChannelResolver::channelLoop, this);
+
+    memoryFd = memory;
+    doorbellFd = resolverDoorbell;
+
+    return true;
+}
+
+void FAFChannelResolver::stop()
+{
+    if (!m_thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_connected = false;
+    }
+
+    m_doorbell.shutdown();
+    m_thread.join();
+
+    resumeAll();
+
+    close(m_doorbell.fd());
+    m_doorbell = FAFDoorbell();
+
+    munmap(m_memory, m_memorySize);
+    m_memory = nullptr;
+    m_memorySize = 0;
+}
+
+FSGuardVerdictTask FAFChannelResolver::resolve(const FSGuardRequest &request, FSGuardResolverExecutor &)
+{
+    switch (m_policy.evaluate(request.filePath, request.filePathLength, request.action))
+    {
+        case FAFPolicyEvaluator::Result::Allow:
+            co_return true;
+
+        case FAFPolicyEvaluator::Result::Deny:
+            co_return false;
+
+        case FAFPolicyEvaluator::Result::Interactive:
+            break;
+    }
+
+    co_return co_await VerdictAwaiter(*this, request);
+}
+
+bool FAFChannelResolver::send(VerdictAwaiter &awaiter)
+{
+    const FSGuardRequest &request = awaiter.m_request;
+    bool notify = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        //
+        // Too many requests wait for the app, let the access go through
+        //
+        if (!m_connected || kFAFInvalidSlot == m_firstFree)
+        {
+            return false;
+        }
+
+        const uint32_t slot = m_firstFree;
+        PendingSlot &pending = m_pending[slot];
+
+        FAFRequestFrame *frame = static_cast<FAFRequestFrame *>(m_channel.requests().allocate(sizeof(FAFRequestFrame) + request.filePathLength + 1));
+        if (!frame)
+        {
+            return false;
+        }
+
+        frame->id = FAFMakeRequestId(slot, pending.generation);
+        frame->pid = request.pid;
+        frame->accessType = static_cast<uint32_t>(request.action);
+        frame->pathLength = request.filePathLength;
+        frame->reserved = 0;
+
+        char *const path = reinterpret_cast<char *>(frame + 1);
+        memcpy(path, request.filePath, request.filePathLength);
+        path[request.filePathLength] = '\0';
+
+        m_firstFree = pending.nextFree;
+        pending.awaiter = &awaiter;
+
+        //
+        // Awaiter may be resumed by the channel thread as soon as the lock is released
+        //
+        notify = m_channel.requests().commit();
+    }
+
+    if (notify)
+    {
+        m_doorbell.ring();
+    }
+
+    return true;
+}
+
+FAFChannelResolver::VerdictAwaiter * FAFChannelResolver::take(uint64_t id)
+{
+    const uint32_t slot = static_cast<uint32_t>(id);
+    const uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+    if (slot >= m_pending.size())
+    {
+        return nullptr;
+    }
+
+    PendingSlot &pending = m_pending[slot];
+    if (!pending.awaiter || pending.generation != generation)
+    {
+        return nullptr;
+    }
+
+    VerdictAwaiter *const awaiter = pending.awaiter;
+
+    pending.awaiter = nullptr;
+    ++pending.generation;
+    pending.nextFree = m_firstFree;
+    m_firstFree = slot;
+
+    return awaiter;
+}
+
+void FAFChannelResolver::channelLoop()
+{
+    std::vector<VerdictAwaiter *> resumed;
+    resumed.reserve(kPendingCapacity);
+
+    FAFFrameRing &verdicts = m_channel.verdicts();
+
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            verdicts.read([&](const void *data, uint32_t size) {
+                if (size < sizeof(FAFVerdictFrame))
+                {
+                    return;
+                }
+
+                FAFVerdictFrame frame;
+                memcpy(&frame, data, sizeof(frame));
+
+                if (VerdictAwaiter *const awaiter = take(frame.id))
+                {
+                    awaiter->m_allow = 0 != frame.allow;
+                    resumed.push_back(awaiter);
+                }
+            });
+
+            verdicts.release();
+        }
+
+        //
+        // Resumed request only posts its verdict to the driver, so it runs right here
+        //
+        for (VerdictAwaiter *const awaiter : resumed)
+        {
+            awaiter->m_handle.resume();
+        }
+
+        if (!resumed.empty())
+        {
+            resumed.clear();
+            continue;
+        }
+
+        if (verdicts.prepareToWait() && !m_doorbell.wait())
+        {
+            break;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_connected = false;
+    }
+
+    resumeAll();
+}
+
+void FAFChannelResolver::resumeAll()
+{
+    std::vector<VerdictAwaiter *> resumed;
+
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        for (uint32_t slot = 0; slot < m_pending.size(); ++slot)
+        {
+            PendingSlot &pending = m_pending[slot];
+            if (VerdictAwaiter *const awaiter = take(FAFMakeRequestId(slot, pending.generation)))
+            {
+                resumed.push_back(awaiter);
+            }
+        }
+    }
+
+    for (VerdictAwaiter *const awaiter : resumed)
+    {
+        awaiter->m_handle.resume();
+    }
+}
@@ -7,16 +7,23 @@
 //
 
 #import "FileAccessFilter.h"
+#import "FAFChannelResolver.h"
 
 #import <FSGuardLib.h>
 #import <IOKit/kext/KextManager.h>
 
+#include <memory>
+
 @interface FileAccessFilter () <FSGuardClientDelegate>
 @property (nullable, atomic, strong) id<FAFResolutionDelegate> delegate;
 @property (nullable, atomic, strong) FSGuardClient *fsGuard;
 @end
 
 @implementation FileAccessFilter
+{
+    std::unique_ptr<FAFChannelResolver> _channelResolver;
+    FAFPolicyEvaluator                  _policy;
+}
 
 - (void)loadKEXT:(NSURL *const)kext identifier:(NSString *const)bundleIdentifier completion:(void (^)(const NSInteger))handler
 {
@@ -81,28 +88,105 @@
 
 - (void)registerResolutionDelegate:(id<FAFResolutionDelegate> const _Nullable)delegate completion:(void (^)(const BOOL))handler
 {
+    [self stopFSGuard];
+
     self.delegate = delegate;
     if (delegate)
     {
-        self.fsGuard = [[FSGuardClient alloc] init];
-        self.fsGuard.delegate = self;
+        FSGuardClient *const fsGuard = [[FSGuardClient alloc] init];
+        fsGuard.delegate = self;
 
-        __weak typeof(self) weakSelf = self;
-        [NSThread detachNewThreadWithBlock:^{
-            [weakSelf.fsGuard start];
-        }];
+        [self startFSGuard:fsGuard];
     }
-    else
+    
+    handler(YES);
+}
+
+- (void)registerBatchResolutionWithCompletion:(void (^)(NSFileHandle *const _Nullable, NSFileHandle *const _Nullable))handler
+{
+    [self stopFSGuard];
+
+    self.delegate = nil;
+
+    std::unique_ptr<FAFChannelResolver> resolver(new FAFChannelResolver(_policy));
+
+    int memory = -1;
+    int doorbell = -1;
+    if (!resolver->start(memory, doorbell))
     {
-        [self.fsGuard stop];
-        self.fsGuard = nil;
+        handler(nil, nil);
+        return;
     }
-    
+
+    _channelResolver = std::move(resolver);
+
+    FSGuardClient *const fsGuard = [[FSGuardClient alloc] init];
+    fsGuard.resolver = _channelResolver.get();
+
+    [self startFSGuard:fsGuard];
+
+    handler([[NSFileHandle alloc] initWithFileDescriptor:memory closeOnDealloc:YES],
+            [[NSFileHandle alloc] initWithFileDescriptor:doorbell closeOnDealloc:YES]);
+}
+
+- (void)loadPolicySnapshot:(NSData *const)snapshot completion:(void (^)(const BOOL))handler
+{
+    if (!_policy.load(snapshot.bytes, snapshot.length))
+    {
+        handler(NO);
+        return;
+    }
+
+    //
+    // Verdicts cached by the driver were given by the previous rules
+    //
+    [self.fsGuard flushVerdictCache];
+
     handler(YES);
 }
 
+- (void)startFSGuard:(FSGuardClient *const)fsGuard
+{
+    self.fsGuard = fsGuard;
+
+    [NSThread detachNewThreadWithBlock:^{
+        [fsGuard start];
+    }];
+}
+
+- (void)stopFSGuard
+{
+    //
+    // Client is joined first, its dequeue loop and resolver threads no longer use
+    // the resolver. Requests waiting for the app are allowed while the client is still alive
+    //
+    [self.fsGuard stop];
+
+    if (_channelResolver)
+    {
+        _channelResolver->stop();
+        _channelResolver.reset();
+    }
+
+    self.fsGuard = nil;
+}
+
 - (void)resolveRequest:(const FSGuardRequest *)request withCompletion:(void (^)(BOOL))completion
 {
+    switch (_policy.evaluate(request->filePath, request->filePathLength, request->action))
+    {
+        case FAFPolicyEvaluator::Result::Allow:
+            completion(YES);
+            return;
+
+        case FAFPolicyEvaluator::Result::Deny:
+            completion(NO);
+            return;
+
+        case FAFPolicyEvaluator::Result::Interactive:
+            break;
+    }
+
     id<FAFResolutionDelegate> const delegate = self.delegate;
     if (!delegate)
     {
@@ -28,9 +28,12 @@ protocol IFileGuardStateObserver: class {
 
 class FileGuard {
     private let ruleQueue = DispatchQueue(label: "", attributes: .concurrent,target: DispatchQueue.global())
-    private var rules: [AccessRule] = []
+    private let rules = FAFRuleIndex<AccessRule>()
+    private let policy = FAFPolicyBuilder()
+    private var policyGeneration: UInt64 = 0
     
     private let fileAccessFilter: FAFFileAccessFilter
+    private var channel: FAFBatchChannel?
     
     
     weak var observer: IFileGuardStateObserver?
@@ -40,24 +43,43 @@ class FileGuard {
     }
     
     func addRule(_ rule: AccessRule) {
-        ruleQueue.async(flags: .barrier) { self.rules.append(rule) }
+        ruleQueue.async(flags: .barrier) {
+            self.rules.setObject(rule, forPath: rule.path)
+            self.policy.setAllowedAccess(rule.policy.allowedAccess, deniedAccess: rule.policy.deniedAccess, forPath: rule.path)
+            self.pushPolicy()
+        }
     }
     
     func removeRule(_ rule: AccessRule) {
-        ruleQueue.async(flags: .barrier) { self.rules.removeAll(where: { $0 === rule }) }
+        ruleQueue.async(flags: .barrier) {
+            if self.rules.object(forPath: rule.path) === rule {
+                self.rules.removeObject(forPath: rule.path)
+                self.policy.removeRule(forPath: rule.path)
+                self.pushPolicy()
+            }
+        }
     }
     
     func start() {
-        fileAccessFilter.register(self) { (success) in
-            if success {
-                self.observer?.fileGuardDidStart()
-            } else {
+        ruleQueue.async(flags: .barrier) { self.pushPolicy() }
+        
+        fileAccessFilter.registerBatchResolution { (memory, doorbell) in
+            guard let memory = memory, let doorbell = doorbell,
+                let channel = FAFBatchChannel(memory: memory, doorbell: doorbell) else {
                 self.observer?.fileGuardDidHandleCriticalError("Failed to start monitoring.")
+                return
             }
+            
+            channel.start { [weak self] (batch) in self?.resolveBatch(batch) }
+            self.channel = channel
+            self.observer?.fileGuardDidStart()
         }
     }
     
     func stop() {
+        channel?.stop()
+        channel = nil
+        
         fileAccessFilter.register(nil) { (success) in
             if success {
                 self.observer?.fileGuardDidStop()
@@ -68,6 +90,37 @@ class FileGuard {
     }
 }
 
+private extension FileGuard {
+    // Called on ruleQueue with barrier, the filter decides requests by the rules from now on
+    func pushPolicy() {
+        policyGeneration += 1
+        
+        fileAccessFilter.loadPolicySnapshot(policy.snapshot(withGeneration: policyGeneration)) { (success) in
+            if !success {
+                self.observer?.fileGuardDidHandleCriticalError("Failed to apply access rules.")
+            }
+        }
+    }
+    
+    // Rules allow or deny every access, so the filter asks only before the first snapshot is loaded
+    func resolveBatch(_ batch: FAFRequestBatch) {
+        ruleQueue.sync {
+            for index in 0..<batch.count {
+                let rule = self.rules.objectMatchingFileSystemPath(batch.fileSystemPath(at: index))
+                
+                switch rule?.policy {
+                case .noaccess?:
+                    batch.setAllow(false, at: index)
+                case .readonly?:
+                    batch.setAllow(!batch.accessType(at: index).isModifying, at: index)
+                case .readwrite?, .none:
+                    break
+                }
+            }
+        }
+    }
+}
+
 extension FileGuard: FAFResolutionDelegate {
     func resolveFileAccessRequest(_ request: FAFRequest, withHandler handler: @escaping (Bool) -> Void) {
         DispatchQueue.global().async {
@@ -77,7 +130,7 @@ extension FileGuard: FAFResolutionDelegate {
             case .noaccess?:
                 handler(false)
             case .readonly?:
-                handler(request.accessType != .write)
+                handler(!request.accessType.isModifying)
             case .readwrite?, .none:
                 handler(true)
             }
@@ -85,7 +138,39 @@ extension FileGuard: FAFResolutionDelegate {
     }
     
     private func findRule(for request: FAFRequest) -> AccessRule? {
-        return ruleQueue.sync { self.rules.first { request.file.path.starts(with: $0.path) } }
+        return ruleQueue.sync { self.rules.objectMatchingPath(request.file.path) }
+    }
+}
+
+extension Policy {
+    var allowedAccess: FAFAccessMask {
+        switch self {
+        case .readwrite:
+            return .all
+        case .readonly:
+            return FAFAccessMask.all.subtracting(.modifying)
+        case .noaccess:
+            return []
+        }
+    }
+    
+    var deniedAccess: FAFAccessMask {
+        return FAFAccessMask.all.subtracting(allowedAccess)
+    }
+}
+
+extension FAFAccessMask {
+    static let modifying: FAFAccessMask = [.write, .append, .delete, .writeMetadata]
+}
+
+extension FAFAccessType {
+    var isModifying: Bool {
+        switch self {
+        case .write, .append, .delete, .writeMetadata:
+            return true
+        default:
+            return false
+        }
     }
 }
 
@@ -0,0 +1,131 @@
+//
+//  ActionClassifier.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ActionClassifier_h
+#define ActionClassifier_h
+
+#include <stdint.h>
+
+#include "FSGuardUserClientInterface.h"
+
+//
+// NOTE: portable decoder of KAuth vnode scope actions, bit values mirror
+//       KAUTH_VNODE_* from sys/kauth.h and are checked by the driver
+//
+constexpr uint32_t kVnodeReadData           = 1u << 1;  // KAUTH_VNODE_LIST_DIRECTORY for directories
+constexpr uint32_t kVnodeWriteData          = 1u << 2;  // KAUTH_VNODE_ADD_FILE for directories
+constexpr uint32_t kVnodeExecute            = 1u << 3;  // KAUTH_VNODE_SEARCH for directories
+constexpr uint32_t kVnodeDelete             = 1u << 4;
+constexpr uint32_t kVnodeAppendData         = 1u << 5;  // KAUTH_VNODE_ADD_SUBDIRECTORY for directories
+constexpr uint32_t kVnodeDeleteChild        = 1u << 6;
+constexpr uint32_t kVnodeReadAttributes     = 1u << 7;
+constexpr uint32_t kVnodeWriteAttributes    = 1u << 8;
+constexpr uint32_t kVnodeReadExtAttributes  = 1u << 9;
+constexpr uint32_t kVnodeWriteExtAttributes = 1u << 10;
+constexpr uint32_t kVnodeReadSecurity       = 1u << 11;
+constexpr uint32_t kVnodeWriteSecurity      = 1u << 12;
+constexpr uint32_t kVnodeTakeOwnership      = 1u << 13;
+constexpr uint32_t kVnodeAccess             = 1u << 31;
+
+struct ActionClassification
+{
+    uint32_t vnodeAction;
+    uint32_t fileMask;
+    uint32_t directoryMask;
+};
+
+constexpr uint32_t kReadMask          = FSGuardActionMask(FSGuardAction::Read);
+constexpr uint32_t kWriteMask         = FSGuardActionMask(FSGuardAction::Write);
+constexpr uint32_t kExecuteMask       = FSGuardActionMask(FSGuardAction::Execute);
+constexpr uint32_t kDeleteMask        = FSGuardActionMask(FSGuardAction::Delete);
+constexpr uint32_t kAppendMask        = FSGuardActionMask(FSGuardAction::Append);
+constexpr uint32_t kReadMetadataMask  = FSGuardActionMask(FSGuardAction::ReadMetadata);
+constexpr uint32_t kWriteMetadataMask = FSGuardActionMask(FSGuardAction::WriteMetadata);
+
+//
+// NOTE: directory search is path traversal, it is not reported at all
+//
+constexpr ActionClassification kActionClassifications[] =
+{
+    { kVnodeReadData,           kReadMask,          kReadMask          },
+    { kVnodeWriteData,          kWriteMask,         kWriteMask         },
+    { kVnodeExecute,            kExecuteMask,       0                  },
+    { kVnodeDelete,             kDeleteMask,        kDeleteMask        },
+    { kVnodeAppendData,         kAppendMask,        kWriteMask         },
+    { kVnodeDeleteChild,        0,                  kDeleteMask        },
+    { kVnodeReadAttributes,     kReadMetadataMask,  kReadMetadataMask  },
+    { kVnodeWriteAttributes,    kWriteMetadataMask, kWriteMetadataMask },
+    { kVnodeReadExtAttributes,  kReadMetadataMask,  kReadMetadataMask  },
+    { kVnodeWriteExtAttributes, kWriteMetadataMask, kWriteMetadataMask },
+    { kVnodeReadSecurity,       kReadMetadataMask,  kReadMetadataMask  },
+    { kVnodeWriteSecurity,      kWriteMetadataMask, kWriteMetadataMask },
+    { kVnodeTakeOwnership,      kWriteMetadataMask, kWriteMetadataMask },
+};
+
+//
+// NOTE: actions of the mask are decided in this order, so the most significant
+//       one is asked first and a denied one ends the decision early
+//
+constexpr FSGuardAction kActionPriority[] =
+{
+    FSGuardAction::Execute,
+    FSGuardAction::Delete,
+    FSGuardAction::Write,
+    FSGuardAction::Append,
+    FSGuardAction::WriteMetadata,
+    FSGuardAction::Read,
+    FSGuardAction::ReadMetadata,
+};
+
+static_assert(sizeof(kActionPriority) / sizeof(kActionPriority[0]) == kFGActionCount, "all actions should have priority");
+
+//
+// NOTE: returns mask of FSGuardAction bits, zero if action should not be reported
+//
+inline uint32_t ClassifyVnodeAction(uint32_t vnodeAction, bool isDirectory)
+{
+    //
+    // NOTE: access(2) and similar checks do not perform the operation
+    //
+    if (vnodeAction & kVnodeAccess)
+    {
+        return 0;
+    }
+
+    uint32_t mask = 0;
+    for (const ActionClassification &classification : kActionClassifications)
+    {
+        if (vnodeAction & classification.vnodeAction)
+        {
+            mask |= isDirectory ? classification.directoryMask : classification.fileMask;
+        }
+    }
+
+    return mask;
+}
+
+//
+// NOTE: takes the first action of the mask in priority order out of it,
+//       false when the mask has no actions left
+//
+inline bool NextAction(uint32_t &mask, FSGuardAction &action)
+{
+    for (FSGuardAction candidate : kActionPriority)
+    {
+        if (mask & FSGuardActionMask(candidate))
+        {
+            mask &= ~FSGuardActionMask(candidate);
+            action = candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#endif /* ActionClassifier_h */
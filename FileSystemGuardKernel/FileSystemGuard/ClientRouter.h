@@ -0,0 +1,129 @@
+//
+//  ClientRouter.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ClientRouter_h
+#define ClientRouter_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FSGuardUserClientInterface.h"
+
+//
+// NOTE: portable routing of requests between connected clients.
+//
+//       Every client occupies a slot with its subscription mask, a request
+//       goes to one of the clients subscribed to its action chosen by
+//       rendezvous hashing of the routing key, so connecting or closing
+//       a client moves only keys of that client. Owner serializes adding
+//       and removing slots against routing, masks may change concurrently.
+//
+template <uint32_t SlotCount>
+class ClientRouter
+{
+    static_assert(SlotCount > 0 && SlotCount <= 32, "SlotCount must fit into the slot bitmap");
+
+public:
+    static constexpr uint32_t kInvalidSlot = UINT32_MAX;
+
+    //
+    // NOTE: returns kInvalidSlot if all slots are in use
+    //
+    uint32_t add(uint32_t mask)
+    {
+        for (uint32_t slot = 0; slot < SlotCount; ++slot)
+        {
+            if (!(m_used & (1u << slot)))
+            {
+                m_used |= 1u << slot;
+                setMask(slot, mask);
+                return slot;
+            }
+        }
+
+        return kInvalidSlot;
+    }
+
+    void remove(uint32_t slot)
+    {
+        m_used &= ~(1u << slot);
+        setMask(slot, 0);
+    }
+
+    void setMask(uint32_t slot, uint32_t mask)
+    {
+        __atomic_store_n(&m_masks[slot], mask & kFGActionMaskAll, __ATOMIC_RELAXED);
+    }
+
+    bool isUsed(uint32_t slot) const
+    {
+        return slot < SlotCount && (m_used & (1u << slot));
+    }
+
+    uint32_t count() const
+    {
+        return static_cast<uint32_t>(__builtin_popcount(m_used));
+    }
+
+    //
+    // NOTE: actions at least one client is subscribed to
+    //
+    uint32_t mask() const
+    {
+        uint32_t mask = 0;
+        for (uint32_t slot = 0; slot < SlotCount; ++slot)
+        {
+            mask |= __atomic_load_n(&m_masks[slot], __ATOMIC_RELAXED);
+        }
+
+        return mask;
+    }
+
+    uint32_t route(FSGuardAction action, uint64_t key) const
+    {
+        const uint32_t actionMask = FSGuardActionMask(action);
+
+        uint32_t result = kInvalidSlot;
+        uint64_t resultWeight = 0;
+
+        for (uint32_t slot = 0; slot < SlotCount; ++slot)
+        {
+            if (!(__atomic_load_n(&m_masks[slot], __ATOMIC_RELAXED) & actionMask))
+            {
+                continue;
+            }
+
+            const uint64_t weight = Mix(key ^ (static_cast<uint64_t>(slot + 1) * 0x9E3779B97F4A7C15ull));
+            if (kInvalidSlot == result || weight > resultWeight)
+            {
+                result = slot;
+                resultWeight = weight;
+            }
+        }
+
+        return result;
+    }
+
+private:
+    //
+    // NOTE: splitmix64 finalizer, every key bit affects every weight bit
+    //
+    static uint64_t Mix(uint64_t value)
+    {
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+        return value ^ (value >> 31);
+    }
+
+private:
+    uint32_t m_used = 0;
+    uint32_t m_masks[SlotCount] {};
+
+};
+
+#endif /* ClientRouter_h */
@@ -8,9 +8,11 @@
 
 #include "FSGuardService.h"
 #include "FSGuardUserClient.h"
+#include "ActionClassifier.h"
 #include "Utils.h"
 
 #include <sys/proc.h>
+#include <sys/mount.h>
 
 #define super IOService
 
@@ -18,29 +20,300 @@ OSDefineMetaClassAndStructors(FSGuardService, IOService)
 
 constexpr pid_t kInvalidDaemonPid = -1;
 
-static bool InitFSGuardRequest(kauth_action_t action, vnode_t vp, FSGuardRequest &request)
+constexpr UInt32 kVerdictCacheTimeout = 5;
+
+static_assert(kVnodeReadData == KAUTH_VNODE_READ_DATA, "KAuth action mismatch");
+static_assert(kVnodeWriteData == KAUTH_VNODE_WRITE_DATA, "KAuth action mismatch");
+static_assert(kVnodeExecute == KAUTH_VNODE_EXECUTE, "KAuth action mismatch");
+static_assert(kVnodeDelete == KAUTH_VNODE_DELETE, "KAuth action mismatch");
+static_assert(kVnodeAppendData == KAUTH_VNODE_APPEND_DATA, "KAuth action mismatch");
+static_assert(kVnodeDeleteChild == KAUTH_VNODE_DELETE_CHILD, "KAuth action mismatch");
+static_assert(kVnodeReadAttributes == KAUTH_VNODE_READ_ATTRIBUTES, "KAuth action mismatch");
+static_assert(kVnodeWriteAttributes == KAUTH_VNODE_WRITE_ATTRIBUTES, "KAuth action mismatch");
+static_assert(kVnodeReadExtAttributes == KAUTH_VNODE_READ_EXTATTRIBUTES, "KAuth action mismatch");
+static_assert(kVnodeWriteExtAttributes == KAUTH_VNODE_WRITE_EXTATTRIBUTES, "KAuth action mismatch");
+static_assert(kVnodeReadSecurity == KAUTH_VNODE_READ_SECURITY, "KAuth action mismatch");
+static_assert(kVnodeWriteSecurity == KAUTH_VNODE_WRITE_SECURITY, "KAuth action mismatch");
+static_assert(kVnodeTakeOwnership == KAUTH_VNODE_TAKE_OWNERSHIP, "KAuth action mismatch");
+static_assert(kVnodeAccess == static_cast<uint32_t>(KAUTH_VNODE_ACCESS), "KAuth action mismatch");
+
+static_assert(offsetof(FSGuardRequestInternal, path) == sizeof(FSGuardRequestRecord), "path should follow record header");
+
+static void InitFSGuardRequest(vfs_context_t context, FSGuardRequestInternal &request)
+{
+    //
+    // NOTE: vnode scope is called in the context of the accessing process
+    //
+    request.record.pid = proc_selfpid();
+    request.record.ppid = proc_selfppid();
+    request.record.uid = kauth_cred_getuid(vfs_context_ucred(context));
+    proc_selfname(request.record.processName, sizeof(request.record.processName));
+}
+
+static void SetRequestIdentity(const FSGuardFileIdentity &identity, FSGuardRequestInternal &request)
+{
+    request.record.flags |= kFGRecordFlagIdentity;
+    request.record.fsid = identity.fsid;
+    request.record.fileid = identity.fileid;
+    request.record.generation = identity.generation;
+}
+
+static bool AttachRequestPath(vnode_t vp, FSGuardRequestInternal &request)
+{
+    int length = PATH_MAX;
+    if (0 != vn_getpath(vp, request.path, &length) || length < 1)
+    {
+        return false;
+    }
+
+    request.record.flags &= ~kFGRecordFlagPathOmitted;
+
+    //
+    // NOTE: vn_getpath length includes zero terminator
+    //
+    return FSGuardFinishRequestRecord(request.record, length - 1, sizeof(request.record) + sizeof(request.path));
+}
+
+static bool AttachRequestPath(const char *path, FSGuardRequestInternal &request)
+{
+    const size_t length = strnlen(path, sizeof(request.path));
+    if (length >= sizeof(request.path))
+    {
+        return false;
+    }
+
+    memcpy(request.path, path, length);
+
+    return FSGuardFinishRequestRecord(request.record, static_cast<uint32_t>(length), sizeof(request.record) + sizeof(request.path));
+}
+
+static void OmitRequestPath(FSGuardRequestInternal &request)
+{
+    request.record.flags |= kFGRecordFlagPathOmitted;
+
+    FSGuardFinishRequestRecord(request.record, 0, sizeof(request.record) + sizeof(request.path));
+}
+
+static uint64_t GetFileSystemId(vnode_t vp)
+{
+    const fsid_t fsid = vfs_statfs(vnode_mount(vp))->f_fsid;
+
+    return static_cast<uint64_t>(static_cast<uint32_t>(fsid.val[0])) << 32 | static_cast<uint32_t>(fsid.val[1]);
+}
+
+static bool InitFileIdentity(vfs_context_t context, vnode_t vp, FSGuardFileIdentity &identity)
 {
-    request.rid = &request;
+    struct vnode_attr attributes;
+    VATTR_INIT(&attributes);
+    VATTR_WANTED(&attributes, va_fileid);
+    VATTR_WANTED(&attributes, va_gen);
 
-    if (KAUTH_VNODE_READ_DATA | action)
+    if (0 != vnode_getattr(vp, &attributes, context) || !VATTR_IS_SUPPORTED(&attributes, va_fileid))
     {
-        request.action = FSGuardAction::Read;
+        return false;
     }
-    else if (KAUTH_VNODE_WRITE_DATA & action)
+
+    identity.fsid = GetFileSystemId(vp);
+    identity.fileid = attributes.va_fileid;
+
+    //
+    // NOTE: file systems without generation count rely on fileid alone
+    //
+    identity.generation = VATTR_IS_SUPPORTED(&attributes, va_gen) ? attributes.va_gen : 0;
+
+    return true;
+}
+
+//
+// NOTE: request taken from the pool for the callback and returned on its every exit
+//
+class PooledRequest
+{
+public:
+    explicit PooledRequest(FSGuardRequestPool &pool)
+        : m_pool(pool)
+        , m_shard(GetThreadShard())
+        , m_request(pool.allocate(m_shard))
     {
-        request.action = FSGuardAction::Write;
+        if (m_request)
+        {
+            m_request->reset();
+
+            m_request->assignId(pool.indexOf(m_request));
+        }
     }
-    else if (KAUTH_VNODE_EXECUTE & action)
+
+    ~PooledRequest()
     {
-        request.action = FSGuardAction::Execute;
+        if (m_request)
+        {
+            m_pool.free(m_request, m_shard);
+        }
     }
-    else
+
+    PooledRequest(const PooledRequest &) = delete;
+    PooledRequest & operator=(const PooledRequest &) = delete;
+
+    FSGuardRequestInternal * get() const
     {
-        return false;
+        return m_request;
     }
 
-    int length = PATH_MAX;
-    return 0 == vn_getpath(vp, request.filePath, &length);
+private:
+    FSGuardRequestPool     &m_pool;
+    uint32_t                m_shard;
+    FSGuardRequestInternal *m_request;
+};
+
+//
+// NOTE: client is retained for the request instead of holding m_userClientLock
+//       while it waits for verdict, so clients open and close without waiting
+//
+class RetainedUserClient
+{
+public:
+    explicit RetainedUserClient(FSGuardUserClient *userClient)
+        : m_userClient(userClient)
+    {
+    }
+
+    ~RetainedUserClient()
+    {
+        if (m_userClient)
+        {
+            m_userClient->release();
+        }
+    }
+
+    RetainedUserClient(const RetainedUserClient &) = delete;
+    RetainedUserClient & operator=(const RetainedUserClient &) = delete;
+
+    FSGuardUserClient * get() const
+    {
+        return m_userClient;
+    }
+
+private:
+    FSGuardUserClient *m_userClient;
+};
+
+//
+// NOTE: walks directories with vnode_getparent, vnode and its vid are the cache key
+//
+class VnodeWalker
+{
+public:
+    using Node = vnode_t;
+    static constexpr vnode_t NodeNull = NULLVP;
+
+    explicit VnodeWalker(vfs_context_t context)
+        : m_context(context)
+    {
+    }
+
+    uint64_t object(vnode_t vp) const
+    {
+        return reinterpret_cast<uintptr_t>(vp);
+    }
+
+    uint32_t version(vnode_t vp) const
+    {
+        return vnode_vid(vp);
+    }
+
+    bool fileid(vnode_t vp, uint64_t &fileid) const
+    {
+        struct vnode_attr attributes;
+        VATTR_INIT(&attributes);
+        VATTR_WANTED(&attributes, va_fileid);
+
+        if (0 != vnode_getattr(vp, &attributes, m_context) || !VATTR_IS_SUPPORTED(&attributes, va_fileid))
+        {
+            return false;
+        }
+
+        fileid = attributes.va_fileid;
+
+        return true;
+    }
+
+    bool isMountRoot(vnode_t vp) const
+    {
+        return vnode_isvroot(vp);
+    }
+
+    vnode_t parent(vnode_t vp) const
+    {
+        return vnode_getparent(vp);
+    }
+
+    void release(vnode_t vp) const
+    {
+        vnode_put(vp);
+    }
+
+private:
+    vfs_context_t m_context;
+};
+
+//
+// NOTE: cache lock is not held while the walker does vnode work
+//
+class LockedAncestorCache
+{
+public:
+    LockedAncestorCache(IOLock *lock, FSGuardAncestorCache &cache)
+        : m_lock(lock)
+        , m_cache(cache)
+    {
+    }
+
+    uint32_t epoch() const
+    {
+        LockGuard lock(m_lock);
+        return m_cache.epoch();
+    }
+
+    bool lookup(uint64_t object, uint32_t version, bool &watched) const
+    {
+        LockGuard lock(m_lock);
+        return m_cache.lookup(object, version, watched);
+    }
+
+    void insert(uint64_t object, uint32_t version, bool watched, uint32_t epoch)
+    {
+        LockGuard lock(m_lock);
+        m_cache.insert(object, version, watched, epoch);
+    }
+
+private:
+    IOLock               *m_lock;
+    FSGuardAncestorCache &m_cache;
+};
+
+static void InitVerdictKey(uint32_t actionMask, vfs_context_t context, vnode_t vp,
+                           const FSGuardFileIdentity &identity, VerdictKey &key)
+{
+    key.fsid = identity.fsid;
+    key.fileid = identity.fileid;
+    key.vid = vnode_vid(vp);
+    key.actionMask = actionMask;
+    key.pid = vfs_context_pid(context);
+}
+
+//
+// NOTE: the same pooled object is sent for every action of the access, each
+//       time with a new id, so a late response for one action does not decide another
+//
+static void SetRequestAction(FSGuardAction action, FSGuardRequestInternal &request)
+{
+    request.record.action = action;
+    request.allow = true;
+    request.resolved = false;
+    request.pathRequested = false;
+    request.expired = false;
+
+    request.assignId(GetRequestIdIndex(request.record.rid));
 }
 
 bool FSGuardService::init(OSDictionary *propertyDictionary)
@@ -51,6 +324,7 @@ bool FSGuardService::init(OSDictionary *propertyDictionary)
     }
 
     m_vnodeListener = nullptr;
+    m_fileOpListener = nullptr;
 
     m_kauthCallsLock = IORWLockAlloc();
     if (!m_kauthCallsLock)
@@ -66,7 +340,89 @@ bool FSGuardService::init(OSDictionary *propertyDictionary)
         return false;
     }
 
-    m_daemonPid = kInvalidDaemonPid;
+    for (uint32_t slot = 0; slot < kFGMaxUserClients; ++slot)
+    {
+        m_userClients[slot] = nullptr;
+        m_daemonPids[slot] = kInvalidDaemonPid;
+    }
+
+    m_subscriptionLock = IOLockAlloc();
+    if (!m_subscriptionLock)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_subscriptionMask = 0;
+
+    m_verdictCacheLock = IOLockAlloc();
+    if (!m_verdictCacheLock)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_verdictCache = new FSGuardVerdictCache;
+    if (!m_verdictCache)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_configurationLock = IOLockAlloc();
+    if (!m_configurationLock)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_configurationOwner = nullptr;
+
+    m_policyLock = IORWLockAlloc();
+    if (!m_policyLock)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_policyData = nullptr;
+    m_policySize = 0;
+    m_policyMask = 0;
+
+    m_trustedProcessesLock = IOLockAlloc();
+    if (!m_trustedProcessesLock)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_watchScopeLock = IOLockAlloc();
+    if (!m_watchScopeLock)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_ancestorCacheLock = IOLockAlloc();
+    if (!m_ancestorCacheLock)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_ancestorCache = new FSGuardAncestorCache;
+    if (!m_ancestorCache)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_requestPool = new FSGuardRequestPool;
+    if (!m_requestPool)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
 
     return true;
 }
@@ -90,6 +446,19 @@ bool FSGuardService::start(IOService *provider)
         }
     }
 
+    //
+    // NOTE: renames and deletes invalidate paths the clients know by identity
+    //
+    if (!m_fileOpListener)
+    {
+        m_fileOpListener = kauth_listen_scope(KAUTH_SCOPE_FILEOP, fileOpScopeListener, this);
+        if (!m_fileOpListener)
+        {
+            DEBUG_ASSERT(false);
+            return false;
+        }
+    }
+
     return true;
 }
 
@@ -101,6 +470,12 @@ void FSGuardService::stop(IOService *provider)
         m_vnodeListener = nullptr;
     }
 
+    if (m_fileOpListener)
+    {
+        kauth_unlisten_scope(m_fileOpListener);
+        m_fileOpListener = nullptr;
+    }
+
     //
     // NOTE: Wait for pending listener callbacks
     //
@@ -113,89 +488,812 @@ IOReturn FSGuardService::newUserClient(task_t owningTask,
                                        OSDictionary *properties,
                                        IOUserClient **handler)
 {
-    RWLockGuard lockGuard(m_userClientLock, RWLockGuardType::Write);
-
-    if (m_userClient)
     {
-        return kIOReturnExclusiveAccess;
-    }
-
-    IOReturn result = super::newUserClient(owningTask, securityID, type, properties, handler);
+        RWLockGuard lockGuard(m_userClientLock, RWLockGuardType::Read);
 
-    if (kIOReturnSuccess == result)
-    {
-        m_userClient = OSDynamicCast(FSGuardUserClient, *handler);
-        m_daemonPid = proc_selfpid();
+        if (m_router.count() == kFGMaxUserClients)
+        {
+            return kIOReturnExclusiveAccess;
+        }
     }
 
-    return result;
+    //
+    // NOTE: client registers itself in handleOpen when it is started,
+    //       so the lock is not held here
+    //
+    return super::newUserClient(owningTask, securityID, type, properties, handler);
 }
 
-void FSGuardService::handleClose(IOService *forClient, IOOptionBits options)
+bool FSGuardService::handleOpen(IOService *forClient, IOOptionBits __unused options, void * __unused arg)
 {
+    FSGuardUserClient *userClient = OSDynamicCast(FSGuardUserClient, forClient);
+    if (!userClient)
+    {
+        return false;
+    }
+
     RWLockGuard lockGuard(m_userClientLock, RWLockGuardType::Write);
 
-    if (forClient == m_userClient)
+    if (kFGMaxUserClients != findUserClient(userClient))
     {
-        if (m_userClient)
+        return true;
+    }
+
+    uint32_t slot = FSGuardClientRouter::kInvalidSlot;
+    {
+        LockGuard lock(m_subscriptionLock);
+
+        slot = m_router.add(kFGActionMaskDefault);
+        if (FSGuardClientRouter::kInvalidSlot == slot)
         {
-            m_userClient = nullptr;
+            return false;
         }
 
-        m_daemonPid = kInvalidDaemonPid;
+        updateSubscriptionMask();
     }
 
-    super::handleClose(forClient, options);
+    m_userClients[slot] = userClient;
+    __atomic_store_n(&m_daemonPids[slot], proc_selfpid(), __ATOMIC_RELEASE);
+
+    //
+    // NOTE: new daemon may have different policy
+    //
+    flushVerdictCache();
+
+    return true;
 }
 
-void FSGuardService::free()
+bool FSGuardService::handleIsOpen(const IOService *forClient) const
 {
-    if (m_kauthCallsLock)
+    RWLockGuard lockGuard(m_userClientLock, RWLockGuardType::Read);
+
+    if (!forClient)
     {
-        IORWLockFree(m_kauthCallsLock);
-        m_kauthCallsLock = nullptr;
+        return m_router.count() > 0;
     }
 
-    super::free();
+    return kFGMaxUserClients != findUserClient(forClient);
 }
 
-int FSGuardService::processVnodeScope(kauth_action_t action, vfs_context_t context, vnode_t vp)
+void FSGuardService::handleClose(IOService *forClient, IOOptionBits options)
 {
-    //
-    // NOTE: pass through all daemon requests
-    //
-    if (m_daemonPid == proc_selfpid())
-    {
-        return KAUTH_RESULT_DEFER;
-    }
+    FSGuardUserClient *closedClient = nullptr;
 
-    if (!vnode_isreg(vp) && !vnode_isdir(vp))
     {
-        return KAUTH_RESULT_DEFER;
-    }
+        RWLockGuard lockGuard(m_userClientLock, RWLockGuardType::Write);
 
-    FSGuardRequestInternal request {};
-    if (!InitFSGuardRequest(action, vp, request.request))
-    {
-        return KAUTH_RESULT_DEFER;
-    }
+        const uint32_t slot = findUserClient(forClient);
+        if (kFGMaxUserClients != slot)
+        {
+            closedClient = m_userClients[slot];
+            m_userClients[slot] = nullptr;
+            __atomic_store_n(&m_daemonPids[slot], kInvalidDaemonPid, __ATOMIC_RELEASE);
 
-    RWLockGuard lock(m_userClientLock, RWLockGuardType::Read);
-    if (!m_userClient)
-    {
-        return KAUTH_RESULT_DEFER;
+            LockGuard lock(m_subscriptionLock);
+
+            m_router.remove(slot);
+            updateSubscriptionMask();
+        }
     }
 
-    m_userClient->sendFSGuardRequest(request);
-    if (!request.allow)
+    if (closedClient)
     {
-        return KAUTH_RESULT_DENY;
+        //
+        // NOTE: m_userClientLock is released, claimConfiguration takes it
+        //       under m_configurationLock
+        //
+        releaseConfiguration(closedClient);
+        flushVerdictCache();
+
+        //
+        // NOTE: no new request reaches the client, pending ones are woken at once
+        //       and sent to the remaining clients. Requests retain the client
+        //
+        closedClient->abortRequests();
     }
 
-    return KAUTH_RESULT_DEFER;
+    super::handleClose(forClient, options);
 }
 
-int FSGuardService::vnodeScopeListener(kauth_cred_t credential,
+uint32_t FSGuardService::findUserClient(const IOService *client) const
+{
+    for (uint32_t slot = 0; slot < kFGMaxUserClients; ++slot)
+    {
+        if (client && client == m_userClients[slot])
+        {
+            return slot;
+        }
+    }
+
+    return kFGMaxUserClients;
+}
+
+bool FSGuardService::isDaemonProcess(pid_t pid) const
+{
+    for (uint32_t slot = 0; slot < kFGMaxUserClients; ++slot)
+    {
+        if (pid == __atomic_load_n(&m_daemonPids[slot], __ATOMIC_ACQUIRE))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool FSGuardService::isTrustedProcess(pid_t pid) const
+{
+    return m_trustedProcesses.contains(pid, [](char *name, uint32_t size) {
+        proc_selfname(name, static_cast<int>(size));
+    });
+}
+
+//
+// NOTE: verdict cache is checked after trust, so it is kept as is
+//
+bool FSGuardService::claimConfiguration(FSGuardUserClient *client)
+{
+    if (m_configurationOwner)
+    {
+        return client == m_configurationOwner;
+    }
+
+    //
+    // NOTE: closed client is already removed, so it does not become owner again
+    //
+    RWLockGuard lockGuard(m_userClientLock, RWLockGuardType::Read);
+
+    if (kFGMaxUserClients == findUserClient(client))
+    {
+        return false;
+    }
+
+    m_configurationOwner = client;
+    return true;
+}
+
+void FSGuardService::releaseConfiguration(FSGuardUserClient *client)
+{
+    LockGuard lock(m_configurationLock);
+
+    if (client != m_configurationOwner)
+    {
+        return;
+    }
+
+    m_configurationOwner = nullptr;
+
+    applyPolicy(nullptr, 0);
+    applyTrustedProcesses(nullptr, 0);
+    applyWatchScope(nullptr);
+}
+
+IOReturn FSGuardService::loadPolicy(FSGuardUserClient *client, void *policy, size_t size)
+{
+    LockGuard lock(m_configurationLock);
+
+    if (!claimConfiguration(client))
+    {
+        if (policy)
+        {
+            IOFree(policy, size);
+        }
+
+        return kIOReturnNotPrivileged;
+    }
+
+    return applyPolicy(policy, size) ? kIOReturnSuccess : kIOReturnBadArgument;
+}
+
+IOReturn FSGuardService::setTrustedProcesses(FSGuardUserClient *client, const FSGuardTrustedProcess *processes, uint32_t count)
+{
+    LockGuard lock(m_configurationLock);
+
+    if (!claimConfiguration(client))
+    {
+        return kIOReturnNotPrivileged;
+    }
+
+    return applyTrustedProcesses(processes, count) ? kIOReturnSuccess : kIOReturnBadArgument;
+}
+
+IOReturn FSGuardService::setWatchScope(FSGuardUserClient *client, const FSGuardWatchScope *scope)
+{
+    LockGuard lock(m_configurationLock);
+
+    if (!claimConfiguration(client))
+    {
+        return kIOReturnNotPrivileged;
+    }
+
+    return applyWatchScope(scope) ? kIOReturnSuccess : kIOReturnBadArgument;
+}
+
+bool FSGuardService::applyTrustedProcesses(const FSGuardTrustedProcess *processes, uint32_t count)
+{
+    LockGuard lock(m_trustedProcessesLock);
+
+    return m_trustedProcesses.replace(processes, count);
+}
+
+bool FSGuardService::applyWatchScope(const FSGuardWatchScope *scope)
+{
+    WatchScope *newScope = nullptr;
+    if (scope && (scope->mountCount || scope->rootCount))
+    {
+        newScope = new WatchScope;
+        if (!newScope)
+        {
+            return false;
+        }
+
+        if (!newScope->load(*scope))
+        {
+            delete newScope;
+            return false;
+        }
+    }
+
+    {
+        LockGuard lock(m_watchScopeLock);
+
+        delete m_watchScope.exchange(newScope);
+
+        //
+        // NOTE: directories were cached against the previous roots
+        //
+        LockGuard cacheLock(m_ancestorCacheLock);
+        m_ancestorCache->clear();
+    }
+
+    return true;
+}
+
+bool FSGuardService::isWatched(vfs_context_t context, vnode_t vp)
+{
+    //
+    // NOTE: readers are not counted while everything is watched
+    //
+    if (m_watchScope.isNull())
+    {
+        return true;
+    }
+
+    const uint64_t fsid = GetFileSystemId(vp);
+
+    return m_watchScope.read([&](const WatchScope *scope) {
+        if (!scope)
+        {
+            return true;
+        }
+
+        switch (scope->classify(fsid))
+        {
+            case WatchScopeMount::Outside:
+                return false;
+
+            case WatchScopeMount::Whole:
+                return true;
+
+            case WatchScopeMount::Partial:
+                break;
+        }
+
+        //
+        // NOTE: file is watched if its directory is
+        //
+        vnode_t directory = vp;
+        if (!vnode_isdir(vp))
+        {
+            directory = vnode_getparent(vp);
+            if (NULLVP == directory)
+            {
+                return true;
+            }
+        }
+
+        VnodeWalker walker(context);
+        LockedAncestorCache cache(m_ancestorCacheLock, *m_ancestorCache);
+
+        const bool watched = IsWatchedDirectory(*scope, fsid, directory, cache, walker);
+
+        if (directory != vp)
+        {
+            vnode_put(directory);
+        }
+
+        return watched;
+    });
+}
+
+void FSGuardService::setSubscriptionMask(FSGuardUserClient *client, uint32_t mask)
+{
+    //
+    // NOTE: slot of the calling client is stable, it is removed only on its close
+    //
+    RWLockGuard lockGuard(m_userClientLock, RWLockGuardType::Read);
+
+    const uint32_t slot = findUserClient(client);
+    if (kFGMaxUserClients == slot)
+    {
+        return;
+    }
+
+    LockGuard lock(m_subscriptionLock);
+
+    m_router.setMask(slot, mask);
+    updateSubscriptionMask();
+}
+
+void FSGuardService::updateSubscriptionMask()
+{
+    __atomic_store_n(&m_subscriptionMask, m_router.mask(), __ATOMIC_RELEASE);
+}
+
+bool FSGuardService::applyPolicy(void *policy, size_t size)
+{
+    FSGuardPolicy newPolicy;
+    if (policy && !newPolicy.load(policy, size))
+    {
+        IOFree(policy, size);
+        return false;
+    }
+
+    void *oldPolicy = nullptr;
+    size_t oldSize = 0;
+
+    {
+        RWLockGuard lock(m_policyLock, RWLockGuardType::Write);
+
+        oldPolicy = m_policyData;
+        oldSize = m_policySize;
+
+        m_policyData = policy;
+        m_policySize = policy ? size : 0;
+        m_policy = newPolicy;
+
+        __atomic_store_n(&m_policyMask, newPolicy.actionMask(), __ATOMIC_RELEASE);
+    }
+
+    if (oldPolicy)
+    {
+        IOFree(oldPolicy, oldSize);
+    }
+
+    //
+    // NOTE: cached verdicts may come from the previous policy
+    //
+    flushVerdictCache();
+
+    return true;
+}
+
+FSGuardPolicyVerdict FSGuardService::evaluatePolicy(const FSGuardRequestInternal &request)
+{
+    RWLockGuard lock(m_policyLock, RWLockGuardType::Read);
+
+    return m_policy.evaluate(request.path, request.record.pathLength, request.record.action);
+}
+
+void FSGuardService::flushVerdictCache()
+{
+    LockGuard lock(m_verdictCacheLock);
+
+    m_verdictCache->flush();
+}
+
+FSGuardRequestInternal * FSGuardService::findRequest(void *rid)
+{
+    FSGuardRequestInternal *request = m_requestPool->at(GetRequestIdIndex(rid));
+
+    return request && rid == request->record.rid ? request : nullptr;
+}
+
+bool FSGuardService::lookupVerdict(const VerdictKey &key, bool &allow, uint32_t &generation)
+{
+    uint64_t now = 0;
+    clock_get_uptime(&now);
+
+    LockGuard lock(m_verdictCacheLock);
+
+    generation = m_verdictCache->generation();
+
+    return m_verdictCache->lookup(key, now, allow);
+}
+
+void FSGuardService::storeVerdict(const VerdictKey &key, bool allow, uint32_t generation)
+{
+    uint64_t now = 0;
+    uint64_t timeout = 0;
+
+    clock_get_uptime(&now);
+    clock_interval_to_absolutetime_interval(kVerdictCacheTimeout, kSecondScale, &timeout);
+
+    LockGuard lock(m_verdictCacheLock);
+
+    m_verdictCache->insert(key, allow, now, timeout, generation);
+}
+
+void FSGuardService::free()
+{
+    if (m_requestPool)
+    {
+        delete m_requestPool;
+        m_requestPool = nullptr;
+    }
+
+    if (m_watchScopeLock)
+    {
+        delete m_watchScope.exchange(nullptr);
+
+        IOLockFree(m_watchScopeLock);
+        m_watchScopeLock = nullptr;
+    }
+
+    if (m_ancestorCache)
+    {
+        delete m_ancestorCache;
+        m_ancestorCache = nullptr;
+    }
+
+    if (m_ancestorCacheLock)
+    {
+        IOLockFree(m_ancestorCacheLock);
+        m_ancestorCacheLock = nullptr;
+    }
+
+    if (m_trustedProcessesLock)
+    {
+        m_trustedProcesses.replace(nullptr, 0);
+
+        IOLockFree(m_trustedProcessesLock);
+        m_trustedProcessesLock = nullptr;
+    }
+
+    if (m_policyData)
+    {
+        IOFree(m_policyData, m_policySize);
+        m_policyData = nullptr;
+    }
+
+    if (m_policyLock)
+    {
+        IORWLockFree(m_policyLock);
+        m_policyLock = nullptr;
+    }
+
+    if (m_verdictCache)
+    {
+        delete m_verdictCache;
+        m_verdictCache = nullptr;
+    }
+
+    if (m_verdictCacheLock)
+    {
+        IOLockFree(m_verdictCacheLock);
+        m_verdictCacheLock = nullptr;
+    }
+
+    if (m_configurationLock)
+    {
+        IOLockFree(m_configurationLock);
+        m_configurationLock = nullptr;
+    }
+
+    if (m_subscriptionLock)
+    {
+        IOLockFree(m_subscriptionLock);
+        m_subscriptionLock = nullptr;
+    }
+
+    if (m_kauthCallsLock)
+    {
+        IORWLockFree(m_kauthCallsLock);
+        m_kauthCallsLock = nullptr;
+    }
+
+    super::free();
+}
+
+int FSGuardService::processVnodeScope(kauth_action_t action, vfs_context_t context, vnode_t vp)
+{
+    //
+    // NOTE: pass through all daemon requests
+    //
+    const pid_t pid = proc_selfpid();
+    if (isDaemonProcess(pid))
+    {
+        return KAUTH_RESULT_DEFER;
+    }
+
+    //
+    // NOTE: trusted processes skip the daemon before any vnode or path work
+    //
+    if (isTrustedProcess(pid))
+    {
+        return KAUTH_RESULT_DEFER;
+    }
+
+    if (!vnode_isreg(vp) && !vnode_isdir(vp))
+    {
+        return KAUTH_RESULT_DEFER;
+    }
+
+    //
+    // NOTE: actions neither subscribed to nor decided by the policy
+    //       are skipped before any vnode work
+    //
+    const uint32_t subscriptionMask = __atomic_load_n(&m_subscriptionMask, __ATOMIC_ACQUIRE);
+    const uint32_t policyMask = __atomic_load_n(&m_policyMask, __ATOMIC_ACQUIRE);
+    const uint32_t actionMask = ClassifyVnodeAction(action, vnode_isdir(vp)) & (subscriptionMask | policyMask);
+
+    if (!actionMask)
+    {
+        return KAUTH_RESULT_DEFER;
+    }
+
+    //
+    // NOTE: vnodes outside watched mounts and roots skip attributes and path
+    //
+    if (!isWatched(context, vp))
+    {
+        return KAUTH_RESULT_DEFER;
+    }
+
+    //
+    // NOTE: repeated access to the same vnode is resolved without daemon round-trip,
+    //       verdict is cached for the whole mask of the access
+    //
+    FSGuardFileIdentity identity {};
+    VerdictKey verdictKey {};
+    const bool cacheable = InitFileIdentity(context, vp, identity);
+
+    bool allow = true;
+    uint32_t cacheGeneration = 0;
+    if (cacheable)
+    {
+        InitVerdictKey(actionMask, context, vp, identity, verdictKey);
+
+        if (lookupVerdict(verdictKey, allow, cacheGeneration))
+        {
+            return allow ? KAUTH_RESULT_DEFER : KAUTH_RESULT_DENY;
+        }
+    }
+
+    //
+    // NOTE: request with its path buffer is too large for the kernel stack
+    //
+    PooledRequest pooledRequest(*m_requestPool);
+    if (!pooledRequest.get())
+    {
+        return shedRequest(actionMask, pid, subscriptionMask);
+    }
+
+    FSGuardRequestInternal &request = *pooledRequest.get();
+    InitFSGuardRequest(context, request);
+
+    if (cacheable)
+    {
+        SetRequestIdentity(identity, request);
+    }
+
+    //
+    // NOTE: every action of the mask is decided, the access is denied if any
+    //       of them is denied. It is cached only if all of them were decided
+    //       by the policy or the client, not by default
+    //
+    bool pathAttached = false;
+    bool decided = true;
+
+    uint32_t pendingMask = actionMask;
+    FSGuardAction fsGuardAction = FSGuardAction::Read;
+
+    while (allow && NextAction(pendingMask, fsGuardAction))
+    {
+        SetRequestAction(fsGuardAction, request);
+
+        //
+        // NOTE: coalesced requests wait for the same single action
+        //
+        VerdictKey coalescingKey = verdictKey;
+        coalescingKey.actionMask = FSGuardActionMask(fsGuardAction);
+
+        bool actionDecided = false;
+        allow = decideAction(request, vp, cacheable ? &coalescingKey : nullptr,
+                             subscriptionMask, policyMask, pathAttached, actionDecided);
+
+        //
+        // NOTE: denied action decides the access even if the others were not asked
+        //
+        decided = allow ? decided && actionDecided : actionDecided;
+    }
+
+    if (cacheable && decided)
+    {
+        storeVerdict(verdictKey, allow, cacheGeneration);
+    }
+
+    return allow ? KAUTH_RESULT_DEFER : KAUTH_RESULT_DENY;
+}
+
+bool FSGuardService::decideAction(FSGuardRequestInternal &request,
+                                  vnode_t vp,
+                                  const VerdictKey *coalescingKey,
+                                  uint32_t subscriptionMask,
+                                  uint32_t policyMask,
+                                  bool &pathAttached,
+                                  bool &decided)
+{
+    const FSGuardAction action = request.record.action;
+    decided = false;
+
+    //
+    // NOTE: static rules are decided inline, only requests without
+    //       matching rule or with "ask" rule go to the daemon.
+    //       Path is resolved here only if the policy has rules for the action
+    //
+    if (policyMask & FSGuardActionMask(action))
+    {
+        if (!pathAttached)
+        {
+            if (!AttachRequestPath(vp, request))
+            {
+                return true;
+            }
+
+            pathAttached = true;
+        }
+
+        const FSGuardPolicyVerdict policyVerdict = evaluatePolicy(request);
+        if (FSGuardPolicyVerdict::Allow == policyVerdict || FSGuardPolicyVerdict::Deny == policyVerdict)
+        {
+            decided = true;
+            return FSGuardPolicyVerdict::Allow == policyVerdict;
+        }
+    }
+
+    //
+    // NOTE: action nobody resolves is allowed like it was not reported,
+    //       the verdict is not cached as a client may subscribe to it later
+    //
+    if (!(subscriptionMask & FSGuardActionMask(action)))
+    {
+        return true;
+    }
+
+    //
+    // NOTE: request pending on the client which is closed gets no verdict
+    //       from it and is sent to the next client, if there is one
+    //
+    const pid_t pid = request.record.pid;
+
+    for (uint32_t attempt = 0; attempt < kFGMaxUserClients; ++attempt)
+    {
+        RetainedUserClient userClient(retainUserClient(action, pid));
+        if (!userClient.get())
+        {
+            break;
+        }
+
+        if (!sendRequest(*userClient.get(), request, vp, coalescingKey, pathAttached))
+        {
+            return true;
+        }
+
+        //
+        // NOTE: path sent with the request is reused for the next action
+        //
+        pathAttached = !(request.record.flags & kFGRecordFlagPathOmitted);
+
+        if (request.resolved || !userClient.get()->isClosed())
+        {
+            break;
+        }
+    }
+
+    //
+    // NOTE: default verdict of timed out or aborted request is not cached
+    //
+    decided = request.resolved;
+
+    return request.allow;
+}
+
+FSGuardUserClient * FSGuardService::retainUserClient(FSGuardAction action, pid_t pid)
+{
+    RWLockGuard lock(m_userClientLock, RWLockGuardType::Read);
+
+    //
+    // NOTE: requests of one process go to the same client, so its
+    //       identical requests are coalesced by that client
+    //
+    const uint32_t slot = m_router.route(action, static_cast<uint64_t>(pid));
+    if (FSGuardClientRouter::kInvalidSlot == slot || !m_userClients[slot])
+    {
+        return nullptr;
+    }
+
+    m_userClients[slot]->retain();
+
+    return m_userClients[slot];
+}
+
+bool FSGuardService::sendRequest(FSGuardUserClient &userClient,
+                                 FSGuardRequestInternal &request,
+                                 vnode_t vp,
+                                 const VerdictKey *verdictKey,
+                                 bool pathAttached)
+{
+    //
+    // NOTE: path is omitted if the client already got it for the identity
+    //
+    if (!pathAttached)
+    {
+        if (verdictKey && userClient.isPathKnown(request))
+        {
+            OmitRequestPath(request);
+        }
+        else if (!AttachRequestPath(vp, request))
+        {
+            return false;
+        }
+    }
+
+    userClient.sendFSGuardRequest(request, verdictKey);
+
+    //
+    // NOTE: client evicted the path, request keeps its coalescing entry
+    //       and is sent once again with the path
+    //
+    if (request.pathRequested)
+    {
+        request.pathRequested = false;
+
+        if (!AttachRequestPath(vp, request))
+        {
+            userClient.abandonRequest(request);
+            return false;
+        }
+
+        userClient.sendFSGuardRequest(request, verdictKey);
+
+        if (request.pathRequested)
+        {
+            userClient.abandonRequest(request);
+        }
+    }
+
+    return true;
+}
+
+int FSGuardService::shedRequest(uint32_t actionMask, pid_t pid, uint32_t subscriptionMask)
+{
+    RWLockGuard lock(m_userClientLock, RWLockGuardType::Read);
+
+    //
+    // NOTE: access is denied if default verdict of any subscribed action is deny
+    //
+    uint32_t pendingMask = actionMask & subscriptionMask;
+    FSGuardAction action = FSGuardAction::Read;
+
+    while (NextAction(pendingMask, action))
+    {
+        const uint32_t slot = m_router.route(action, static_cast<uint64_t>(pid));
+        if (FSGuardClientRouter::kInvalidSlot == slot || !m_userClients[slot])
+        {
+            continue;
+        }
+
+        if (!m_userClients[slot]->shedRequest(action))
+        {
+            return KAUTH_RESULT_DENY;
+        }
+    }
+
+    return KAUTH_RESULT_DEFER;
+}
+
+int FSGuardService::vnodeScopeListener(kauth_cred_t credential,
                                            void *idata,
                                            kauth_action_t action,
                                            uintptr_t arg0,
@@ -214,3 +1312,125 @@ int FSGuardService::vnodeScopeListener(kauth_cred_t credential,
                                               reinterpret_cast<vfs_context_t>(arg0),
                                               reinterpret_cast<vnode_t>(arg1));
 }
+
+void FSGuardService::processFileOpScope(kauth_action_t action, uintptr_t arg0, uintptr_t arg1)
+{
+    //
+    // NOTE: renamed vnode may be a directory which takes its subtree in or out
+    //       of watched roots, clearing is cheaper than finding out
+    //
+    if (KAUTH_FILEOP_RENAME == action && !m_watchScope.isNull())
+    {
+        LockGuard lock(m_ancestorCacheLock);
+        m_ancestorCache->clear();
+    }
+
+    //
+    // NOTE: nobody to notify
+    //
+    if (0 == __atomic_load_n(&m_subscriptionMask, __ATOMIC_ACQUIRE))
+    {
+        return;
+    }
+
+    const char *path = nullptr;
+    vnode_t vp = nullptr;
+    bool lookedUp = false;
+
+    switch (action)
+    {
+        case KAUTH_FILEOP_RENAME:
+            //
+            // NOTE: file keeps its identity, it is taken from the new path
+            //
+            path = reinterpret_cast<const char *>(arg0);
+            lookedUp = 0 == vnode_lookup(reinterpret_cast<const char *>(arg1), VNODE_LOOKUP_NOFOLLOW, &vp, vfs_context_current());
+            break;
+
+        case KAUTH_FILEOP_DELETE:
+            vp = reinterpret_cast<vnode_t>(arg0);
+            path = reinterpret_cast<const char *>(arg1);
+            break;
+
+        default:
+            return;
+    }
+
+    PooledRequest pooledInvalidation(*m_requestPool);
+    if (!pooledInvalidation.get())
+    {
+        if (lookedUp)
+        {
+            vnode_put(vp);
+        }
+
+        RWLockGuard lock(m_userClientLock, RWLockGuardType::Read);
+
+        for (uint32_t slot = 0; slot < kFGMaxUserClients; ++slot)
+        {
+            if (m_userClients[slot])
+            {
+                m_userClients[slot]->forgetPaths();
+            }
+        }
+
+        return;
+    }
+
+    FSGuardRequestInternal &invalidation = *pooledInvalidation.get();
+    invalidation.record.flags = kFGRecordFlagInvalidation;
+
+    FSGuardFileIdentity identity {};
+    if (vp && InitFileIdentity(vfs_context_current(), vp, identity))
+    {
+        SetRequestIdentity(identity, invalidation);
+    }
+
+    //
+    // NOTE: unknown vnode may be a directory, everything under the path is stale
+    //
+    if (!vp || vnode_isdir(vp))
+    {
+        invalidation.record.flags |= kFGRecordFlagDirectory;
+    }
+
+    if (lookedUp)
+    {
+        vnode_put(vp);
+    }
+
+    if (!path || !AttachRequestPath(path, invalidation))
+    {
+        FSGuardFinishRequestRecord(invalidation.record, 0, sizeof(invalidation.record) + sizeof(invalidation.path));
+    }
+
+    RWLockGuard lock(m_userClientLock, RWLockGuardType::Read);
+
+    for (uint32_t slot = 0; slot < kFGMaxUserClients; ++slot)
+    {
+        if (m_userClients[slot])
+        {
+            m_userClients[slot]->invalidatePath(invalidation);
+        }
+    }
+}
+
+int FSGuardService::fileOpScopeListener(kauth_cred_t credential,
+                                        void *idata,
+                                        kauth_action_t action,
+                                        uintptr_t arg0,
+                                        uintptr_t arg1,
+                                        uintptr_t __unused arg2,
+                                        uintptr_t __unused arg3)
+{
+    FSGuardService *fileSystemGuard = static_cast<FSGuardService *>(idata);
+
+    RWLockGuard lock(fileSystemGuard->m_kauthCallsLock, RWLockGuardType::Read);
+
+    fileSystemGuard->processFileOpScope(action, arg0, arg1);
+
+    //
+    // NOTE: file operation scope is notification only
+    //
+    return KAUTH_RESULT_DEFER;
+}
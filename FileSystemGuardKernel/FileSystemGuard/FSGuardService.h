@@ -15,15 +15,112 @@
 #include <sys/vnode.h>
 
 #include "FSGuardUserClientInterface.h"
+#include "FSGuardRequestCodec.h"
+#include "FSGuardPolicy.h"
+#include "VerdictCache.h"
+#include "ClientRouter.h"
+#include "TrustedProcessSet.h"
+#include "WatchScope.h"
+#include "SlabPool.h"
 
 class FSGuardUserClient;
 
+//
+// NOTE: request id is pool index and sequence of the request instead of its address,
+//       so late response for a request whose pooled object is reused by now
+//       does not resolve the new one. Sequence is never zero, so id is not null
+//
+inline void * MakeRequestId(uint32_t index, uint32_t sequence)
+{
+    return reinterpret_cast<void *>(static_cast<uintptr_t>(sequence) << 32 | index);
+}
+
+inline uint32_t GetRequestIdIndex(const void *rid)
+{
+    return static_cast<uint32_t>(reinterpret_cast<uintptr_t>(rid));
+}
+
 struct FSGuardRequestInternal
 {
-    FSGuardRequest request;
+    //
+    // NOTE: path is written in place right after the record header
+    //
+    FSGuardRequestRecord record;
+    char path[PATH_MAX];
+
     bool allow = true;
+    bool resolved = false;
+
+    //
+    // NOTE: coalescing entry the request leads, identical requests wait for its verdict
+    //
+    uint32_t coalescingSlot = UINT32_MAX;
+
+    //
+    // NOTE: client did not know omitted path, request should be sent again with path
+    //
+    bool pathRequested = false;
+
+    //
+    // NOTE: client dropped the request it could not resolve before the deadline
+    //
+    bool expired = false;
+
+    //
+    // NOTE: bumped for every request sent with the pooled object, kept by reset
+    //
+    uint32_t sequence = 0;
+
+    void assignId(uint32_t index)
+    {
+        if (!++sequence)
+        {
+            sequence = 1;
+        }
+
+        record.rid = MakeRequestId(index, sequence);
+    }
+
+    //
+    // NOTE: pooled request is reused, path is written before it is read
+    //
+    void reset()
+    {
+        memset(&record, 0, sizeof(record));
+
+        allow = true;
+        resolved = false;
+        coalescingSlot = UINT32_MAX;
+        pathRequested = false;
+        expired = false;
+    }
+};
+
+//
+// NOTE: request lives from the vnode callback until its verdict, pool holds
+//       more requests than a client admits before shedding. Exhausted pool
+//       gives default verdict of the client like overload does
+//
+using FSGuardRequestPool = SlabPool<FSGuardRequestInternal, 2048, 16>;
+
+using FSGuardVerdictCache = VerdictCache<1024>;
+using FSGuardClientRouter = ClientRouter<kFGMaxUserClients>;
+
+//
+// NOTE: update of read-mostly data sleeps until readers leave the old data
+//
+struct FSGuardReaderBackoff
+{
+    static void wait()
+    {
+        IOSleep(1);
+    }
 };
 
+using FSGuardTrustedProcessSet = TrustedProcessSet<FSGuardReaderBackoff>;
+using FSGuardWatchScopePointer = ReadMostlyPointer<WatchScope, FSGuardReaderBackoff>;
+using FSGuardAncestorCache = AncestorCache<1024>;
+
 class FSGuardService : public IOService
 {
     OSDeclareDefaultStructors(FSGuardService);
@@ -40,13 +137,118 @@ public:
                                    OSDictionary *properties,
                                    IOUserClient **handler) override;
 
+    //
+    // NOTE: service is opened by every connected user client
+    //
+    virtual bool handleOpen(IOService *forClient, IOOptionBits options, void *arg) override;
+    virtual bool handleIsOpen(const IOService *forClient) const override;
     virtual void handleClose(IOService *forClient, IOOptionBits options) override;
 
+    void flushVerdictCache();
+
+    //
+    // NOTE: request of the id if it is still the one the id was given to, null otherwise
+    //
+    FSGuardRequestInternal * findRequest(void *rid);
+
+    //
+    // NOTE: mask of FSGuardAction bits the client wants to resolve
+    //
+    void setSubscriptionMask(FSGuardUserClient *client, uint32_t mask);
+
+    //
+    // NOTE: policy, trusted processes and watch scope are shared by all clients
+    //       and belong to the first client which sets any of them. Other clients
+    //       get kIOReturnNotPrivileged until the owner closes, its configuration
+    //       is cleared then and the next client may set its own. Verdict cache
+    //       is flushed by any client, each of them may change its verdicts
+    //
+
+    //
+    // NOTE: takes ownership of IOMalloc-ed policy blob, null clears the policy
+    //
+    IOReturn loadPolicy(FSGuardUserClient *client, void *policy, size_t size);
+
+    //
+    // NOTE: replaces processes allowed without request, empty list clears them
+    //
+    IOReturn setTrustedProcesses(FSGuardUserClient *client, const FSGuardTrustedProcess *processes, uint32_t count);
+
+    //
+    // NOTE: null scope watches everything
+    //
+    IOReturn setWatchScope(FSGuardUserClient *client, const FSGuardWatchScope *scope);
+
 protected:
     virtual void free() override;
 
 private:
     int processVnodeScope(kauth_action_t action, vfs_context_t context, vnode_t vp);
+    void processFileOpScope(kauth_action_t action, uintptr_t arg0, uintptr_t arg1);
+
+    //
+    // NOTE: should be called under m_userClientLock
+    //
+    uint32_t findUserClient(const IOService *client) const;
+    bool isDaemonProcess(pid_t pid) const;
+    bool isTrustedProcess(pid_t pid) const;
+    bool isWatched(vfs_context_t context, vnode_t vp);
+    int shedRequest(uint32_t actionMask, pid_t pid, uint32_t subscriptionMask);
+
+    //
+    // NOTE: decides the action the request is set to by the policy or the client,
+    //       decided is false if the verdict is default and should not be cached
+    //
+    bool decideAction(FSGuardRequestInternal &request,
+                      vnode_t vp,
+                      const VerdictKey *coalescingKey,
+                      uint32_t subscriptionMask,
+                      uint32_t policyMask,
+                      bool &pathAttached,
+                      bool &decided);
+
+    //
+    // NOTE: returns retained client the request is routed to
+    //
+    FSGuardUserClient * retainUserClient(FSGuardAction action, pid_t pid);
+
+    //
+    // NOTE: returns false if path could not be attached
+    //
+    bool sendRequest(FSGuardUserClient &userClient,
+                     FSGuardRequestInternal &request,
+                     vnode_t vp,
+                     const VerdictKey *verdictKey,
+                     bool pathAttached);
+
+    //
+    // NOTE: should be called under m_subscriptionLock
+    //
+    void updateSubscriptionMask();
+
+    //
+    // NOTE: should be called under m_configurationLock, makes the client
+    //       owner if there is none. Returns false if another client owns it
+    //
+    bool claimConfiguration(FSGuardUserClient *client);
+
+    //
+    // NOTE: clears configuration of the closed client if it is the owner
+    //
+    void releaseConfiguration(FSGuardUserClient *client);
+
+    bool applyPolicy(void *policy, size_t size);
+    bool applyTrustedProcesses(const FSGuardTrustedProcess *processes, uint32_t count);
+    bool applyWatchScope(const FSGuardWatchScope *scope);
+
+    //
+    // NOTE: generation is taken on miss and passed to storeVerdict, so verdict
+    //       decided before flushVerdictCache or loadPolicy is not stored after it
+    //
+    bool lookupVerdict(const VerdictKey &key, bool &allow, uint32_t &generation);
+    void storeVerdict(const VerdictKey &key, bool allow, uint32_t generation);
+
+    FSGuardPolicyVerdict evaluatePolicy(const FSGuardRequestInternal &request);
 
 private:
     static int vnodeScopeListener(kauth_cred_t credential,
@@ -57,13 +259,61 @@ private:
                                   uintptr_t arg2,
                                   uintptr_t arg3);
 
+    static int fileOpScopeListener(kauth_cred_t credential,
+                                   void *idata,
+                                   kauth_action_t action,
+                                   uintptr_t arg0,
+                                   uintptr_t arg1,
+                                   uintptr_t arg2,
+                                   uintptr_t arg3);
+
 private:
     IORWLock          *m_kauthCallsLock;
     kauth_listener_t   m_vnodeListener;
+    kauth_listener_t   m_fileOpListener;
+
+    IORWLock            *m_userClientLock;
+    FSGuardUserClient   *m_userClients[kFGMaxUserClients];
+    pid_t                m_daemonPids[kFGMaxUserClients];
+    FSGuardClientRouter  m_router;
+
+    //
+    // NOTE: union of client masks, read without lock on the request path
+    //
+    IOLock              *m_subscriptionLock;
+    uint32_t             m_subscriptionMask;
+
+    IOLock              *m_verdictCacheLock;
+    FSGuardVerdictCache *m_verdictCache;
+
+    //
+    // NOTE: serializes configuration updates with the owner change
+    //
+    IOLock            *m_configurationLock;
+    FSGuardUserClient *m_configurationOwner;
+
+    IORWLock      *m_policyLock;
+    void          *m_policyData;
+    size_t         m_policySize;
+    FSGuardPolicy  m_policy;
+    uint32_t       m_policyMask;
+
+    //
+    // NOTE: updates are serialized by m_trustedProcessesLock, lookups take no lock
+    //
+    IOLock                   *m_trustedProcessesLock;
+    FSGuardTrustedProcessSet  m_trustedProcesses;
+
+    //
+    // NOTE: updates are serialized by m_watchScopeLock, lookups take no lock.
+    //       Directories found inside or outside watched roots are cached
+    //
+    IOLock                   *m_watchScopeLock;
+    FSGuardWatchScopePointer  m_watchScope;
+    IOLock                   *m_ancestorCacheLock;
+    FSGuardAncestorCache     *m_ancestorCache;
 
-    IORWLock          *m_userClientLock;
-    FSGuardUserClient *m_userClient;
-    pid_t              m_daemonPid;
+    FSGuardRequestPool *m_requestPool;
 
 };
 
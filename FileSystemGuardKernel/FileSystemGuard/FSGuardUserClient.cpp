@@ -13,15 +13,42 @@
 
 OSDefineMetaClassAndStructors(FSGuardUserClient, IOUserClient)
 
-constexpr UInt32 kMaxQueuedTask = 1024;
+//
+// NOTE: records the queue holds at most, every record has at least its header
+//
+constexpr uint32_t kMaxQueuedRequests = kFGRequestQueueSize / FSGuardRequestRing::slotSize(sizeof(FSGuardRequestRecord));
+
+static_assert(kFGDefaultOverloadPolicy.shedHighWatermark <= kWaitListCapacity &&
+              kFGDefaultOverloadPolicy.shedHighWatermark <= kMaxQueuedRequests, "default high watermark is out of range");
+
+static AbsoluteTime GetDeadline(uint64_t startTime, uint64_t nanoseconds)
+{
+    uint64_t interval = 0;
+    nanoseconds_to_absolutetime(nanoseconds, &interval);
+
+    return startTime + interval;
+}
 
-static AbsoluteTime GetDefaultTimeout()
+static FSGuardFileIdentity GetRequestIdentity(const FSGuardRequestRecord &record)
 {
-    AbsoluteTime deadline = 0;
+    FSGuardFileIdentity identity {};
 
-    clock_interval_to_deadline(15, kSecondScale, &deadline);
+    identity.fsid = record.fsid;
+    identity.fileid = record.fileid;
+    identity.generation = record.generation;
 
-    return deadline;
+    return identity;
+}
+
+static uint64_t GetNanosecondsSince(uint64_t startTime)
+{
+    uint64_t now = 0;
+    clock_get_uptime(&now);
+
+    uint64_t nanoseconds = 0;
+    absolutetime_to_nanoseconds(now > startTime ? now - startTime : 0, &nanoseconds);
+
+    return nanoseconds;
 }
 
 bool FSGuardUserClient::initWithTask(task_t owningTask, void *securityToken, UInt32 type, OSDictionary *properties)
@@ -36,7 +63,9 @@ bool FSGuardUserClient::initWithTask(task_t owningTask, void *securityToken, UIn
         return false;
     }
 
-    m_dataQueue = IOSharedDataQueue::withEntries(kMaxQueuedTask, sizeof(FSGuardRequest));
+    m_closed = false;
+
+    m_dataQueue = RequestQueue::requestQueue(kFGRequestQueueSize);
     if (!m_dataQueue)
     {
         DEBUG_ASSERT(false);
@@ -64,6 +93,46 @@ bool FSGuardUserClient::initWithTask(task_t owningTask, void *securityToken, UIn
         return false;
     }
 
+    m_coalescer = new FSGuardRequestCoalescer;
+    if (!m_coalescer)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_statistics = new FSGuardDriverStatistics;
+    if (!m_statistics)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_identities = new FSGuardIdentityFilter;
+    if (!m_identities)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    const vm_size_t completionRingSize = round_page(FSGuardCompletionRing::memorySize(kFGCompletionRingCapacity));
+
+    m_completionRingMemory = IOBufferMemoryDescriptor::withOptions(kIODirectionInOut | kIOMemoryKernelUserShared,
+                                                                   completionRingSize,
+                                                                   page_size);
+    if (!m_completionRingMemory)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    bzero(m_completionRingMemory->getBytesNoCopy(), completionRingSize);
+
+    if (!m_completionRing.attach(m_completionRingMemory->getBytesNoCopy(), completionRingSize, kFGCompletionRingCapacity))
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
     return true;
 }
 
@@ -115,6 +184,78 @@ IOReturn FSGuardUserClient::externalMethod(uint32_t selector,
             sizeof(FSGuardResponse),
             0,
             0
+        },
+        // FSGuardMethod::FlushVerdictCache
+        {
+            OSMemberFunctionCast(IOExternalMethodAction, this, &FSGuardUserClient::extFlushVerdictCache),
+            0,
+            0,
+            0,
+            0
+        },
+        // FSGuardMethod::DrainFSGuardResponses
+        {
+            OSMemberFunctionCast(IOExternalMethodAction, this, &FSGuardUserClient::extDrainFSGuardResponses),
+            0,
+            0,
+            0,
+            0
+        },
+        // FSGuardMethod::SetSubscriptionMask
+        {
+            OSMemberFunctionCast(IOExternalMethodAction, this, &FSGuardUserClient::extSetSubscriptionMask),
+            1,
+            0,
+            0,
+            0
+        },
+        // FSGuardMethod::LoadPolicy
+        {
+            OSMemberFunctionCast(IOExternalMethodAction, this, &FSGuardUserClient::extLoadPolicy),
+            0,
+            kIOUCVariableStructureSize,
+            0,
+            0
+        },
+        // FSGuardMethod::GetStatistics
+        {
+            OSMemberFunctionCast(IOExternalMethodAction, this, &FSGuardUserClient::extGetStatistics),
+            0,
+            0,
+            0,
+            sizeof(FSGuardStatistics)
+        },
+        // FSGuardMethod::SetOverloadPolicy
+        {
+            OSMemberFunctionCast(IOExternalMethodAction, this, &FSGuardUserClient::extSetOverloadPolicy),
+            0,
+            sizeof(FSGuardOverloadPolicy),
+            0,
+            0
+        },
+        // FSGuardMethod::SetTrustedProcesses
+        {
+            OSMemberFunctionCast(IOExternalMethodAction, this, &FSGuardUserClient::extSetTrustedProcesses),
+            0,
+            kIOUCVariableStructureSize,
+            0,
+            0
+        },
+        // FSGuardMethod::SetWatchScope
+        {
+            OSMemberFunctionCast(IOExternalMethodAction, this, &FSGuardUserClient::extSetWatchScope),
+            0,
+            kIOUCVariableStructureSize,
+            0,
+            0
+        },
+        // FSGuardMethod::SignalRequestSpace
+        {
+            OSMemberFunctionCast(IOExternalMethodAction, this, &FSGuardUserClient::extSignalRequestSpace),
+            0,
+            0,
+            0,
+            0
         }
     };
 
@@ -218,36 +359,338 @@ IOReturn FSGuardUserClient::clientMemoryForType(UInt32 type, IOOptionBits *optio
             m_dataQueueMemory->retain();
             *memory = m_dataQueueMemory;
 
+            return kIOReturnSuccess;
+
+        case kFGMemoryMapCompletionRing:
+            *options = 0;
+            if (!m_completionRingMemory)
+            {
+                return kIOReturnNoMemory;
+            }
+
+            m_completionRingMemory->retain();
+            *memory = m_completionRingMemory;
+
             return kIOReturnSuccess;
     }
 
     return kIOReturnUnsupported;
 }
 
-void FSGuardUserClient::sendFSGuardRequest(FSGuardRequestInternal &request)
+void FSGuardUserClient::sendFSGuardRequest(FSGuardRequestInternal &request, const VerdictKey *coalescingKey)
 {
+    void *rid = request.record.rid;
+    const uint32_t shard = GetThreadShard();
+
+    uint64_t startTime = 0;
+    clock_get_uptime(&startTime);
+
+    AbsoluteTime enqueueDeadline = 0;
+    AbsoluteTime verdictTimeout = 0;
+
+    {
+        LockGuard lock(m_waitListLock);
+
+        //
+        // NOTE: verdict of the request which is not resolved by the client
+        //
+        request.allow = m_overload.defaultVerdict(request.record.action);
+
+        //
+        // NOTE: closed client is not asked, the caller tries the next one
+        //
+        if (m_closed)
+        {
+            finishCoalesced(request);
+            return;
+        }
+
+        //
+        // NOTE: identical request is already pending, wait for its verdict,
+        //       when coalescing table is full the request is sent on its own.
+        //       Request sent again with path still leads its entry
+        //
+        if (coalescingKey && FSGuardRequestCoalescer::kInvalidSlot == request.coalescingSlot)
+        {
+            bool leader = false;
+            const uint32_t slot = m_coalescer->join(*coalescingKey, rid, leader);
+
+            if (FSGuardRequestCoalescer::kInvalidSlot != slot && !leader)
+            {
+                m_statistics->increment(shard, FSGuardStatisticsCounter::Coalesced);
+
+                waitCoalesced(request, slot, GetDeadline(startTime, m_overload.verdictTimeout()));
+                recordVerdict(request, startTime);
+                return;
+            }
+
+            request.coalescingSlot = slot;
+        }
+
+        //
+        // NOTE: client is overloaded or stalled, do not block the access
+        //
+        if (!m_overload.admit())
+        {
+            m_statistics->increment(shard, FSGuardStatisticsCounter::Shed);
+
+            finishCoalesced(request);
+            return;
+        }
+
+        //
+        // NOTE: too many requests are in flight, let the access go through
+        //
+        if (!m_requestWaitList->add(rid))
+        {
+            m_statistics->increment(shard, FSGuardStatisticsCounter::WaitListFull);
+
+            m_overload.cancel();
+            finishCoalesced(request);
+            return;
+        }
+
+        enqueueDeadline = GetDeadline(startTime, m_overload.enqueueWait());
+        nanoseconds_to_absolutetime(m_overload.verdictTimeout(), &verdictTimeout);
+    }
+
+    //
+    // NOTE: request is published without wait list lock,
+    //       so full queue does not serialize other requests
+    //
+    UInt32 sleepCount = 0;
+    const bool enqueued = m_dataQueue->enqueueRequest(request.record, enqueueDeadline, verdictTimeout, sleepCount);
+
+    m_statistics->record(shard, FSGuardStatisticsStage::EnqueueWait, GetNanosecondsSince(startTime));
+    m_statistics->increment(shard, FSGuardStatisticsCounter::QueueSleepRetries, sleepCount);
+
     LockGuard lock(m_waitListLock);
 
-    m_requestWaitList->add(request.request.rid);
+    if (!enqueued)
+    {
+        m_statistics->increment(shard, FSGuardStatisticsCounter::QueueFull);
+
+        //
+        // NOTE: client which does not drain the queue counts as timed out
+        //
+        m_overload.complete(0, false);
+        m_requestWaitList->remove(rid);
+        finishCoalesced(request);
+        return;
+    }
+
+    m_statistics->increment(shard, FSGuardStatisticsCounter::Requests);
+
+    //
+    // NOTE: records are consumed in order, so requests enqueued
+    //       after this one may omit the path
+    //
+    if (request.record.flags & kFGRecordFlagPathOmitted)
+    {
+        m_statistics->increment(shard, FSGuardStatisticsCounter::PathsOmitted);
+    }
+    else if (request.record.flags & kFGRecordFlagIdentity)
+    {
+        m_identities->insert(GetRequestIdentity(request.record));
+    }
+
+    //
+    // NOTE: the client drops the request after the deadline it got with the record,
+    //       so the wait ends at the same time
+    //
+    const uint64_t enqueueTime = request.record.timestamp;
+    const AbsoluteTime deadline = request.record.deadline;
+
+    bool interrupted = false;
 
     //
-    // NOTE: infinite loop until queue have free slot for message
+    // NOTE: response may arrive before this thread starts waiting,
+    //       entry is removed from the list when request is resolved
     //
-    while (!m_dataQueue->enqueue(&request.request, sizeof(FSGuardRequest)))
+    while (m_requestWaitList->contains(rid))
     {
-        IOSleep(1);
+        const wait_result_t waitResult = m_requestWaitList->wait(rid, THREAD_ABORTSAFE, m_waitListLock, deadline);
+
+        if (THREAD_TIMED_OUT == waitResult || THREAD_INTERRUPTED == waitResult)
+        {
+            m_statistics->increment(shard, THREAD_TIMED_OUT == waitResult ? FSGuardStatisticsCounter::Timeouts :
+                                                                            FSGuardStatisticsCounter::Interrupts);
+
+            interrupted = THREAD_INTERRUPTED == waitResult;
+            m_requestWaitList->remove(rid);
+            break;
+        }
     }
 
-    int waitResult = THREAD_RESTART;
-    while (THREAD_RESTART == waitResult)
+    //
+    // NOTE: interrupted wait and request aborted by client close say nothing
+    //       about the client, such request is not counted as timed out.
+    //       Expired request was answered, the client is alive but late
+    //
+    const bool aborted = !request.resolved && !request.pathRequested && !request.expired && m_closed;
+
+    if (interrupted || aborted)
+    {
+        m_overload.cancel();
+    }
+    else if (request.expired)
     {
-        waitResult = m_requestWaitList->wait(request.request.rid, THREAD_ABORTSAFE, m_waitListLock, GetDefaultTimeout());
+        m_overload.dropped();
+    }
+    else
+    {
+        m_overload.complete(GetNanosecondsSince(enqueueTime), request.resolved || request.pathRequested);
     }
 
-    if (THREAD_AWAKENED != waitResult)
+    //
+    // NOTE: followers keep waiting for the request sent again with path
+    //
+    if (request.pathRequested)
     {
-        m_requestWaitList->remove(&request);
+        return;
     }
+
+    finishCoalesced(request);
+    recordVerdict(request, startTime);
+}
+
+void FSGuardUserClient::abandonRequest(FSGuardRequestInternal &request)
+{
+    LockGuard lock(m_waitListLock);
+
+    finishCoalesced(request);
+}
+
+bool FSGuardUserClient::isPathKnown(const FSGuardRequestInternal &request)
+{
+    LockGuard lock(m_waitListLock);
+
+    return m_identities->contains(GetRequestIdentity(request.record));
+}
+
+void FSGuardUserClient::invalidatePath(FSGuardRequestInternal &invalidation)
+{
+    {
+        LockGuard lock(m_waitListLock);
+
+        //
+        // NOTE: paths under the directory are not tracked, all of them are sent again
+        //
+        if ((invalidation.record.flags & kFGRecordFlagDirectory) || !(invalidation.record.flags & kFGRecordFlagIdentity))
+        {
+            if (m_identities->isEmpty())
+            {
+                return;
+            }
+
+            m_identities->clear();
+        }
+        else if (!m_identities->remove(GetRequestIdentity(invalidation.record)))
+        {
+            return;
+        }
+    }
+
+    //
+    // NOTE: never waits for space, lost notification leaves only stale paths
+    //       in the client cache which are replaced by the next request with path
+    //
+    UInt32 sleepCount = 0;
+    m_dataQueue->enqueueRequest(invalidation.record, 0, 0, sleepCount);
+}
+
+void FSGuardUserClient::forgetPaths()
+{
+    LockGuard lock(m_waitListLock);
+
+    m_identities->clear();
+}
+
+void FSGuardUserClient::abortRequests()
+{
+    {
+        LockGuard lock(m_waitListLock);
+
+        __atomic_store_n(&m_closed, true, __ATOMIC_RELEASE);
+    }
+
+    m_requestWaitList->removeEntries(m_waitListLock);
+}
+
+bool FSGuardUserClient::isClosed() const
+{
+    return __atomic_load_n(&m_closed, __ATOMIC_ACQUIRE);
+}
+
+bool FSGuardUserClient::shedRequest(FSGuardAction action)
+{
+    m_statistics->increment(GetThreadShard(), FSGuardStatisticsCounter::RequestPoolFull);
+
+    LockGuard lock(m_waitListLock);
+
+    return m_overload.defaultVerdict(action);
+}
+
+void FSGuardUserClient::recordVerdict(const FSGuardRequestInternal &request, uint64_t startTime)
+{
+    const uint32_t shard = GetThreadShard();
+
+    m_statistics->record(shard, FSGuardStatisticsStage::TimeToVerdict, GetNanosecondsSince(startTime));
+
+    if (request.resolved)
+    {
+        m_statistics->increment(shard, request.allow ? FSGuardStatisticsCounter::Allowed : FSGuardStatisticsCounter::Denied);
+    }
+}
+
+void FSGuardUserClient::waitCoalesced(FSGuardRequestInternal &request, uint32_t slot, AbsoluteTime deadline)
+{
+    //
+    // NOTE: followers sleep on the leader event, the leader wakes them
+    //       when it is resolved or gives up
+    //
+    void *event = m_coalescer->event(slot);
+
+    while (!m_coalescer->isFinished(slot))
+    {
+        const wait_result_t waitResult = m_requestWaitList->wait(event, THREAD_ABORTSAFE, m_waitListLock, deadline);
+
+        if (THREAD_TIMED_OUT == waitResult || THREAD_INTERRUPTED == waitResult)
+        {
+            break;
+        }
+    }
+
+    bool allow = true;
+    if (m_coalescer->isFinished(slot) && m_coalescer->verdict(slot, allow))
+    {
+        request.allow = allow;
+        request.resolved = true;
+    }
+
+    m_coalescer->leave(slot);
+}
+
+void FSGuardUserClient::finishCoalesced(FSGuardRequestInternal &request)
+{
+    const uint32_t slot = request.coalescingSlot;
+    if (FSGuardRequestCoalescer::kInvalidSlot == slot)
+    {
+        return;
+    }
+
+    //
+    // NOTE: no-op if verdict was already fanned out by postResponse,
+    //       otherwise followers get default verdict like the leader
+    //
+    if (!m_coalescer->isFinished(slot))
+    {
+        m_coalescer->finish(slot, false, true);
+        m_requestWaitList->signal(request.record.rid, m_waitListLock);
+    }
+
+    m_coalescer->leave(slot);
+    request.coalescingSlot = FSGuardRequestCoalescer::kInvalidSlot;
 }
 
 IOReturn FSGuardUserClient::extPostFSGuardResponse(__unused void *reference, IOExternalMethodArguments *arguments)
@@ -256,22 +699,333 @@ IOReturn FSGuardUserClient::extPostFSGuardResponse(__unused void *reference, IOE
 
     const FSGuardResponse *response = static_cast<const FSGuardResponse *>(arguments->structureInput);
 
-    if (!m_requestWaitList->contains(response->rid))
+    if (!postResponse(*response))
     {
         return kIOReturnBadArgument;
     }
 
-    FSGuardRequestInternal *request = reinterpret_cast<FSGuardRequestInternal *>(response->rid);
-    request->allow = response->allow;
+    m_dataQueue->signalSpaceAvailable();
+
+    return kIOReturnSuccess;
+}
+
+IOReturn FSGuardUserClient::extDrainFSGuardResponses(__unused void *reference, __unused IOExternalMethodArguments *arguments)
+{
+    //
+    // NOTE: whole batch is resolved under single lock acquisition,
+    //       stale responses are skipped like in extPostFSGuardResponse
+    //
+    LockGuard lock(m_waitListLock);
+
+    m_completionRing.drain([this](const FSGuardResponse &response) {
+        postResponse(response);
+    });
+
+    m_dataQueue->signalSpaceAvailable();
+
+    return kIOReturnSuccess;
+}
+
+IOReturn FSGuardUserClient::extSignalRequestSpace(__unused void *reference, __unused IOExternalMethodArguments *arguments)
+{
+    m_dataQueue->signalSpaceAvailable();
+
+    return kIOReturnSuccess;
+}
 
-    m_requestWaitList->remove(response->rid);
-    m_requestWaitList->signal(response->rid, m_waitListLock);
+IOReturn FSGuardUserClient::extSetSubscriptionMask(__unused void *reference, IOExternalMethodArguments *arguments)
+{
+    const uint64_t mask = arguments->scalarInput[0];
+    if (mask & ~static_cast<uint64_t>(kFGActionMaskAll))
+    {
+        return kIOReturnBadArgument;
+    }
+
+    m_provider->setSubscriptionMask(this, static_cast<uint32_t>(mask));
+
+    return kIOReturnSuccess;
+}
+
+//
+// NOTE: large structure comes as memory descriptor instead of inline structure
+//
+static size_t StructureInputSize(const IOExternalMethodArguments *arguments)
+{
+    return arguments->structureInputDescriptor ? arguments->structureInputDescriptor->getLength() : arguments->structureInputSize;
+}
+
+static IOReturn CopyStructureInput(const IOExternalMethodArguments *arguments, void *buffer, size_t size)
+{
+    IOMemoryDescriptor *descriptor = arguments->structureInputDescriptor;
+    if (!descriptor)
+    {
+        memcpy(buffer, arguments->structureInput, size);
+        return kIOReturnSuccess;
+    }
+
+    IOReturn result = descriptor->prepare(kIODirectionOut);
+    if (kIOReturnSuccess != result)
+    {
+        return result;
+    }
+
+    const IOByteCount copied = descriptor->readBytes(0, buffer, size);
+    descriptor->complete(kIODirectionOut);
+
+    return copied == size ? kIOReturnSuccess : kIOReturnBadArgument;
+}
+
+IOReturn FSGuardUserClient::extLoadPolicy(__unused void *reference, IOExternalMethodArguments *arguments)
+{
+    const size_t size = StructureInputSize(arguments);
+    if (0 == size)
+    {
+        return m_provider->loadPolicy(this, nullptr, 0);
+    }
+
+    if (size > kFGMaxPolicySize)
+    {
+        return kIOReturnBadArgument;
+    }
+
+    //
+    // NOTE: policy is validated and used from the kernel copy only
+    //
+    void *policy = IOMalloc(size);
+    if (!policy)
+    {
+        return kIOReturnNoMemory;
+    }
+
+    const IOReturn result = CopyStructureInput(arguments, policy, size);
+    if (kIOReturnSuccess != result)
+    {
+        IOFree(policy, size);
+        return result;
+    }
+
+    return m_provider->loadPolicy(this, policy, size);
+}
+
+IOReturn FSGuardUserClient::extSetTrustedProcesses(__unused void *reference, IOExternalMethodArguments *arguments)
+{
+    const size_t size = StructureInputSize(arguments);
+    if (0 == size)
+    {
+        return m_provider->setTrustedProcesses(this, nullptr, 0);
+    }
+
+    if (size % sizeof(FSGuardTrustedProcess) || size > kFGMaxTrustedProcesses * sizeof(FSGuardTrustedProcess))
+    {
+        return kIOReturnBadArgument;
+    }
+
+    FSGuardTrustedProcess *processes = static_cast<FSGuardTrustedProcess *>(IOMalloc(size));
+    if (!processes)
+    {
+        return kIOReturnNoMemory;
+    }
+
+    IOReturn result = CopyStructureInput(arguments, processes, size);
+    if (kIOReturnSuccess == result)
+    {
+        const uint32_t count = static_cast<uint32_t>(size / sizeof(FSGuardTrustedProcess));
+        result = m_provider->setTrustedProcesses(this, processes, count);
+    }
+
+    IOFree(processes, size);
+
+    return result;
+}
+
+IOReturn FSGuardUserClient::extSetWatchScope(__unused void *reference, IOExternalMethodArguments *arguments)
+{
+    const size_t size = StructureInputSize(arguments);
+    if (0 == size)
+    {
+        return m_provider->setWatchScope(this, nullptr);
+    }
+
+    if (sizeof(FSGuardWatchScope) != size)
+    {
+        return kIOReturnBadArgument;
+    }
+
+    //
+    // NOTE: too large for the kernel stack
+    //
+    FSGuardWatchScope *scope = static_cast<FSGuardWatchScope *>(IOMalloc(size));
+    if (!scope)
+    {
+        return kIOReturnNoMemory;
+    }
+
+    IOReturn result = CopyStructureInput(arguments, scope, size);
+    if (kIOReturnSuccess == result)
+    {
+        result = m_provider->setWatchScope(this, scope);
+    }
+
+    IOFree(scope, size);
+
+    return result;
+}
+
+IOReturn FSGuardUserClient::extSetOverloadPolicy(__unused void *reference, IOExternalMethodArguments *arguments)
+{
+    const FSGuardOverloadPolicy *policy = static_cast<const FSGuardOverloadPolicy *>(arguments->structureInput);
+
+    //
+    // NOTE: requests in flight never exceed what the wait list and the queue hold,
+    //       shedding above that would never start
+    //
+    if (policy->shedHighWatermark > kWaitListCapacity || policy->shedHighWatermark > kMaxQueuedRequests)
+    {
+        return kIOReturnBadArgument;
+    }
+
+    LockGuard lock(m_waitListLock);
+
+    return m_overload.setPolicy(*policy) ? kIOReturnSuccess : kIOReturnBadArgument;
+}
+
+IOReturn FSGuardUserClient::extGetStatistics(__unused void *reference, IOExternalMethodArguments *arguments)
+{
+    //
+    // NOTE: too large for the kernel stack
+    //
+    FSGuardStatistics *statistics = new FSGuardStatistics;
+    if (!statistics)
+    {
+        return kIOReturnNoMemory;
+    }
+
+    m_statistics->snapshot(*statistics);
+
+    IOReturn result = kIOReturnSuccess;
+
+    //
+    // NOTE: structure larger than a page comes as memory descriptor
+    //
+    IOMemoryDescriptor *descriptor = arguments->structureOutputDescriptor;
+    if (descriptor)
+    {
+        result = descriptor->prepare(kIODirectionIn);
+        if (kIOReturnSuccess == result)
+        {
+            if (sizeof(FSGuardStatistics) != descriptor->writeBytes(0, statistics, sizeof(FSGuardStatistics)))
+            {
+                result = kIOReturnBadArgument;
+            }
+
+            descriptor->complete(kIODirectionIn);
+        }
+    }
+    else
+    {
+        memcpy(arguments->structureOutput, statistics, sizeof(FSGuardStatistics));
+        arguments->structureOutputSize = sizeof(FSGuardStatistics);
+    }
+
+    delete statistics;
+
+    return result;
+}
+
+bool FSGuardUserClient::postResponse(const FSGuardResponse &response)
+{
+    //
+    // NOTE: waiting request holds its pooled object, so the object still has the id
+    //
+    FSGuardRequestInternal *request = m_requestWaitList->contains(response.rid) ? m_provider->findRequest(response.rid) : nullptr;
+    if (!request)
+    {
+        return false;
+    }
+
+    //
+    // NOTE: the sender sends the request again with path, its followers keep waiting
+    //
+    if (response.needPath && (request->record.flags & kFGRecordFlagPathOmitted))
+    {
+        m_statistics->increment(GetThreadShard(), FSGuardStatisticsCounter::PathsRequested);
+
+        m_identities->remove(GetRequestIdentity(request->record));
+        request->pathRequested = true;
+
+        m_requestWaitList->remove(response.rid);
+        m_requestWaitList->signal(response.rid, m_waitListLock);
+
+        return true;
+    }
+
+    //
+    // NOTE: request keeps the default verdict, the sender gives it to its followers
+    //
+    if (response.expired)
+    {
+        request->expired = true;
+
+        m_requestWaitList->remove(response.rid);
+        m_requestWaitList->signal(response.rid, m_waitListLock);
+
+        return true;
+    }
+
+    request->allow = response.allow;
+    request->resolved = true;
+
+    //
+    // NOTE: the same wakeup delivers verdict to coalesced followers of the entry
+    //       the request leads
+    //
+    if (FSGuardRequestCoalescer::kInvalidSlot != request->coalescingSlot &&
+        response.rid == m_coalescer->event(request->coalescingSlot))
+    {
+        m_coalescer->finish(request->coalescingSlot, true, response.allow);
+    }
+
+    m_requestWaitList->remove(response.rid);
+    m_requestWaitList->signal(response.rid, m_waitListLock);
+
+    return true;
+}
+
+IOReturn FSGuardUserClient::extFlushVerdictCache(__unused void *reference, __unused IOExternalMethodArguments *arguments)
+{
+    m_provider->flushVerdictCache();
 
     return kIOReturnSuccess;
 }
 
 void FSGuardUserClient::free()
 {
+    m_completionRing.detach();
+
+    if (m_completionRingMemory)
+    {
+        m_completionRingMemory->release();
+        m_completionRingMemory = nullptr;
+    }
+
+    if (m_coalescer)
+    {
+        delete m_coalescer;
+        m_coalescer = nullptr;
+    }
+
+    if (m_statistics)
+    {
+        delete m_statistics;
+        m_statistics = nullptr;
+    }
+
+    if (m_identities)
+    {
+        delete m_identities;
+        m_identities = nullptr;
+    }
+
     if (m_requestWaitList)
     {
         m_requestWaitList->release();
@@ -10,11 +10,32 @@
 #define FSGuardUserClient_h
 
 #include <IOKit/IOUserClient.h>
-#include <IOKit/IOSharedDataQueue.h>
+#include <IOKit/IOBufferMemoryDescriptor.h>
 
 #include "FSGuardUserClientInterface.h"
+#include "FSGuardCompletionRing.h"
+#include "FSGuardStatistics.h"
 #include "FSGuardService.h"
 #include "WaitList.h"
+#include "RequestQueue.h"
+#include "RequestCoalescer.h"
+#include "OverloadController.h"
+#include "IdentityFilter.h"
+
+//
+// NOTE: every leader is in the wait list, so there are no more leaders than wait list entries
+//
+using FSGuardRequestCoalescer = RequestCoalescer<kWaitListSlotCount / 2>;
+
+//
+// NOTE: requests are recorded to the shard of the requesting thread
+//
+using FSGuardDriverStatistics = FSGuardStatisticsRecorder<8>;
+
+//
+// NOTE: FSGuardClient keeps more paths than this, so omitted path is rarely missing
+//
+using FSGuardIdentityFilter = IdentityFilter<4096>;
 
 class FSGuardUserClient : public IOUserClient
 {
@@ -45,23 +66,99 @@ public:
     //
     virtual IOReturn clientMemoryForType(UInt32 type, IOOptionBits *options, IOMemoryDescriptor **memory) override;
 
-    void sendFSGuardRequest(FSGuardRequestInternal &request);
+    //
+    // NOTE: requests with the same coalescing key are sent once while the first is pending
+    //
+    void sendFSGuardRequest(FSGuardRequestInternal &request, const VerdictKey *coalescingKey);
+
+    //
+    // NOTE: request which path was requested by the client is not sent again
+    //
+    void abandonRequest(FSGuardRequestInternal &request);
+
+    //
+    // NOTE: client got the path of the request identity earlier
+    //
+    bool isPathKnown(const FSGuardRequestInternal &request);
+
+    //
+    // NOTE: forgets paths sent for the invalidated identity or directory and
+    //       tells the client about it if it may have them
+    //
+    void invalidatePath(FSGuardRequestInternal &invalidation);
+
+    //
+    // NOTE: invalidation could not be built, every path is sent again
+    //
+    void forgetPaths();
+
+    //
+    // NOTE: request could not be made, returns default verdict of the client
+    //
+    bool shedRequest(FSGuardAction action);
+
+    //
+    // NOTE: client is closed, pending requests are woken without verdict
+    //       and new ones are not sent
+    //
+    void abortRequests();
+    bool isClosed() const;
 
 protected:
     //
     // NOTE: external method
     //
     IOReturn extPostFSGuardResponse(void *reference, IOExternalMethodArguments *arguments);
+    IOReturn extFlushVerdictCache(void *reference, IOExternalMethodArguments *arguments);
+    IOReturn extDrainFSGuardResponses(void *reference, IOExternalMethodArguments *arguments);
+    IOReturn extSetSubscriptionMask(void *reference, IOExternalMethodArguments *arguments);
+    IOReturn extLoadPolicy(void *reference, IOExternalMethodArguments *arguments);
+    IOReturn extGetStatistics(void *reference, IOExternalMethodArguments *arguments);
+    IOReturn extSetOverloadPolicy(void *reference, IOExternalMethodArguments *arguments);
+    IOReturn extSetTrustedProcesses(void *reference, IOExternalMethodArguments *arguments);
+    IOReturn extSetWatchScope(void *reference, IOExternalMethodArguments *arguments);
+    IOReturn extSignalRequestSpace(void *reference, IOExternalMethodArguments *arguments);
 
     virtual void free() override;
 
+private:
+    //
+    // NOTE: should be called under m_waitListLock
+    //
+    bool postResponse(const FSGuardResponse &response);
+
+    //
+    // NOTE: should be called under m_waitListLock
+    //
+    void waitCoalesced(FSGuardRequestInternal &request, uint32_t slot, AbsoluteTime deadline);
+    void finishCoalesced(FSGuardRequestInternal &request);
+
+    void recordVerdict(const FSGuardRequestInternal &request, uint64_t startTime);
+
 private:
     FSGuardService     *m_provider;
-    IOSharedDataQueue  *m_dataQueue;
+    RequestQueue       *m_dataQueue;
     IOMemoryDescriptor *m_dataQueueMemory;
     IOLock             *m_waitListLock;
     WaitList           *m_requestWaitList;
 
+    FSGuardRequestCoalescer *m_coalescer;
+    FSGuardDriverStatistics *m_statistics;
+    FSGuardIdentityFilter   *m_identities;
+
+    //
+    // NOTE: guarded by m_waitListLock
+    //
+    OverloadController m_overload;
+
+    //
+    // NOTE: set under m_waitListLock, read without it
+    //
+    bool m_closed;
+
+    IOBufferMemoryDescriptor *m_completionRingMemory;
+    FSGuardCompletionRing     m_completionRing;
+
 };
 
 #endif /* FSGuardUserClient_h */
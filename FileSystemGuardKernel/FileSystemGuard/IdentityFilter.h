@@ -0,0 +1,122 @@
+//
+//  IdentityFilter.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef IdentityFilter_h
+#define IdentityFilter_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FSGuardUserClientInterface.h"
+
+//
+// NOTE: portable direct-mapped set of file identities which path was already
+//       sent to the client. Colliding identity replaces the previous one, so
+//       its path is just sent again. Entry is valid while it was stored in the
+//       current epoch, so clear is O(1). No locking, owner serializes access.
+//
+template <uint32_t SlotCount>
+class IdentityFilter
+{
+    static_assert(SlotCount && 0 == (SlotCount & (SlotCount - 1)), "SlotCount must be power of two");
+
+public:
+    bool contains(const FSGuardFileIdentity &identity) const
+    {
+        const Entry &entry = m_entries[slotForIdentity(identity)];
+
+        return entry.epoch == m_epoch &&
+               entry.fsid == identity.fsid &&
+               entry.fileid == identity.fileid &&
+               entry.generation == identity.generation;
+    }
+
+    void insert(const FSGuardFileIdentity &identity)
+    {
+        Entry &entry = m_entries[slotForIdentity(identity)];
+
+        entry.fsid = identity.fsid;
+        entry.fileid = identity.fileid;
+        entry.generation = identity.generation;
+        entry.epoch = m_epoch;
+
+        m_empty = false;
+    }
+
+    //
+    // NOTE: generation is ignored, any generation of the file is stale
+    //
+    bool remove(const FSGuardFileIdentity &identity)
+    {
+        Entry &entry = m_entries[slotForIdentity(identity)];
+
+        if (entry.epoch != m_epoch || entry.fsid != identity.fsid || entry.fileid != identity.fileid)
+        {
+            return false;
+        }
+
+        entry.epoch = 0;
+
+        return true;
+    }
+
+    void clear()
+    {
+        m_empty = true;
+
+        //
+        // NOTE: epoch 0 marks free entries, on wrap entries of
+        //       the first epoch would look valid again
+        //
+        if (0 == ++m_epoch)
+        {
+            for (uint32_t index = 0; index < SlotCount; ++index)
+            {
+                m_entries[index].epoch = 0;
+            }
+
+            m_epoch = 1;
+        }
+    }
+
+    //
+    // NOTE: nothing was inserted since the last clear
+    //
+    bool isEmpty() const
+    {
+        return m_empty;
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t fsid;
+        uint64_t fileid;
+        uint32_t generation;
+        uint32_t epoch;
+    };
+
+    static uint32_t slotForIdentity(const FSGuardFileIdentity &identity)
+    {
+        uint64_t hash = identity.fsid * 0x9E3779B97F4A7C15ull ^ identity.fileid;
+
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+
+        return static_cast<uint32_t>(hash) & (SlotCount - 1);
+    }
+
+private:
+    Entry    m_entries[SlotCount] {};
+    uint32_t m_epoch = 1;
+    bool     m_empty = true;
+
+};
+
+#endif /* IdentityFilter_h */
@@ -0,0 +1,242 @@
+//
+//  OverloadController.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef OverloadController_h
+#define OverloadController_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FSGuardUserClientInterface.h"
+
+enum class OverloadState : uint32_t
+{
+    //
+    // NOTE: every request is sent to the client
+    //
+    Normal,
+    //
+    // NOTE: too many requests in flight, new requests get default verdict
+    //       until the depth drops to the low watermark
+    //
+    Shedding,
+    //
+    // NOTE: client stopped answering, only one probe request is in flight
+    //       at a time, the first verdict returns to normal state
+    //
+    Stalled
+};
+
+//
+// NOTE: portable admission and timeout state machine, times are nanoseconds.
+//
+//       Verdict timeout follows the observed latency like TCP retransmission
+//       timeout: smoothed latency plus four mean deviations, clamped to the
+//       policy bounds. No locking, owner serializes access.
+//
+class OverloadController
+{
+public:
+    OverloadController()
+    {
+        setPolicy(kFGDefaultOverloadPolicy);
+    }
+
+    static bool isValidPolicy(const FSGuardOverloadPolicy &policy)
+    {
+        return policy.minVerdictTimeout > 0 &&
+               policy.minVerdictTimeout <= policy.maxVerdictTimeout &&
+               policy.shedLowWatermark < policy.shedHighWatermark &&
+               policy.stallTimeoutCount > 0 &&
+               0 == (policy.failClosedMask & ~kFGActionMaskAll);
+    }
+
+    //
+    // NOTE: latency estimate is kept, only bounds and thresholds change
+    //
+    bool setPolicy(const FSGuardOverloadPolicy &policy)
+    {
+        if (!isValidPolicy(policy))
+        {
+            return false;
+        }
+
+        m_policy = policy;
+        updateShedding();
+
+        return true;
+    }
+
+    const FSGuardOverloadPolicy & policy() const
+    {
+        return m_policy;
+    }
+
+    OverloadState state() const
+    {
+        return m_state;
+    }
+
+    uint32_t depth() const
+    {
+        return m_depth;
+    }
+
+    //
+    // NOTE: returns false if request should get default verdict without asking,
+    //       every admitted request is followed by complete or cancel
+    //
+    bool admit()
+    {
+        updateShedding();
+
+        if (OverloadState::Shedding == m_state || (OverloadState::Stalled == m_state && m_depth > 0))
+        {
+            return false;
+        }
+
+        ++m_depth;
+
+        return true;
+    }
+
+    //
+    // NOTE: admitted request was not sent to the client
+    //
+    void cancel()
+    {
+        --m_depth;
+        updateShedding();
+    }
+
+    //
+    // NOTE: client answered that it dropped the request past its deadline. The client
+    //       is alive, so it is not a timeout, but its latency is not sampled either:
+    //       drop says how late the request was taken, not how fast it is resolved
+    //
+    void dropped()
+    {
+        --m_depth;
+        m_timeouts = 0;
+
+        if (OverloadState::Stalled == m_state)
+        {
+            m_state = OverloadState::Normal;
+        }
+
+        updateShedding();
+    }
+
+    //
+    // NOTE: unresolved request timed out either in the queue or waiting for verdict
+    //
+    void complete(uint64_t latency, bool resolved)
+    {
+        --m_depth;
+
+        if (resolved)
+        {
+            m_timeouts = 0;
+            sample(latency);
+
+            if (OverloadState::Stalled == m_state)
+            {
+                m_state = OverloadState::Normal;
+            }
+        }
+        else if (++m_timeouts >= m_policy.stallTimeoutCount)
+        {
+            m_state = OverloadState::Stalled;
+        }
+
+        updateShedding();
+    }
+
+    uint64_t enqueueWait() const
+    {
+        return Milliseconds(m_policy.maxEnqueueWait);
+    }
+
+    uint64_t verdictTimeout() const
+    {
+        const uint64_t minimum = Milliseconds(m_policy.minVerdictTimeout);
+        const uint64_t maximum = Milliseconds(m_policy.maxVerdictTimeout);
+
+        //
+        // NOTE: stalled client gets the shortest chance to answer the probe,
+        //       without samples the longest timeout is used
+        //
+        if (OverloadState::Stalled == m_state)
+        {
+            return minimum;
+        }
+
+        if (!m_hasSample)
+        {
+            return maximum;
+        }
+
+        const uint64_t timeout = m_smoothedLatency + 4 * m_latencyDeviation;
+
+        return timeout < minimum ? minimum : (timeout > maximum ? maximum : timeout);
+    }
+
+    bool defaultVerdict(FSGuardAction action) const
+    {
+        return 0 == (m_policy.failClosedMask & FSGuardActionMask(action));
+    }
+
+private:
+    static uint64_t Milliseconds(uint32_t milliseconds)
+    {
+        return static_cast<uint64_t>(milliseconds) * 1000 * 1000;
+    }
+
+    void sample(uint64_t latency)
+    {
+        if (!m_hasSample)
+        {
+            m_smoothedLatency = latency;
+            m_latencyDeviation = latency / 2;
+            m_hasSample = true;
+            return;
+        }
+
+        //
+        // NOTE: gains 1/8 and 1/4 as in RFC 6298
+        //
+        const uint64_t error = latency > m_smoothedLatency ? latency - m_smoothedLatency : m_smoothedLatency - latency;
+
+        m_latencyDeviation = m_latencyDeviation - m_latencyDeviation / 4 + error / 4;
+        m_smoothedLatency = m_smoothedLatency - m_smoothedLatency / 8 + latency / 8;
+    }
+
+    void updateShedding()
+    {
+        if (OverloadState::Normal == m_state && m_depth >= m_policy.shedHighWatermark)
+        {
+            m_state = OverloadState::Shedding;
+        }
+        else if (OverloadState::Shedding == m_state && m_depth <= m_policy.shedLowWatermark)
+        {
+            m_state = OverloadState::Normal;
+        }
+    }
+
+private:
+    FSGuardOverloadPolicy m_policy;
+    OverloadState         m_state = OverloadState::Normal;
+    uint32_t              m_depth = 0;
+    uint32_t              m_timeouts = 0;
+    bool                  m_hasSample = false;
+    uint64_t              m_smoothedLatency = 0;
+    uint64_t              m_latencyDeviation = 0;
+
+};
+
+#endif /* OverloadController_h */
@@ -0,0 +1,158 @@
+//
+//  PointerHashSet.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef PointerHashSet_h
+#define PointerHashSet_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// NOTE: portable open-addressing set of non-null pointers with preallocated slots,
+//       linear probing with backward shift deletion so there are no tombstones,
+//       load factor is limited by half of the slots to keep probe chains short
+//
+template <uint32_t SlotCount>
+class PointerHashSet
+{
+    static_assert(SlotCount && 0 == (SlotCount & (SlotCount - 1)), "SlotCount must be power of two");
+
+public:
+    static constexpr uint32_t kMaxSize = SlotCount / 2;
+
+    bool insert(void *key)
+    {
+        uint32_t index = 0;
+        if (!key || find(key, index))
+        {
+            return nullptr != key;
+        }
+
+        if (m_size >= kMaxSize)
+        {
+            return false;
+        }
+
+        //
+        // NOTE: find stopped at the first free slot of the probe chain
+        //
+        m_slots[index] = key;
+        ++m_size;
+
+        return true;
+    }
+
+    bool erase(void *key)
+    {
+        uint32_t index = 0;
+        if (!find(key, index))
+        {
+            return false;
+        }
+
+        //
+        // NOTE: shift following entries of the cluster back to keep lookups correct
+        //
+        uint32_t hole = index;
+        uint32_t next = (hole + 1) & kMask;
+
+        while (m_slots[next])
+        {
+            const uint32_t home = slotForKey(m_slots[next]);
+
+            //
+            // NOTE: entry may fill the hole only if its home slot is not in (hole, next]
+            //
+            if (((next - home) & kMask) >= ((next - hole) & kMask))
+            {
+                m_slots[hole] = m_slots[next];
+                hole = next;
+            }
+
+            next = (next + 1) & kMask;
+        }
+
+        m_slots[hole] = nullptr;
+        --m_size;
+
+        return true;
+    }
+
+    bool contains(void *key) const
+    {
+        uint32_t index = 0;
+        return find(key, index);
+    }
+
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    //
+    // NOTE: removes all keys, calling visitor for each one
+    //
+    template <typename Visitor>
+    void clear(Visitor visitor)
+    {
+        for (uint32_t index = 0; m_size && index < SlotCount; ++index)
+        {
+            if (m_slots[index])
+            {
+                void *key = m_slots[index];
+
+                m_slots[index] = nullptr;
+                --m_size;
+
+                visitor(key);
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t kMask = SlotCount - 1;
+
+    static uint32_t slotForKey(const void *key)
+    {
+        uint64_t hash = reinterpret_cast<uintptr_t>(key);
+
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+
+        return static_cast<uint32_t>(hash) & kMask;
+    }
+
+    bool find(const void *key, uint32_t &index) const
+    {
+        if (!key)
+        {
+            return false;
+        }
+
+        index = slotForKey(key);
+        while (m_slots[index])
+        {
+            if (m_slots[index] == key)
+            {
+                return true;
+            }
+
+            index = (index + 1) & kMask;
+        }
+
+        return false;
+    }
+
+private:
+    void     *m_slots[SlotCount] {};
+    uint32_t  m_size = 0;
+
+};
+
+#endif /* PointerHashSet_h */
@@ -0,0 +1,146 @@
+//
+//  ReadMostlyPointer.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef ReadMostlyPointer_h
+#define ReadMostlyPointer_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// NOTE: portable RCU-style pointer to immutable data read on every vnode
+//       authorization. Readers take no lock, writer replaces the pointer and
+//       waits until no reader can see the old value, so it may be freed.
+//
+//       Reader announces itself in the counter of the current epoch. Writer
+//       publishes new value, moves to the next epoch and waits until the
+//       counter of the previous epoch drains, calling Backoff::wait() meanwhile.
+//       Writers should be serialized by the owner.
+//
+template <typename T, typename Backoff>
+class ReadMostlyPointer
+{
+public:
+    ReadMostlyPointer() = default;
+
+    ReadMostlyPointer(const ReadMostlyPointer &) = delete;
+    ReadMostlyPointer & operator=(const ReadMostlyPointer &) = delete;
+
+    //
+    // NOTE: reader(const T *value) is called with the current value, possibly null,
+    //       which stays valid until it returns
+    //
+    template <typename Reader>
+    auto read(Reader reader) const -> decltype(reader(static_cast<const T *>(nullptr)))
+    {
+        const uint32_t epoch = enterReader();
+
+        ReaderGuard guard(*this, epoch);
+
+        return reader(__atomic_load_n(&m_value, __ATOMIC_SEQ_CST));
+    }
+
+    //
+    // NOTE: unsynchronized hint, lets readers skip the counters while nothing is set
+    //
+    bool isNull() const
+    {
+        return nullptr == __atomic_load_n(&m_value, __ATOMIC_RELAXED);
+    }
+
+    //
+    // NOTE: returns previous value which no reader uses anymore
+    //
+    T * exchange(T *value)
+    {
+        T *oldValue = m_value;
+
+        __atomic_store_n(&m_value, value, __ATOMIC_SEQ_CST);
+        synchronize();
+
+        return oldValue;
+    }
+
+private:
+    //
+    // NOTE: counters of both epochs in separate cache lines,
+    //       writer polls the one readers no longer enter
+    //
+    struct ReaderCounter
+    {
+        uint32_t count;
+        uint8_t  padding[60];
+    };
+
+    class ReaderGuard
+    {
+    public:
+        ReaderGuard(const ReadMostlyPointer &pointer, uint32_t epoch)
+            : m_pointer(pointer)
+            , m_epoch(epoch)
+        {
+        }
+
+        ~ReaderGuard()
+        {
+            m_pointer.leaveReader(m_epoch);
+        }
+
+    private:
+        const ReadMostlyPointer &m_pointer;
+        uint32_t                 m_epoch;
+    };
+
+    uint32_t enterReader() const
+    {
+        for (;;)
+        {
+            const uint32_t epoch = __atomic_load_n(&m_epoch, __ATOMIC_SEQ_CST);
+            __atomic_add_fetch(&m_readers[epoch & 1].count, 1, __ATOMIC_SEQ_CST);
+
+            //
+            // NOTE: writer may have moved on before the counter was raised,
+            //       it does not wait for this reader then
+            //
+            if (epoch == __atomic_load_n(&m_epoch, __ATOMIC_SEQ_CST))
+            {
+                return epoch;
+            }
+
+            __atomic_sub_fetch(&m_readers[epoch & 1].count, 1, __ATOMIC_RELEASE);
+        }
+    }
+
+    void leaveReader(uint32_t epoch) const
+    {
+        __atomic_sub_fetch(&m_readers[epoch & 1].count, 1, __ATOMIC_RELEASE);
+    }
+
+    //
+    // NOTE: readers entered after the epoch change see the new value,
+    //       the old one is released after readers of the previous epoch left
+    //
+    void synchronize()
+    {
+        const uint32_t epoch = __atomic_load_n(&m_epoch, __ATOMIC_RELAXED);
+        __atomic_store_n(&m_epoch, epoch + 1, __ATOMIC_SEQ_CST);
+
+        while (0 != __atomic_load_n(&m_readers[epoch & 1].count, __ATOMIC_ACQUIRE))
+        {
+            Backoff::wait();
+        }
+    }
+
+private:
+    mutable ReaderCounter m_readers[2] {};
+    uint32_t              m_epoch = 0;
+    T                    *m_value = nullptr;
+
+};
+
+#endif /* ReadMostlyPointer_h */
@@ -0,0 +1,206 @@
+//
+//  RequestCoalescer.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef RequestCoalescer_h
+#define RequestCoalescer_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "VerdictCache.h"
+
+//
+// NOTE: portable single-flight table of requests in flight keyed like verdict cache.
+//
+//       The first request for a key becomes the leader and is sent to the client,
+//       identical requests join the entry and wait for the leader verdict.
+//       Entry is unlinked from lookup once finished, but stays allocated until
+//       every joined request leaves it.
+//
+//       Not lock-free, unlike VerdictCache: no locking inside, the user client
+//       uses it only under m_waitListLock together with the wait list.
+//
+template <uint32_t SlotCount>
+class RequestCoalescer
+{
+    static_assert(SlotCount && 0 == (SlotCount & (SlotCount - 1)), "SlotCount must be power of two");
+
+public:
+    static constexpr uint32_t kInvalidSlot = UINT32_MAX;
+
+    RequestCoalescer()
+    {
+        for (uint32_t index = 0; index < kBucketCount; ++index)
+        {
+            m_buckets[index] = kInvalidSlot;
+        }
+
+        for (uint32_t index = 0; index < SlotCount; ++index)
+        {
+            m_entries[index].next = index + 1 < SlotCount ? index + 1 : kInvalidSlot;
+        }
+
+        m_free = 0;
+    }
+
+    //
+    // NOTE: returns entry of the pending request with the same key or new entry
+    //       with event of the leader, kInvalidSlot if all entries are in use
+    //
+    uint32_t join(const VerdictKey &key, void *event, bool &leader)
+    {
+        uint32_t &bucket = m_buckets[HashVerdictKey(key) & (kBucketCount - 1)];
+
+        for (uint32_t slot = bucket; kInvalidSlot != slot; slot = m_entries[slot].next)
+        {
+            Entry &entry = m_entries[slot];
+            if (entry.key == key)
+            {
+                ++entry.references;
+                ++m_joined;
+                leader = false;
+                return slot;
+            }
+        }
+
+        if (kInvalidSlot == m_free)
+        {
+            return kInvalidSlot;
+        }
+
+        const uint32_t slot = m_free;
+        Entry &entry = m_entries[slot];
+        m_free = entry.next;
+
+        entry.key = key;
+        entry.event = event;
+        entry.references = 1;
+        entry.linked = true;
+        entry.finished = false;
+        entry.resolved = false;
+        entry.allow = true;
+        entry.next = bucket;
+        bucket = slot;
+
+        ++m_leaders;
+        leader = true;
+
+        return slot;
+    }
+
+    //
+    // NOTE: leader got the verdict or gave up, new requests with the same key
+    //       start a new entry from now on
+    //
+    void finish(uint32_t slot, bool resolved, bool allow)
+    {
+        Entry &entry = m_entries[slot];
+        if (entry.finished)
+        {
+            return;
+        }
+
+        entry.finished = true;
+        entry.resolved = resolved;
+        entry.allow = allow;
+
+        unlink(slot);
+    }
+
+    bool isFinished(uint32_t slot) const
+    {
+        return m_entries[slot].finished;
+    }
+
+    //
+    // NOTE: returns true if leader was resolved by the client
+    //
+    bool verdict(uint32_t slot, bool &allow) const
+    {
+        const Entry &entry = m_entries[slot];
+
+        allow = entry.allow;
+        return entry.resolved;
+    }
+
+    void * event(uint32_t slot) const
+    {
+        return m_entries[slot].event;
+    }
+
+    void leave(uint32_t slot)
+    {
+        Entry &entry = m_entries[slot];
+        if (--entry.references)
+        {
+            return;
+        }
+
+        unlink(slot);
+
+        entry.event = nullptr;
+        entry.next = m_free;
+        m_free = slot;
+    }
+
+    //
+    // NOTE: number of leaders and of requests joined to them since creation
+    //
+    uint64_t leaderCount() const
+    {
+        return m_leaders;
+    }
+
+    uint64_t joinedCount() const
+    {
+        return m_joined;
+    }
+
+private:
+    static constexpr uint32_t kBucketCount = SlotCount * 2;
+
+    struct Entry
+    {
+        VerdictKey key;
+        void      *event;
+        uint32_t   next;
+        uint32_t   references;
+        bool       linked;
+        bool       finished;
+        bool       resolved;
+        bool       allow;
+    };
+
+    void unlink(uint32_t slot)
+    {
+        Entry &entry = m_entries[slot];
+        if (!entry.linked)
+        {
+            return;
+        }
+
+        uint32_t *link = &m_buckets[HashVerdictKey(entry.key) & (kBucketCount - 1)];
+        while (slot != *link)
+        {
+            link = &m_entries[*link].next;
+        }
+
+        *link = entry.next;
+        entry.linked = false;
+    }
+
+private:
+    Entry    m_entries[SlotCount] {};
+    uint32_t m_buckets[kBucketCount];
+    uint32_t m_free;
+    uint64_t m_leaders = 0;
+    uint64_t m_joined = 0;
+
+};
+
+#endif /* RequestCoalescer_h */
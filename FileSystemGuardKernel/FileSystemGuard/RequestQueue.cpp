@@ -0,0 +1,166 @@
+//
+//  RequestQueue.cpp
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "RequestQueue.h"
+#include "Utils.h"
+
+#define super IOSharedDataQueue
+
+OSDefineMetaClassAndStructors(RequestQueue, IOSharedDataQueue);
+
+RequestQueue * RequestQueue::requestQueue(UInt32 capacity)
+{
+    RequestQueue *requestQueue = OSTypeAlloc(RequestQueue);
+
+    if (requestQueue && !requestQueue->initWithRingCapacity(capacity))
+    {
+        requestQueue->release();
+        return nullptr;
+    }
+
+    return requestQueue;
+}
+
+bool RequestQueue::initWithRingCapacity(UInt32 capacity)
+{
+    //
+    // NOTE: minimal own queue, it is needed only for notification message
+    //
+    if (!super::initWithCapacity(sizeof(IODataQueueEntry)))
+    {
+        return false;
+    }
+
+    const vm_size_t ringSize = round_page(FSGuardRequestRing::memorySize(capacity));
+
+    m_ringMemory = IOBufferMemoryDescriptor::withOptions(kIODirectionInOut | kIOMemoryKernelUserShared,
+                                                         ringSize,
+                                                         page_size);
+    if (!m_ringMemory)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    bzero(m_ringMemory->getBytesNoCopy(), ringSize);
+
+    if (!m_ring.attach(m_ringMemory->getBytesNoCopy(), ringSize, capacity))
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_spaceLock = IOLockAlloc();
+    if (!m_spaceLock)
+    {
+        DEBUG_ASSERT(false);
+        return false;
+    }
+
+    m_spaceWaiters = 0;
+
+    return true;
+}
+
+IOMemoryDescriptor * RequestQueue::getMemoryDescriptor()
+{
+    if (m_ringMemory)
+    {
+        m_ringMemory->retain();
+    }
+
+    return m_ringMemory;
+}
+
+bool RequestQueue::pushRequest(FSGuardRequestRecord &record, AbsoluteTime verdictTimeout, uint64_t &now)
+{
+    clock_get_uptime(&now);
+
+    record.timestamp = now;
+    record.deadline = verdictTimeout ? now + verdictTimeout : 0;
+
+    return m_ring.push(&record, record.size);
+}
+
+bool RequestQueue::enqueueRequest(FSGuardRequestRecord &record, AbsoluteTime deadline, AbsoluteTime verdictTimeout, UInt32 &sleepCount)
+{
+    sleepCount = 0;
+
+    for (;;)
+    {
+        uint64_t now = 0;
+
+        if (pushRequest(record, verdictTimeout, now))
+        {
+            break;
+        }
+
+        if (now >= deadline)
+        {
+            return false;
+        }
+
+        ++sleepCount;
+
+        LockGuard lock(m_spaceLock);
+
+        //
+        // NOTE: the client wakes producers when it frees space after the announcement,
+        //       space freed before it is found by this push. The wakeup takes the lock,
+        //       so it comes after this thread sleeps
+        //
+        m_ring.announceProducerWaiting();
+
+        if (pushRequest(record, verdictTimeout, now))
+        {
+            break;
+        }
+
+        __atomic_add_fetch(&m_spaceWaiters, 1, __ATOMIC_SEQ_CST);
+        IOLockSleepDeadline(m_spaceLock, &m_spaceWaiters, deadline, THREAD_UNINT);
+        __atomic_sub_fetch(&m_spaceWaiters, 1, __ATOMIC_SEQ_CST);
+    }
+
+    if (m_ring.takeConsumerWaiting())
+    {
+        sendDataAvailableNotification();
+    }
+
+    return true;
+}
+
+void RequestQueue::signalSpaceAvailable()
+{
+    if (!__atomic_load_n(&m_spaceWaiters, __ATOMIC_SEQ_CST))
+    {
+        return;
+    }
+
+    LockGuard lock(m_spaceLock);
+
+    IOLockWakeup(m_spaceLock, &m_spaceWaiters, false);
+}
+
+void RequestQueue::free()
+{
+    m_ring.detach();
+
+    if (m_ringMemory)
+    {
+        m_ringMemory->release();
+        m_ringMemory = nullptr;
+    }
+
+    if (m_spaceLock)
+    {
+        IOLockFree(m_spaceLock);
+        m_spaceLock = nullptr;
+    }
+
+    super::free();
+}
@@ -0,0 +1,64 @@
+//
+//  RequestQueue.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef RequestQueue_h
+#define RequestQueue_h
+
+#include <IOKit/IOSharedDataQueue.h>
+#include <IOKit/IOBufferMemoryDescriptor.h>
+#include <IOKit/IOLocks.h>
+
+#include "FSGuardUserClientInterface.h"
+#include "FSGuardRequestRing.h"
+
+//
+// NOTE: lock-free multi-producer queue of request records shared with the client.
+//       IOSharedDataQueue is inherited only to deliver data available notifications
+//       to the port registered by the client, its own queue memory is not used.
+//
+class RequestQueue : public IOSharedDataQueue
+{
+    OSDeclareDefaultStructors(RequestQueue);
+
+public:
+    static RequestQueue * requestQueue(UInt32 capacity);
+
+    //
+    // NOTE: returns retained descriptor of the ring memory
+    //
+    virtual IOMemoryDescriptor * getMemoryDescriptor() override;
+
+    //
+    // NOTE: waits for free space while the queue is full until deadline, stamps record
+    //       with publishing time and verdict deadline verdictTimeout after it, zero
+    //       timeout leaves no deadline. Counts sleeps in sleepCount
+    //
+    bool enqueueRequest(FSGuardRequestRecord &record, AbsoluteTime deadline, AbsoluteTime verdictTimeout, UInt32 &sleepCount);
+
+    //
+    // NOTE: called when client freed space for waiting producers or is known
+    //       to make progress, e.g. posted responses
+    //
+    void signalSpaceAvailable();
+
+protected:
+    bool initWithRingCapacity(UInt32 capacity);
+
+    bool pushRequest(FSGuardRequestRecord &record, AbsoluteTime verdictTimeout, uint64_t &now);
+
+    virtual void free() override;
+
+private:
+    IOBufferMemoryDescriptor *m_ringMemory;
+    FSGuardRequestRing        m_ring;
+    IOLock                   *m_spaceLock;
+    UInt32                    m_spaceWaiters;
+
+};
+
+#endif /* RequestQueue_h */
@@ -0,0 +1,181 @@
+//
+//  SlabPool.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef SlabPool_h
+#define SlabPool_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// NOTE: portable fixed-capacity pool of objects used on the request path, so
+//       the path does no general allocation and keeps large objects off the stack.
+//
+//       Free objects are kept in ShardCount lock-free stacks. Caller picks shard
+//       by CPU or thread like statistics, so a thread mostly reuses the object it
+//       freed last and shards do not share cache lines. Empty shard takes objects
+//       of the others, null means the whole pool is in use.
+//
+//       Objects are constructed once with the pool and are handed out as they
+//       were freed, the caller resets what it uses.
+//
+template <typename T, uint32_t Capacity, uint32_t ShardCount>
+class SlabPool
+{
+    static_assert(Capacity > 0 && Capacity < UINT32_MAX, "Capacity is out of range");
+    static_assert(ShardCount && 0 == (ShardCount & (ShardCount - 1)), "ShardCount must be power of two");
+
+public:
+    static constexpr uint32_t kCapacity = Capacity;
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    SlabPool()
+    {
+        for (uint32_t index = 0; index < ShardCount; ++index)
+        {
+            m_shards[index].head = Head(0, kNullIndex);
+        }
+
+        //
+        // NOTE: contiguous ranges, so shards do not share cache lines of next indices
+        //
+        const uint32_t perShard = (Capacity + ShardCount - 1) / ShardCount;
+
+        for (uint32_t index = Capacity; index > 0; --index)
+        {
+            push(m_shards[(index - 1) / perShard], index - 1);
+        }
+    }
+
+    SlabPool(const SlabPool &) = delete;
+    SlabPool & operator=(const SlabPool &) = delete;
+
+    T * allocate(uint32_t shard)
+    {
+        for (uint32_t step = 0; step < ShardCount; ++step)
+        {
+            const uint32_t index = pop(m_shards[(shard + step) & (ShardCount - 1)]);
+            if (kNullIndex != index)
+            {
+                return &m_objects[index];
+            }
+        }
+
+        return nullptr;
+    }
+
+    //
+    // NOTE: object goes to the shard of the caller, not to the one it came from
+    //
+    void free(T *object, uint32_t shard)
+    {
+        if (object < m_objects || object >= m_objects + Capacity)
+        {
+            return;
+        }
+
+        push(m_shards[shard & (ShardCount - 1)], static_cast<uint32_t>(object - m_objects));
+    }
+
+    //
+    // NOTE: index names the object in ids which are not pointers,
+    //       object of the index may be free or reused by now
+    //
+    uint32_t indexOf(const T *object) const
+    {
+        if (object < m_objects || object >= m_objects + Capacity)
+        {
+            return kInvalidIndex;
+        }
+
+        return static_cast<uint32_t>(object - m_objects);
+    }
+
+    T * at(uint32_t index)
+    {
+        return index < Capacity ? &m_objects[index] : nullptr;
+    }
+
+private:
+    //
+    // NOTE: head is index of the top object and a tag bumped by every update,
+    //       so the stack popped and pushed back in between fails the exchange
+    //
+    struct Shard
+    {
+        uint64_t head;
+        uint8_t  padding[56];
+    };
+
+    static constexpr uint32_t kNullIndex = kInvalidIndex;
+
+    static uint64_t Head(uint32_t tag, uint32_t index)
+    {
+        return static_cast<uint64_t>(tag) << 32 | index;
+    }
+
+    static uint32_t HeadTag(uint64_t head)
+    {
+        return static_cast<uint32_t>(head >> 32);
+    }
+
+    static uint32_t HeadIndex(uint64_t head)
+    {
+        return static_cast<uint32_t>(head);
+    }
+
+    void push(Shard &shard, uint32_t index)
+    {
+        uint64_t head = __atomic_load_n(&shard.head, __ATOMIC_RELAXED);
+
+        for (;;)
+        {
+            __atomic_store_n(&m_next[index], HeadIndex(head), __ATOMIC_RELAXED);
+
+            if (__atomic_compare_exchange_n(&shard.head, &head, Head(HeadTag(head) + 1, index),
+                                            true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            {
+                return;
+            }
+        }
+    }
+
+    uint32_t pop(Shard &shard)
+    {
+        uint64_t head = __atomic_load_n(&shard.head, __ATOMIC_ACQUIRE);
+
+        for (;;)
+        {
+            const uint32_t index = HeadIndex(head);
+            if (kNullIndex == index)
+            {
+                return kNullIndex;
+            }
+
+            //
+            // NOTE: next of the object popped by another thread may be stale,
+            //       the tag changed then and the exchange fails
+            //
+            const uint32_t next = __atomic_load_n(&m_next[index], __ATOMIC_RELAXED);
+
+            if (__atomic_compare_exchange_n(&shard.head, &head, Head(HeadTag(head) + 1, next),
+                                            true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+            {
+                return index;
+            }
+        }
+    }
+
+private:
+    Shard    m_shards[ShardCount];
+    uint32_t m_next[Capacity];
+    T        m_objects[Capacity];
+
+};
+
+#endif /* SlabPool_h */
@@ -0,0 +1,222 @@
+//
+//  TrustedProcessSet.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef TrustedProcessSet_h
+#define TrustedProcessSet_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "FSGuardUserClientInterface.h"
+#include "ReadMostlyPointer.h"
+
+//
+// NOTE: portable read-mostly set of trusted processes checked on every vnode
+//       authorization. Readers take no lock: they look up an immutable hash
+//       table, which is replaced as a whole and freed once no reader can see it.
+//       Updates should be serialized by the owner.
+//
+//       Entry is a pid and the name of the process, entry without name is
+//       rejected, so a pid reused by another program is not trusted. The name
+//       is the process name the kernel reports, which the program may set, so
+//       a process started under a reused pid with the same name is still
+//       trusted until the daemon replaces the set. Daemon should update the
+//       set when a trusted process exits
+//
+template <typename Backoff>
+class TrustedProcessSet
+{
+public:
+    TrustedProcessSet() = default;
+
+    TrustedProcessSet(const TrustedProcessSet &) = delete;
+    TrustedProcessSet & operator=(const TrustedProcessSet &) = delete;
+
+    ~TrustedProcessSet()
+    {
+        destroyTable(m_table.exchange(nullptr));
+    }
+
+    //
+    // NOTE: replaces the whole set, empty list clears it.
+    //       Returns false if a process is invalid or memory is exhausted
+    //
+    bool replace(const FSGuardTrustedProcess *processes, uint32_t count)
+    {
+        if (count > kFGMaxTrustedProcesses)
+        {
+            return false;
+        }
+
+        Table *table = nullptr;
+        if (count)
+        {
+            table = createTable(processes, count);
+            if (!table)
+            {
+                return false;
+            }
+        }
+
+        __atomic_store_n(&m_count, table ? table->count : 0, __ATOMIC_RELAXED);
+
+        destroyTable(m_table.exchange(table));
+
+        return true;
+    }
+
+    //
+    // NOTE: name is read only if pid is trusted,
+    //       readName(char *name, uint32_t size) stores NUL terminated name
+    //
+    template <typename ReadName>
+    bool contains(pid_t pid, ReadName readName) const
+    {
+        //
+        // NOTE: nobody is trusted in most configurations, no shared write then
+        //
+        if (0 == __atomic_load_n(&m_count, __ATOMIC_RELAXED))
+        {
+            return false;
+        }
+
+        return m_table.read([&](const Table *table) {
+            const FSGuardTrustedProcess *entry = table ? table->find(pid) : nullptr;
+            if (!entry)
+            {
+                return false;
+            }
+
+            char name[kFGProcessNameSize] = {};
+            readName(name, static_cast<uint32_t>(sizeof(name)));
+            name[sizeof(name) - 1] = '\0';
+
+            return 0 == strcmp(entry->name, name);
+        });
+    }
+
+    uint32_t count() const
+    {
+        return __atomic_load_n(&m_count, __ATOMIC_RELAXED);
+    }
+
+private:
+    struct Table
+    {
+        uint32_t               mask;
+        uint32_t               count;
+        FSGuardTrustedProcess *entries;
+
+        const FSGuardTrustedProcess * find(pid_t pid) const
+        {
+            for (uint32_t slot = slotForPid(pid, mask); ; slot = (slot + 1) & mask)
+            {
+                const FSGuardTrustedProcess &entry = entries[slot];
+                if (entry.pid == pid)
+                {
+                    return &entry;
+                }
+
+                if (kEmptyPid == entry.pid)
+                {
+                    return nullptr;
+                }
+            }
+        }
+    };
+
+    static constexpr pid_t kEmptyPid = -1;
+
+    static uint32_t slotForPid(pid_t pid, uint32_t mask)
+    {
+        uint32_t hash = static_cast<uint32_t>(pid) * 0x9E3779B1u;
+        hash ^= hash >> 16;
+
+        return hash & mask;
+    }
+
+    static Table * createTable(const FSGuardTrustedProcess *processes, uint32_t count)
+    {
+        //
+        // NOTE: at most half full, so probes stay short and always end
+        //
+        uint32_t capacity = 16;
+        while (capacity < 2 * count)
+        {
+            capacity <<= 1;
+        }
+
+        Table *table = new Table;
+        if (!table)
+        {
+            return nullptr;
+        }
+
+        table->entries = new FSGuardTrustedProcess[capacity];
+        if (!table->entries)
+        {
+            delete table;
+            return nullptr;
+        }
+
+        table->mask = capacity - 1;
+        table->count = 0;
+
+        for (uint32_t slot = 0; slot < capacity; ++slot)
+        {
+            table->entries[slot].pid = kEmptyPid;
+            table->entries[slot].name[0] = '\0';
+        }
+
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            const FSGuardTrustedProcess &process = processes[index];
+
+            if (process.pid <= 0 || '\0' == process.name[0] || !memchr(process.name, '\0', sizeof(process.name)))
+            {
+                destroyTable(table);
+                return nullptr;
+            }
+
+            //
+            // NOTE: duplicate pid replaces the previous entry
+            //
+            uint32_t slot = slotForPid(process.pid, table->mask);
+            while (kEmptyPid != table->entries[slot].pid && process.pid != table->entries[slot].pid)
+            {
+                slot = (slot + 1) & table->mask;
+            }
+
+            if (kEmptyPid == table->entries[slot].pid)
+            {
+                ++table->count;
+            }
+
+            table->entries[slot] = process;
+        }
+
+        return table;
+    }
+
+    static void destroyTable(Table *table)
+    {
+        if (table)
+        {
+            delete [] table->entries;
+            delete table;
+        }
+    }
+
+private:
+    ReadMostlyPointer<Table, Backoff> m_table;
+    uint32_t                          m_count = 0;
+
+};
+
+#endif /* TrustedProcessSet_h */
@@ -8,6 +8,8 @@
 
 #include "Utils.h"
 
+#include <kern/thread.h>
+
 void * MallocNoFail(vm_size_t size)
 {
     void * buff = nullptr;
@@ -19,3 +21,13 @@ void * MallocNoFail(vm_size_t size)
 
     return buff;
 }
+
+uint32_t GetThreadShard()
+{
+    //
+    // NOTE: thread structures are at least cache line apart, drop low bits before hashing
+    //
+    const uint64_t thread = reinterpret_cast<uintptr_t>(current_thread()) >> 6;
+
+    return static_cast<uint32_t>((thread * 0x9E3779B97F4A7C15ull) >> 32);
+}
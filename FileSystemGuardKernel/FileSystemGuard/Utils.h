@@ -37,6 +37,11 @@ static Type * MallocTypeNoFail(vm_size_t size = sizeof(Type))
     return static_cast<Type *>(MallocNoFail(size));
 }
 
+//
+// NOTE: hash of the current thread, picks shard of per-thread counters and pools
+//
+uint32_t GetThreadShard();
+
 class LockGuard
 {
 public:
@@ -0,0 +1,203 @@
+//
+//  VerdictCache.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef VerdictCache_h
+#define VerdictCache_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// NOTE: portable core, it does not depend on IOKit and does no locking,
+//       owner is responsible for serializing access and providing time
+//
+
+struct VerdictKey
+{
+    uint64_t fsid;
+    uint64_t fileid;
+    uint32_t vid;
+
+    //
+    // NOTE: mask of FSGuardAction bits, verdict is for all of them together
+    //
+    uint32_t actionMask;
+    int32_t  pid;
+};
+
+inline bool operator==(const VerdictKey &lhs, const VerdictKey &rhs)
+{
+    return lhs.fsid == rhs.fsid &&
+           lhs.fileid == rhs.fileid &&
+           lhs.vid == rhs.vid &&
+           lhs.actionMask == rhs.actionMask &&
+           lhs.pid == rhs.pid;
+}
+
+inline uint64_t HashVerdictKey(const VerdictKey &key)
+{
+    uint64_t hash = key.fsid * 0x9E3779B97F4A7C15ull;
+
+    hash ^= key.fileid + 0x632BE59BD9B4E019ull + (hash << 6) + (hash >> 2);
+    hash ^= (static_cast<uint64_t>(key.vid) << 32 | key.actionMask) + (hash << 6) + (hash >> 2);
+    hash ^= static_cast<uint32_t>(key.pid) + (hash << 6) + (hash >> 2);
+
+    //
+    // NOTE: final avalanche, low bits select the set
+    //
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+//
+// NOTE: bounded set-associative cache, entry is valid while it is not expired
+//       and was stored in the current generation, so flush is O(1)
+//
+template <uint32_t SetCount, uint32_t Ways = 4>
+class VerdictCache
+{
+    static_assert(SetCount && 0 == (SetCount & (SetCount - 1)), "SetCount must be power of two");
+
+public:
+    static constexpr uint32_t kCapacity = SetCount * Ways;
+
+    bool lookup(const VerdictKey &key, uint64_t now, bool &allow) const
+    {
+        const Entry *set = setForKey(key);
+
+        for (uint32_t way = 0; way < Ways; ++way)
+        {
+            const Entry &entry = set[way];
+            if (isLive(entry, now) && entry.key == key)
+            {
+                allow = entry.allow;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void insert(const VerdictKey &key, bool allow, uint64_t now, uint64_t timeout)
+    {
+        Entry *set = setForKey(key);
+        Entry *victim = nullptr;
+
+        //
+        // NOTE: live entry of the key may be in any way, it must be replaced
+        //       or lookup could return its stale verdict
+        //
+        for (uint32_t way = 0; way < Ways; ++way)
+        {
+            Entry &entry = set[way];
+            if (isLive(entry, now) && entry.key == key)
+            {
+                victim = &entry;
+                break;
+            }
+        }
+
+        for (uint32_t way = 0; !victim && way < Ways; ++way)
+        {
+            if (!isLive(set[way], now))
+            {
+                victim = &set[way];
+            }
+        }
+
+        //
+        // NOTE: all ways are live, replace the one which expires first
+        //
+        if (!victim)
+        {
+            victim = &set[0];
+            for (uint32_t way = 1; way < Ways; ++way)
+            {
+                if (set[way].expires < victim->expires)
+                {
+                    victim = &set[way];
+                }
+            }
+        }
+
+        victim->key = key;
+        victim->allow = allow;
+        victim->expires = now + timeout;
+        victim->generation = m_generation;
+    }
+
+    //
+    // NOTE: verdict decided by rules of the generation taken before the decision
+    //       is dropped if the cache was flushed meanwhile
+    //
+    bool insert(const VerdictKey &key, bool allow, uint64_t now, uint64_t timeout, uint32_t generation)
+    {
+        if (generation != m_generation)
+        {
+            return false;
+        }
+
+        insert(key, allow, now, timeout);
+        return true;
+    }
+
+    void flush()
+    {
+        //
+        // NOTE: generation 0 is never current, it marks never used entries
+        //
+        if (0 == ++m_generation)
+        {
+            for (Entry &entry : m_entries)
+            {
+                entry.generation = 0;
+            }
+
+            m_generation = 1;
+        }
+    }
+
+    uint32_t generation() const
+    {
+        return m_generation;
+    }
+
+private:
+    struct Entry
+    {
+        VerdictKey key;
+        uint64_t   expires;
+        uint32_t   generation;
+        bool       allow;
+    };
+
+    Entry * setForKey(const VerdictKey &key)
+    {
+        return &m_entries[(HashVerdictKey(key) & (SetCount - 1)) * Ways];
+    }
+
+    const Entry * setForKey(const VerdictKey &key) const
+    {
+        return &m_entries[(HashVerdictKey(key) & (SetCount - 1)) * Ways];
+    }
+
+    bool isLive(const Entry &entry, uint64_t now) const
+    {
+        return entry.generation == m_generation && now < entry.expires;
+    }
+
+private:
+    Entry    m_entries[kCapacity] {};
+    uint32_t m_generation = 1;
+
+};
+
+#endif /* VerdictCache_h */
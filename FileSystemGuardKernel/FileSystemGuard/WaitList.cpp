@@ -26,49 +26,19 @@ WaitList * WaitList::waitList()
     return waitList;
 }
 
-void WaitList::add(void *event)
+bool WaitList::add(void *event)
 {
-    WaitListEntry *waitListEntry = MallocTypeNoFail<struct WaitListEntry>();
-
-    if (waitListEntry)
-    {
-        waitListEntry->event = event;
-
-        LIST_INSERT_HEAD(&m_list, waitListEntry, entry);
-    }
+    return m_events.insert(event);
 }
 
 void WaitList::remove(void *event)
 {
-    WaitListEntry *waitListEntry = nullptr;
-    WaitListEntry *tmp = nullptr;
-
-    LIST_FOREACH_SAFE(waitListEntry, &m_list, entry, tmp)
-    {
-        if (waitListEntry->event == event)
-        {
-            LIST_REMOVE(waitListEntry, entry);
-            IOFree(waitListEntry, sizeof(struct WaitListEntry));
-
-            return;
-        }
-    }
+    m_events.erase(event);
 }
 
 bool WaitList::contains(void *event) const
 {
-    WaitListEntry *waitListEntry = nullptr;
-    WaitListEntry *tmp = nullptr;
-
-    LIST_FOREACH_SAFE(waitListEntry, &m_list, entry, tmp)
-    {
-        if (waitListEntry->event == event)
-        {
-            return true;
-        }
-    }
-
-    return false;
+    return m_events.contains(event);
 }
 
 wait_result_t WaitList::wait(void *event, wait_interrupt_t interruptType, IOLock *lock, AbsoluteTime timeout)
@@ -92,15 +62,9 @@ void WaitList::removeEntries(IOLock *lock)
 {
     LockGuard lockGuard(lock);
 
-    WaitListEntry *waitListEntry = nullptr;
-    WaitListEntry *tmp = nullptr;
-
-    LIST_FOREACH_SAFE(waitListEntry, &m_list, entry, tmp)
-    {
-        LIST_REMOVE(waitListEntry, entry);
-        IOLockWakeup(lock, waitListEntry->event, false);
-        IOFree(waitListEntry, sizeof(struct WaitListEntry));
-    }
+    m_events.clear([lock](void *event) {
+        IOLockWakeup(lock, event, false);
+    });
 }
 
 bool WaitList::init()
@@ -110,8 +74,5 @@ bool WaitList::init()
         return false;
     }
 
-    LIST_INIT(&m_list);
-
     return true;
 }
-
@@ -11,16 +11,22 @@
 
 #include <libkern/c++/OSObject.h>
 #include <IOKit/IOLocks.h>
-#include <sys/queue.h>
 
-struct WaitListEntry
-{
-    LIST_ENTRY(WaitListEntry) entry;
-    void *event;
-};
+#include "PointerHashSet.h"
 
 const AbsoluteTime kNoTimeout = -1;
 
+//
+// NOTE: twice the number of queued requests, so requests which are already
+//       dequeued by the daemon but not yet resolved still have room
+//
+constexpr uint32_t kWaitListSlotCount = 4096;
+
+//
+// NOTE: requests the list holds at once, slots are kept at most half full
+//
+constexpr uint32_t kWaitListCapacity = PointerHashSet<kWaitListSlotCount>::kMaxSize;
+
 class WaitList : public OSObject
 {
     OSDeclareDefaultStructors(WaitList);
@@ -28,7 +34,10 @@ class WaitList : public OSObject
 public:
     static WaitList * waitList();
 
-    void add(void *event);
+    //
+    // NOTE: fails when all preallocated entries are in use
+    //
+    bool add(void *event);
     void remove(void *event);
     bool contains(void *event) const;
     wait_result_t wait(void *event, wait_interrupt_t interruptType, IOLock *lock, AbsoluteTime timeout = kNoTimeout);
@@ -39,7 +48,7 @@ protected:
     virtual bool init() override;
 
 private:
-    LIST_HEAD(WaitListData, WaitListEntry) m_list = LIST_HEAD_INITIALIZER(m_list);
+    PointerHashSet<kWaitListSlotCount> m_events;
 
 };
 
@@ -0,0 +1,392 @@
+//
+//  WatchScope.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef WatchScope_h
+#define WatchScope_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FSGuardUserClientInterface.h"
+
+//
+// NOTE: portable matcher of FSGuardWatchScope. Mount of the vnode is classified
+//       by fsid first, only vnodes of mounts with watched roots need ancestor walk
+//
+enum class WatchScopeMount
+{
+    Outside,
+    Whole,
+    Partial
+};
+
+class WatchScope
+{
+public:
+    //
+    // NOTE: validates scope sent by the client, mounts and roots are sorted
+    //       here, so lookups are binary searches
+    //
+    bool load(const FSGuardWatchScope &scope)
+    {
+        if (scope.mountCount > kFGMaxWatchedMounts || scope.rootCount > kFGMaxWatchedRoots)
+        {
+            return false;
+        }
+
+        m_mountCount = 0;
+        m_rootCount = 0;
+
+        for (uint32_t index = 0; index < scope.mountCount; ++index)
+        {
+            insertMount(scope.mounts[index], WatchScopeMount::Whole);
+        }
+
+        for (uint32_t index = 0; index < scope.rootCount; ++index)
+        {
+            const FSGuardFileIdentity &root = scope.roots[index];
+
+            insertMount(root.fsid, WatchScopeMount::Partial);
+            insertRoot(root.fsid, root.fileid);
+        }
+
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return 0 == m_mountCount;
+    }
+
+    WatchScopeMount classify(uint64_t fsid) const
+    {
+        if (isEmpty())
+        {
+            return WatchScopeMount::Whole;
+        }
+
+        uint32_t low = 0;
+        uint32_t high = m_mountCount;
+
+        while (low < high)
+        {
+            const uint32_t middle = low + (high - low) / 2;
+            if (m_mounts[middle].fsid < fsid)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        if (low < m_mountCount && m_mounts[low].fsid == fsid)
+        {
+            return m_mounts[low].kind;
+        }
+
+        return WatchScopeMount::Outside;
+    }
+
+    bool isRoot(uint64_t fsid, uint64_t fileid) const
+    {
+        const uint32_t index = lowerBoundRoot(fsid, fileid);
+
+        return index < m_rootCount && m_roots[index].fsid == fsid && m_roots[index].fileid == fileid;
+    }
+
+private:
+    struct Mount
+    {
+        uint64_t        fsid;
+        WatchScopeMount kind;
+    };
+
+    struct Root
+    {
+        uint64_t fsid;
+        uint64_t fileid;
+    };
+
+    //
+    // NOTE: whole mount wins over the roots on it
+    //
+    void insertMount(uint64_t fsid, WatchScopeMount kind)
+    {
+        uint32_t index = 0;
+        while (index < m_mountCount && m_mounts[index].fsid < fsid)
+        {
+            ++index;
+        }
+
+        if (index < m_mountCount && m_mounts[index].fsid == fsid)
+        {
+            if (WatchScopeMount::Whole == kind)
+            {
+                m_mounts[index].kind = kind;
+            }
+
+            return;
+        }
+
+        for (uint32_t move = m_mountCount; move > index; --move)
+        {
+            m_mounts[move] = m_mounts[move - 1];
+        }
+
+        m_mounts[index] = Mount { fsid, kind };
+        ++m_mountCount;
+    }
+
+    void insertRoot(uint64_t fsid, uint64_t fileid)
+    {
+        const uint32_t index = lowerBoundRoot(fsid, fileid);
+        if (index < m_rootCount && m_roots[index].fsid == fsid && m_roots[index].fileid == fileid)
+        {
+            return;
+        }
+
+        for (uint32_t move = m_rootCount; move > index; --move)
+        {
+            m_roots[move] = m_roots[move - 1];
+        }
+
+        m_roots[index] = Root { fsid, fileid };
+        ++m_rootCount;
+    }
+
+    uint32_t lowerBoundRoot(uint64_t fsid, uint64_t fileid) const
+    {
+        uint32_t low = 0;
+        uint32_t high = m_rootCount;
+
+        while (low < high)
+        {
+            const uint32_t middle = low + (high - low) / 2;
+            const Root &root = m_roots[middle];
+
+            if (root.fsid < fsid || (root.fsid == fsid && root.fileid < fileid))
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        return low;
+    }
+
+private:
+    //
+    // NOTE: every root may add its own mount
+    //
+    Mount    m_mounts[kFGMaxWatchedMounts + kFGMaxWatchedRoots];
+    uint32_t m_mountCount = 0;
+
+    Root     m_roots[kFGMaxWatchedRoots];
+    uint32_t m_rootCount = 0;
+
+};
+
+//
+// NOTE: direct-mapped cache of directories known to be inside or outside
+//       watched roots, keyed by the directory object and its version, so
+//       reused object misses. Entry is valid while it was stored in the
+//       current epoch, clear is O(1). No locking, owner serializes access.
+//
+template <uint32_t SlotCount>
+class AncestorCache
+{
+    static_assert(SlotCount && 0 == (SlotCount & (SlotCount - 1)), "SlotCount must be power of two");
+
+public:
+    uint32_t epoch() const
+    {
+        return m_epoch;
+    }
+
+    bool lookup(uint64_t object, uint32_t version, bool &watched) const
+    {
+        const Entry &entry = m_entries[slotForObject(object)];
+        if (entry.epoch != m_epoch || entry.object != object || entry.version != version)
+        {
+            return false;
+        }
+
+        watched = entry.watched;
+
+        return true;
+    }
+
+    //
+    // NOTE: result of the walk started before clear is dropped
+    //
+    void insert(uint64_t object, uint32_t version, bool watched, uint32_t epoch)
+    {
+        if (epoch != m_epoch)
+        {
+            return;
+        }
+
+        Entry &entry = m_entries[slotForObject(object)];
+
+        entry.object = object;
+        entry.version = version;
+        entry.epoch = m_epoch;
+        entry.watched = watched;
+    }
+
+    void clear()
+    {
+        //
+        // NOTE: epoch 0 marks free entries, on wrap entries of
+        //       the first epoch would look valid again
+        //
+        if (0 == ++m_epoch)
+        {
+            for (uint32_t index = 0; index < SlotCount; ++index)
+            {
+                m_entries[index].epoch = 0;
+            }
+
+            m_epoch = 1;
+        }
+    }
+
+private:
+    struct Entry
+    {
+        uint64_t object;
+        uint32_t version;
+        uint32_t epoch;
+        bool     watched;
+    };
+
+    static uint32_t slotForObject(uint64_t object)
+    {
+        uint64_t hash = object;
+
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+
+        return static_cast<uint32_t>(hash) & (SlotCount - 1);
+    }
+
+private:
+    Entry    m_entries[SlotCount] {};
+    uint32_t m_epoch = 1;
+
+};
+
+//
+// NOTE: max directories walked up from the vnode, deeper one is treated as watched
+//
+constexpr uint32_t kFGWatchScopeMaxDepth = 128;
+
+//
+// NOTE: directories of one walk stored to the cache, the nearest ones matter most
+//
+constexpr uint32_t kFGWatchScopeCachedAncestors = 8;
+
+//
+// NOTE: decides whether directory on partially watched mount is one of the roots
+//       or under one, walking up until cached directory, root or mount root.
+//       Directory which can not be identified or has unknown parent is watched,
+//       so it is checked like before the scope was set, and is not cached.
+//
+//       Cache provides epoch, lookup and insert of AncestorCache. Walker provides:
+//           Node                                              - directory handle, NodeNull when none
+//           uint64_t object(Node) / uint32_t version(Node)    - cache key
+//           bool fileid(Node, uint64_t &)
+//           bool isMountRoot(Node)
+//           Node parent(Node)                                 - released by release(Node)
+//
+template <typename Cache, typename Walker>
+bool IsWatchedDirectory(const WatchScope &scope, uint64_t fsid, typename Walker::Node directory, Cache &cache, Walker &walker)
+{
+    struct Key
+    {
+        uint64_t object;
+        uint32_t version;
+    };
+
+    Key visited[kFGWatchScopeCachedAncestors];
+    uint32_t visitedCount = 0;
+
+    const uint32_t epoch = cache.epoch();
+
+    typename Walker::Node node = directory;
+    bool watched = true;
+    bool cacheable = false;
+
+    for (uint32_t depth = 0; depth < kFGWatchScopeMaxDepth; ++depth)
+    {
+        const Key key { walker.object(node), walker.version(node) };
+        if (cache.lookup(key.object, key.version, watched))
+        {
+            cacheable = true;
+            break;
+        }
+
+        if (visitedCount < kFGWatchScopeCachedAncestors)
+        {
+            visited[visitedCount++] = key;
+        }
+
+        uint64_t fileid = 0;
+        if (!walker.fileid(node, fileid))
+        {
+            watched = true;
+            break;
+        }
+
+        if (scope.isRoot(fsid, fileid) || walker.isMountRoot(node))
+        {
+            watched = scope.isRoot(fsid, fileid);
+            cacheable = true;
+            break;
+        }
+
+        typename Walker::Node parent = walker.parent(node);
+        if (node != directory)
+        {
+            walker.release(node);
+        }
+
+        node = parent;
+        if (Walker::NodeNull == node)
+        {
+            watched = true;
+            break;
+        }
+    }
+
+    if (Walker::NodeNull != node && node != directory)
+    {
+        walker.release(node);
+    }
+
+    //
+    // NOTE: every directory on the way has the same answer
+    //
+    if (cacheable)
+    {
+        for (uint32_t index = 0; index < visitedCount; ++index)
+        {
+            cache.insert(visited[index].object, visited[index].version, watched, epoch);
+        }
+    }
+
+    return watched;
+}
+
+#endif /* WatchScope_h */
@@ -0,0 +1,126 @@
+//
+//  FSGuardCompletionRing.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardCompletionRing_h
+#define FSGuardCompletionRing_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FSGuardUserClientInterface.h"
+
+//
+// NOTE: single-producer/single-consumer ring of responses placed in memory
+//       shared between the client (producer) and the driver (consumer).
+//       Each side keeps its own index privately and only publishes it,
+//       index of the other side is validated before use because the
+//       shared memory may be corrupted by the peer.
+//
+struct FSGuardCompletionRingHeader
+{
+    alignas(64) uint32_t head;
+    alignas(64) uint32_t tail;
+};
+
+class FSGuardCompletionRing
+{
+public:
+    static constexpr size_t memorySize(uint32_t capacity)
+    {
+        return sizeof(FSGuardCompletionRingHeader) + capacity * sizeof(FSGuardResponse);
+    }
+
+    bool attach(void *memory, size_t size, uint32_t capacity)
+    {
+        if (!memory || !capacity || (capacity & (capacity - 1)) || size < memorySize(capacity))
+        {
+            return false;
+        }
+
+        m_header = static_cast<FSGuardCompletionRingHeader *>(memory);
+        m_entries = reinterpret_cast<FSGuardResponse *>(m_header + 1);
+        m_mask = capacity - 1;
+        m_position = 0;
+
+        return true;
+    }
+
+    void detach()
+    {
+        m_header = nullptr;
+        m_entries = nullptr;
+    }
+
+    bool isAttached() const
+    {
+        return nullptr != m_header;
+    }
+
+    //
+    // NOTE: producer side
+    //
+    bool push(const FSGuardResponse &response)
+    {
+        const uint32_t head = __atomic_load_n(&m_header->head, __ATOMIC_ACQUIRE);
+        if (m_position - head > m_mask)
+        {
+            return false;
+        }
+
+        m_entries[m_position & m_mask] = response;
+        __atomic_store_n(&m_header->tail, ++m_position, __ATOMIC_RELEASE);
+
+        return true;
+    }
+
+    bool empty() const
+    {
+        return __atomic_load_n(&m_header->head, __ATOMIC_ACQUIRE) == m_position;
+    }
+
+    //
+    // NOTE: consumer side, visitor gets a private copy of every published response,
+    //       returns number of drained responses
+    //
+    template <typename Visitor>
+    uint32_t drain(Visitor visitor)
+    {
+        const uint32_t tail = __atomic_load_n(&m_header->tail, __ATOMIC_ACQUIRE);
+
+        //
+        // NOTE: producer can not be ahead more than capacity, otherwise memory is corrupted
+        //
+        if (tail - m_position > m_mask + 1)
+        {
+            m_position = tail;
+            __atomic_store_n(&m_header->head, m_position, __ATOMIC_RELEASE);
+
+            return 0;
+        }
+
+        uint32_t count = 0;
+        for (; m_position != tail; ++m_position, ++count)
+        {
+            const FSGuardResponse response = m_entries[m_position & m_mask];
+            visitor(response);
+        }
+
+        __atomic_store_n(&m_header->head, m_position, __ATOMIC_RELEASE);
+
+        return count;
+    }
+
+private:
+    FSGuardCompletionRingHeader *m_header = nullptr;
+    FSGuardResponse             *m_entries = nullptr;
+    uint32_t                     m_mask = 0;
+    uint32_t                     m_position = 0;
+
+};
+
+#endif /* FSGuardCompletionRing_h */
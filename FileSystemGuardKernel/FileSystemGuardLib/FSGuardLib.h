@@ -9,11 +9,18 @@
 #import <Foundation/Foundation.h>
 
 #include "FSGuardUserClientInterface.h"
+#include "FSGuardStatistics.h"
+
+class FSGuardResolver;
 
 NS_ASSUME_NONNULL_BEGIN
 
 @protocol FSGuardClientDelegate
 
+//
+// NOTE: request and its file path are valid only until the method returns
+//
+
 - (void) resolveRequest:(const FSGuardRequest *)request
          withCompletion:(void (^)(BOOL))completion;
 
@@ -23,10 +30,93 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (atomic, weak) NSObject<FSGuardClientDelegate> *delegate;
 
+//
+// NOTE: number of threads resolving requests, should be set before start,
+//       defaults to the number of active processors
+//
+@property (nonatomic) NSUInteger resolverConcurrency;
+
+//
+// NOTE: native resolver from FSGuardResolver.h used instead of the delegate,
+//       should be set before start and outlive the run of start. stop joins
+//       the dequeue loop and the resolver pool, so the resolver may be stopped
+//       and destroyed right after stop returns. Requests still suspended in
+//       the resolver are completed by it through the client, which has to be
+//       alive until the resolver is stopped
+//
+@property (nonatomic, nullable) FSGuardResolver *resolver;
+
 - (instancetype)init;
 - (BOOL)start;
+
+//
+// NOTE: waits until start returns, a stopped client is not started again.
+//       Must not be called from the delegate or the resolver
+//
 - (void)stop;
 
+//
+// NOTE: drop verdicts cached by the driver, e.g. after policy change
+//
+- (BOOL)flushVerdictCache;
+
+//
+// NOTE: mask of FSGuardActionMask bits to be resolved by the delegate,
+//       other actions are allowed by the driver without request. Up to
+//       kFGMaxUserClients clients may be started, each action is split
+//       by process between the clients subscribed to it
+//
+- (BOOL)setSubscriptionMask:(uint32_t)mask;
+
+//
+// NOTE: policy, trusted processes and watched mounts are shared by all clients
+//       and belong to the first client which sets any of them. They fail for
+//       other clients until the owner closes, which clears them
+//
+
+//
+// NOTE: load policy compiled by FSGuardPolicyBuilder, requests decided by
+//       the policy do not reach the delegate, nil policy removes it
+//
+- (BOOL)loadPolicy:(nullable NSData *)policy;
+
+//
+// NOTE: limits how long access waits for the client, see FSGuardOverloadPolicy,
+//       the driver uses kFGDefaultOverloadPolicy until it is set
+//
+- (BOOL)setOverloadPolicy:(const FSGuardOverloadPolicy *)policy;
+
+//
+// NOTE: processes allowed by the driver without request, e.g. backup agents
+//       and indexers verified by the caller. Replaces the previous list,
+//       zero count clears it. Up to kFGMaxTrustedProcesses entries, each
+//       with the name of the process, list with unnamed entry is rejected
+//
+- (BOOL)setTrustedProcesses:(const FSGuardTrustedProcess *_Nullable)processes count:(NSUInteger)count;
+
+//
+// NOTE: limits requests to the given mount points and directory subtrees,
+//       access outside is allowed by the driver without path lookup.
+//       Both empty watch everything. Up to kFGMaxWatchedMounts mounts
+//       and kFGMaxWatchedRoots roots, which must exist
+//
+- (BOOL)setWatchedMounts:(NSArray<NSString *> *)mounts roots:(NSArray<NSString *> *)roots;
+
+//
+// NOTE: record every resolved request with its verdict and latency
+//       to the file in FSGuardTrace.h format, for replay with fsguardreplay
+//
+- (BOOL)startTraceAtPath:(NSString *)path;
+- (void)stopTrace;
+
+//
+// NOTE: counters and stage latencies since start, the driver reports
+//       enqueue wait and time to verdict, the client queue residency
+//       and resolution by the delegate
+//
+- (BOOL)getDriverStatistics:(FSGuardStatistics *)statistics;
+- (void)getClientStatistics:(FSGuardStatistics *)statistics;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -9,25 +9,135 @@
 #import "FSGuardLib.h"
 
 #include <IOKit/IOKitLib.h>
-#include <IOKit/IODataQueueShared.h>
 #include <IOKit/IODataQueueClient.h>
 
 #include <mach/mach.h>
+#include <mach/mach_time.h>
+#include <os/lock.h>
+#include <sys/mount.h>
+#include <sys/stat.h>
+
+#include <atomic>
+#include <optional>
 
 #include "FSGuardUserClientInterface.h"
+#include "FSGuardCompletionRing.h"
+#include "FSGuardPathCache.h"
+#include "FSGuardRequestCodec.h"
+#include "FSGuardRequestRing.h"
+#include "FSGuardRequestScheduler.h"
+#include "FSGuardResolver.h"
+#include "FSGuardResolverPool.h"
+#include "FSGuardStatistics.h"
+#include "FSGuardTrace.h"
+
+//
+// NOTE: requests in flight in user space, when all are busy
+//       the driver queues new requests in the request ring
+//
+constexpr uint32_t kFGResolverTaskCount = 1024;
+
+struct FSGuardResolverTask
+{
+    alignas(kFGRequestRecordAlignment) uint8_t record[kFGMaxRequestRecordSize];
+    uint32_t size;
+
+    //
+    // NOTE: uptime in nanoseconds the record was taken from the ring
+    //
+    uint64_t dequeueTime;
+};
+
+//
+// NOTE: request copied for the trace while native resolver decides it
+//
+struct FSGuardResolverTrace
+{
+    std::string   path;
+    pid_t         pid;
+    FSGuardAction action;
+};
+
+//
+// NOTE: resolver threads and the dequeue loop record to own shards
+//
+using FSGuardClientStatistics = FSGuardStatisticsRecorder<16>;
+
+static uint32_t GetStatisticsShard()
+{
+    static std::atomic<uint32_t> nextShard {0};
+    static thread_local const uint32_t shard = nextShard++;
+
+    return shard;
+}
+
+//
+// NOTE: header is validated by the decoder on resolver thread,
+//       truncated record is scheduled as read and rejected there
+//
+static FSGuardRequestLane GetTaskLane(const FSGuardResolverTask &task, pid_t &pid, uint64_t &deadline)
+{
+    pid = 0;
+    deadline = 0;
+
+    if (task.size < sizeof(FSGuardRequestRecord))
+    {
+        return FSGuardRequestLane::Read;
+    }
+
+    const FSGuardRequestRecord *record = reinterpret_cast<const FSGuardRequestRecord *>(task.record);
+    pid = record->pid;
+    deadline = record->deadline;
+
+    return FSGuardRequestLaneForAction(record->action);
+}
+
+static uint64_t GetUptimeNanoseconds(uint64_t absoluteTime)
+{
+    static mach_timebase_info_data_t timebase = [] {
+        mach_timebase_info_data_t info = {};
+        mach_timebase_info(&info);
+        return info;
+    }();
+
+    return absoluteTime * timebase.numer / timebase.denom;
+}
 
 @interface FSGuardClient ()
 
 @property (nonatomic) io_connect_t       connection;
 @property (nonatomic) mach_port_t        dataQueuePort;
-@property (nonatomic) IODataQueueMemory *queueMappedMemory;
+@property (nonatomic) mach_vm_address_t  queueMappedMemory;
 @property (nonatomic) vm_size_t          queueMappedMemorySize;
+@property (nonatomic) mach_vm_address_t  completionRingAddress;
 @property (nonatomic) BOOL               dataQueueLoopStop;
 @property (nonatomic) NSThread          *dataQueueLoopThread;
 
 @end
 
 @implementation FSGuardClient
+{
+    FSGuardRequestRing    _requestRing;
+    FSGuardCompletionRing _completionRing;
+    os_unfair_lock        _completionRingLock;
+    std::atomic<bool>     _doorbellPending;
+
+    FSGuardResolverPool<FSGuardResolverTask> _resolverPool;
+    std::optional<FSGuardResolverExecutor>   _resolverExecutor;
+    FSGuardResolutionEstimate                _resolutionEstimate;
+
+    FSGuardClientStatistics _statistics;
+
+    FSGuardPathCache _pathCache;
+    os_unfair_lock   _pathCacheLock;
+
+    FSGuardTraceWriter _traceWriter;
+    std::atomic<bool>  _tracing;
+    uint64_t           _traceStartTime;
+
+    NSCondition *_runCondition;
+    BOOL         _running;
+}
 
 - (instancetype)init
 {
@@ -35,18 +145,51 @@
 
     if (self)
     {
+
         _delegate = nil;
         _connection = IO_OBJECT_NULL;
         _dataQueuePort = MACH_PORT_NULL;
-        _queueMappedMemory = NULL;
+        _queueMappedMemory = 0;
         _queueMappedMemorySize = 0;
+        _completionRingAddress = 0;
         _dataQueueLoopStop = NO;
+        _completionRingLock = OS_UNFAIR_LOCK_INIT;
+        _pathCacheLock = OS_UNFAIR_LOCK_INIT;
+        _doorbellPending = false;
+        _resolverConcurrency = NSProcessInfo.processInfo.activeProcessorCount;
+        _resolver = nullptr;
+        _resolverExecutor.emplace(_resolverPool);
+        _tracing = false;
+        _traceStartTime = 0;
+        _runCondition = [[NSCondition alloc] init];
+        _running = NO;
     }
 
     return self;
 }
 
 - (BOOL)start
+{
+    [_runCondition lock];
+    if (_running || self.dataQueueLoopStop)
+    {
+        [_runCondition unlock];
+        return NO;
+    }
+    _running = YES;
+    [_runCondition unlock];
+
+    const BOOL started = [self run];
+
+    [_runCondition lock];
+    _running = NO;
+    [_runCondition broadcast];
+    [_runCondition unlock];
+
+    return started;
+}
+
+- (BOOL)run
 {
     if (![self openDriverConnection])
     {
@@ -60,14 +203,75 @@
         return NO;
     }
 
+    //
+    // NOTE: responses are sent one by one if completion ring is not available
+    //
+    if (![self mapCompletionRing])
+    {
+        NSLog(@"Failed to map completion ring");
+    }
+
+    //
+    // NOTE: pool does not outlive this method, so self is not retained by the handler
+    //
+    __unsafe_unretained FSGuardClient *const client = self;
+
+    const uint32_t concurrency = static_cast<uint32_t>(MAX(self.resolverConcurrency, 1));
+    if (!_resolverPool.start(concurrency, MAX(kFGResolverTaskCount, concurrency), [client](FSGuardResolverTask &task) {
+        @autoreleasepool
+        {
+            [client handleRequestRecord:task.record size:task.size dequeueTime:task.dequeueTime];
+        }
+    }))
+    {
+        NSLog(@"Failed to start resolver pool");
+        return NO;
+    }
+
     [self startDataQueueLoop];
 
+    _resolverPool.stop();
+
     return YES;
 }
 
 - (void)stop
 {
     self.dataQueueLoopStop = YES;
+
+    //
+    // NOTE: wakes the dequeue loop blocked in waitForRequests and waits until start
+    //       returns, so neither the loop nor the resolver pool touch the resolver after
+    //
+    [_runCondition lock];
+    [self wakeDataQueueLoop];
+    while (_running)
+    {
+        [_runCondition wait];
+    }
+    [_runCondition unlock];
+}
+
+- (void)wakeDataQueueLoop
+{
+    if (MACH_PORT_NULL == self.dataQueuePort)
+    {
+        return;
+    }
+
+    mach_msg_header_t header = {};
+    header.msgh_bits = MACH_MSGH_BITS(MACH_MSG_TYPE_MAKE_SEND, 0);
+    header.msgh_size = sizeof(header);
+    header.msgh_remote_port = self.dataQueuePort;
+
+    //
+    // NOTE: a full port queue already wakes the loop, so the message is not waited for
+    //
+    kern_return_t kr = mach_msg(&header, MACH_SEND_MSG | MACH_SEND_TIMEOUT, sizeof(header), 0, MACH_PORT_NULL, 0, MACH_PORT_NULL);
+    if (KERN_SUCCESS != kr && MACH_SEND_TIMED_OUT != kr)
+    {
+        NSLog(@"mach_msg failed - %s", mach_error_string(kr));
+    }
 }
 
 - (BOOL)openDriverConnection
@@ -99,22 +303,22 @@
 
 - (BOOL)createDataQueuePort
 {
-    self.dataQueuePort = IODataQueueAllocateNotificationPort();
+    mach_port_t port = IODataQueueAllocateNotificationPort();
 
-    if (!self.dataQueuePort)
+    if (!port)
     {
         NSLog(@"IODataQueueAllocateNotificationPort failed");
 
         return false;
     }
 
-    kern_return_t kr = IOConnectSetNotificationPort(self.connection, kFGNotificationPortQueue, self.dataQueuePort, 0);
+    kern_return_t kr = IOConnectSetNotificationPort(self.connection, kFGNotificationPortQueue, port, 0);
 
     if (kIOReturnSuccess != kr)
     {
         NSLog(@"IOConnectSetNotificationPort failed - %s", mach_error_string(kr));
 
-        mach_port_destroy(mach_task_self(), self.dataQueuePort);
+        mach_port_destroy(mach_task_self(), port);
         return false;
     }
 
@@ -126,63 +330,156 @@
     {
         NSLog(@"IOConnectMapMemory failed - %s", mach_error_string(kr));
 
-        mach_port_destroy(mach_task_self(), self.dataQueuePort);
+        mach_port_destroy(mach_task_self(), port);
         return NO;
     }
 
-    self.queueMappedMemory = (IODataQueueMemory *)address;
+    if (!_requestRing.attach(reinterpret_cast<void *>(address), size, kFGRequestQueueSize))
+    {
+        NSLog(@"Invalid request queue memory");
+
+        IOConnectUnmapMemory(self.connection, kFGMemoryMapQueue, mach_task_self(), address);
+        mach_port_destroy(mach_task_self(), port);
+        return NO;
+    }
+
+    self.queueMappedMemory = address;
     self.queueMappedMemorySize = size;
 
+    //
+    // NOTE: port is published under the run condition, stop may be sending a wakeup to it
+    //
+    [_runCondition lock];
+    self.dataQueuePort = port;
+    [_runCondition unlock];
+
+    return YES;
+}
+
+- (BOOL)mapCompletionRing
+{
+    mach_vm_address_t address = 0;
+    mach_vm_size_t size = 0;
+
+    kern_return_t kr = IOConnectMapMemory(self.connection, kFGMemoryMapCompletionRing, mach_task_self(), &address, &size, kIOMapAnywhere);
+    if (kIOReturnSuccess != kr)
+    {
+        NSLog(@"IOConnectMapMemory failed - %s", mach_error_string(kr));
+        return NO;
+    }
+
+    os_unfair_lock_lock(&_completionRingLock);
+    const bool attached = _completionRing.attach(reinterpret_cast<void *>(address), size, kFGCompletionRingCapacity);
+    os_unfair_lock_unlock(&_completionRingLock);
+
+    if (!attached)
+    {
+        IOConnectUnmapMemory(self.connection, kFGMemoryMapCompletionRing, mach_task_self(), address);
+        return NO;
+    }
+
+    self.completionRingAddress = address;
+
     return YES;
 }
 
+- (void)unmapCompletionRing
+{
+    os_unfair_lock_lock(&_completionRingLock);
+
+    if (_completionRing.isAttached())
+    {
+        _completionRing.detach();
+        IOConnectUnmapMemory(self.connection, kFGMemoryMapCompletionRing, mach_task_self(), self.completionRingAddress);
+        self.completionRingAddress = 0;
+    }
+
+    os_unfair_lock_unlock(&_completionRingLock);
+}
+
 - (void)startDataQueueLoop
 {
     do
     {
-        while (!self.dataQueueLoopStop && IODataQueueDataAvailable(self.queueMappedMemory))
+        while (!self.dataQueueLoopStop)
         {
-            FSGuardRequest request = {};
-            uint32_t size = sizeof(FSGuardRequest);
+            //
+            // NOTE: waits for a free task, so the ring is not drained faster than requests are resolved
+            //
+            FSGuardResolverTask *task = _resolverPool.acquire();
+            if (!task)
+            {
+                break;
+            }
+
+            const bool popped = _requestRing.pop([task](const void *data, uint32_t size) {
+                //
+                // NOTE: copy only real size of the record, ring space is released right after.
+                //       Oversized record is truncated and rejected by the decoder
+                //
+                task->size = MIN(size, static_cast<uint32_t>(sizeof(task->record)));
+                memcpy(task->record, data, task->size);
+            });
 
-            IOReturn ioret = IODataQueueDequeue(self.queueMappedMemory, &request, &size);
-            if (kIOReturnSuccess != ioret)
+            if (!popped)
             {
-                NSLog(@"Invalid dequeue");
-                continue;
+                _resolverPool.release(task);
+
+                //
+                // NOTE: records after the corrupted one can not be found, the driver
+                //       gives requests of this client the default verdict at their deadline
+                //
+                if (_requestRing.isCorrupted())
+                {
+                    NSLog(@"Request queue is corrupted, stop processing requests");
+                    self.dataQueueLoopStop = YES;
+                }
+
+                break;
+            }
+
+            //
+            // NOTE: the driver does not see consumed space, producers waiting for it are woken
+            //
+            if (_requestRing.takeProducerWaiting())
+            {
+                [self signalRequestSpace];
             }
-            
-            void* rid = request.rid;
-            if (sizeof(FSGuardRequest) != size)
+
+            task->dequeueTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+
+            //
+            // NOTE: invalidations are consumed here, they need no verdict
+            //
+            if (![self updatePathCacheWithRecord:task->record size:task->size])
             {
-                NSLog(@"Invalid request size");
-                [self sendFSGuardResponse:YES forRequset:rid];
+                _resolverPool.release(task);
                 continue;
             }
-            
-            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-                id<FSGuardClientDelegate> const delegate = self.delegate;
-                if (delegate)
-                {
-                    [delegate resolveRequest:&request withCompletion:^(BOOL allow) {
-                        [self sendFSGuardResponse:allow forRequset:rid];
-                    }];
-                }
-                else
-                {
-                    [self sendFSGuardResponse:YES forRequset:rid];
-                }
-            });
+
+            pid_t pid = 0;
+            uint64_t deadline = 0;
+            const FSGuardRequestLane lane = GetTaskLane(*task, pid, deadline);
+
+            _resolverPool.submit(task, lane, pid, deadline);
         }
-    } while (!self.dataQueueLoopStop && (kIOReturnSuccess == IODataQueueWaitForAvailableData(self.queueMappedMemory, self.dataQueuePort)));
+    } while (!self.dataQueueLoopStop && [self waitForRequests]);
+
+    _requestRing.detach();
 
-    if (NULL != self.queueMappedMemory)
+    if (0 != self.queueMappedMemory)
     {
-        IOConnectUnmapMemory(self.connection, kFGMemoryMapQueue, mach_task_self(), reinterpret_cast<mach_vm_address_t>(self.queueMappedMemory));
-        self.queueMappedMemory = NULL;
+        IOConnectUnmapMemory(self.connection, kFGMemoryMapQueue, mach_task_self(), self.queueMappedMemory);
+        self.queueMappedMemory = 0;
         self.queueMappedMemorySize = 0;
     }
 
+    [self unmapCompletionRing];
+
+    //
+    // NOTE: port is destroyed under the run condition, stop may be sending a wakeup to it
+    //
+    [_runCondition lock];
     if (MACH_PORT_NULL != self.dataQueuePort)
     {
         kern_return_t kr = mach_port_destroy(mach_task_self(), self.dataQueuePort);
@@ -193,14 +490,487 @@
 
         self.dataQueuePort = MACH_PORT_NULL;
     }
+    [_runCondition unlock];
+}
+
+- (void)signalRequestSpace
+{
+    kern_return_t kr = IOConnectCallScalarMethod(self.connection,
+                                                 static_cast<uint32_t>(FSGuardMethod::SignalRequestSpace),
+                                                 nullptr, 0, nullptr, nullptr);
+
+    if (KERN_SUCCESS != kr)
+    {
+        NSLog(@"IOConnectCallScalarMethod failed -- %016x -- %s", kr, mach_error_string(kr));
+    }
+}
+
+- (BOOL)waitForRequests
+{
+    //
+    // NOTE: driver sends notification only if consumer announced it is going to wait
+    //
+    if (!_requestRing.prepareToWait())
+    {
+        return YES;
+    }
+
+    struct
+    {
+        mach_msg_header_t  header;
+        mach_msg_trailer_t trailer;
+    } message = {};
+
+    kern_return_t kr = mach_msg(&message.header, MACH_RCV_MSG, 0, sizeof(message), self.dataQueuePort, MACH_MSG_TIMEOUT_NONE, MACH_PORT_NULL);
+    if (KERN_SUCCESS != kr)
+    {
+        NSLog(@"mach_msg failed - %s", mach_error_string(kr));
+        return NO;
+    }
+
+    return YES;
+}
+
+//
+// NOTE: called on the dequeue loop in ring order, so path sent by the driver is
+//       cached before any request omitting it is resolved. Returns NO for
+//       invalidation records which are not passed to resolver threads
+//
+- (BOOL)updatePathCacheWithRecord:(const void *)record size:(uint32_t)size
+{
+    FSGuardRequest request = {};
+    if (!FSGuardDecodeRequest(record, size, request) || !(request.flags & kFGRecordFlagIdentity))
+    {
+        return YES;
+    }
+
+    const bool invalidation = request.flags & kFGRecordFlagInvalidation;
+
+    os_unfair_lock_lock(&_pathCacheLock);
+
+    if (!invalidation)
+    {
+        if (!(request.flags & kFGRecordFlagPathOmitted))
+        {
+            _pathCache.insert(request.identity, request.filePath, request.filePathLength);
+        }
+    }
+    else if (request.flags & kFGRecordFlagDirectory)
+    {
+        _pathCache.erase(request.identity);
+        _pathCache.eraseSubtree(request.filePath, request.filePathLength);
+    }
+    else
+    {
+        _pathCache.erase(request.identity);
+    }
+
+    os_unfair_lock_unlock(&_pathCacheLock);
+
+    return !invalidation;
+}
+
+//
+// NOTE: called on resolver thread, record is valid until the method returns
+//
+- (void)handleRequestRecord:(const void *)record size:(uint32_t)size dequeueTime:(uint64_t)dequeueTime
+{
+    FSGuardRequest request = {};
+    if (!FSGuardDecodeRequest(record, size, request))
+    {
+        NSLog(@"Invalid request record");
+        if (size >= sizeof(FSGuardRequestRecord))
+        {
+            const FSGuardRequestRecord *header = static_cast<const FSGuardRequestRecord *>(record);
+            [self sendFSGuardResponse:YES forRequset:header->rid];
+        }
+
+        return;
+    }
+
+    if (request.timestamp)
+    {
+        const uint64_t publishTime = GetUptimeNanoseconds(request.timestamp);
+
+        _statistics.record(GetStatisticsShard(), FSGuardStatisticsStage::QueueResidency,
+                           dequeueTime > publishTime ? dequeueTime - publishTime : 0);
+    }
+
+    _statistics.increment(GetStatisticsShard(), FSGuardStatisticsCounter::Requests);
+
+    //
+    // NOTE: the driver applies the default verdict at the deadline and ignores late
+    //       response, request which can not be resolved before it is not worth the
+    //       delegate time. The driver is told at once, so the access and requests
+    //       coalesced with it do not wait for the deadline
+    //
+    const uint64_t startTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    if (_resolutionEstimate.isExpired(startTime, GetUptimeNanoseconds(request.timestamp), GetUptimeNanoseconds(request.deadline)))
+    {
+        _statistics.increment(GetStatisticsShard(), FSGuardStatisticsCounter::Expired);
+
+        FSGuardResponse response = {};
+        response.rid = request.rid;
+        response.allow = true;
+        response.expired = true;
+
+        [self postFSGuardResponse:response];
+        return;
+    }
+
+    void* rid = request.rid;
+
+    //
+    // NOTE: path evicted from the cache is asked from the driver,
+    //       which sends the request again with path
+    //
+    std::string cachedPath;
+    if (request.flags & kFGRecordFlagPathOmitted)
+    {
+        os_unfair_lock_lock(&_pathCacheLock);
+        const bool found = _pathCache.lookup(request.identity, cachedPath);
+        os_unfair_lock_unlock(&_pathCacheLock);
+
+        if (!found)
+        {
+            _statistics.increment(GetStatisticsShard(), FSGuardStatisticsCounter::PathsRequested);
+
+            FSGuardResponse response = {};
+            response.rid = rid;
+            response.needPath = true;
+
+            [self postFSGuardResponse:response];
+            return;
+        }
+
+        request.filePath = cachedPath.c_str();
+        request.filePathLength = static_cast<uint32_t>(cachedPath.size());
+    }
+
+    //
+    // NOTE: native resolver completes without block, message or allocation per request
+    //
+    if (_resolver)
+    {
+        [self resolveRequest:request withResolver:_resolver dequeueTime:dequeueTime startTime:startTime];
+        return;
+    }
+
+    void (^completion)(BOOL) = ^(BOOL allow) {
+        [self recordVerdict:allow dequeueTime:dequeueTime startTime:startTime];
+        [self sendFSGuardResponse:allow forRequset:rid];
+    };
+
+    //
+    // NOTE: request is copied for the trace only while it is recorded
+    //
+    if (_tracing.load(std::memory_order_relaxed))
+    {
+        const std::string path(request.filePath, request.filePathLength);
+        const pid_t pid = request.pid;
+        const FSGuardAction action = request.action;
+
+        completion = ^(BOOL allow) {
+            [self recordVerdict:allow dequeueTime:dequeueTime startTime:startTime];
+            [self traceRequestWithPath:path pid:pid action:action allow:allow dequeueTime:dequeueTime];
+            [self sendFSGuardResponse:allow forRequset:rid];
+        };
+    }
+
+    id<FSGuardClientDelegate> const delegate = self.delegate;
+    if (delegate)
+    {
+        [delegate resolveRequest:&request withCompletion:completion];
+    }
+    else
+    {
+        completion(YES);
+    }
+}
+
+- (void)resolveRequest:(const FSGuardRequest &)request
+          withResolver:(FSGuardResolver *)resolver
+           dequeueTime:(uint64_t)dequeueTime
+             startTime:(uint64_t)startTime
+{
+    //
+    // NOTE: completion may run after start returned, see resolver property
+    //
+    __unsafe_unretained FSGuardClient *const client = self;
+    void *const rid = request.rid;
+
+    FSGuardResolverTrace *trace = nullptr;
+    if (_tracing.load(std::memory_order_relaxed))
+    {
+        trace = new FSGuardResolverTrace { std::string(request.filePath, request.filePathLength), request.pid, request.action };
+    }
+
+    resolver->resolve(request, *_resolverExecutor).start([client, rid, dequeueTime, startTime, trace](bool allow) {
+        @autoreleasepool
+        {
+            [client recordVerdict:allow dequeueTime:dequeueTime startTime:startTime];
+
+            if (trace)
+            {
+                [client traceRequestWithPath:trace->path pid:trace->pid action:trace->action allow:allow dequeueTime:dequeueTime];
+                delete trace;
+            }
+
+            [client sendFSGuardResponse:allow forRequset:rid];
+        }
+    });
+}
+
+- (BOOL)startTraceAtPath:(NSString *)path
+{
+    if (!_traceWriter.open(path.fileSystemRepresentation))
+    {
+        NSLog(@"Failed to open trace file %@", path);
+        return NO;
+    }
+
+    _traceStartTime = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    _tracing = true;
+
+    return YES;
+}
+
+- (void)stopTrace
+{
+    _tracing = false;
+
+    //
+    // NOTE: requests answered after this point are not recorded
+    //
+    _traceWriter.close();
+}
+
+- (void)traceRequestWithPath:(const std::string &)path
+                         pid:(pid_t)pid
+                      action:(FSGuardAction)action
+                       allow:(BOOL)allow
+                 dequeueTime:(uint64_t)dequeueTime
+{
+    const uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+    const uint64_t timestamp = dequeueTime > _traceStartTime ? dequeueTime - _traceStartTime : 0;
+
+    _traceWriter.write(timestamp, now - dequeueTime, pid, action,
+                       allow ? FSGuardTraceVerdict::Allow : FSGuardTraceVerdict::Deny,
+                       path.data(), static_cast<uint32_t>(path.size()));
+}
+
+//
+// NOTE: start time is when resolver thread took the request
+//
+- (void)recordVerdict:(BOOL)allow dequeueTime:(uint64_t)dequeueTime startTime:(uint64_t)startTime
+{
+    const uint32_t shard = GetStatisticsShard();
+    const uint64_t now = clock_gettime_nsec_np(CLOCK_UPTIME_RAW);
+
+    _resolutionEstimate.sample(now > startTime ? now - startTime : 0);
+
+    _statistics.record(shard, FSGuardStatisticsStage::Resolution, now > dequeueTime ? now - dequeueTime : 0);
+    _statistics.increment(shard, allow ? FSGuardStatisticsCounter::Allowed : FSGuardStatisticsCounter::Denied);
+}
+
+- (BOOL)getDriverStatistics:(FSGuardStatistics *)statistics
+{
+    //
+    // NOTE: structure is larger than inline limit, kernel writes it through memory descriptor
+    //
+    size_t size = sizeof(FSGuardStatistics);
+
+    kern_return_t kr = IOConnectCallStructMethod(self.connection,
+                                                 static_cast<uint32_t>(FSGuardMethod::GetStatistics),
+                                                 nullptr, 0, statistics, &size);
+
+    if (KERN_SUCCESS != kr)
+    {
+        NSLog(@"IOConnectCallStructMethod failed -- %016x -- %s", kr, mach_error_string(kr));
+        return NO;
+    }
+
+    return YES;
+}
+
+- (void)getClientStatistics:(FSGuardStatistics *)statistics
+{
+    _statistics.snapshot(*statistics);
+}
+
+- (BOOL)flushVerdictCache
+{
+    kern_return_t kr = IOConnectCallScalarMethod(self.connection,
+                                                 static_cast<uint32_t>(FSGuardMethod::FlushVerdictCache),
+                                                 nullptr, 0, nullptr, nullptr);
+
+    if (KERN_SUCCESS != kr)
+    {
+        NSLog(@"IOConnectCallScalarMethod failed -- %016x -- %s", kr, mach_error_string(kr));
+        return NO;
+    }
+
+    return YES;
+}
+
+- (BOOL)setSubscriptionMask:(uint32_t)mask
+{
+    const uint64_t input = mask;
+
+    kern_return_t kr = IOConnectCallScalarMethod(self.connection,
+                                                 static_cast<uint32_t>(FSGuardMethod::SetSubscriptionMask),
+                                                 &input, 1, nullptr, nullptr);
+
+    if (KERN_SUCCESS != kr)
+    {
+        NSLog(@"IOConnectCallScalarMethod failed -- %016x -- %s", kr, mach_error_string(kr));
+        return NO;
+    }
+
+    return YES;
+}
+
+- (BOOL)loadPolicy:(NSData *)policy
+{
+    //
+    // NOTE: driver takes large structure input through memory descriptor
+    //
+    kern_return_t kr = IOConnectCallStructMethod(self.connection,
+                                                 static_cast<uint32_t>(FSGuardMethod::LoadPolicy),
+                                                 policy.bytes, policy.length, nullptr, nullptr);
+
+    if (KERN_SUCCESS != kr)
+    {
+        NSLog(@"IOConnectCallStructMethod failed -- %016x -- %s", kr, mach_error_string(kr));
+        return NO;
+    }
+
+    return YES;
+}
+
+- (BOOL)setOverloadPolicy:(const FSGuardOverloadPolicy *)policy
+{
+    kern_return_t kr = IOConnectCallStructMethod(self.connection,
+                                                 static_cast<uint32_t>(FSGuardMethod::SetOverloadPolicy),
+                                                 policy, sizeof(FSGuardOverloadPolicy), nullptr, nullptr);
+
+    if (KERN_SUCCESS != kr)
+    {
+        NSLog(@"IOConnectCallStructMethod failed -- %016x -- %s", kr, mach_error_string(kr));
+        return NO;
+    }
+
+    return YES;
+}
+
+- (BOOL)setTrustedProcesses:(const FSGuardTrustedProcess *)processes count:(NSUInteger)count
+{
+    if (count > kFGMaxTrustedProcesses)
+    {
+        return NO;
+    }
+
+    kern_return_t kr = IOConnectCallStructMethod(self.connection,
+                                                 static_cast<uint32_t>(FSGuardMethod::SetTrustedProcesses),
+                                                 processes, count * sizeof(FSGuardTrustedProcess), nullptr, nullptr);
+
+    if (KERN_SUCCESS != kr)
+    {
+        NSLog(@"IOConnectCallStructMethod failed -- %016x -- %s", kr, mach_error_string(kr));
+        return NO;
+    }
+
+    return YES;
+}
+
+- (BOOL)setWatchedMounts:(NSArray<NSString *> *)mounts roots:(NSArray<NSString *> *)roots
+{
+    if (mounts.count > kFGMaxWatchedMounts || roots.count > kFGMaxWatchedRoots)
+    {
+        return NO;
+    }
+
+    //
+    // NOTE: the driver identifies mounts the same way, see GetFileSystemId
+    //
+    auto fileSystemId = [](const fsid_t &fsid) {
+        return static_cast<uint64_t>(static_cast<uint32_t>(fsid.val[0])) << 32 | static_cast<uint32_t>(fsid.val[1]);
+    };
+
+    FSGuardWatchScope *scope = static_cast<FSGuardWatchScope *>(calloc(1, sizeof(FSGuardWatchScope)));
+    if (!scope)
+    {
+        return NO;
+    }
+
+    BOOL result = YES;
+
+    for (NSString *mount in mounts)
+    {
+        struct statfs status = {};
+        if (0 != statfs(mount.fileSystemRepresentation, &status))
+        {
+            NSLog(@"statfs failed for %@ -- %s", mount, strerror(errno));
+            result = NO;
+            break;
+        }
+
+        scope->mounts[scope->mountCount++] = fileSystemId(status.f_fsid);
+    }
+
+    for (NSString *root in result ? roots : @[])
+    {
+        struct statfs fileSystem = {};
+        struct stat status = {};
+        if (0 != statfs(root.fileSystemRepresentation, &fileSystem) || 0 != stat(root.fileSystemRepresentation, &status))
+        {
+            NSLog(@"stat failed for %@ -- %s", root, strerror(errno));
+            result = NO;
+            break;
+        }
+
+        FSGuardFileIdentity &identity = scope->roots[scope->rootCount++];
+        identity.fsid = fileSystemId(fileSystem.f_fsid);
+        identity.fileid = status.st_ino;
+    }
+
+    if (result)
+    {
+        const bool empty = 0 == scope->mountCount && 0 == scope->rootCount;
+
+        kern_return_t kr = IOConnectCallStructMethod(self.connection,
+                                                     static_cast<uint32_t>(FSGuardMethod::SetWatchScope),
+                                                     empty ? nullptr : scope, empty ? 0 : sizeof(FSGuardWatchScope),
+                                                     nullptr, nullptr);
+
+        if (KERN_SUCCESS != kr)
+        {
+            NSLog(@"IOConnectCallStructMethod failed -- %016x -- %s", kr, mach_error_string(kr));
+            result = NO;
+        }
+    }
+
+    free(scope);
+
+    return result;
 }
 
 - (void)sendFSGuardResponse:(BOOL)allow forRequset:(void *)rid
 {
-    FSGuardResponse response;
+    FSGuardResponse response = {};
     response.rid = rid;
     response.allow = allow;
 
+    [self postFSGuardResponse:response];
+}
+
+- (void)postFSGuardResponse:(const FSGuardResponse &)response
+{
+    if ([self postCompletion:response])
+    {
+        return;
+    }
+
     kern_return_t kr = IOConnectCallStructMethod(self.connection,
                                                  static_cast<uint32_t>(FSGuardMethod::PostFSGuardResponse),
                                                  &response, sizeof(FSGuardResponse), nullptr, nullptr);
@@ -211,4 +981,51 @@
     }
 }
 
+- (BOOL)postCompletion:(const FSGuardResponse &)response
+{
+    os_unfair_lock_lock(&_completionRingLock);
+    const bool posted = _completionRing.isAttached() && _completionRing.push(response);
+    os_unfair_lock_unlock(&_completionRingLock);
+
+    if (!posted)
+    {
+        return NO;
+    }
+
+    //
+    // NOTE: only one thread rings the doorbell at a time, responses posted meanwhile
+    //       are drained by the same call or by the recheck after it
+    //
+    if (_doorbellPending.exchange(true))
+    {
+        return YES;
+    }
+
+    do
+    {
+        kern_return_t kr = IOConnectCallScalarMethod(self.connection,
+                                                     static_cast<uint32_t>(FSGuardMethod::DrainFSGuardResponses),
+                                                     nullptr, 0, nullptr, nullptr);
+
+        _doorbellPending = false;
+
+        if (KERN_SUCCESS != kr)
+        {
+            NSLog(@"IOConnectCallScalarMethod failed -- %016x -- %s", kr, mach_error_string(kr));
+            break;
+        }
+    } while (![self isCompletionRingEmpty] && !_doorbellPending.exchange(true));
+
+    return YES;
+}
+
+- (BOOL)isCompletionRingEmpty
+{
+    os_unfair_lock_lock(&_completionRingLock);
+    const bool empty = !_completionRing.isAttached() || _completionRing.empty();
+    os_unfair_lock_unlock(&_completionRingLock);
+
+    return empty;
+}
+
 @end
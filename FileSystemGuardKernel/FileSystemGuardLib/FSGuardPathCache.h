@@ -0,0 +1,297 @@
+//
+//  FSGuardPathCache.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardPathCache_h
+#define FSGuardPathCache_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "FSGuardUserClientInterface.h"
+
+//
+// NOTE: the driver remembers fewer identities, so omitted path is rarely missing
+//
+constexpr uint32_t kFGPathCacheCapacity = 16384;
+
+//
+// NOTE: paths of files the driver sent once, so it may omit them later.
+//
+//       Least recently used entry is evicted when the cache is full. Entries and
+//       the open addressing table are allocated once, LRU list is linked by indices.
+//       Entry of another generation of the same file is never returned.
+//
+//       Not thread safe, callers serialize access.
+//
+class FSGuardPathCache
+{
+public:
+    explicit FSGuardPathCache(uint32_t capacity = kFGPathCacheCapacity)
+        : m_entries(capacity ? capacity : 1)
+        , m_table(TableSize(static_cast<uint32_t>(m_entries.size())), kInvalidIndex)
+    {
+        clear();
+    }
+
+    uint32_t capacity() const
+    {
+        return static_cast<uint32_t>(m_entries.size());
+    }
+
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    void insert(const FSGuardFileIdentity &identity, const char *path, size_t pathLength)
+    {
+        uint32_t index = find(identity);
+
+        if (kInvalidIndex == index)
+        {
+            if (m_size == capacity())
+            {
+                remove(m_tail);
+            }
+
+            index = m_free;
+            m_free = m_entries[index].next;
+
+            Entry &entry = m_entries[index];
+            entry.fsid = identity.fsid;
+            entry.fileid = identity.fileid;
+
+            m_table[emptySlot(identity)] = index;
+            ++m_size;
+        }
+        else
+        {
+            unlink(index);
+        }
+
+        Entry &entry = m_entries[index];
+        entry.generation = identity.generation;
+        entry.path.assign(path, pathLength);
+
+        pushFront(index);
+    }
+
+    bool lookup(const FSGuardFileIdentity &identity, std::string &path)
+    {
+        const uint32_t index = find(identity);
+        if (kInvalidIndex == index || m_entries[index].generation != identity.generation)
+        {
+            return false;
+        }
+
+        unlink(index);
+        pushFront(index);
+
+        path = m_entries[index].path;
+
+        return true;
+    }
+
+    //
+    // NOTE: any generation of the file is removed
+    //
+    void erase(const FSGuardFileIdentity &identity)
+    {
+        const uint32_t index = find(identity);
+        if (kInvalidIndex != index)
+        {
+            remove(index);
+        }
+    }
+
+    //
+    // NOTE: removes the path itself and every path below it, linear in the cache size
+    //
+    void eraseSubtree(const char *path, size_t pathLength)
+    {
+        while (pathLength > 1 && '/' == path[pathLength - 1])
+        {
+            --pathLength;
+        }
+
+        uint32_t index = m_head;
+        while (kInvalidIndex != index)
+        {
+            const Entry &entry = m_entries[index];
+            const uint32_t next = entry.next;
+
+            if (entry.path.size() >= pathLength &&
+                0 == entry.path.compare(0, pathLength, path, pathLength) &&
+                (entry.path.size() == pathLength || '/' == entry.path[pathLength] || '/' == path[pathLength - 1]))
+            {
+                remove(index);
+            }
+
+            index = next;
+        }
+    }
+
+    void clear()
+    {
+        for (uint32_t index = 0; index < capacity(); ++index)
+        {
+            m_entries[index].path.clear();
+            m_entries[index].path.shrink_to_fit();
+            m_entries[index].next = index + 1 < capacity() ? index + 1 : kInvalidIndex;
+        }
+
+        std::fill(m_table.begin(), m_table.end(), kInvalidIndex);
+
+        m_head = kInvalidIndex;
+        m_tail = kInvalidIndex;
+        m_free = 0;
+        m_size = 0;
+    }
+
+private:
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    struct Entry
+    {
+        uint64_t    fsid = 0;
+        uint64_t    fileid = 0;
+        uint32_t    generation = 0;
+        uint32_t    prev = kInvalidIndex;
+        uint32_t    next = kInvalidIndex;
+        std::string path;
+    };
+
+    //
+    // NOTE: power of two at least twice the capacity, so probe sequences stay short
+    //
+    static uint32_t TableSize(uint32_t capacity)
+    {
+        uint32_t size = 2;
+        while (size < capacity * 2)
+        {
+            size <<= 1;
+        }
+
+        return size;
+    }
+
+    uint32_t slotForIdentity(const FSGuardFileIdentity &identity) const
+    {
+        uint64_t hash = identity.fsid * 0x9E3779B97F4A7C15ull ^ identity.fileid;
+
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+
+        return static_cast<uint32_t>(hash) & (static_cast<uint32_t>(m_table.size()) - 1);
+    }
+
+    uint32_t find(const FSGuardFileIdentity &identity) const
+    {
+        const uint32_t mask = static_cast<uint32_t>(m_table.size()) - 1;
+
+        for (uint32_t slot = slotForIdentity(identity); kInvalidIndex != m_table[slot]; slot = (slot + 1) & mask)
+        {
+            const Entry &entry = m_entries[m_table[slot]];
+            if (entry.fsid == identity.fsid && entry.fileid == identity.fileid)
+            {
+                return m_table[slot];
+            }
+        }
+
+        return kInvalidIndex;
+    }
+
+    uint32_t emptySlot(const FSGuardFileIdentity &identity) const
+    {
+        const uint32_t mask = static_cast<uint32_t>(m_table.size()) - 1;
+
+        uint32_t slot = slotForIdentity(identity);
+        while (kInvalidIndex != m_table[slot])
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        return slot;
+    }
+
+    void unlink(uint32_t index)
+    {
+        Entry &entry = m_entries[index];
+
+        (kInvalidIndex != entry.prev ? m_entries[entry.prev].next : m_head) = entry.next;
+        (kInvalidIndex != entry.next ? m_entries[entry.next].prev : m_tail) = entry.prev;
+    }
+
+    void pushFront(uint32_t index)
+    {
+        Entry &entry = m_entries[index];
+
+        entry.prev = kInvalidIndex;
+        entry.next = m_head;
+
+        (kInvalidIndex != m_head ? m_entries[m_head].prev : m_tail) = index;
+        m_head = index;
+    }
+
+    void remove(uint32_t index)
+    {
+        Entry &entry = m_entries[index];
+        const FSGuardFileIdentity identity = { entry.fsid, entry.fileid, entry.generation };
+
+        //
+        // NOTE: backward shift deletion keeps probe sequences without tombstones
+        //
+        const uint32_t mask = static_cast<uint32_t>(m_table.size()) - 1;
+
+        uint32_t slot = slotForIdentity(identity);
+        while (index != m_table[slot])
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        for (uint32_t next = (slot + 1) & mask; kInvalidIndex != m_table[next]; next = (next + 1) & mask)
+        {
+            const Entry &moved = m_entries[m_table[next]];
+            const uint32_t home = slotForIdentity({ moved.fsid, moved.fileid, moved.generation });
+
+            //
+            // NOTE: entry may move to the hole only if its home slot is not between the hole and it
+            //
+            if (((next - home) & mask) >= ((next - slot) & mask))
+            {
+                m_table[slot] = m_table[next];
+                slot = next;
+            }
+        }
+
+        m_table[slot] = kInvalidIndex;
+
+        unlink(index);
+
+        entry.path.clear();
+        entry.next = m_free;
+        m_free = index;
+        --m_size;
+    }
+
+private:
+    std::vector<Entry>    m_entries;
+    std::vector<uint32_t> m_table;
+    uint32_t              m_head = kInvalidIndex;
+    uint32_t              m_tail = kInvalidIndex;
+    uint32_t              m_free = 0;
+    uint32_t              m_size = 0;
+
+};
+
+#endif /* FSGuardPathCache_h */
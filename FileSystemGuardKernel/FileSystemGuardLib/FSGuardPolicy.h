@@ -0,0 +1,303 @@
+//
+//  FSGuardPolicy.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardPolicy_h
+#define FSGuardPolicy_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "FSGuardUserClientInterface.h"
+
+//
+// NOTE: compiled path policy, built in user space by FSGuardPolicyBuilder and
+//       evaluated in place both by the driver and by user space.
+//
+//       Layout: FSGuardPolicyHeader, ruleCount of FSGuardPolicyRule sorted by path,
+//       string table with rule paths. Paths are absolute, without trailing slash
+//       except the root and are matched by whole components with the longest rule winning.
+//
+constexpr uint32_t kFGPolicyMagic = 0x4C504746; // 'FGPL'
+constexpr uint16_t kFGPolicyVersion = 1;
+
+//
+// NOTE: policy larger than this is rejected by the driver
+//
+constexpr uint32_t kFGMaxPolicySize = 32 * 1024 * 1024;
+
+struct FSGuardPolicyHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t ruleSize;
+    uint32_t ruleCount;
+    uint32_t stringsSize;
+    uint32_t reserved;
+};
+
+//
+// NOTE: action is denied if its bit is in denyMask, allowed if it is in allowMask,
+//       otherwise rule asks user space for the verdict
+//
+struct FSGuardPolicyRule
+{
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    uint32_t allowMask;
+    uint32_t denyMask;
+};
+
+enum class FSGuardPolicyVerdict
+{
+    NoMatch,
+    Allow,
+    Deny,
+    Ask
+};
+
+class FSGuardPolicy
+{
+public:
+    //
+    // NOTE: validates untrusted blob, it should stay alive while policy is used
+    //
+    bool load(const void *blob, size_t size)
+    {
+        m_rules = nullptr;
+        m_strings = nullptr;
+        m_ruleCount = 0;
+        m_actionMask = 0;
+
+        if (!blob || size < sizeof(FSGuardPolicyHeader))
+        {
+            return false;
+        }
+
+        FSGuardPolicyHeader header;
+        memcpy(&header, blob, sizeof(header));
+
+        if (kFGPolicyMagic != header.magic ||
+            kFGPolicyVersion != header.version ||
+            header.headerSize < sizeof(FSGuardPolicyHeader) ||
+            header.headerSize % alignof(FSGuardPolicyRule) ||
+            header.ruleSize != sizeof(FSGuardPolicyRule) ||
+            header.headerSize > size)
+        {
+            return false;
+        }
+
+        const size_t available = size - header.headerSize;
+        if (header.ruleCount > available / sizeof(FSGuardPolicyRule) ||
+            header.stringsSize != available - header.ruleCount * sizeof(FSGuardPolicyRule))
+        {
+            return false;
+        }
+
+        const uint8_t *bytes = static_cast<const uint8_t *>(blob);
+        if (reinterpret_cast<uintptr_t>(bytes) % alignof(FSGuardPolicyRule))
+        {
+            return false;
+        }
+
+        const FSGuardPolicyRule *rules = reinterpret_cast<const FSGuardPolicyRule *>(bytes + header.headerSize);
+        const char *strings = reinterpret_cast<const char *>(rules + header.ruleCount);
+
+        uint32_t actionMask = 0;
+        for (uint32_t index = 0; index < header.ruleCount; ++index)
+        {
+            const FSGuardPolicyRule &rule = rules[index];
+
+            if (rule.pathOffset > header.stringsSize ||
+                rule.pathLength > header.stringsSize - rule.pathOffset ||
+                !isNormalized(strings + rule.pathOffset, rule.pathLength))
+            {
+                return false;
+            }
+
+            //
+            // NOTE: binary search requires strictly ascending unique paths
+            //
+            if (index && compare(strings + rules[index - 1].pathOffset, rules[index - 1].pathLength,
+                                 strings + rule.pathOffset, rule.pathLength) >= 0)
+            {
+                return false;
+            }
+
+            actionMask |= (rule.allowMask | rule.denyMask) & kFGActionMaskAll;
+        }
+
+        m_rules = rules;
+        m_strings = strings;
+        m_ruleCount = header.ruleCount;
+        m_actionMask = actionMask;
+
+        return true;
+    }
+
+    bool isLoaded() const
+    {
+        return nullptr != m_rules;
+    }
+
+    uint32_t ruleCount() const
+    {
+        return m_ruleCount;
+    }
+
+    //
+    // NOTE: actions some rule decides without asking user space
+    //
+    uint32_t actionMask() const
+    {
+        return m_actionMask;
+    }
+
+    //
+    // NOTE: returns the most specific rule covering the path, null if none
+    //
+    const FSGuardPolicyRule * match(const char *path, uint32_t length) const
+    {
+        if (!m_ruleCount || !length || '/' != path[0])
+        {
+            return nullptr;
+        }
+
+        //
+        // NOTE: trailing slash does not make path different
+        //
+        while (length > 1 && '/' == path[length - 1])
+        {
+            --length;
+        }
+
+        for (;;)
+        {
+            const FSGuardPolicyRule *rule = find(path, length);
+            if (rule)
+            {
+                return rule;
+            }
+
+            if (1 == length)
+            {
+                return nullptr;
+            }
+
+            //
+            // NOTE: strip the last component, root is the last candidate
+            //
+            do
+            {
+                --length;
+            } while (length > 1 && '/' != path[length]);
+        }
+    }
+
+    FSGuardPolicyVerdict evaluate(const char *path, uint32_t length, FSGuardAction action) const
+    {
+        const FSGuardPolicyRule *rule = match(path, length);
+        if (!rule)
+        {
+            return FSGuardPolicyVerdict::NoMatch;
+        }
+
+        return verdict(*rule, action);
+    }
+
+    static FSGuardPolicyVerdict verdict(const FSGuardPolicyRule &rule, FSGuardAction action)
+    {
+        const uint32_t mask = FSGuardActionMask(action);
+
+        if (rule.denyMask & mask)
+        {
+            return FSGuardPolicyVerdict::Deny;
+        }
+
+        if (rule.allowMask & mask)
+        {
+            return FSGuardPolicyVerdict::Allow;
+        }
+
+        return FSGuardPolicyVerdict::Ask;
+    }
+
+    static int compare(const char *lhs, uint32_t lhsLength, const char *rhs, uint32_t rhsLength)
+    {
+        const int result = memcmp(lhs, rhs, lhsLength < rhsLength ? lhsLength : rhsLength);
+        if (result)
+        {
+            return result;
+        }
+
+        return lhsLength < rhsLength ? -1 : (lhsLength > rhsLength ? 1 : 0);
+    }
+
+    static bool isNormalized(const char *path, uint32_t length)
+    {
+        if (!length || '/' != path[0])
+        {
+            return false;
+        }
+
+        if (length > 1 && '/' == path[length - 1])
+        {
+            return false;
+        }
+
+        for (uint32_t index = 1; index < length; ++index)
+        {
+            if ('\0' == path[index] || ('/' == path[index] && '/' == path[index - 1]))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    const FSGuardPolicyRule * find(const char *path, uint32_t length) const
+    {
+        uint32_t low = 0;
+        uint32_t high = m_ruleCount;
+
+        while (low < high)
+        {
+            const uint32_t middle = low + (high - low) / 2;
+            const FSGuardPolicyRule &rule = m_rules[middle];
+
+            const int result = compare(m_strings + rule.pathOffset, rule.pathLength, path, length);
+            if (0 == result)
+            {
+                return &rule;
+            }
+
+            if (result < 0)
+            {
+                low = middle + 1;
+            }
+            else
+            {
+                high = middle;
+            }
+        }
+
+        return nullptr;
+    }
+
+private:
+    const FSGuardPolicyRule *m_rules = nullptr;
+    const char              *m_strings = nullptr;
+    uint32_t                 m_ruleCount = 0;
+    uint32_t                 m_actionMask = 0;
+
+};
+
+#endif /* FSGuardPolicy_h */
@@ -0,0 +1,146 @@
+//
+//  FSGuardPolicyBuilder.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardPolicyBuilder_h
+#define FSGuardPolicyBuilder_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FSGuardPolicy.h"
+
+//
+// NOTE: user space compiler of FSGuardPolicy blob
+//
+class FSGuardPolicyBuilder
+{
+public:
+    //
+    // NOTE: rule for the same path replaces previous one,
+    //       actions present in neither mask are asked from user space
+    //
+    bool addRule(const std::string &path, uint32_t allowMask, uint32_t denyMask)
+    {
+        std::string normalized;
+        if (!normalize(path, normalized))
+        {
+            return false;
+        }
+
+        m_rules[normalized] = Masks { allowMask & kFGActionMaskAll, denyMask & kFGActionMaskAll };
+
+        return true;
+    }
+
+    bool removeRule(const std::string &path)
+    {
+        std::string normalized;
+        if (!normalize(path, normalized))
+        {
+            return false;
+        }
+
+        return 0 != m_rules.erase(normalized);
+    }
+
+    void clear()
+    {
+        m_rules.clear();
+    }
+
+    size_t ruleCount() const
+    {
+        return m_rules.size();
+    }
+
+    std::vector<uint8_t> build() const
+    {
+        size_t stringsSize = 0;
+        for (const auto &rule : m_rules)
+        {
+            stringsSize += rule.first.size();
+        }
+
+        const size_t rulesSize = m_rules.size() * sizeof(FSGuardPolicyRule);
+        std::vector<uint8_t> blob(sizeof(FSGuardPolicyHeader) + rulesSize + stringsSize);
+
+        FSGuardPolicyHeader header {};
+        header.magic = kFGPolicyMagic;
+        header.version = kFGPolicyVersion;
+        header.headerSize = sizeof(FSGuardPolicyHeader);
+        header.ruleSize = sizeof(FSGuardPolicyRule);
+        header.ruleCount = static_cast<uint32_t>(m_rules.size());
+        header.stringsSize = static_cast<uint32_t>(stringsSize);
+        memcpy(blob.data(), &header, sizeof(header));
+
+        //
+        // NOTE: std::map keeps paths in byte order expected by FSGuardPolicy
+        //
+        uint8_t *rules = blob.data() + sizeof(FSGuardPolicyHeader);
+        char *strings = reinterpret_cast<char *>(rules + rulesSize);
+        uint32_t offset = 0;
+
+        for (const auto &entry : m_rules)
+        {
+            FSGuardPolicyRule rule {};
+            rule.pathOffset = offset;
+            rule.pathLength = static_cast<uint32_t>(entry.first.size());
+            rule.allowMask = entry.second.allowMask;
+            rule.denyMask = entry.second.denyMask;
+
+            memcpy(rules, &rule, sizeof(rule));
+            memcpy(strings + offset, entry.first.data(), entry.first.size());
+
+            rules += sizeof(rule);
+            offset += rule.pathLength;
+        }
+
+        return blob;
+    }
+
+    static bool normalize(const std::string &path, std::string &normalized)
+    {
+        if (path.empty() || '/' != path[0] || std::string::npos != path.find('\0'))
+        {
+            return false;
+        }
+
+        normalized.clear();
+        normalized.reserve(path.size());
+
+        for (char character : path)
+        {
+            if ('/' == character && !normalized.empty() && '/' == normalized.back())
+            {
+                continue;
+            }
+
+            normalized.push_back(character);
+        }
+
+        if (normalized.size() > 1 && '/' == normalized.back())
+        {
+            normalized.pop_back();
+        }
+
+        return normalized.size() < PATH_MAX;
+    }
+
+private:
+    struct Masks
+    {
+        uint32_t allowMask;
+        uint32_t denyMask;
+    };
+
+    std::map<std::string, Masks> m_rules;
+
+};
+
+#endif /* FSGuardPolicyBuilder_h */
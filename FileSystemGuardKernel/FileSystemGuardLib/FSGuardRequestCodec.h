@@ -0,0 +1,172 @@
+//
+//  FSGuardRequestCodec.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardRequestCodec_h
+#define FSGuardRequestCodec_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "FSGuardUserClientInterface.h"
+
+//
+// NOTE: portable encoder/decoder of variable-length request records,
+//       used by the driver (encoder) and by the client (decoder)
+//
+
+constexpr uint32_t FSGuardRequestRecordSize(uint32_t pathLength)
+{
+    return (sizeof(FSGuardRequestRecord) + pathLength + 1 + kFGRequestRecordAlignment - 1) & ~(kFGRequestRecordAlignment - 1);
+}
+
+//
+// NOTE: size of the record with the longest path vn_getpath can return
+//
+constexpr uint32_t kFGMaxRequestRecordSize = FSGuardRequestRecordSize(PATH_MAX - 1);
+
+//
+// NOTE: finalizes record which path was already written in place right after the header,
+//       capacity is the size of the memory available for the whole record
+//
+inline bool FSGuardFinishRequestRecord(FSGuardRequestRecord &record, uint32_t pathLength, size_t capacity)
+{
+    const uint32_t size = FSGuardRequestRecordSize(pathLength);
+    if (size > capacity)
+    {
+        return false;
+    }
+
+    char *path = reinterpret_cast<char *>(&record) + sizeof(FSGuardRequestRecord);
+
+    //
+    // NOTE: zero terminator and padding, so no stale bytes leave the kernel
+    //
+    memset(path + pathLength, 0, size - sizeof(FSGuardRequestRecord) - pathLength);
+
+    record.version = kFGRequestRecordVersion;
+    record.headerSize = sizeof(FSGuardRequestRecord);
+    record.size = size;
+    record.pathLength = pathLength;
+
+    return true;
+}
+
+inline bool FSGuardEncodeRequest(const FSGuardRequest &request, void *buffer, size_t bufferSize, uint32_t &size)
+{
+    if (!buffer || bufferSize < sizeof(FSGuardRequestRecord) || !request.filePath ||
+        request.filePathLength > bufferSize - sizeof(FSGuardRequestRecord))
+    {
+        return false;
+    }
+
+    FSGuardRequestRecord *record = static_cast<FSGuardRequestRecord *>(buffer);
+
+    memset(record, 0, sizeof(FSGuardRequestRecord));
+    record->rid = request.rid;
+    record->pid = request.pid;
+    record->action = request.action;
+    record->flags = request.flags;
+    record->generation = request.identity.generation;
+    record->fsid = request.identity.fsid;
+    record->fileid = request.identity.fileid;
+    record->ppid = request.ppid;
+    record->uid = request.uid;
+    record->timestamp = request.timestamp;
+    record->deadline = request.deadline;
+
+    //
+    // NOTE: record is zeroed, so truncated name stays terminated
+    //
+    if (request.processName)
+    {
+        memcpy(record->processName, request.processName, strnlen(request.processName, sizeof(record->processName) - 1));
+    }
+
+    memcpy(record + 1, request.filePath, request.filePathLength);
+
+    if (!FSGuardFinishRequestRecord(*record, request.filePathLength, bufferSize))
+    {
+        return false;
+    }
+
+    size = record->size;
+
+    return true;
+}
+
+//
+// NOTE: validates untrusted record, on success request.filePath points into the buffer
+//
+inline bool FSGuardDecodeRequest(const void *buffer, size_t size, FSGuardRequest &request)
+{
+    if (!buffer || size < sizeof(FSGuardRequestRecord))
+    {
+        return false;
+    }
+
+    FSGuardRequestRecord record;
+    memcpy(&record, buffer, sizeof(FSGuardRequestRecord));
+
+    //
+    // NOTE: newer versions may only append header fields
+    //
+    if (record.version < kFGRequestRecordVersion ||
+        record.headerSize < sizeof(FSGuardRequestRecord) ||
+        record.size > size ||
+        record.headerSize > record.size ||
+        record.pathLength >= record.size - record.headerSize)
+    {
+        return false;
+    }
+
+    const char *path = static_cast<const char *>(buffer) + record.headerSize;
+    if ('\0' != path[record.pathLength])
+    {
+        return false;
+    }
+
+    const uint32_t action = static_cast<uint32_t>(record.action);
+    if (action >= kFGActionCount)
+    {
+        return false;
+    }
+
+    const char *processName = static_cast<const char *>(buffer) + offsetof(FSGuardRequestRecord, processName);
+    if (!memchr(processName, '\0', sizeof(record.processName)))
+    {
+        return false;
+    }
+
+    //
+    // NOTE: omitted path can be found only by identity
+    //
+    if ((record.flags & kFGRecordFlagPathOmitted) && !(record.flags & kFGRecordFlagIdentity))
+    {
+        return false;
+    }
+
+    request.rid = record.rid;
+    request.pid = record.pid;
+    request.action = record.action;
+    request.filePathLength = record.pathLength;
+    request.filePath = path;
+    request.flags = record.flags;
+    request.identity.fsid = record.fsid;
+    request.identity.fileid = record.fileid;
+    request.identity.generation = record.generation;
+    request.ppid = record.ppid;
+    request.uid = record.uid;
+    request.processName = processName;
+    request.timestamp = record.timestamp;
+    request.deadline = record.deadline;
+
+    return true;
+}
+
+#endif /* FSGuardRequestCodec_h */
@@ -0,0 +1,299 @@
+//
+//  FSGuardRequestRing.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardRequestRing_h
+#define FSGuardRequestRing_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+//
+// NOTE: multi-producer/single-consumer ring of variable-length records placed
+//       in memory shared between the driver (producers) and the client (consumer).
+//
+//       Producers reserve space with a single CAS on the private reservation cursor,
+//       copy the record and publish it by storing the slot sequence number, so no
+//       lock is taken to publish. Consumer reads slots in order and waits until the
+//       slot at its position carries sequence number of that position.
+//
+//       Each side keeps its cursor privately, consumer cursor read from shared memory
+//       is validated by producers because the peer may corrupt it. Slot published
+//       with invalid size stops the consumer, the ring is corrupted then.
+//
+//       Both sides announce waiting in the header, producer publishing a record and
+//       consumer freeing space take the announcement and notify the peer.
+//
+
+constexpr uint32_t kFGRequestRingAlignment = 16;
+
+struct FSGuardRequestRingHeader
+{
+    alignas(64) uint64_t consumed;
+    alignas(64) uint32_t consumerWaiting;
+    uint32_t producerWaiting;
+};
+
+struct FSGuardRequestRingSlot
+{
+    uint64_t sequence;
+    uint32_t size;
+    uint32_t flags;
+};
+
+constexpr uint32_t kFGRequestRingSlotPadding = 1;
+
+class FSGuardRequestRing
+{
+public:
+    static constexpr size_t memorySize(uint32_t capacity)
+    {
+        return sizeof(FSGuardRequestRingHeader) + capacity;
+    }
+
+    static constexpr uint32_t slotSize(uint32_t recordSize)
+    {
+        return (sizeof(FSGuardRequestRingSlot) + recordSize + kFGRequestRingAlignment - 1) & ~(kFGRequestRingAlignment - 1);
+    }
+
+    bool attach(void *memory, size_t size, uint32_t capacity)
+    {
+        if (!memory || capacity < kFGRequestRingAlignment || (capacity & (capacity - 1)) || size < memorySize(capacity))
+        {
+            return false;
+        }
+
+        m_header = static_cast<FSGuardRequestRingHeader *>(memory);
+        m_data = reinterpret_cast<uint8_t *>(m_header + 1);
+        m_capacity = capacity;
+        m_cursor = __atomic_load_n(&m_header->consumed, __ATOMIC_ACQUIRE);
+        m_corrupted = false;
+
+        return true;
+    }
+
+    void detach()
+    {
+        m_header = nullptr;
+        m_data = nullptr;
+    }
+
+    bool isAttached() const
+    {
+        return nullptr != m_header;
+    }
+
+    //
+    // NOTE: producer side, may be called concurrently
+    //
+    bool push(const void *record, uint32_t recordSize)
+    {
+        const uint32_t size = slotSize(recordSize);
+        if (recordSize > m_capacity || size > m_capacity)
+        {
+            return false;
+        }
+
+        uint64_t position = __atomic_load_n(&m_cursor, __ATOMIC_RELAXED);
+        uint32_t padding = 0;
+
+        for (;;)
+        {
+            const uint64_t consumed = __atomic_load_n(&m_header->consumed, __ATOMIC_ACQUIRE);
+            if (position - consumed > m_capacity)
+            {
+                //
+                // NOTE: consumer cursor is corrupted or stale, behave as full
+                //
+                return false;
+            }
+
+            //
+            // NOTE: record never wraps, tail of the ring is skipped by padding slot
+            //
+            const uint32_t contiguous = m_capacity - static_cast<uint32_t>(position & (m_capacity - 1));
+            padding = contiguous < size ? contiguous : 0;
+
+            if (position + padding + size - consumed > m_capacity)
+            {
+                return false;
+            }
+
+            if (__atomic_compare_exchange_n(&m_cursor, &position, position + padding + size,
+                                            true, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+
+        if (padding)
+        {
+            publish(position, padding, kFGRequestRingSlotPadding, nullptr, 0);
+            position += padding;
+        }
+
+        publish(position, size, 0, record, recordSize);
+
+        return true;
+    }
+
+    //
+    // NOTE: producer side, returns true if consumer asked to be notified
+    //       about this publication, the flag is consumed
+    //
+    bool takeConsumerWaiting()
+    {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (!__atomic_load_n(&m_header->consumerWaiting, __ATOMIC_RELAXED))
+        {
+            return false;
+        }
+
+        return 0 != __atomic_exchange_n(&m_header->consumerWaiting, 0, __ATOMIC_SEQ_CST);
+    }
+
+    //
+    // NOTE: producer side, called before waiting for free space, the caller tries
+    //       to push again after it, so space freed before the consumer saw
+    //       the announcement is not missed
+    //
+    void announceProducerWaiting()
+    {
+        __atomic_store_n(&m_header->producerWaiting, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    }
+
+    //
+    // NOTE: consumer side, returns true if a producer waits for the space
+    //       released by pop, the flag is consumed
+    //
+    bool takeProducerWaiting()
+    {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (!__atomic_load_n(&m_header->producerWaiting, __ATOMIC_RELAXED))
+        {
+            return false;
+        }
+
+        return 0 != __atomic_exchange_n(&m_header->producerWaiting, 0, __ATOMIC_SEQ_CST);
+    }
+
+    //
+    // NOTE: consumer side, visitor is called for the next published record
+    //       with pointer into the ring, record space is released after it returns.
+    //       Returns false if no record is published or the ring is corrupted
+    //
+    template <typename Visitor>
+    bool pop(Visitor visitor)
+    {
+        for (;;)
+        {
+            const FSGuardRequestRingSlot *slot = slotAt(m_cursor);
+            if (m_corrupted || __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != m_cursor + 1)
+            {
+                return false;
+            }
+
+            //
+            // NOTE: the slot can not be skipped without its size, no later record is readable
+            //
+            const uint32_t size = slot->size;
+            const uint32_t contiguous = m_capacity - static_cast<uint32_t>(m_cursor & (m_capacity - 1));
+            if (size < sizeof(FSGuardRequestRingSlot) || size > contiguous || (size & (kFGRequestRingAlignment - 1)))
+            {
+                m_corrupted = true;
+                return false;
+            }
+
+            const bool padding = 0 != (slot->flags & kFGRequestRingSlotPadding);
+            if (!padding)
+            {
+                visitor(static_cast<const void *>(slot + 1), size - static_cast<uint32_t>(sizeof(FSGuardRequestRingSlot)));
+            }
+
+            //
+            // NOTE: released space is zeroed, so stale bytes of previous lap
+            //       are never taken for sequence number of unpublished slot
+            //
+            memset(const_cast<FSGuardRequestRingSlot *>(slot), 0, size);
+
+            m_cursor += size;
+            __atomic_store_n(&m_header->consumed, m_cursor, __ATOMIC_RELEASE);
+
+            if (!padding)
+            {
+                return true;
+            }
+        }
+    }
+
+    bool isCorrupted() const
+    {
+        return m_corrupted;
+    }
+
+    bool empty() const
+    {
+        const FSGuardRequestRingSlot *slot = slotAt(m_cursor);
+        return __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != m_cursor + 1;
+    }
+
+    //
+    // NOTE: consumer side, returns true if it is safe to sleep until producer notification
+    //
+    bool prepareToWait()
+    {
+        __atomic_store_n(&m_header->consumerWaiting, 1, __ATOMIC_SEQ_CST);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if (!empty())
+        {
+            __atomic_store_n(&m_header->consumerWaiting, 0, __ATOMIC_RELAXED);
+            return false;
+        }
+
+        return true;
+    }
+
+private:
+    FSGuardRequestRingSlot * slotAt(uint64_t position) const
+    {
+        return reinterpret_cast<FSGuardRequestRingSlot *>(m_data + (position & (m_capacity - 1)));
+    }
+
+    void publish(uint64_t position, uint32_t size, uint32_t flags, const void *record, uint32_t recordSize)
+    {
+        FSGuardRequestRingSlot *slot = slotAt(position);
+
+        slot->size = size;
+        slot->flags = flags;
+
+        if (record)
+        {
+            memcpy(slot + 1, record, recordSize);
+        }
+
+        __atomic_store_n(&slot->sequence, position + 1, __ATOMIC_RELEASE);
+    }
+
+private:
+    FSGuardRequestRingHeader *m_header = nullptr;
+    uint8_t                  *m_data = nullptr;
+    uint32_t                  m_capacity = 0;
+
+    //
+    // NOTE: reservation cursor for producers, read cursor for consumer
+    //
+    uint64_t                  m_cursor = 0;
+    bool                      m_corrupted = false;
+
+};
+
+#endif /* FSGuardRequestRing_h */
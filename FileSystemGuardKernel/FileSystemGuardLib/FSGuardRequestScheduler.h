@@ -0,0 +1,366 @@
+//
+//  FSGuardRequestScheduler.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardRequestScheduler_h
+#define FSGuardRequestScheduler_h
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+#include "FSGuardUserClientInterface.h"
+
+//
+// NOTE: lanes are served in priority order, execution blocks process launch,
+//       modification blocks writer which usually holds the file open
+//
+enum class FSGuardRequestLane : uint32_t
+{
+    Execute,
+    Modify,
+    Read,
+
+    Count
+};
+
+constexpr uint32_t kFGRequestLaneCount = static_cast<uint32_t>(FSGuardRequestLane::Count);
+
+constexpr FSGuardRequestLane FSGuardRequestLaneForAction(FSGuardAction action)
+{
+    return FSGuardAction::Execute == action ? FSGuardRequestLane::Execute :
+           (FSGuardAction::Read == action || FSGuardAction::ReadMetadata == action) ? FSGuardRequestLane::Read :
+                                                                                      FSGuardRequestLane::Modify;
+}
+
+//
+// NOTE: requests a process may have resolved in a row while other processes wait
+//
+constexpr uint32_t kFGRequestSchedulerQuantum = 4;
+
+//
+// NOTE: requests of higher lanes served in a row while a lower lane waits,
+//       the lower lane is served next then. So every waiting lane gets at least
+//       one request in kFGRequestLaneAgingLimit + 1 and a flood of executions
+//       does not starve reads
+//
+constexpr uint32_t kFGRequestLaneAgingLimit = 8;
+
+//
+// NOTE: smoothed time from taking a request to its verdict, like smoothed latency of
+//       the driver overload controller. Verdict of the request taken later than its
+//       deadline minus the estimate comes after the driver stopped waiting, so such
+//       request is expired already. Estimate counts for at most half of the timeout,
+//       fresh requests are always resolved and keep sampling after slow verdicts.
+//
+//       Concurrent samples may overwrite each other, the estimate stays close enough.
+//
+class FSGuardResolutionEstimate
+{
+public:
+    void sample(uint64_t duration)
+    {
+        const uint64_t smoothed = m_smoothed.load(std::memory_order_relaxed);
+
+        m_smoothed.store(smoothed ? smoothed - smoothed / 8 + duration / 8 : duration, std::memory_order_relaxed);
+    }
+
+    //
+    // NOTE: times share the clock, zero deadline never expires
+    //
+    bool isExpired(uint64_t now, uint64_t timestamp, uint64_t deadline) const
+    {
+        if (0 == deadline)
+        {
+            return false;
+        }
+
+        const uint64_t timeout = deadline > timestamp ? deadline - timestamp : 0;
+        const uint64_t smoothed = m_smoothed.load(std::memory_order_relaxed);
+
+        return now + (smoothed < timeout / 2 ? smoothed : timeout / 2) >= deadline;
+    }
+
+private:
+    std::atomic<uint64_t> m_smoothed {0};
+
+};
+
+//
+// NOTE: portable scheduler of pending requests identified by index below capacity.
+//
+//       Every lane is deficit round robin over flows with unit request cost: a flow
+//       at the head of the active list gets kFGRequestSchedulerQuantum requests and
+//       goes to the tail, new flow starts at the tail. Flow of the request is picked
+//       by hash of its pid, processes sharing a flow share its turn. So a process
+//       flooding the client delays requests of another process by at most one
+//       quantum per active flow, instead of by its whole backlog.
+//
+//       This is not earliest deadline first scheduling. Deadline orders requests
+//       only within a flow, lanes and flows are picked without it, because the
+//       oldest backlog of a flooding process would always go first then. Driver
+//       deadlines grow with arrival, so the flow is FIFO in practice and the request
+//       is appended, a request with an earlier deadline is inserted before later
+//       ones. Zero deadline is the latest one. Requests which miss their deadline
+//       are dropped by the resolver, see FSGuardResolutionEstimate.
+//
+//       No allocation after reset, no locking, owner serializes access.
+//
+template <uint32_t FlowCount>
+class FSGuardRequestScheduler
+{
+    static_assert(FlowCount && 0 == (FlowCount & (FlowCount - 1)), "FlowCount must be power of two");
+
+public:
+    void reset(uint32_t capacity)
+    {
+        m_next.reset(new uint32_t[capacity]);
+        m_deadlines.reset(new uint64_t[capacity]);
+        m_size = 0;
+
+        for (Lane &lane : m_lanes)
+        {
+            lane.activeHead = kNullIndex;
+            lane.activeTail = kNullIndex;
+            lane.passed = 0;
+
+            for (Flow &flow : lane.flows)
+            {
+                flow = Flow {};
+            }
+        }
+    }
+
+    bool empty() const
+    {
+        return 0 == m_size;
+    }
+
+    uint32_t size() const
+    {
+        return m_size;
+    }
+
+    void push(uint32_t index, FSGuardRequestLane lane, pid_t pid, uint64_t deadline)
+    {
+        Lane &target = m_lanes[static_cast<uint32_t>(lane) % kFGRequestLaneCount];
+        const uint32_t flowIndex = flowForPid(pid);
+        Flow &flow = target.flows[flowIndex];
+
+        m_deadlines[index] = deadline ? deadline : UINT64_MAX;
+        insert(flow, index);
+        ++m_size;
+
+        if (!flow.active)
+        {
+            flow.active = true;
+            flow.deficit = 0;
+            appendActive(target, flowIndex);
+        }
+    }
+
+    bool pop(uint32_t &index)
+    {
+        Lane *lane = selectLane();
+        if (!lane)
+        {
+            return false;
+        }
+
+        popFrom(*lane, index);
+        return true;
+    }
+
+private:
+    static constexpr uint32_t kNullIndex = UINT32_MAX;
+
+    struct Flow
+    {
+        uint32_t head = kNullIndex;
+        uint32_t tail = kNullIndex;
+        uint32_t nextActive = kNullIndex;
+        uint32_t deficit = 0;
+        bool     active = false;
+    };
+
+    struct Lane
+    {
+        Flow     flows[FlowCount];
+        uint32_t activeHead = kNullIndex;
+        uint32_t activeTail = kNullIndex;
+
+        //
+        // NOTE: requests of higher lanes served while this one waited
+        //
+        uint32_t passed = 0;
+    };
+
+    //
+    // NOTE: the highest waiting lane unless a lower one was passed over too long
+    //
+    Lane * selectLane()
+    {
+        Lane *selected = nullptr;
+
+        for (Lane &lane : m_lanes)
+        {
+            if (kNullIndex == lane.activeHead)
+            {
+                continue;
+            }
+
+            if (!selected)
+            {
+                selected = &lane;
+            }
+            else if (lane.passed >= kFGRequestLaneAgingLimit)
+            {
+                selected = &lane;
+                break;
+            }
+        }
+
+        for (Lane &lane : m_lanes)
+        {
+            if (&lane == selected)
+            {
+                lane.passed = 0;
+            }
+            else if (kNullIndex != lane.activeHead)
+            {
+                ++lane.passed;
+            }
+        }
+
+        return selected;
+    }
+
+    void popFrom(Lane &lane, uint32_t &index)
+    {
+        const uint32_t flowIndex = lane.activeHead;
+        Flow &flow = lane.flows[flowIndex];
+
+        //
+        // NOTE: zero deficit at the head starts the turn of the flow
+        //
+        if (0 == flow.deficit)
+        {
+            flow.deficit = kFGRequestSchedulerQuantum;
+        }
+
+        index = flow.head;
+        flow.head = m_next[index];
+        if (kNullIndex == flow.head)
+        {
+            flow.tail = kNullIndex;
+        }
+
+        --flow.deficit;
+        --m_size;
+
+        if (kNullIndex == flow.head)
+        {
+            removeActiveHead(lane);
+
+            flow.active = false;
+            flow.deficit = 0;
+        }
+        else if (0 == flow.deficit)
+        {
+            removeActiveHead(lane);
+            appendActive(lane, flowIndex);
+        }
+    }
+
+    static uint32_t flowForPid(pid_t pid)
+    {
+        uint32_t hash = static_cast<uint32_t>(pid) * 0x9E3779B1u;
+        hash ^= hash >> 16;
+
+        return hash & (FlowCount - 1);
+    }
+
+    void insert(Flow &flow, uint32_t index)
+    {
+        const uint64_t deadline = m_deadlines[index];
+
+        if (kNullIndex == flow.tail || m_deadlines[flow.tail] <= deadline)
+        {
+            m_next[index] = kNullIndex;
+
+            if (kNullIndex == flow.tail)
+            {
+                flow.head = index;
+            }
+            else
+            {
+                m_next[flow.tail] = index;
+            }
+
+            flow.tail = index;
+            return;
+        }
+
+        //
+        // NOTE: tail is later, so the request goes before it
+        //
+        uint32_t previous = kNullIndex;
+        uint32_t current = flow.head;
+
+        while (m_deadlines[current] <= deadline)
+        {
+            previous = current;
+            current = m_next[current];
+        }
+
+        m_next[index] = current;
+
+        if (kNullIndex == previous)
+        {
+            flow.head = index;
+        }
+        else
+        {
+            m_next[previous] = index;
+        }
+    }
+
+    static void appendActive(Lane &lane, uint32_t flowIndex)
+    {
+        lane.flows[flowIndex].nextActive = kNullIndex;
+
+        if (kNullIndex == lane.activeTail)
+        {
+            lane.activeHead = flowIndex;
+        }
+        else
+        {
+            lane.flows[lane.activeTail].nextActive = flowIndex;
+        }
+
+        lane.activeTail = flowIndex;
+    }
+
+    static void removeActiveHead(Lane &lane)
+    {
+        lane.activeHead = lane.flows[lane.activeHead].nextActive;
+        if (kNullIndex == lane.activeHead)
+        {
+            lane.activeTail = kNullIndex;
+        }
+    }
+
+private:
+    Lane                        m_lanes[kFGRequestLaneCount];
+    std::unique_ptr<uint32_t[]> m_next;
+    std::unique_ptr<uint64_t[]> m_deadlines;
+    uint32_t                    m_size = 0;
+
+};
+
+#endif /* FSGuardRequestScheduler_h */
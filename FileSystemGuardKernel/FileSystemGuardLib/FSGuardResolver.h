@@ -0,0 +1,439 @@
+//
+//  FSGuardResolver.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardResolver_h
+#define FSGuardResolver_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <coroutine>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "FSGuardUserClientInterface.h"
+#include "FSGuardResolverPool.h"
+
+//
+// NOTE: native C++ resolver API, resolver is a coroutine returning the verdict:
+//
+//           FSGuardVerdictTask resolve(const FSGuardRequest &request, FSGuardResolverExecutor &executor) override
+//           {
+//               const std::string path(request.filePath, request.filePathLength);
+//               const bool trusted = co_await lookupSignature(path);
+//               co_await executor.schedule();
+//               co_return trusted;
+//           }
+//
+//       Frames are allocated from FSGuardFramePool, so resolver which completes
+//       without suspension allocates nothing once the pool is warm.
+//
+
+//
+// NOTE: per-thread free lists of coroutine frames in power of two size classes.
+//       Frame freed on another thread joins the free list of that thread, lists
+//       are bounded, so frames flowing one way are returned to the heap
+//
+class FSGuardFramePool
+{
+public:
+    static constexpr size_t kMinFrameSize = 128;
+    static constexpr size_t kMaxFrameSize = 4096;
+    static constexpr uint32_t kMaxFreeFrames = 256;
+
+    static void * allocate(size_t size)
+    {
+        const uint32_t sizeClass = SizeClass(size);
+        if (kSizeClassCount == sizeClass)
+        {
+            return ::operator new(size);
+        }
+
+        FreeList &list = freeLists()[sizeClass];
+        if (FreeFrame *frame = list.head)
+        {
+            list.head = frame->next;
+            --list.count;
+            return frame;
+        }
+
+        return ::operator new(kMinFrameSize << sizeClass);
+    }
+
+    static void deallocate(void *memory, size_t size)
+    {
+        const uint32_t sizeClass = SizeClass(size);
+        if (kSizeClassCount == sizeClass)
+        {
+            ::operator delete(memory);
+            return;
+        }
+
+        FreeList &list = freeLists()[sizeClass];
+        if (list.count >= kMaxFreeFrames)
+        {
+            ::operator delete(memory);
+            return;
+        }
+
+        FreeFrame *frame = static_cast<FreeFrame *>(memory);
+        frame->next = list.head;
+        list.head = frame;
+        ++list.count;
+    }
+
+private:
+    static constexpr uint32_t kSizeClassCount = 6;
+
+    static_assert((kMinFrameSize << (kSizeClassCount - 1)) == kMaxFrameSize, "size classes must cover frame sizes");
+
+    struct FreeFrame
+    {
+        FreeFrame *next;
+    };
+
+    struct FreeList
+    {
+        FreeFrame *head = nullptr;
+        uint32_t   count = 0;
+    };
+
+    struct FreeLists
+    {
+        FreeList lists[kSizeClassCount];
+
+        FreeList & operator[](uint32_t sizeClass)
+        {
+            return lists[sizeClass];
+        }
+
+        ~FreeLists()
+        {
+            for (FreeList &list : lists)
+            {
+                while (FreeFrame *frame = list.head)
+                {
+                    list.head = frame->next;
+                    ::operator delete(frame);
+                }
+            }
+        }
+    };
+
+    //
+    // NOTE: kSizeClassCount for frames larger than kMaxFrameSize
+    //
+    static uint32_t SizeClass(size_t size)
+    {
+        uint32_t sizeClass = 0;
+        for (size_t classSize = kMinFrameSize; classSize < size; classSize <<= 1)
+        {
+            if (++sizeClass == kSizeClassCount)
+            {
+                break;
+            }
+        }
+
+        return sizeClass;
+    }
+
+    static FreeLists & freeLists()
+    {
+        static thread_local FreeLists lists;
+        return lists;
+    }
+};
+
+//
+// NOTE: resumes coroutines on resolver threads, e.g. after resolver awaited
+//       a result delivered on another thread
+//
+class FSGuardResolverExecutor
+{
+public:
+    template <typename Item>
+    explicit FSGuardResolverExecutor(FSGuardResolverPool<Item> &pool)
+        : m_pool(&pool)
+        , m_post([](void *pool, FSGuardDeferredWork &work) {
+              static_cast<FSGuardResolverPool<Item> *>(pool)->post(work);
+          })
+    {
+    }
+
+    void post(FSGuardDeferredWork &work) const
+    {
+        m_post(m_pool, work);
+    }
+
+    class ScheduleAwaiter
+    {
+    public:
+        explicit ScheduleAwaiter(const FSGuardResolverExecutor &executor)
+            : m_executor(executor)
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        //
+        // NOTE: node lives in the suspended frame until the pool resumes it
+        //
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            m_work.handle = handle;
+            m_work.run = [](FSGuardDeferredWork &work) {
+                static_cast<ResumeWork &>(work).handle.resume();
+            };
+
+            m_executor.post(m_work);
+        }
+
+        void await_resume() const noexcept
+        {
+        }
+
+    private:
+        struct ResumeWork : FSGuardDeferredWork
+        {
+            std::coroutine_handle<> handle;
+        };
+
+        const FSGuardResolverExecutor &m_executor;
+        ResumeWork                     m_work {};
+    };
+
+    //
+    // NOTE: co_await executor.schedule() continues on one of resolver threads
+    //
+    ScheduleAwaiter schedule() const
+    {
+        return ScheduleAwaiter(*this);
+    }
+
+private:
+    void  *m_pool;
+    void (*m_post)(void *pool, FSGuardDeferredWork &work);
+};
+
+//
+// NOTE: lazily started coroutine producing the verdict, allow is true. Task may
+//       be awaited by another resolver coroutine or started as the top level one,
+//       which calls completion with the verdict and frees the frame. Resolver
+//       which throws fails open like request without delegate
+//
+class FSGuardVerdictTask
+{
+public:
+    //
+    // NOTE: completion is stored in the frame, so starting allocates nothing
+    //
+    static constexpr size_t kCompletionSize = 6 * sizeof(void *);
+
+    class promise_type
+    {
+    public:
+        static void * operator new(size_t size)
+        {
+            return FSGuardFramePool::allocate(size);
+        }
+
+        static void operator delete(void *memory, size_t size)
+        {
+            FSGuardFramePool::deallocate(memory, size);
+        }
+
+        FSGuardVerdictTask get_return_object()
+        {
+            return FSGuardVerdictTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() const noexcept
+        {
+            return {};
+        }
+
+        class FinalAwaiter
+        {
+        public:
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+            {
+                promise_type &promise = handle.promise();
+
+                if (promise.m_continuation)
+                {
+                    return promise.m_continuation;
+                }
+
+                //
+                // NOTE: frame goes back to the pool before the verdict is sent
+                //
+                alignas(std::max_align_t) unsigned char completion[kCompletionSize];
+                promise.m_moveCompletion(promise.m_completion, completion);
+
+                const bool allow = promise.m_allow;
+                void (*const invoke)(void *, bool) = promise.m_invokeCompletion;
+
+                handle.destroy();
+                invoke(completion, allow);
+
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept
+            {
+            }
+        };
+
+        FinalAwaiter final_suspend() const noexcept
+        {
+            return {};
+        }
+
+        void return_value(bool allow)
+        {
+            m_allow = allow;
+        }
+
+        void unhandled_exception()
+        {
+            m_allow = true;
+        }
+
+    private:
+        friend class FSGuardVerdictTask;
+
+        bool                    m_allow = true;
+        std::coroutine_handle<> m_continuation;
+
+        alignas(std::max_align_t) unsigned char m_completion[kCompletionSize];
+        void (*m_moveCompletion)(void *source, void *target) = nullptr;
+        void (*m_invokeCompletion)(void *completion, bool allow) = nullptr;
+    };
+
+    FSGuardVerdictTask(FSGuardVerdictTask &&other) noexcept
+        : m_handle(std::exchange(other.m_handle, nullptr))
+    {
+    }
+
+    FSGuardVerdictTask(const FSGuardVerdictTask &) = delete;
+    FSGuardVerdictTask & operator=(const FSGuardVerdictTask &) = delete;
+    FSGuardVerdictTask & operator=(FSGuardVerdictTask &&) = delete;
+
+    ~FSGuardVerdictTask()
+    {
+        if (m_handle)
+        {
+            m_handle.destroy();
+        }
+    }
+
+    //
+    // NOTE: runs the resolver on the calling thread until its first suspension,
+    //       completion(bool allow) is called exactly once on the thread finishing it
+    //
+    template <typename Completion>
+    void start(Completion completion) &&
+    {
+        static_assert(sizeof(Completion) <= kCompletionSize, "completion must fit into the frame");
+        static_assert(alignof(Completion) <= alignof(std::max_align_t), "completion must fit into the frame");
+        static_assert(std::is_nothrow_move_constructible<Completion>::value, "completion must be nothrow movable");
+
+        promise_type &promise = m_handle.promise();
+
+        new (promise.m_completion) Completion(std::move(completion));
+
+        promise.m_moveCompletion = [](void *source, void *target) {
+            Completion &completion = *static_cast<Completion *>(source);
+            new (target) Completion(std::move(completion));
+            completion.~Completion();
+        };
+
+        promise.m_invokeCompletion = [](void *memory, bool allow) {
+            Completion &completion = *static_cast<Completion *>(memory);
+            completion(allow);
+            completion.~Completion();
+        };
+
+        std::exchange(m_handle, nullptr).resume();
+    }
+
+    class Awaiter
+    {
+    public:
+        explicit Awaiter(std::coroutine_handle<promise_type> handle)
+            : m_handle(handle)
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+        {
+            m_handle.promise().m_continuation = continuation;
+            return m_handle;
+        }
+
+        bool await_resume() const noexcept
+        {
+            return m_handle.promise().m_allow;
+        }
+
+    private:
+        std::coroutine_handle<promise_type> m_handle;
+    };
+
+    //
+    // NOTE: awaited task runs without rescheduling and resumes the awaiting one
+    //
+    Awaiter operator co_await() & noexcept
+    {
+        return Awaiter(m_handle);
+    }
+
+    Awaiter operator co_await() && noexcept
+    {
+        return Awaiter(m_handle);
+    }
+
+private:
+    explicit FSGuardVerdictTask(std::coroutine_handle<promise_type> handle)
+        : m_handle(handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+//
+// NOTE: C++ counterpart of FSGuardClientDelegate, called on resolver threads
+//
+class FSGuardResolver
+{
+public:
+    virtual ~FSGuardResolver() = default;
+
+    //
+    // NOTE: request and its file path are valid only until the first suspension
+    //
+    virtual FSGuardVerdictTask resolve(const FSGuardRequest &request, FSGuardResolverExecutor &executor) = 0;
+};
+
+#endif /* FSGuardResolver_h */
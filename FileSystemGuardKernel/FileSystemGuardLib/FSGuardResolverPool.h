@@ -0,0 +1,401 @@
+//
+//  FSGuardResolverPool.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardResolverPool_h
+#define FSGuardResolverPool_h
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "FSGuardRequestScheduler.h"
+
+//
+// NOTE: work posted to the pool by any thread, e.g. resumption of suspended
+//       resolver. Node is owned by the poster and must stay valid until it runs
+//
+struct FSGuardDeferredWork
+{
+    void (*run)(FSGuardDeferredWork &work);
+    FSGuardDeferredWork *next;
+};
+
+//
+// NOTE: fixed-size pool of resolver threads working on preallocated items.
+//
+//       Producer acquires a free item, fills it and submits it with its lane,
+//       pid and deadline to the queue of the worker picked by pid. Each queue is
+//       FSGuardRequestScheduler, so a flooding process does not delay processes
+//       sharing its worker by its whole backlog and processes of other workers
+//       not at all. Idle workers steal from queues of busy ones in their order.
+//       Number of items bounds the work in flight, so producer waits for a free
+//       item instead of allocating one and no memory is allocated per request.
+//       Deferred work is run before items, it finishes requests already in flight.
+//
+template <typename Item>
+class FSGuardResolverPool
+{
+public:
+    using Handler = std::function<void(Item &)>;
+
+    FSGuardResolverPool() = default;
+
+    FSGuardResolverPool(const FSGuardResolverPool &) = delete;
+    FSGuardResolverPool & operator=(const FSGuardResolverPool &) = delete;
+
+    ~FSGuardResolverPool()
+    {
+        stop();
+    }
+
+    //
+    // NOTE: concurrency is the number of worker threads, capacity is the number of items
+    //
+    bool start(uint32_t concurrency, uint32_t capacity, Handler handler)
+    {
+        if (!m_workers.empty() || !concurrency || capacity < concurrency || !handler)
+        {
+            return false;
+        }
+
+        m_handler = std::move(handler);
+        m_items.reset(new Item[capacity]);
+        m_stopping = false;
+        m_pending = 0;
+        m_deferredHead = nullptr;
+        m_deferredTail = nullptr;
+
+        m_free.reset(capacity);
+        for (uint32_t index = 0; index < capacity; ++index)
+        {
+            m_free.push(index);
+        }
+
+        m_queues.reset(new Queue[concurrency]);
+        m_queueCount = concurrency;
+        for (uint32_t index = 0; index < concurrency; ++index)
+        {
+            m_queues[index].scheduler.reset(capacity);
+        }
+
+        m_workers.reserve(concurrency);
+        for (uint32_t index = 0; index < concurrency; ++index)
+        {
+            m_workers.emplace_back(&FSGuardResolverPool::workerLoop, this, index);
+        }
+
+        return true;
+    }
+
+    //
+    // NOTE: handles all submitted items and joins workers
+    //
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> sleepLock(m_sleepLock);
+            std::lock_guard<std::mutex> freeLock(m_freeLock);
+            m_stopping = true;
+        }
+
+        m_wakeup.notify_all();
+        m_itemReleased.notify_all();
+
+        for (std::thread &worker : m_workers)
+        {
+            worker.join();
+        }
+
+        m_workers.clear();
+    }
+
+    //
+    // NOTE: single producer, waits for a free item, returns null if pool is stopping
+    //
+    Item * acquire()
+    {
+        std::unique_lock<std::mutex> lock(m_freeLock);
+
+        m_itemReleased.wait(lock, [this] { return m_stopping || !m_free.empty(); });
+
+        if (m_stopping)
+        {
+            return nullptr;
+        }
+
+        return &m_items[m_free.pop()];
+    }
+
+    //
+    // NOTE: returns acquired item which was not submitted
+    //
+    void release(Item *item)
+    {
+        releaseIndex(indexOf(item));
+    }
+
+    //
+    // NOTE: requests of a process go to the same worker, deadline is zero if none
+    //
+    void submit(Item *item, FSGuardRequestLane lane, pid_t pid, uint64_t deadline)
+    {
+        Queue &queue = m_queues[queueForPid(pid)];
+
+        {
+            std::lock_guard<std::mutex> lock(queue.lock);
+            queue.scheduler.push(indexOf(item), lane, pid, deadline);
+            m_pending.fetch_add(1, std::memory_order_release);
+        }
+
+        std::lock_guard<std::mutex> lock(m_sleepLock);
+        if (m_sleepers)
+        {
+            m_wakeup.notify_one();
+        }
+    }
+
+    //
+    // NOTE: multiple producers, work posted after stop is not run
+    //
+    void post(FSGuardDeferredWork &work)
+    {
+        work.next = nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(m_deferredLock);
+            if (m_deferredTail)
+            {
+                m_deferredTail->next = &work;
+            }
+            else
+            {
+                m_deferredHead.store(&work, std::memory_order_relaxed);
+            }
+
+            m_deferredTail = &work;
+            m_pending.fetch_add(1, std::memory_order_release);
+        }
+
+        std::lock_guard<std::mutex> lock(m_sleepLock);
+        if (m_sleepers)
+        {
+            m_wakeup.notify_one();
+        }
+    }
+
+    uint32_t concurrency() const
+    {
+        return m_queueCount;
+    }
+
+private:
+    //
+    // NOTE: bounded FIFO of item indices, never holds more than pool capacity
+    //
+    class IndexRing
+    {
+    public:
+        void reset(uint32_t capacity)
+        {
+            m_indices.reset(new uint32_t[capacity]);
+            m_capacity = capacity;
+            m_head = 0;
+            m_size = 0;
+        }
+
+        bool empty() const
+        {
+            return 0 == m_size;
+        }
+
+        void push(uint32_t index)
+        {
+            m_indices[(m_head + m_size) % m_capacity] = index;
+            ++m_size;
+        }
+
+        uint32_t pop()
+        {
+            const uint32_t index = m_indices[m_head];
+            m_head = (m_head + 1) % m_capacity;
+            --m_size;
+
+            return index;
+        }
+
+    private:
+        std::unique_ptr<uint32_t[]> m_indices;
+        uint32_t                    m_capacity = 0;
+        uint32_t                    m_head = 0;
+        uint32_t                    m_size = 0;
+    };
+
+    struct alignas(64) Queue
+    {
+        std::mutex                   lock;
+        FSGuardRequestScheduler<256> scheduler;
+    };
+
+    //
+    // NOTE: mixed unlike the flow hash of the scheduler, so processes
+    //       of one worker still spread over its flows
+    //
+    uint32_t queueForPid(pid_t pid) const
+    {
+        uint32_t hash = static_cast<uint32_t>(pid) * 0x85EBCA6Bu;
+        hash ^= hash >> 13;
+
+        return hash % m_queueCount;
+    }
+
+    uint32_t indexOf(const Item *item) const
+    {
+        return static_cast<uint32_t>(item - m_items.get());
+    }
+
+    void releaseIndex(uint32_t index)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_freeLock);
+            m_free.push(index);
+        }
+
+        m_itemReleased.notify_one();
+    }
+
+    FSGuardDeferredWork * takeDeferred()
+    {
+        std::lock_guard<std::mutex> lock(m_deferredLock);
+
+        FSGuardDeferredWork *work = m_deferredHead.load(std::memory_order_relaxed);
+        if (work)
+        {
+            m_deferredHead.store(work->next, std::memory_order_relaxed);
+            if (!m_deferredHead)
+            {
+                m_deferredTail = nullptr;
+            }
+
+            m_pending.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        return work;
+    }
+
+    bool takeFrom(uint32_t queueIndex, uint32_t &index)
+    {
+        Queue &queue = m_queues[queueIndex];
+
+        std::lock_guard<std::mutex> lock(queue.lock);
+        if (!queue.scheduler.pop(index))
+        {
+            return false;
+        }
+
+        m_pending.fetch_sub(1, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    //
+    // NOTE: own queue first, then steal starting from the neighbour,
+    //       pending counter always equals number of scheduled items and deferred work
+    //
+    bool take(uint32_t worker, uint32_t &index)
+    {
+        if (0 == m_pending.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        for (uint32_t offset = 0; offset < m_queueCount; ++offset)
+        {
+            if (takeFrom((worker + offset) % m_queueCount, index))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void workerLoop(uint32_t worker)
+    {
+        for (;;)
+        {
+            if (m_deferredHead.load(std::memory_order_acquire))
+            {
+                if (FSGuardDeferredWork *work = takeDeferred())
+                {
+                    work->run(*work);
+                    continue;
+                }
+            }
+
+            uint32_t index = 0;
+            if (take(worker, index))
+            {
+                m_handler(m_items[index]);
+                releaseIndex(index);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_sleepLock);
+
+            //
+            // NOTE: pending counter is incremented before producer takes the sleep lock,
+            //       so submission is either seen here or followed by notification
+            //
+            if (m_pending.load(std::memory_order_acquire))
+            {
+                continue;
+            }
+
+            if (m_stopping)
+            {
+                return;
+            }
+
+            ++m_sleepers;
+            m_wakeup.wait(lock);
+            --m_sleepers;
+        }
+    }
+
+private:
+    Handler                  m_handler;
+    std::unique_ptr<Item[]>  m_items;
+
+    std::mutex               m_freeLock;
+    std::condition_variable  m_itemReleased;
+    IndexRing                m_free;
+
+    std::unique_ptr<Queue[]> m_queues;
+    uint32_t                 m_queueCount = 0;
+    std::atomic<uint32_t>    m_pending {0};
+
+    std::mutex                         m_deferredLock;
+    std::atomic<FSGuardDeferredWork *> m_deferredHead {nullptr};
+    FSGuardDeferredWork               *m_deferredTail = nullptr;
+
+    std::mutex               m_sleepLock;
+    std::condition_variable  m_wakeup;
+    uint32_t                 m_sleepers = 0;
+    bool                     m_stopping = false;
+
+    std::vector<std::thread> m_workers;
+
+};
+
+#endif /* FSGuardResolverPool_h */
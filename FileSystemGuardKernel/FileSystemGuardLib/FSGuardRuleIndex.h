@@ -0,0 +1,396 @@
+//
+//  FSGuardRuleIndex.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardRuleIndex_h
+#define FSGuardRuleIndex_h
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//
+// NOTE: path rules indexed by compressed radix trie over path components.
+//
+//       Edges are labeled with one or more whole components, so "/data" never
+//       matches "/database", and lookup returns the value of the longest
+//       (most specific) rule path that is the path itself or its parent directory.
+//       Lookup cost depends on the path depth, not on the number of rules.
+//
+//       Not thread safe, callers serialize modifications against lookups.
+//
+template <typename Value>
+class FSGuardRuleIndex
+{
+public:
+    //
+    // NOTE: value for the same path replaces previous one
+    //
+    bool insert(std::string_view path, Value value)
+    {
+        std::string normalized;
+        if (!normalize(path, normalized))
+        {
+            return false;
+        }
+
+        Node *node = &m_root;
+        std::string_view rest = normalized;
+
+        while (!rest.empty())
+        {
+            auto position = lowerBound(*node, firstComponent(rest));
+            if (position == node->children.end() || firstComponent((*position)->label) != firstComponent(rest))
+            {
+                std::unique_ptr<Node> child(new Node);
+                child->label = std::string(rest);
+                node = node->children.insert(position, std::move(child))->get();
+                break;
+            }
+
+            Node *child = position->get();
+            const size_t common = commonPrefix(child->label, rest);
+
+            if (common < child->label.size())
+            {
+                //
+                // NOTE: split the edge at component boundary
+                //
+                std::unique_ptr<Node> middle(new Node);
+                middle->label = child->label.substr(0, common);
+
+                std::unique_ptr<Node> tail = std::move(*position);
+                tail->label.erase(0, common + 1);
+                middle->children.push_back(std::move(tail));
+
+                *position = std::move(middle);
+                child = position->get();
+            }
+
+            node = child;
+            rest.remove_prefix(common == rest.size() ? common : common + 1);
+        }
+
+        if (!node->value)
+        {
+            ++m_size;
+        }
+
+        node->value = std::move(value);
+
+        return true;
+    }
+
+    bool erase(std::string_view path)
+    {
+        std::string normalized;
+        if (!normalize(path, normalized))
+        {
+            return false;
+        }
+
+        if (normalized.empty())
+        {
+            if (!m_root.value)
+            {
+                return false;
+            }
+
+            m_root.value.reset();
+            --m_size;
+
+            return true;
+        }
+
+        return erase(m_root, normalized);
+    }
+
+    //
+    // NOTE: value of the rule with exactly this path
+    //
+    const Value * find(std::string_view path) const
+    {
+        const Value *exact = nullptr;
+        walk(path, exact);
+
+        return exact;
+    }
+
+    //
+    // NOTE: value of the most specific rule covering the path
+    //
+    const Value * match(std::string_view path) const
+    {
+        const Value *exact = nullptr;
+
+        return walk(path, exact);
+    }
+
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return 0 == m_size;
+    }
+
+    void clear()
+    {
+        m_root.value.reset();
+        m_root.children.clear();
+        m_size = 0;
+    }
+
+    //
+    // NOTE: absolute path without repeated and trailing slashes and without leading one,
+    //       root becomes empty string
+    //
+    static bool normalize(std::string_view path, std::string &normalized)
+    {
+        if (path.empty() || '/' != path[0] || std::string_view::npos != path.find('\0'))
+        {
+            return false;
+        }
+
+        normalized.clear();
+        normalized.reserve(path.size());
+
+        for (char character : path)
+        {
+            if ('/' == character && (normalized.empty() || '/' == normalized.back()))
+            {
+                continue;
+            }
+
+            normalized.push_back(character);
+        }
+
+        if (!normalized.empty() && '/' == normalized.back())
+        {
+            normalized.pop_back();
+        }
+
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        //
+        // NOTE: components from the parent, separated by single slash
+        //
+        std::string                        label;
+        std::optional<Value>               value;
+        std::vector<std::unique_ptr<Node>> children;
+    };
+
+    using Children = std::vector<std::unique_ptr<Node>>;
+
+    static std::string_view firstComponent(std::string_view path)
+    {
+        return path.substr(0, path.find('/'));
+    }
+
+    static std::string_view skipSlashes(std::string_view path)
+    {
+        const size_t position = path.find_first_not_of('/');
+
+        return std::string_view::npos == position ? std::string_view() : path.substr(position);
+    }
+
+    //
+    // NOTE: children are sorted by the first component of their label,
+    //       which is unique among siblings
+    //
+    static bool precedes(const std::unique_ptr<Node> &child, std::string_view component)
+    {
+        return firstComponent(child->label) < component;
+    }
+
+    static typename Children::iterator lowerBound(Node &node, std::string_view component)
+    {
+        return std::lower_bound(node.children.begin(), node.children.end(), component, precedes);
+    }
+
+    static const Node * findChild(const Node &node, std::string_view component)
+    {
+        auto position = std::lower_bound(node.children.begin(), node.children.end(), component, precedes);
+
+        if (position == node.children.end() || firstComponent((*position)->label) != component)
+        {
+            return nullptr;
+        }
+
+        return position->get();
+    }
+
+    //
+    // NOTE: length of the longest common prefix of whole components
+    //
+    static size_t commonPrefix(std::string_view lhs, std::string_view rhs)
+    {
+        const size_t length = std::min(lhs.size(), rhs.size());
+
+        size_t common = 0;
+        size_t index = 0;
+
+        for (; index < length && lhs[index] == rhs[index]; ++index)
+        {
+            if ('/' == lhs[index])
+            {
+                common = index;
+            }
+        }
+
+        const bool lhsEnds = index == lhs.size() || '/' == lhs[index];
+        const bool rhsEnds = index == rhs.size() || '/' == rhs[index];
+
+        return index == length && lhsEnds && rhsEnds ? index : common;
+    }
+
+    //
+    // NOTE: matches normalized label against unnormalized path,
+    //       returns number of path characters consumed or zero on mismatch
+    //
+    static size_t matchLabel(std::string_view label, std::string_view path)
+    {
+        size_t position = 0;
+
+        for (char character : label)
+        {
+            if ('/' == character)
+            {
+                if (position == path.size() || '/' != path[position])
+                {
+                    return 0;
+                }
+
+                while (position < path.size() && '/' == path[position])
+                {
+                    ++position;
+                }
+            }
+            else
+            {
+                if (position == path.size() || character != path[position])
+                {
+                    return 0;
+                }
+
+                ++position;
+            }
+        }
+
+        if (position != path.size() && '/' != path[position])
+        {
+            return 0;
+        }
+
+        return position;
+    }
+
+    const Value * walk(std::string_view path, const Value *&exact) const
+    {
+        exact = nullptr;
+
+        if (path.empty() || '/' != path[0])
+        {
+            return nullptr;
+        }
+
+        const Node *node = &m_root;
+        const Value *longest = m_root.value ? &*m_root.value : nullptr;
+
+        std::string_view rest = skipSlashes(path);
+
+        while (!rest.empty())
+        {
+            const Node *child = findChild(*node, firstComponent(rest));
+            if (!child)
+            {
+                return longest;
+            }
+
+            const size_t consumed = matchLabel(child->label, rest);
+            if (!consumed)
+            {
+                return longest;
+            }
+
+            node = child;
+            if (node->value)
+            {
+                longest = &*node->value;
+            }
+
+            rest = skipSlashes(rest.substr(consumed));
+        }
+
+        exact = node->value ? &*node->value : nullptr;
+
+        return longest;
+    }
+
+    bool erase(Node &parent, std::string_view rest)
+    {
+        auto position = lowerBound(parent, firstComponent(rest));
+        if (position == parent.children.end())
+        {
+            return false;
+        }
+
+        Node &child = **position;
+        if (0 != rest.compare(0, child.label.size(), child.label) ||
+            (rest.size() != child.label.size() && '/' != rest[child.label.size()]))
+        {
+            return false;
+        }
+
+        if (rest.size() == child.label.size())
+        {
+            if (!child.value)
+            {
+                return false;
+            }
+
+            child.value.reset();
+            --m_size;
+        }
+        else if (!erase(child, rest.substr(child.label.size() + 1)))
+        {
+            return false;
+        }
+
+        //
+        // NOTE: keep the trie compressed, nodes without value have at least two children
+        //
+        if (!child.value && child.children.empty())
+        {
+            parent.children.erase(position);
+        }
+        else if (!child.value && 1 == child.children.size())
+        {
+            std::unique_ptr<Node> grandchild = std::move(child.children.front());
+            grandchild->label = child.label + "/" + grandchild->label;
+            *position = std::move(grandchild);
+        }
+
+        return true;
+    }
+
+private:
+    Node   m_root;
+    size_t m_size = 0;
+
+};
+
+#endif /* FSGuardRuleIndex_h */
@@ -0,0 +1,299 @@
+//
+//  FSGuardStatistics.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardStatistics_h
+#define FSGuardStatistics_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+//
+// NOTE: portable counters and latency histograms shared by the driver and the client.
+//
+//       Histograms are log-linear like HDR histogram: values below kFGHistogramSubBucketCount
+//       have own bucket, every next power of two is split into kFGHistogramSubBucketCount
+//       buckets, so relative error is below 1 / kFGHistogramSubBucketCount. Values are
+//       nanoseconds, larger than kFGHistogramMaxValue go to the last bucket.
+//
+constexpr uint32_t kFGStatisticsVersion = 1;
+
+constexpr uint32_t kFGHistogramSubBucketBits = 3;
+constexpr uint32_t kFGHistogramSubBucketCount = 1u << kFGHistogramSubBucketBits;
+constexpr uint32_t kFGHistogramMaxValueBits = 41;
+constexpr uint64_t kFGHistogramMaxValue = (1ull << kFGHistogramMaxValueBits) - 1;
+constexpr uint32_t kFGHistogramBucketCount = (kFGHistogramMaxValueBits - kFGHistogramSubBucketBits + 1) * kFGHistogramSubBucketCount;
+
+enum class FSGuardStatisticsCounter : uint32_t
+{
+    //
+    // NOTE: requests sent to the client by the driver or dequeued by the client
+    //
+    Requests,
+    //
+    // NOTE: requests which waited for identical pending request
+    //
+    Coalesced,
+    //
+    // NOTE: requests allowed without asking, too many requests were in flight
+    //
+    WaitListFull,
+    //
+    // NOTE: requests which did not fit into the request queue until the deadline
+    //
+    QueueFull,
+    //
+    // NOTE: sleeps of producers waiting for free space in the request queue
+    //
+    QueueSleepRetries,
+    Timeouts,
+    Interrupts,
+    Allowed,
+    Denied,
+    //
+    // NOTE: requests given default verdict by overload policy without asking
+    //
+    Shed,
+    //
+    // NOTE: requests sent without path, the client knew it by identity
+    //
+    PathsOmitted,
+    //
+    // NOTE: requests sent again with path asked by the client
+    //
+    PathsRequested,
+    //
+    // NOTE: requests given default verdict, driver request pool was exhausted
+    //
+    RequestPoolFull,
+    //
+    // NOTE: requests dropped by the client, the driver stopped waiting for them
+    //
+    Expired,
+
+    Count
+};
+
+constexpr uint32_t kFGStatisticsCounterCount = static_cast<uint32_t>(FSGuardStatisticsCounter::Count);
+
+enum class FSGuardStatisticsStage : uint32_t
+{
+    //
+    // NOTE: driver, time spent publishing request into the request queue
+    //
+    EnqueueWait,
+    //
+    // NOTE: client, from publishing request to its dequeue by the client
+    //
+    QueueResidency,
+    //
+    // NOTE: client, from dequeue to the verdict of the delegate
+    //
+    Resolution,
+    //
+    // NOTE: driver, from the start of the request to its verdict or timeout
+    //
+    TimeToVerdict,
+
+    Count
+};
+
+constexpr uint32_t kFGStatisticsStageCount = static_cast<uint32_t>(FSGuardStatisticsStage::Count);
+
+struct FSGuardHistogram
+{
+    uint64_t count;
+    uint64_t sum;
+    uint64_t max;
+    uint64_t buckets[kFGHistogramBucketCount];
+};
+
+//
+// NOTE: wire format of FSGuardMethod::GetStatistics, the client fills
+//       the same structure with its own stages and counters
+//
+struct FSGuardStatistics
+{
+    uint32_t version;
+    uint32_t size;
+    uint64_t counters[kFGStatisticsCounterCount];
+    FSGuardHistogram histograms[kFGStatisticsStageCount];
+};
+
+constexpr uint32_t FSGuardHistogramBucket(uint64_t value)
+{
+    if (value < kFGHistogramSubBucketCount)
+    {
+        return static_cast<uint32_t>(value);
+    }
+
+    if (value > kFGHistogramMaxValue)
+    {
+        value = kFGHistogramMaxValue;
+    }
+
+    const uint32_t shift = 63 - __builtin_clzll(value) - kFGHistogramSubBucketBits;
+
+    return ((shift + 1) << kFGHistogramSubBucketBits) + static_cast<uint32_t>((value >> shift) & (kFGHistogramSubBucketCount - 1));
+}
+
+constexpr uint64_t FSGuardHistogramBucketLowerBound(uint32_t bucket)
+{
+    if (bucket < kFGHistogramSubBucketCount)
+    {
+        return bucket;
+    }
+
+    const uint32_t shift = (bucket >> kFGHistogramSubBucketBits) - 1;
+    const uint64_t mantissa = kFGHistogramSubBucketCount + (bucket & (kFGHistogramSubBucketCount - 1));
+
+    return mantissa << shift;
+}
+
+constexpr uint64_t FSGuardHistogramBucketUpperBound(uint32_t bucket)
+{
+    return bucket + 1 < kFGHistogramBucketCount ? FSGuardHistogramBucketLowerBound(bucket + 1) - 1 : kFGHistogramMaxValue;
+}
+
+//
+// NOTE: upper bound of the bucket holding the value at numerator / denominator
+//       quantile, e.g. 999 / 1000 for p99.9, integer only to be usable in the kernel
+//
+inline uint64_t FSGuardHistogramQuantile(const FSGuardHistogram &histogram, uint64_t numerator, uint64_t denominator)
+{
+    if (0 == histogram.count || 0 == denominator)
+    {
+        return 0;
+    }
+
+    uint64_t rank = (histogram.count * numerator + denominator - 1) / denominator;
+    if (0 == rank)
+    {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < kFGHistogramBucketCount; ++bucket)
+    {
+        seen += histogram.buckets[bucket];
+        if (seen >= rank)
+        {
+            const uint64_t upper = FSGuardHistogramBucketUpperBound(bucket);
+            return upper < histogram.max ? upper : histogram.max;
+        }
+    }
+
+    return histogram.max;
+}
+
+//
+// NOTE: lock-free recorder, every shard is written with relaxed atomics, so
+//       writers of different shards do not share cache lines and writers of
+//       the same shard never lose updates. Callers pick shard by CPU or thread.
+//       Snapshot is not atomic as a whole, counters may be a few events apart.
+//
+template <uint32_t ShardCount>
+class FSGuardStatisticsRecorder
+{
+    static_assert(ShardCount && 0 == (ShardCount & (ShardCount - 1)), "ShardCount must be power of two");
+
+public:
+    static constexpr uint32_t kShardCount = ShardCount;
+
+    void increment(uint32_t shard, FSGuardStatisticsCounter counter, uint64_t value = 1)
+    {
+        uint64_t *target = &m_shards[shard & (ShardCount - 1)].counters[static_cast<uint32_t>(counter)];
+
+        __atomic_fetch_add(target, value, __ATOMIC_RELAXED);
+    }
+
+    void record(uint32_t shard, FSGuardStatisticsStage stage, uint64_t nanoseconds)
+    {
+        FSGuardHistogram &histogram = m_shards[shard & (ShardCount - 1)].histograms[static_cast<uint32_t>(stage)];
+
+        __atomic_fetch_add(&histogram.buckets[FSGuardHistogramBucket(nanoseconds)], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&histogram.sum, nanoseconds, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&histogram.count, 1, __ATOMIC_RELAXED);
+
+        uint64_t max = __atomic_load_n(&histogram.max, __ATOMIC_RELAXED);
+        while (nanoseconds > max &&
+               !__atomic_compare_exchange_n(&histogram.max, &max, nanoseconds, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+        }
+    }
+
+    void snapshot(FSGuardStatistics &statistics) const
+    {
+        memset(&statistics, 0, sizeof(statistics));
+        statistics.version = kFGStatisticsVersion;
+        statistics.size = sizeof(FSGuardStatistics);
+
+        for (uint32_t index = 0; index < ShardCount; ++index)
+        {
+            const Shard &shard = m_shards[index];
+
+            for (uint32_t counter = 0; counter < kFGStatisticsCounterCount; ++counter)
+            {
+                statistics.counters[counter] += __atomic_load_n(&shard.counters[counter], __ATOMIC_RELAXED);
+            }
+
+            for (uint32_t stage = 0; stage < kFGStatisticsStageCount; ++stage)
+            {
+                const FSGuardHistogram &source = shard.histograms[stage];
+                FSGuardHistogram &target = statistics.histograms[stage];
+
+                for (uint32_t bucket = 0; bucket < kFGHistogramBucketCount; ++bucket)
+                {
+                    target.buckets[bucket] += __atomic_load_n(&source.buckets[bucket], __ATOMIC_RELAXED);
+                }
+
+                target.sum += __atomic_load_n(&source.sum, __ATOMIC_RELAXED);
+
+                const uint64_t max = __atomic_load_n(&source.max, __ATOMIC_RELAXED);
+                target.max = max > target.max ? max : target.max;
+            }
+        }
+
+        //
+        // NOTE: count follows the buckets, so quantiles of a snapshot taken
+        //       while recording never run past the last bucket
+        //
+        for (uint32_t stage = 0; stage < kFGStatisticsStageCount; ++stage)
+        {
+            FSGuardHistogram &histogram = statistics.histograms[stage];
+
+            for (uint32_t bucket = 0; bucket < kFGHistogramBucketCount; ++bucket)
+            {
+                histogram.count += histogram.buckets[bucket];
+            }
+        }
+    }
+
+private:
+    struct ShardData
+    {
+        uint64_t counters[kFGStatisticsCounterCount];
+        FSGuardHistogram histograms[kFGStatisticsStageCount];
+    };
+
+    //
+    // NOTE: padded instead of alignas, the driver allocates recorder
+    //       with plain operator new which does not honor extended alignment
+    //
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct Shard : ShardData
+    {
+        uint8_t padding[kCacheLineSize - sizeof(ShardData) % kCacheLineSize];
+    };
+
+    Shard m_shards[ShardCount] {};
+
+};
+
+#endif /* FSGuardStatistics_h */
@@ -0,0 +1,253 @@
+//
+//  FSGuardTrace.h
+//  FileSystemGuard
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardTrace_h
+#define FSGuardTrace_h
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <mutex>
+#include <string>
+
+#include "FSGuardUserClientInterface.h"
+
+//
+// NOTE: binary trace of resolved requests.
+//
+//       Layout: FSGuardTraceHeader followed by records, each record is
+//       FSGuardTraceRecord with the path inline padded to kFGTraceRecordAlignment.
+//       Timestamps are nanoseconds since the trace was started, all fields are
+//       little endian as written by the host.
+//
+constexpr uint32_t kFGTraceMagic = 0x52544746; // 'FGTR'
+constexpr uint16_t kFGTraceVersion = 1;
+constexpr uint32_t kFGTraceRecordAlignment = 8;
+
+enum class FSGuardTraceVerdict : uint8_t
+{
+    Deny,
+    Allow
+};
+
+struct FSGuardTraceHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint64_t reserved;
+};
+
+struct FSGuardTraceRecord
+{
+    uint32_t size;
+    uint16_t pathLength;
+    uint8_t  action;
+    uint8_t  verdict;
+    int32_t  pid;
+    uint32_t reserved;
+    uint64_t timestamp;
+    uint64_t latency;
+};
+
+constexpr uint32_t FSGuardTraceRecordSize(uint32_t pathLength)
+{
+    return (sizeof(FSGuardTraceRecord) + pathLength + kFGTraceRecordAlignment - 1) & ~(kFGTraceRecordAlignment - 1);
+}
+
+struct FSGuardTraceEvent
+{
+    uint64_t            timestamp;
+    uint64_t            latency;
+    pid_t               pid;
+    FSGuardAction       action;
+    FSGuardTraceVerdict verdict;
+    std::string         path;
+};
+
+//
+// NOTE: appends records from any thread, output is buffered by stdio
+//
+class FSGuardTraceWriter
+{
+public:
+    FSGuardTraceWriter() = default;
+
+    FSGuardTraceWriter(const FSGuardTraceWriter &) = delete;
+    FSGuardTraceWriter & operator=(const FSGuardTraceWriter &) = delete;
+
+    ~FSGuardTraceWriter()
+    {
+        close();
+    }
+
+    bool open(const char *path)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        if (m_file)
+        {
+            return false;
+        }
+
+        m_file = fopen(path, "wb");
+        if (!m_file)
+        {
+            return false;
+        }
+
+        FSGuardTraceHeader header {};
+        header.magic = kFGTraceMagic;
+        header.version = kFGTraceVersion;
+        header.headerSize = sizeof(FSGuardTraceHeader);
+
+        if (1 != fwrite(&header, sizeof(header), 1, m_file))
+        {
+            fclose(m_file);
+            m_file = nullptr;
+            return false;
+        }
+
+        return true;
+    }
+
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        if (m_file)
+        {
+            fclose(m_file);
+            m_file = nullptr;
+        }
+    }
+
+    bool write(uint64_t timestamp, uint64_t latency, pid_t pid, FSGuardAction action,
+               FSGuardTraceVerdict verdict, const char *path, uint32_t pathLength)
+    {
+        if (pathLength > UINT16_MAX)
+        {
+            pathLength = UINT16_MAX;
+        }
+
+        const uint32_t size = FSGuardTraceRecordSize(pathLength);
+
+        FSGuardTraceRecord record {};
+        record.size = size;
+        record.pathLength = static_cast<uint16_t>(pathLength);
+        record.action = static_cast<uint8_t>(action);
+        record.verdict = static_cast<uint8_t>(verdict);
+        record.pid = pid;
+        record.timestamp = timestamp;
+        record.latency = latency;
+
+        static const uint8_t padding[kFGTraceRecordAlignment] = {};
+        const size_t paddingSize = size - sizeof(record) - pathLength;
+
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        if (!m_file)
+        {
+            return false;
+        }
+
+        return 1 == fwrite(&record, sizeof(record), 1, m_file) &&
+               pathLength == fwrite(path, 1, pathLength, m_file) &&
+               paddingSize == fwrite(padding, 1, paddingSize, m_file);
+    }
+
+private:
+    std::mutex m_lock;
+    FILE      *m_file = nullptr;
+
+};
+
+class FSGuardTraceReader
+{
+public:
+    FSGuardTraceReader() = default;
+
+    FSGuardTraceReader(const FSGuardTraceReader &) = delete;
+    FSGuardTraceReader & operator=(const FSGuardTraceReader &) = delete;
+
+    ~FSGuardTraceReader()
+    {
+        if (m_file)
+        {
+            fclose(m_file);
+        }
+    }
+
+    bool open(const char *path)
+    {
+        m_file = fopen(path, "rb");
+        if (!m_file)
+        {
+            return false;
+        }
+
+        FSGuardTraceHeader header {};
+        if (1 != fread(&header, sizeof(header), 1, m_file) ||
+            kFGTraceMagic != header.magic ||
+            kFGTraceVersion != header.version ||
+            header.headerSize < sizeof(header))
+        {
+            return false;
+        }
+
+        //
+        // NOTE: newer versions may only append header fields
+        //
+        return 0 == fseek(m_file, header.headerSize, SEEK_SET);
+    }
+
+    //
+    // NOTE: returns false at the end of the trace or on malformed record
+    //
+    bool next(FSGuardTraceEvent &event)
+    {
+        FSGuardTraceRecord record {};
+        if (!m_file || 1 != fread(&record, sizeof(record), 1, m_file))
+        {
+            return false;
+        }
+
+        if (record.size != FSGuardTraceRecordSize(record.pathLength) ||
+            record.action >= kFGActionCount ||
+            record.verdict > static_cast<uint8_t>(FSGuardTraceVerdict::Allow))
+        {
+            return false;
+        }
+
+        event.path.resize(record.pathLength);
+        if (record.pathLength != fread(&event.path[0], 1, record.pathLength, m_file))
+        {
+            return false;
+        }
+
+        if (0 != fseek(m_file, record.size - sizeof(record) - record.pathLength, SEEK_CUR))
+        {
+            return false;
+        }
+
+        event.timestamp = record.timestamp;
+        event.latency = record.latency;
+        event.pid = record.pid;
+        event.action = static_cast<FSGuardAction>(record.action);
+        event.verdict = static_cast<FSGuardTraceVerdict>(record.verdict);
+
+        return true;
+    }
+
+private:
+    FILE *m_file = nullptr;
+
+};
+
+#endif /* FSGuardTrace_h */
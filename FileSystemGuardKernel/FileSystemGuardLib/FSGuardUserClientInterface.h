@@ -16,6 +16,15 @@ constexpr const char *kFSGuardServiceClass = "FSGuardService";
 enum class FSGuardMethod
 {
     PostFSGuardResponse,
+    FlushVerdictCache,
+    DrainFSGuardResponses,
+    SetSubscriptionMask,
+    LoadPolicy,
+    GetStatistics,
+    SetOverloadPolicy,
+    SetTrustedProcesses,
+    SetWatchScope,
+    SignalRequestSpace,
     //
     // NOTE: identifiers for additional external methods
     //
@@ -23,28 +32,231 @@ enum class FSGuardMethod
     Count
 };
 
+//
+// NOTE: number of clients which may be connected at the same time,
+//       requests are split between clients subscribed to the action
+//
+constexpr uint32_t kFGMaxUserClients = 8;
+
 constexpr uint32_t kFGNotificationPortQueue = 1;
 constexpr uint32_t kFGMemoryMapQueue = 1;
+constexpr uint32_t kFGMemoryMapCompletionRing = 2;
+
+//
+// NOTE: size of the request ring in bytes, must be power of two,
+//       fits about thousand requests with typical path length
+//
+constexpr uint32_t kFGRequestQueueSize = 256 * 1024;
+
+//
+// NOTE: number of responses in the completion ring, must be power of two
+//
+constexpr uint32_t kFGCompletionRingCapacity = 1024;
 
 enum class FSGuardAction
 {
     Read,
     Write,
-    Execute
+    Execute,
+    Delete,
+    Append,
+    ReadMetadata,
+    WriteMetadata
 };
 
+constexpr uint32_t kFGActionCount = 7;
+
+constexpr uint32_t FSGuardActionMask(FSGuardAction action)
+{
+    return 1u << static_cast<uint32_t>(action);
+}
+
+constexpr uint32_t kFGActionMaskAll = (1u << kFGActionCount) - 1;
+
+//
+// NOTE: actions delivered to the client until it registers own subscription mask
+//
+constexpr uint32_t kFGActionMaskDefault = FSGuardActionMask(FSGuardAction::Read) |
+                                          FSGuardActionMask(FSGuardAction::Write) |
+                                          FSGuardActionMask(FSGuardAction::Execute) |
+                                          FSGuardActionMask(FSGuardAction::Delete) |
+                                          FSGuardActionMask(FSGuardAction::Append);
+
+//
+// NOTE: wire format of the request in the queue, NUL terminated path
+//       follows the header inline at its real length and the record is
+//       padded to kFGRequestRecordAlignment, see FSGuardRequestCodec.h
+//
+constexpr uint16_t kFGRequestRecordVersion = 3;
+constexpr uint32_t kFGRequestRecordAlignment = 8;
+
+//
+// NOTE: fsid, fileid and generation of the record are valid
+//
+constexpr uint32_t kFGRecordFlagIdentity = 1u << 0;
+
+//
+// NOTE: path of the identity was sent earlier, the record has empty path
+//
+constexpr uint32_t kFGRecordFlagPathOmitted = 1u << 1;
+
+//
+// NOTE: not a request, paths cached for the identity or for the path
+//       are stale after rename or delete and no response is expected
+//
+constexpr uint32_t kFGRecordFlagInvalidation = 1u << 2;
+
+//
+// NOTE: invalidated path is a directory, paths under it are stale too
+//
+constexpr uint32_t kFGRecordFlagDirectory = 1u << 3;
+
+//
+// NOTE: size of the process name buffer, fits the longest name the driver reports
+//
+constexpr uint32_t kFGProcessNameSize = 32;
+
+struct FSGuardRequestRecord
+{
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t size;
+    void *rid;
+    pid_t pid;
+    FSGuardAction action;
+    uint32_t pathLength;
+
+    //
+    // NOTE: mach absolute time the record was published to the queue, zero if unknown
+    //
+    uint64_t timestamp;
+
+    uint32_t flags;
+    uint32_t generation;
+    uint64_t fsid;
+    uint64_t fileid;
+
+    //
+    // NOTE: process which accesses the file, its name is NUL terminated
+    //
+    pid_t ppid;
+    uid_t uid;
+    char processName[kFGProcessNameSize];
+
+    //
+    // NOTE: mach absolute time the driver stops waiting for the verdict
+    //       and applies the default one, zero if it waits without limit
+    //
+    uint64_t deadline;
+};
+
+struct FSGuardFileIdentity
+{
+    uint64_t fsid;
+    uint64_t fileid;
+    uint32_t generation;
+};
+
+//
+// NOTE: decoded request, filePath points into the record it was decoded from
+//
 struct FSGuardRequest
 {
     void *rid;
     pid_t pid;
     FSGuardAction action;
-    char filePath[PATH_MAX];
+    uint32_t filePathLength;
+    const char *filePath;
+    uint32_t flags;
+    FSGuardFileIdentity identity;
+    pid_t ppid;
+    uid_t uid;
+    const char *processName;
+
+    //
+    // NOTE: mach absolute times of publishing and of the verdict deadline, zero if unknown
+    //
+    uint64_t timestamp;
+    uint64_t deadline;
 };
 
 struct FSGuardResponse
 {
     void *rid;
     bool allow;
+
+    //
+    // NOTE: client does not know the path of omitted path request,
+    //       the driver sends the request again with the path
+    //
+    bool needPath;
+
+    //
+    // NOTE: client dropped the request it could not resolve before the deadline,
+    //       the driver applies the default verdict without waiting for it
+    //
+    bool expired;
+};
+
+//
+// NOTE: bounds the time access is blocked when the client is slow or stalled,
+//       times are milliseconds. Unresolved requests are allowed unless their
+//       action is in failClosedMask. Requests in flight above high watermark
+//       get default verdict without asking until they drop to low watermark.
+//       After stallTimeoutCount timeouts in a row only one request at a time
+//       is sent until the client answers again
+//
+struct FSGuardOverloadPolicy
+{
+    uint32_t maxEnqueueWait;
+    uint32_t minVerdictTimeout;
+    uint32_t maxVerdictTimeout;
+    uint32_t failClosedMask;
+    uint32_t shedHighWatermark;
+    uint32_t shedLowWatermark;
+    uint32_t stallTimeoutCount;
+};
+
+constexpr FSGuardOverloadPolicy kFGDefaultOverloadPolicy =
+{
+    250,    // maxEnqueueWait
+    1000,   // minVerdictTimeout
+    15000,  // maxVerdictTimeout
+    0,      // failClosedMask
+    1024,   // shedHighWatermark
+    256,    // shedLowWatermark
+    4       // stallTimeoutCount
+};
+
+//
+// NOTE: process the driver allows without request and before any path work,
+//       e.g. backup agent or indexer verified by the daemon. Name is required
+//       and should match the process name too, so pid reused by another
+//       program is not trusted. Process name may be set by the program itself
+//
+constexpr uint32_t kFGMaxTrustedProcesses = 4096;
+
+struct FSGuardTrustedProcess
+{
+    pid_t pid;
+    char name[kFGProcessNameSize];
+};
+
+//
+// NOTE: limits requests to watched mounts and subtrees, the driver defers other
+//       vnodes before resolving their paths. Mounts are fsid in the form of
+//       FSGuardFileIdentity::fsid, whole mount is watched. Roots are directories
+//       watched with everything under them. Empty scope watches everything
+//
+constexpr uint32_t kFGMaxWatchedMounts = 64;
+constexpr uint32_t kFGMaxWatchedRoots = 256;
+
+struct FSGuardWatchScope
+{
+    uint32_t mountCount;
+    uint32_t rootCount;
+    uint64_t mounts[kFGMaxWatchedMounts];
+    FSGuardFileIdentity roots[kFGMaxWatchedRoots];
 };
 
 #endif /* FSGuardUserClientInterface_h */
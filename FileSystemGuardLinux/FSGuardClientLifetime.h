@@ -0,0 +1,334 @@
+//
+//  FSGuardClientLifetime.h
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardClientLifetime_h
+#define FSGuardClientLifetime_h
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+
+#include "PointerHashSet.h"
+
+//
+// NOTE: portable model of the user client lifetime protocol of FSGuardService,
+//       standard library primitives stand in for IOKit ones:
+//
+//       - std::shared_mutex is m_userClientLock, it is held only to route and
+//         retain the client, never while the request waits for the verdict
+//       - FSGuardLifetimeClient reference count is OSObject retain/release
+//       - per request condition variable waited on with the client lock is
+//         IOLockSleep on the request, PointerHashSet of waiting requests is WaitList
+//       - abortRequests marks the client closed and wakes every waiter at once
+//         as WaitList::removeEntries does, requests without verdict are sent to
+//         the next client
+//
+struct FSGuardLifetimeRequest
+{
+    uint64_t                pid = 0;
+    bool                    resolved = false;
+    bool                    allow = true;
+    std::condition_variable wakeup;
+};
+
+class FSGuardLifetimeClient
+{
+public:
+    static constexpr uint32_t kWaitListSlotCount = 4096;
+
+    explicit FSGuardLifetimeClient(std::atomic<uint32_t> *liveClients = nullptr)
+        : m_liveClients(liveClients)
+    {
+        if (m_liveClients)
+        {
+            m_liveClients->fetch_add(1);
+        }
+    }
+
+    FSGuardLifetimeClient(const FSGuardLifetimeClient &) = delete;
+    FSGuardLifetimeClient & operator=(const FSGuardLifetimeClient &) = delete;
+
+    void retain()
+    {
+        m_references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release()
+    {
+        if (1 == m_references.fetch_sub(1, std::memory_order_acq_rel))
+        {
+            delete this;
+        }
+    }
+
+    //
+    // NOTE: waits until the daemon answers, the client is closed or the timeout,
+    //       request keeps the default verdict unless resolved
+    //
+    void sendRequest(FSGuardLifetimeRequest &request, std::chrono::steady_clock::duration timeout)
+    {
+        std::unique_lock<std::mutex> lock(m_waitListLock);
+
+        if (m_closed || !m_events.insert(&request))
+        {
+            return;
+        }
+
+        m_queue.push_back(&request);
+        m_queueReady.notify_one();
+
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+        while (!request.resolved && m_events.contains(&request))
+        {
+            if (std::cv_status::timeout == request.wakeup.wait_until(lock, deadline))
+            {
+                break;
+            }
+        }
+
+        //
+        // NOTE: request left without verdict is not handed to the daemon anymore
+        //
+        if (!request.resolved)
+        {
+            std::erase(m_queue, &request);
+        }
+
+        m_events.erase(&request);
+    }
+
+    //
+    // NOTE: daemon side, returns null once the client is closed
+    //
+    FSGuardLifetimeRequest * nextRequest()
+    {
+        std::unique_lock<std::mutex> lock(m_waitListLock);
+
+        m_queueReady.wait(lock, [this] { return m_closed || !m_queue.empty(); });
+
+        if (m_closed)
+        {
+            return nullptr;
+        }
+
+        FSGuardLifetimeRequest *request = m_queue.front();
+        m_queue.pop_front();
+
+        return request;
+    }
+
+    //
+    // NOTE: verdict for the request which stopped waiting is dropped
+    //
+    bool postResponse(FSGuardLifetimeRequest *request, bool allow)
+    {
+        std::lock_guard<std::mutex> lock(m_waitListLock);
+
+        if (!m_events.contains(request))
+        {
+            return false;
+        }
+
+        request->resolved = true;
+        request->allow = allow;
+        m_events.erase(request);
+        request->wakeup.notify_one();
+
+        return true;
+    }
+
+    void abortRequests()
+    {
+        std::lock_guard<std::mutex> lock(m_waitListLock);
+
+        m_closed = true;
+        m_queue.clear();
+        m_queueReady.notify_all();
+
+        m_events.clear([](void *event) {
+            static_cast<FSGuardLifetimeRequest *>(event)->wakeup.notify_one();
+        });
+    }
+
+    bool isClosed() const
+    {
+        std::lock_guard<std::mutex> lock(m_waitListLock);
+
+        return m_closed;
+    }
+
+    uint32_t pendingCount() const
+    {
+        std::lock_guard<std::mutex> lock(m_waitListLock);
+
+        return m_events.size();
+    }
+
+private:
+    ~FSGuardLifetimeClient()
+    {
+        if (m_liveClients)
+        {
+            m_liveClients->fetch_sub(1);
+        }
+    }
+
+private:
+    std::atomic<uint32_t>               m_references {1};
+    std::atomic<uint32_t>              *m_liveClients;
+
+    mutable std::mutex                  m_waitListLock;
+    PointerHashSet<kWaitListSlotCount>  m_events;
+    std::deque<FSGuardLifetimeRequest *> m_queue;
+    std::condition_variable             m_queueReady;
+    bool                                m_closed = false;
+
+};
+
+template <uint32_t MaxClients>
+class FSGuardLifetimeService
+{
+public:
+    static constexpr uint32_t kInvalidSlot = MaxClients;
+
+    explicit FSGuardLifetimeService(std::chrono::steady_clock::duration timeout)
+        : m_timeout(timeout)
+    {
+    }
+
+    ~FSGuardLifetimeService()
+    {
+        for (FSGuardLifetimeClient *&client : m_clients)
+        {
+            if (client)
+            {
+                client->abortRequests();
+                client->release();
+                client = nullptr;
+            }
+        }
+    }
+
+    FSGuardLifetimeService(const FSGuardLifetimeService &) = delete;
+    FSGuardLifetimeService & operator=(const FSGuardLifetimeService &) = delete;
+
+    //
+    // NOTE: service keeps the reference the client is created with
+    //
+    uint32_t newUserClient(FSGuardLifetimeClient *client)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_userClientLock);
+
+        for (uint32_t slot = 0; slot < MaxClients; ++slot)
+        {
+            if (!m_clients[slot])
+            {
+                m_clients[slot] = client;
+                return slot;
+            }
+        }
+
+        return kInvalidSlot;
+    }
+
+    void handleClose(uint32_t slot)
+    {
+        FSGuardLifetimeClient *closedClient = nullptr;
+
+        {
+            std::unique_lock<std::shared_mutex> lock(m_userClientLock);
+
+            closedClient = m_clients[slot];
+            m_clients[slot] = nullptr;
+        }
+
+        //
+        // NOTE: no new request reaches the client, pending ones are woken at once
+        //       and sent to the remaining clients. Requests retain the client
+        //
+        if (closedClient)
+        {
+            closedClient->abortRequests();
+            closedClient->release();
+        }
+    }
+
+    //
+    // NOTE: returns true if some client answered, request closed by its client
+    //       is tried on the next one
+    //
+    bool processRequest(FSGuardLifetimeRequest &request)
+    {
+        for (uint32_t attempt = 0; attempt < MaxClients; ++attempt)
+        {
+            FSGuardLifetimeClient *client = retainUserClient(request.pid);
+            if (!client)
+            {
+                break;
+            }
+
+            client->sendRequest(request, m_timeout);
+
+            const bool closed = client->isClosed();
+            client->release();
+
+            if (request.resolved || !closed)
+            {
+                break;
+            }
+        }
+
+        return request.resolved;
+    }
+
+private:
+    //
+    // NOTE: requests of one process go to the same client
+    //
+    FSGuardLifetimeClient * retainUserClient(uint64_t pid)
+    {
+        std::shared_lock<std::shared_mutex> lock(m_userClientLock);
+
+        uint32_t count = 0;
+        for (FSGuardLifetimeClient *client : m_clients)
+        {
+            count += nullptr != client;
+        }
+
+        if (!count)
+        {
+            return nullptr;
+        }
+
+        uint32_t index = static_cast<uint32_t>(pid % count);
+        for (FSGuardLifetimeClient *client : m_clients)
+        {
+            if (client && 0 == index--)
+            {
+                client->retain();
+                return client;
+            }
+        }
+
+        return nullptr;
+    }
+
+private:
+    std::shared_mutex                   m_userClientLock;
+    FSGuardLifetimeClient              *m_clients[MaxClients] {};
+    std::chrono::steady_clock::duration m_timeout;
+
+};
+
+#endif /* FSGuardClientLifetime_h */
@@ -0,0 +1,569 @@
+//
+//  FSGuardFanotifyClient.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardFanotifyClient.h"
+#include "FSGuardRequestCodec.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/eventfd.h>
+#include <sys/fanotify.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include <time.h>
+
+#include <algorithm>
+
+#ifndef FAN_OPEN_EXEC_PERM
+#define FAN_OPEN_EXEC_PERM 0x00040000
+#endif
+
+const uint64_t kFGFanotifyDefaultMask = FAN_OPEN_PERM | FAN_OPEN_EXEC_PERM;
+
+//
+// NOTE: one read returns as many queued events as fit into the buffer
+//
+constexpr size_t kFGFanotifyReadBufferSize = 64 * 1024;
+
+//
+// NOTE: fanotify takes one response per write, writev batches them into one syscall
+//
+constexpr size_t kFGFanotifyMaxResponseBatch = IOV_MAX;
+
+static uint64_t GetMonotonicNanoseconds()
+{
+    timespec now = {};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + static_cast<uint64_t>(now.tv_nsec);
+}
+
+static void * EventRequestId(int fd, uint32_t sequence)
+{
+    return reinterpret_cast<void *>(static_cast<uintptr_t>(sequence) << 32 | static_cast<uint32_t>(fd));
+}
+
+static int EventDescriptor(void *rid)
+{
+    return static_cast<int>(static_cast<uint32_t>(reinterpret_cast<uintptr_t>(rid)));
+}
+
+//
+// NOTE: fanotify has no write permission events, opens are reported as reads
+//
+static FSGuardAction EventAction(uint64_t mask)
+{
+    if (mask & FAN_OPEN_EXEC_PERM)
+    {
+        return FSGuardAction::Execute;
+    }
+
+    return FSGuardAction::Read;
+}
+
+//
+// NOTE: "pid (name) state ppid ..." from /proc, the owner of the file is
+//       effective uid of the process. Name may contain ')', the last one ends it
+//
+static void ReadProcessAttribution(pid_t pid, FSGuardRequest &request, char (&name)[kFGProcessNameSize])
+{
+    char statPath[32];
+    snprintf(statPath, sizeof(statPath), "/proc/%d/stat", pid);
+
+    const int fd = ::open(statPath, O_RDONLY | O_CLOEXEC);
+    if (-1 == fd)
+    {
+        return;
+    }
+
+    struct stat status = {};
+    if (0 == fstat(fd, &status))
+    {
+        request.uid = status.st_uid;
+    }
+
+    char buffer[512];
+    const ssize_t size = read(fd, buffer, sizeof(buffer) - 1);
+    ::close(fd);
+
+    if (size <= 0)
+    {
+        return;
+    }
+
+    buffer[size] = '\0';
+
+    const char *nameBegin = strchr(buffer, '(');
+    const char *nameEnd = strrchr(buffer, ')');
+    if (!nameBegin || !nameEnd || nameEnd < nameBegin)
+    {
+        return;
+    }
+
+    const size_t nameLength = std::min<size_t>(nameEnd - nameBegin - 1, sizeof(name) - 1);
+    memcpy(name, nameBegin + 1, nameLength);
+    name[nameLength] = '\0';
+    request.processName = name;
+
+    char state = 0;
+    int ppid = 0;
+    if (2 == sscanf(nameEnd + 1, " %c %d", &state, &ppid))
+    {
+        request.ppid = ppid;
+    }
+}
+
+FSGuardFanotifyClient::FSGuardFanotifyClient(FSGuardFanotifyDelegate &delegate, uint64_t verdictTimeout)
+: m_delegate(delegate)
+, m_fanotify(-1)
+, m_wakeup(-1)
+, m_eventMask(0)
+, m_verdictTimeout(verdictTimeout)
+, m_stop(false)
+, m_sequence(0)
+, m_record(kFGMaxRequestRecordSize)
+{
+}
+
+FSGuardFanotifyClient::~FSGuardFanotifyClient()
+{
+    close();
+}
+
+bool FSGuardFanotifyClient::open(uint64_t eventMask)
+{
+    if (-1 != m_fanotify)
+    {
+        return false;
+    }
+
+    const int fanotify = fanotify_init(FAN_CLASS_CONTENT | FAN_CLOEXEC | FAN_NONBLOCK, O_RDONLY | O_LARGEFILE | O_CLOEXEC);
+    if (-1 == fanotify)
+    {
+        fprintf(stderr, "fanotify_init failed - %s\n", strerror(errno));
+        return false;
+    }
+
+    return attach(fanotify, eventMask);
+}
+
+bool FSGuardFanotifyClient::attach(int fanotify, uint64_t eventMask)
+{
+    if (-1 != m_fanotify)
+    {
+        return false;
+    }
+
+    m_fanotify = fanotify;
+
+    //
+    // NOTE: the reader drains the descriptor until it would block
+    //
+    const int flags = fcntl(m_fanotify, F_GETFL);
+    if (-1 == flags || -1 == fcntl(m_fanotify, F_SETFL, flags | O_NONBLOCK))
+    {
+        fprintf(stderr, "fcntl failed - %s\n", strerror(errno));
+        close();
+        return false;
+    }
+
+    m_wakeup = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (-1 == m_wakeup)
+    {
+        fprintf(stderr, "eventfd failed - %s\n", strerror(errno));
+        close();
+        return false;
+    }
+
+    m_eventMask = eventMask;
+    m_stop = false;
+
+    return true;
+}
+
+bool FSGuardFanotifyClient::addMount(const char *path)
+{
+    if (0 != fanotify_mark(m_fanotify, FAN_MARK_ADD | FAN_MARK_MOUNT, m_eventMask, AT_FDCWD, path))
+    {
+        fprintf(stderr, "fanotify_mark failed for %s - %s\n", path, strerror(errno));
+        return false;
+    }
+
+    return true;
+}
+
+bool FSGuardFanotifyClient::run()
+{
+    std::vector<uint8_t> buffer(kFGFanotifyReadBufferSize);
+
+    pollfd descriptors[2] = {};
+    descriptors[0].fd = m_fanotify;
+    descriptors[0].events = POLLIN;
+    descriptors[1].fd = m_wakeup;
+    descriptors[1].events = POLLIN;
+
+    bool result = true;
+    int timeout = -1;
+
+    while (result && !m_stop)
+    {
+        if (-1 == poll(descriptors, 2, timeout))
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            fprintf(stderr, "poll failed - %s\n", strerror(errno));
+            result = false;
+            break;
+        }
+
+        if (descriptors[1].revents & POLLIN)
+        {
+            uint64_t value = 0;
+            (void)read(m_wakeup, &value, sizeof(value));
+        }
+
+        if (descriptors[0].revents & POLLIN)
+        {
+            //
+            // NOTE: drain everything queued, each read is a batch of events
+            //
+            for (;;)
+            {
+                const ssize_t size = read(m_fanotify, buffer.data(), buffer.size());
+                if (size <= 0)
+                {
+                    if (size < 0 && EAGAIN != errno && EINTR != errno)
+                    {
+                        fprintf(stderr, "read failed - %s\n", strerror(errno));
+                        result = false;
+                    }
+
+                    break;
+                }
+
+                handleEvents(buffer.data(), static_cast<size_t>(size));
+
+                //
+                // NOTE: verdicts of the batch are written before reading the next one
+                //
+                flushResponses();
+            }
+        }
+
+        timeout = expireEvents(GetMonotonicNanoseconds());
+        flushResponses();
+    }
+
+    //
+    // NOTE: never leave access blocked, pending events are allowed on exit.
+    //       They are taken out first, so late delegate response is rejected
+    //       instead of answering and closing the descriptor twice
+    //
+    {
+        std::lock_guard<std::mutex> lock(m_responsesLock);
+
+        std::unordered_map<int, void *> pendingEvents;
+        pendingEvents.swap(m_pendingEvents);
+        m_deadlines.clear();
+
+        for (const auto &event : pendingEvents)
+        {
+            m_responses.push_back(FSGuardResponse { event.second, true, false, false });
+        }
+    }
+
+    flushResponses();
+
+    return result;
+}
+
+void FSGuardFanotifyClient::stop()
+{
+    m_stop = true;
+
+    const uint64_t value = 1;
+    (void)write(m_wakeup, &value, sizeof(value));
+}
+
+bool FSGuardFanotifyClient::loadPolicy(const void *policy, size_t size)
+{
+    std::lock_guard<std::mutex> lock(m_policyLock);
+
+    if (!policy)
+    {
+        m_policy = FSGuardPolicy();
+        m_policyData.clear();
+        return true;
+    }
+
+    std::vector<uint8_t> data(static_cast<const uint8_t *>(policy), static_cast<const uint8_t *>(policy) + size);
+
+    FSGuardPolicy newPolicy;
+    if (!newPolicy.load(data.data(), data.size()))
+    {
+        return false;
+    }
+
+    //
+    // NOTE: moved vector keeps its buffer, so loaded policy stays valid
+    //
+    m_policyData = std::move(data);
+    m_policy = newPolicy;
+
+    return true;
+}
+
+bool FSGuardFanotifyClient::postResponse(const FSGuardResponse &response)
+{
+    bool wakeup = false;
+
+    {
+        std::lock_guard<std::mutex> lock(m_responsesLock);
+
+        //
+        // NOTE: stale or forged request id never closes unrelated descriptor
+        //
+        const auto event = m_pendingEvents.find(EventDescriptor(response.rid));
+        if (m_pendingEvents.end() == event || response.rid != event->second)
+        {
+            return false;
+        }
+
+        m_pendingEvents.erase(event);
+
+        wakeup = m_responses.empty();
+        m_responses.push_back(response);
+    }
+
+    //
+    // NOTE: responses posted from the reader thread are flushed after the batch
+    //
+    if (wakeup)
+    {
+        const uint64_t value = 1;
+        (void)write(m_wakeup, &value, sizeof(value));
+    }
+
+    return true;
+}
+
+int FSGuardFanotifyClient::expireEvents(uint64_t now)
+{
+    std::lock_guard<std::mutex> lock(m_responsesLock);
+
+    while (!m_deadlines.empty())
+    {
+        const EventDeadline &front = m_deadlines.front();
+
+        const auto event = m_pendingEvents.find(EventDescriptor(front.rid));
+        if (m_pendingEvents.end() != event && front.rid == event->second)
+        {
+            if (front.deadline > now)
+            {
+                //
+                // NOTE: rounded up, poll should not wake before the deadline
+                //
+                return static_cast<int>(std::min<uint64_t>((front.deadline - now + 999999) / 1000000, INT_MAX));
+            }
+
+            m_pendingEvents.erase(event);
+            m_responses.push_back(FSGuardResponse { front.rid, true, false, false });
+        }
+
+        m_deadlines.pop_front();
+    }
+
+    return -1;
+}
+
+bool FSGuardFanotifyClient::handleEvents(const uint8_t *buffer, size_t size)
+{
+    const fanotify_event_metadata *metadata = reinterpret_cast<const fanotify_event_metadata *>(buffer);
+    ssize_t length = static_cast<ssize_t>(size);
+
+    for (; FAN_EVENT_OK(metadata, length); metadata = FAN_EVENT_NEXT(metadata, length))
+    {
+        if (FANOTIFY_METADATA_VERSION != metadata->vers)
+        {
+            fprintf(stderr, "unexpected fanotify metadata version %u\n", metadata->vers);
+            return false;
+        }
+
+        if (FAN_NOFD == metadata->fd)
+        {
+            continue;
+        }
+
+        handleEvent(metadata->fd, metadata->pid, metadata->mask);
+    }
+
+    return true;
+}
+
+void FSGuardFanotifyClient::handleEvent(int fd, pid_t pid, uint64_t mask)
+{
+    const uint64_t now = GetMonotonicNanoseconds();
+
+    void *rid = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_responsesLock);
+
+        rid = EventRequestId(fd, ++m_sequence);
+        m_pendingEvents[fd] = rid;
+        m_deadlines.push_back(EventDeadline { rid, now + m_verdictTimeout });
+    }
+
+    const FSGuardResponse allow { rid, true, false, false };
+
+    //
+    // NOTE: pass through own requests, like the driver does for the daemon
+    //
+    if (pid == getpid() || !(mask & (FAN_OPEN_PERM | FAN_OPEN_EXEC_PERM | FAN_ACCESS_PERM)))
+    {
+        postResponse(allow);
+        return;
+    }
+
+    char path[PATH_MAX];
+    char link[32];
+    snprintf(link, sizeof(link), "/proc/self/fd/%d", fd);
+
+    const ssize_t pathLength = readlink(link, path, sizeof(path) - 1);
+    if (pathLength <= 0)
+    {
+        postResponse(allow);
+        return;
+    }
+
+    FSGuardRequest request = {};
+    request.rid = rid;
+    request.pid = pid;
+    request.action = EventAction(mask);
+    request.filePath = path;
+    request.filePathLength = static_cast<uint32_t>(pathLength);
+    request.timestamp = now;
+    request.deadline = now + m_verdictTimeout;
+
+    FSGuardPolicyVerdict verdict = FSGuardPolicyVerdict::NoMatch;
+    {
+        std::lock_guard<std::mutex> lock(m_policyLock);
+        verdict = m_policy.evaluate(path, request.filePathLength, request.action);
+    }
+
+    if (FSGuardPolicyVerdict::Allow == verdict || FSGuardPolicyVerdict::Deny == verdict)
+    {
+        postResponse(FSGuardResponse { request.rid, FSGuardPolicyVerdict::Allow == verdict, false, false });
+        return;
+    }
+
+    //
+    // NOTE: only requests going to the delegate pay for reading /proc
+    //
+    char processName[kFGProcessNameSize] = {};
+    ReadProcessAttribution(pid, request, processName);
+
+    //
+    // NOTE: delegate gets the same record the driver produces
+    //
+    uint32_t recordSize = 0;
+    FSGuardRequest decoded = {};
+    if (!FSGuardEncodeRequest(request, m_record.data(), m_record.size(), recordSize) ||
+        !FSGuardDecodeRequest(m_record.data(), recordSize, decoded))
+    {
+        postResponse(allow);
+        return;
+    }
+
+    m_delegate.resolveRequest(decoded);
+}
+
+bool FSGuardFanotifyClient::flushResponses()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_responsesLock);
+
+        if (m_responses.empty())
+        {
+            return true;
+        }
+
+        m_flushing.swap(m_responses);
+    }
+
+    std::vector<fanotify_response> responses(m_flushing.size());
+    std::vector<iovec> vectors(m_flushing.size());
+
+    for (size_t index = 0; index < m_flushing.size(); ++index)
+    {
+        responses[index].fd = EventDescriptor(m_flushing[index].rid);
+        responses[index].response = m_flushing[index].allow ? FAN_ALLOW : FAN_DENY;
+
+        vectors[index].iov_base = &responses[index];
+        vectors[index].iov_len = sizeof(fanotify_response);
+    }
+
+    bool result = true;
+
+    for (size_t offset = 0; offset < vectors.size();)
+    {
+        const size_t count = std::min(kFGFanotifyMaxResponseBatch, vectors.size() - offset);
+
+        const ssize_t written = writev(m_fanotify, &vectors[offset], static_cast<int>(count));
+        if (written > 0)
+        {
+            offset += static_cast<size_t>(written) / sizeof(fanotify_response);
+            continue;
+        }
+
+        if (written < 0 && EINTR == errno)
+        {
+            continue;
+        }
+
+        //
+        // NOTE: writev stops at the first rejected response, skip it and go on with the rest
+        //
+        fprintf(stderr, "writev failed for fd %d - %s\n", responses[offset].fd, strerror(errno));
+        result = false;
+        ++offset;
+    }
+
+    for (const fanotify_response &response : responses)
+    {
+        ::close(response.fd);
+    }
+
+    m_flushing.clear();
+
+    return result;
+}
+
+void FSGuardFanotifyClient::close()
+{
+    if (-1 != m_wakeup)
+    {
+        ::close(m_wakeup);
+        m_wakeup = -1;
+    }
+
+    if (-1 != m_fanotify)
+    {
+        ::close(m_fanotify);
+        m_fanotify = -1;
+    }
+}
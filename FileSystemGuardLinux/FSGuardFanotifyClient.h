@@ -0,0 +1,142 @@
+//
+//  FSGuardFanotifyClient.h
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardFanotifyClient_h
+#define FSGuardFanotifyClient_h
+
+#include <stdint.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "FSGuardUserClientInterface.h"
+#include "FSGuardPolicy.h"
+
+//
+// NOTE: fanotify permission events the client listens to by default
+//
+extern const uint64_t kFGFanotifyDefaultMask;
+
+//
+// NOTE: fanotify waits for the verdict forever, the client allows the event itself
+//       after this many nanoseconds, the longest verdict timeout of the driver
+//
+constexpr uint64_t kFGFanotifyVerdictTimeout = 15000000000ull;
+
+class FSGuardFanotifyDelegate
+{
+public:
+    virtual ~FSGuardFanotifyDelegate() = default;
+
+    //
+    // NOTE: called on the reader thread, request and its file path are valid
+    //       only until the method returns. Verdict is posted with
+    //       FSGuardFanotifyClient::postResponse from any thread
+    //
+    virtual void resolveRequest(const FSGuardRequest &request) = 0;
+};
+
+//
+// NOTE: Linux counterpart of FSGuardClient built on fanotify permission events.
+//
+//       Events are read in batches, encoded to the same FSGuardRequestRecord the driver
+//       sends and decided by the loaded FSGuardPolicy or by the delegate. Verdicts are
+//       FSGuardResponse with the event descriptor and its sequence as request id,
+//       they are written back in batches by the reader thread with a single writev call.
+//
+//       Request timestamp and deadline are CLOCK_MONOTONIC nanoseconds, events without
+//       verdict at their deadline are allowed and later verdicts for them are rejected.
+//
+class FSGuardFanotifyClient
+{
+public:
+    explicit FSGuardFanotifyClient(FSGuardFanotifyDelegate &delegate, uint64_t verdictTimeout = kFGFanotifyVerdictTimeout);
+    ~FSGuardFanotifyClient();
+
+    FSGuardFanotifyClient(const FSGuardFanotifyClient &) = delete;
+    FSGuardFanotifyClient & operator=(const FSGuardFanotifyClient &) = delete;
+
+    //
+    // NOTE: mask of FAN_*_PERM events, requires CAP_SYS_ADMIN
+    //
+    bool open(uint64_t eventMask = kFGFanotifyDefaultMask);
+    bool addMount(const char *path);
+
+    //
+    // NOTE: takes ownership of fanotify descriptor initialized elsewhere, for example
+    //       by a privileged helper, or of any descriptor speaking the same protocol
+    //
+    bool attach(int fanotify, uint64_t eventMask = kFGFanotifyDefaultMask);
+
+    //
+    // NOTE: reads and resolves events until stop is called
+    //
+    bool run();
+    void stop();
+
+    //
+    // NOTE: blob compiled by FSGuardPolicyBuilder, requests decided by the policy
+    //       do not reach the delegate, null policy removes it
+    //
+    bool loadPolicy(const void *policy, size_t size);
+
+    bool postResponse(const FSGuardResponse &response);
+
+private:
+    bool handleEvents(const uint8_t *buffer, size_t size);
+    void handleEvent(int fd, pid_t pid, uint64_t mask);
+    bool flushResponses();
+
+    //
+    // NOTE: allows events past their deadline, returns milliseconds
+    //       until the next deadline or -1 if no event is pending
+    //
+    int expireEvents(uint64_t now);
+
+    void close();
+
+private:
+    FSGuardFanotifyDelegate &m_delegate;
+
+    int               m_fanotify;
+    int               m_wakeup;
+    uint64_t          m_eventMask;
+    uint64_t          m_verdictTimeout;
+    std::atomic<bool> m_stop;
+
+    //
+    // NOTE: request ids of event descriptors waiting for verdict and verdicts
+    //       to be written. Descriptor number is reused once it is closed, the
+    //       sequence in the id tells its events apart. Deadlines are in the order
+    //       of events, entries of answered events are dropped when they come first
+    //
+    struct EventDeadline
+    {
+        void     *rid;
+        uint64_t  deadline;
+    };
+
+    std::mutex                         m_responsesLock;
+    std::unordered_map<int, void *>    m_pendingEvents;
+    std::deque<EventDeadline>          m_deadlines;
+    uint32_t                           m_sequence;
+    std::vector<FSGuardResponse>       m_responses;
+    std::vector<FSGuardResponse>       m_flushing;
+
+    std::mutex           m_policyLock;
+    std::vector<uint8_t> m_policyData;
+    FSGuardPolicy        m_policy;
+
+    std::vector<uint8_t> m_record;
+
+};
+
+#endif /* FSGuardFanotifyClient_h */
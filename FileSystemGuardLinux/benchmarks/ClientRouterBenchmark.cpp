@@ -0,0 +1,173 @@
+//
+//  ClientRouterBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "ClientRouter.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+//
+// NOTE: stands in for a user client, its reference count and the lock of its
+//       queue and wait list, each on own cache line like separate objects
+//
+struct ClientShard
+{
+    alignas(64) std::atomic<uint32_t> references {0};
+    alignas(64) std::mutex            lock;
+    uint64_t                          queued = 0;
+};
+
+//
+// NOTE: path of a request through retainUserClient and sendFSGuardRequest, the
+//       route under the shared client lock, retain, enqueue under the lock of the
+//       client and release. Every producer thread is a process with own pids
+//
+static void MeasureProducers(uint32_t producers, uint32_t clients)
+{
+    constexpr uint32_t kRequests = 2000000;
+    constexpr uint32_t kSlots = 16;
+
+    ClientRouter<kSlots> router;
+    for (uint32_t index = 0; index < clients; ++index)
+    {
+        router.add(kFGActionMaskAll);
+    }
+
+    std::shared_mutex userClientLock;
+    std::unique_ptr<ClientShard[]> shards(new ClientShard[kSlots]);
+
+    const uint32_t requestsPerProducer = kRequests / producers;
+    std::atomic<uint32_t> ready {0};
+    std::atomic<bool> start {false};
+    std::vector<std::thread> threads;
+
+    for (uint32_t producer = 0; producer < producers; ++producer)
+    {
+        threads.emplace_back([&, producer] {
+            ++ready;
+            while (!start.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+
+            for (uint32_t index = 0; index < requestsPerProducer; ++index)
+            {
+                const uint64_t pid = producer * 64 + index % 64;
+                uint32_t slot = 0;
+
+                {
+                    std::shared_lock<std::shared_mutex> lock(userClientLock);
+
+                    slot = router.route(FSGuardAction::Read, pid);
+                    shards[slot].references.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(shards[slot].lock);
+                    ++shards[slot].queued;
+                }
+
+                shards[slot].references.fetch_sub(1, std::memory_order_release);
+            }
+        });
+    }
+
+    while (ready.load() < producers)
+    {
+        std::this_thread::yield();
+    }
+
+    const auto startTime = std::chrono::steady_clock::now();
+    start.store(true, std::memory_order_release);
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    const double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+    const uint64_t total = static_cast<uint64_t>(requestsPerProducer) * producers;
+
+    uint64_t busiest = 0;
+    for (uint32_t slot = 0; slot < kSlots; ++slot)
+    {
+        busiest = std::max(busiest, shards[slot].queued);
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "route+enqueue, %u producers, %u clients", producers, clients);
+
+    //
+    // NOTE: busiest client against the even share, 1.00 is a perfect spread
+    //
+    printf("%-48s %10.1f ns/op %8.2f M requests/s  busiest client %.2fx\n", name, nanoseconds / total,
+           total * 1e3 / nanoseconds, static_cast<double>(busiest) * clients / total);
+}
+
+int main()
+{
+    constexpr uint32_t kIterations = 5000000;
+
+    //
+    // NOTE: every slot is scanned, weights are computed only for subscribed clients
+    //
+    for (uint32_t clients : { 1u, 4u, 16u })
+    {
+        ClientRouter<16> router;
+        for (uint32_t index = 0; index < clients; ++index)
+        {
+            router.add(kFGActionMaskAll);
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "route, 16 slots, %u clients", clients);
+
+        FSGuardBenchmark(name, kIterations, [&](uint64_t iteration) {
+            FSGuardKeep(router.route(FSGuardAction::Read, iteration));
+        });
+    }
+
+    ClientRouter<32> router;
+    for (uint32_t index = 0; index < 32; ++index)
+    {
+        router.add(kFGActionMaskAll);
+    }
+
+    FSGuardBenchmark("route, 32 slots, 32 clients", kIterations, [&](uint64_t iteration) {
+        FSGuardKeep(router.route(FSGuardAction::Read, iteration));
+    });
+
+    FSGuardBenchmark("subscription mask, 32 slots", kIterations, [&](uint64_t) {
+        FSGuardKeep(router.mask());
+    });
+
+    //
+    // NOTE: one client funnels every producer through one queue lock, more clients
+    //       split them. No CPU pinning, producers are scheduled by the system
+    //
+    for (uint32_t clients : { 1u, 4u, 16u })
+    {
+        for (uint32_t producers : { 1u, 4u, 16u, 64u })
+        {
+            MeasureProducers(producers, clients);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,245 @@
+//
+//  FAFChannelBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FAFChannel.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+
+static const char kPath[] = "/Users/user/Documents/Projects/Example/Sources/main.cpp";
+
+static const size_t kChannelSize = FAFChannel::memorySize(kFAFChannelRequestCapacity, kFAFChannelVerdictCapacity);
+
+//
+// NOTE: shared memory of the channel, descriptor is what the filter passes to the resolver
+//
+static int CreateChannelMemory()
+{
+    const int memory = memfd_create("faf-channel", MFD_CLOEXEC);
+    if (-1 != memory && 0 != ftruncate(memory, static_cast<off_t>(kChannelSize)))
+    {
+        close(memory);
+        return -1;
+    }
+
+    return memory;
+}
+
+static void * MapChannelMemory(int memory)
+{
+    void *const mapping = mmap(nullptr, kChannelSize, PROT_READ | PROT_WRITE, MAP_SHARED, memory, 0);
+
+    return MAP_FAILED != mapping ? mapping : nullptr;
+}
+
+//
+// NOTE: resolver process, answers every request until the filter closes the doorbell
+//
+static int RunResolver(int memory, int doorbellFd)
+{
+    FAFChannel resolver;
+    if (!resolver.attach(MapChannelMemory(memory), kChannelSize))
+    {
+        return 1;
+    }
+
+    const FAFDoorbell doorbell(doorbellFd);
+
+    for (;;)
+    {
+        if (resolver.requests().empty() && resolver.requests().prepareToWait())
+        {
+            if (!doorbell.wait())
+            {
+                return 0;
+            }
+
+            continue;
+        }
+
+        resolver.requests().read([&](const void *payload, uint32_t) {
+            FAFVerdictFrame *verdict = static_cast<FAFVerdictFrame *>(resolver.verdicts().allocate(sizeof(FAFVerdictFrame)));
+            *verdict = { static_cast<const FAFRequestFrame *>(payload)->id, 1, 0 };
+        });
+        resolver.requests().release();
+
+        if (resolver.verdicts().commit())
+        {
+            doorbell.ring();
+        }
+    }
+}
+
+static bool MeasureProcesses(uint32_t batchSize)
+{
+    constexpr uint64_t kEvents = 200000;
+
+    const int memory = CreateChannelMemory();
+    void *const mapping = -1 != memory ? MapChannelMemory(memory) : nullptr;
+
+    FAFChannel filter;
+    int filterFd = -1;
+    int resolverFd = -1;
+
+    if (!mapping ||
+        !filter.create(mapping, kChannelSize, kFAFChannelRequestCapacity, kFAFChannelVerdictCapacity) ||
+        !FAFDoorbell::createPair(filterFd, resolverFd))
+    {
+        return false;
+    }
+
+    fflush(stdout);
+
+    const pid_t child = fork();
+    if (-1 == child)
+    {
+        return false;
+    }
+
+    if (0 == child)
+    {
+        close(filterFd);
+        _exit(RunResolver(memory, resolverFd));
+    }
+
+    close(resolverFd);
+
+    const FAFDoorbell doorbell(filterFd);
+    uint64_t rings = 0;
+    uint64_t allowed = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t next = 0; next < kEvents; )
+    {
+        uint32_t batch = 0;
+        for (; batch < batchSize && next < kEvents; ++batch, ++next)
+        {
+            FAFRequestFrame *frame = static_cast<FAFRequestFrame *>(filter.requests().allocate(sizeof(FAFRequestFrame) + sizeof(kPath)));
+            *frame = { next, 1, 1, sizeof(kPath) - 1, 0 };
+            memcpy(frame + 1, kPath, sizeof(kPath));
+        }
+
+        if (filter.requests().commit())
+        {
+            doorbell.ring();
+            ++rings;
+        }
+
+        for (uint32_t received = 0; received < batch; )
+        {
+            const uint32_t count = filter.verdicts().read([&](const void *payload, uint32_t) {
+                allowed += static_cast<const FAFVerdictFrame *>(payload)->allow;
+            });
+            filter.verdicts().release();
+
+            received += count;
+
+            if (!count && filter.verdicts().prepareToWait() && !doorbell.wait())
+            {
+                return false;
+            }
+        }
+    }
+
+    const auto duration = std::chrono::steady_clock::now() - start;
+
+    close(filterFd);
+
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    munmap(mapping, kChannelSize);
+    close(memory);
+
+    const double seconds = std::chrono::duration<double>(duration).count();
+
+    char name[64];
+    snprintf(name, sizeof(name), "two processes over memfd, batch of %u", batchSize);
+
+    printf("%-48s %10.0f events/s %8.1f ns/event %8.3f doorbells/batch\n", name, kEvents / seconds,
+           seconds * 1e9 / kEvents, static_cast<double>(rings) * batchSize / kEvents);
+
+    return kEvents == allowed && WIFEXITED(status) && 0 == WEXITSTATUS(status);
+}
+
+int main()
+{
+    constexpr uint32_t kRequests = 2000000;
+
+    const int memory = CreateChannelMemory();
+    void *const mapping = -1 != memory ? MapChannelMemory(memory) : nullptr;
+
+    FAFChannel filter;
+    FAFChannel resolver;
+    if (!filter.create(mapping, kChannelSize, kFAFChannelRequestCapacity, kFAFChannelVerdictCapacity) ||
+        !resolver.attach(mapping, kChannelSize))
+    {
+        return 1;
+    }
+
+    //
+    // NOTE: request and verdict of every frame pass both rings on one thread,
+    //       cost of the rings alone
+    //
+    for (uint32_t batchSize : { 1u, 32u })
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "request+verdict round trip, batch of %u", batchSize);
+
+        FSGuardBenchmark(name, kRequests / batchSize, [&](uint64_t iteration) {
+            for (uint32_t index = 0; index < batchSize; ++index)
+            {
+                FAFRequestFrame *frame = static_cast<FAFRequestFrame *>(filter.requests().allocate(sizeof(FAFRequestFrame) + sizeof(kPath)));
+                *frame = { iteration * batchSize + index, 1, 1, sizeof(kPath) - 1, 0 };
+                memcpy(frame + 1, kPath, sizeof(kPath));
+            }
+
+            filter.requests().commit();
+
+            resolver.requests().read([&](const void *payload, uint32_t) {
+                FAFVerdictFrame *verdict = static_cast<FAFVerdictFrame *>(resolver.verdicts().allocate(sizeof(FAFVerdictFrame)));
+                *verdict = { static_cast<const FAFRequestFrame *>(payload)->id, 1, 0 };
+            });
+            resolver.requests().release();
+            resolver.verdicts().commit();
+
+            filter.verdicts().read([](const void *payload, uint32_t) {
+                FSGuardKeep(static_cast<const FAFVerdictFrame *>(payload)->allow);
+            });
+            filter.verdicts().release();
+        }, batchSize);
+    }
+
+    //
+    // NOTE: filter and resolver in two processes over memfd memory, the resolver maps
+    //       it from the descriptor like the app maps the one passed by the daemon.
+    //       Each batch is published at once and the filter waits for its verdicts
+    //       before the next one, both sides sleep on the socket doorbell when idle
+    //
+    for (uint32_t batchSize : { 1u, 8u, 32u, 128u, 512u })
+    {
+        if (!MeasureProcesses(batchSize))
+        {
+            return 1;
+        }
+    }
+
+    munmap(mapping, kChannelSize);
+    close(memory);
+
+    return 0;
+}
@@ -0,0 +1,125 @@
+//
+//  FAFPolicySnapshotBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: decision latency of the daemon with the app rules loaded,
+//       the path the daemon takes instead of asking the app
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FAFPolicySnapshot.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    constexpr uint32_t kIterations = 2000000;
+    constexpr uint32_t kRead = FSGuardActionMask(FSGuardAction::Read);
+    constexpr uint32_t kWrite = FSGuardActionMask(FSGuardAction::Write);
+
+    const std::string matched = "/Users/user/Protected/dir17/Projects/Example/Sources/main.cpp";
+    const std::string unmatched = "/Users/user/Library/Caches/Example/Cache.db";
+
+    for (uint32_t ruleCount : { 10u, 1000u, 10000u })
+    {
+        FAFPolicySnapshotBuilder builder;
+        for (uint32_t index = 0; index < ruleCount; ++index)
+        {
+            builder.addRule("/Users/user/Protected/dir" + std::to_string(index), kRead, kWrite);
+        }
+
+        const std::vector<uint8_t> snapshot = builder.build(1);
+
+        FAFPolicyEvaluator evaluator;
+        if (!evaluator.load(snapshot.data(), snapshot.size()))
+        {
+            return 1;
+        }
+
+        char name[64];
+
+        snprintf(name, sizeof(name), "evaluate matching path, %u rules", ruleCount);
+        FSGuardBenchmark(name, kIterations, [&](uint64_t) {
+            FSGuardKeep(evaluator.evaluate(matched.data(), static_cast<uint32_t>(matched.size()), kRead | kWrite));
+        });
+
+        snprintf(name, sizeof(name), "evaluate unmatched path, %u rules", ruleCount);
+        FSGuardBenchmark(name, kIterations, [&](uint64_t) {
+            FSGuardKeep(evaluator.evaluate(unmatched.data(), static_cast<uint32_t>(unmatched.size()), kRead));
+        });
+
+        snprintf(name, sizeof(name), "load snapshot, %u rules", ruleCount);
+        FSGuardBenchmark(name, 20000000 / ruleCount / 10, [&](uint64_t) {
+            FSGuardKeep(evaluator.load(snapshot.data(), snapshot.size()));
+        });
+    }
+
+    //
+    // NOTE: readers evaluating while the app pushes a snapshot every millisecond
+    //
+    FAFPolicySnapshotBuilder builder;
+    for (uint32_t index = 0; index < 1000; ++index)
+    {
+        builder.addRule("/Users/user/Protected/dir" + std::to_string(index), kRead, kWrite);
+    }
+
+    const std::vector<uint8_t> snapshot = builder.build(1);
+
+    FAFPolicyEvaluator evaluator;
+    evaluator.load(snapshot.data(), snapshot.size());
+
+    for (uint32_t readerCount : { 1u, 4u })
+    {
+        std::atomic<bool> done {false};
+        std::thread writer([&] {
+            while (!done.load(std::memory_order_relaxed))
+            {
+                evaluator.load(snapshot.data(), snapshot.size());
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+
+        std::vector<std::thread> readers;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t reader = 0; reader < readerCount; ++reader)
+        {
+            readers.emplace_back([&] {
+                for (uint32_t index = 0; index < kIterations / readerCount; ++index)
+                {
+                    FSGuardKeep(evaluator.evaluate(matched.data(), static_cast<uint32_t>(matched.size()), kRead));
+                }
+            });
+        }
+
+        for (std::thread &reader : readers)
+        {
+            reader.join();
+        }
+
+        const auto duration = std::chrono::steady_clock::now() - start;
+
+        done = true;
+        writer.join();
+
+        char name[64];
+        snprintf(name, sizeof(name), "evaluate, %u readers, reloading writer", readerCount);
+
+        printf("%-48s %10.1f ns/op\n", name, std::chrono::duration<double, std::nano>(duration).count() / (kIterations / readerCount * readerCount));
+    }
+
+    return 0;
+}
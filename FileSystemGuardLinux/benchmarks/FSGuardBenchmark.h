@@ -0,0 +1,53 @@
+//
+//  FSGuardBenchmark.h
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardBenchmark_h
+#define FSGuardBenchmark_h
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <chrono>
+
+//
+// NOTE: keeps the compiler from removing the benchmarked work
+//
+template <typename T>
+inline void FSGuardKeep(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+//
+// NOTE: runs body iterations times after a warm up of a tenth of them
+//       and prints mean time per operation, body does operations per iteration
+//
+template <typename Body>
+double FSGuardBenchmark(const char *name, uint64_t iterations, Body body, uint32_t operations = 1)
+{
+    for (uint64_t iteration = 0; iteration < iterations / 10; ++iteration)
+    {
+        body(iteration);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t iteration = 0; iteration < iterations; ++iteration)
+    {
+        body(iteration);
+    }
+
+    const auto duration = std::chrono::steady_clock::now() - start;
+    const double nanoseconds = std::chrono::duration<double, std::nano>(duration).count() / iterations / operations;
+
+    printf("%-48s %10.1f ns/op\n", name, nanoseconds);
+
+    return nanoseconds;
+}
+
+#endif /* FSGuardBenchmark_h */
@@ -0,0 +1,57 @@
+//
+//  FSGuardCompletionRingBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: cost per verdict of the completion ring, pushed one by one and drained
+//       in batches like extDrainFSGuardResponses does
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardCompletionRing.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+int main()
+{
+    std::vector<uint64_t> memory((FSGuardCompletionRing::memorySize(kFGCompletionRingCapacity) + 7) / 8);
+
+    FSGuardCompletionRing producer;
+    FSGuardCompletionRing consumer;
+
+    if (!producer.attach(memory.data(), memory.size() * 8, kFGCompletionRingCapacity) ||
+        !consumer.attach(memory.data(), memory.size() * 8, kFGCompletionRingCapacity))
+    {
+        return 1;
+    }
+
+    for (uint32_t batch : { 1u, 16u, 256u })
+    {
+        char name[64];
+        snprintf(name, sizeof(name), "push+drain per verdict, batch of %u", batch);
+
+        FSGuardBenchmark(name, 10000000 / batch, [&](uint64_t iteration) {
+            for (uint32_t index = 0; index < batch; ++index)
+            {
+                FSGuardResponse response = {};
+                response.rid = reinterpret_cast<void *>(iteration * batch + index + 1);
+                response.allow = true;
+
+                producer.push(response);
+            }
+
+            consumer.drain([](const FSGuardResponse &response) {
+                FSGuardKeep(response.rid);
+            });
+        }, batch);
+    }
+
+    return 0;
+}
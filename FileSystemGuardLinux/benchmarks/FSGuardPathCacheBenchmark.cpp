@@ -0,0 +1,175 @@
+//
+//  FSGuardPathCacheBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardPathCache.h"
+#include "IdentityFilter.h"
+
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+//
+// NOTE: counts live heap bytes as the allocator sizes them, including rounding
+//
+static size_t gLiveBytes = 0;
+
+void * operator new(size_t size)
+{
+    if (void *memory = malloc(size ? size : 1))
+    {
+        gLiveBytes += malloc_usable_size(memory);
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    if (memory)
+    {
+        gLiveBytes -= malloc_usable_size(memory);
+        free(memory);
+    }
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    operator delete(memory);
+}
+
+//
+// NOTE: paths shaped like ones of a home directory, depth picks the length
+//
+static std::string MakePath(std::mt19937_64 &random, uint32_t minimumDepth, uint32_t maximumDepth)
+{
+    static const char *const kComponents[] = {
+        "home", "user", "projects", "src", "Library", "Caches", "node_modules", "lib",
+        "build", "include", "com.example.application", "Documents", "share", "tmp",
+        "FileSystemGuard", "config", "v2", ".cache", "thumbnails", "packages"
+    };
+
+    constexpr uint32_t kComponentCount = sizeof(kComponents) / sizeof(kComponents[0]);
+
+    std::string path;
+
+    const uint32_t depth = minimumDepth + random() % (maximumDepth - minimumDepth + 1);
+    for (uint32_t level = 0; level < depth; ++level)
+    {
+        path += '/';
+        path += kComponents[random() % kComponentCount];
+    }
+
+    path += "/file";
+    path += std::to_string(random() % 100000);
+    path += ".dat";
+
+    return path;
+}
+
+//
+// NOTE: memory of a full cache per cached path, the slot array and the open
+//       addressing table are allocated up front, path storage grows with entries.
+//       After churn entries keep the capacity of the longest path they held
+//
+static void MeasureMemory(const char *name, uint32_t minimumDepth, uint32_t maximumDepth)
+{
+    std::mt19937_64 random(minimumDepth);
+
+    std::vector<std::string> paths;
+    size_t pathBytes = 0;
+
+    for (uint32_t index = 0; index < kFGPathCacheCapacity * 4; ++index)
+    {
+        paths.push_back(MakePath(random, minimumDepth, maximumDepth));
+        pathBytes += paths.back().size();
+    }
+
+    const size_t baseline = gLiveBytes;
+
+    auto cache = std::make_unique<FSGuardPathCache>();
+    const size_t fixedBytes = gLiveBytes - baseline;
+
+    for (uint32_t fileid = 0; fileid < kFGPathCacheCapacity; ++fileid)
+    {
+        cache->insert({ 1, fileid, 1 }, paths[fileid].data(), paths[fileid].size());
+    }
+
+    const size_t filledBytes = gLiveBytes - baseline;
+
+    for (uint32_t fileid = kFGPathCacheCapacity; fileid < paths.size(); ++fileid)
+    {
+        cache->insert({ 1, fileid, 1 }, paths[fileid].data(), paths[fileid].size());
+    }
+
+    const size_t churnedBytes = gLiveBytes - baseline;
+    const double count = cache->size();
+
+    printf("%-48s %10.1f bytes/path  mean path %5.1f  slots+table %5.1f  paths %6.1f  after churn %6.1f\n",
+           name, filledBytes / count, static_cast<double>(pathBytes) / paths.size(),
+           fixedBytes / count, (filledBytes - fixedBytes) / count, churnedBytes / count);
+}
+
+int main()
+{
+    MeasureMemory("path cache memory, short paths", 1, 2);
+    MeasureMemory("path cache memory, typical paths", 3, 6);
+    MeasureMemory("path cache memory, deep paths", 8, 14);
+
+    constexpr uint32_t kIterations = 2000000;
+
+    FSGuardPathCache cache;
+    const std::string path = "/Users/user/Library/Application Support/Example/Cache/entry.db";
+
+    for (uint32_t fileid = 0; fileid < kFGPathCacheCapacity; ++fileid)
+    {
+        cache.insert({ 1, fileid, 1 }, path.data(), path.size());
+    }
+
+    std::string result;
+
+    FSGuardBenchmark("path cache lookup hit", kIterations, [&](uint64_t iteration) {
+        FSGuardKeep(cache.lookup({ 1, iteration * 7919 % kFGPathCacheCapacity, 1 }, result));
+    });
+
+    FSGuardBenchmark("path cache lookup miss", kIterations, [&](uint64_t iteration) {
+        FSGuardKeep(cache.lookup({ 2, iteration, 1 }, result));
+    });
+
+    //
+    // NOTE: every insert of a new file evicts the least recently used one
+    //
+    FSGuardBenchmark("path cache insert with eviction", kIterations, [&](uint64_t iteration) {
+        cache.insert({ 3, iteration, 1 }, path.data(), path.size());
+    });
+
+    auto filter = std::make_unique<IdentityFilter<4096>>();
+    for (uint32_t fileid = 0; fileid < 4096; ++fileid)
+    {
+        filter->insert({ 1, fileid, 1 });
+    }
+
+    FSGuardBenchmark("identity filter contains", kIterations * 5, [&](uint64_t iteration) {
+        FSGuardKeep(filter->contains({ 1, iteration & 8191, 1 }));
+    });
+
+    FSGuardBenchmark("identity filter insert", kIterations * 5, [&](uint64_t iteration) {
+        filter->insert({ 1, iteration, 1 });
+    });
+
+    return 0;
+}
@@ -0,0 +1,85 @@
+//
+//  FSGuardPolicyBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: decision latency of the driver with a compiled policy loaded,
+//       the path processVnodeScope takes instead of asking user space
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardPolicy.h"
+#include "FSGuardPolicyBuilder.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+int main()
+{
+    constexpr uint32_t kIterations = 2000000;
+    constexpr uint32_t kRead = FSGuardActionMask(FSGuardAction::Read);
+    constexpr uint32_t kWrite = FSGuardActionMask(FSGuardAction::Write);
+
+    for (uint32_t ruleCount : { 10u, 1000u, 100000u })
+    {
+        FSGuardPolicyBuilder builder;
+        for (uint32_t index = 0; index < ruleCount; ++index)
+        {
+            builder.addRule("/Users/user" + std::to_string(index % 8) + "/Projects/project" + std::to_string(index), kRead, kWrite);
+        }
+
+        const std::vector<uint8_t> blob = builder.build();
+
+        FSGuardPolicy policy;
+        if (!policy.load(blob.data(), blob.size()))
+        {
+            return 1;
+        }
+
+        //
+        // NOTE: files a few components below a rule and files no rule covers
+        //
+        std::mt19937 random(ruleCount);
+        std::vector<std::string> matched;
+        std::vector<std::string> unmatched;
+
+        for (uint32_t index = 0; index < 1024; ++index)
+        {
+            const uint32_t rule = random() % ruleCount;
+            matched.push_back("/Users/user" + std::to_string(rule % 8) + "/Projects/project" + std::to_string(rule) +
+                              "/Sources/Module" + std::to_string(index % 16) + "/File" + std::to_string(index) + ".cpp");
+            unmatched.push_back("/Users/user" + std::to_string(index % 8) + "/Library/Caches/com.example.app/Cache" +
+                                std::to_string(index) + ".db");
+        }
+
+        char name[64];
+
+        snprintf(name, sizeof(name), "evaluate matching path, %u rules", ruleCount);
+        FSGuardBenchmark(name, kIterations, [&](uint64_t iteration) {
+            const std::string &path = matched[iteration % matched.size()];
+            FSGuardKeep(policy.evaluate(path.data(), static_cast<uint32_t>(path.size()), FSGuardAction::Write));
+        });
+
+        snprintf(name, sizeof(name), "evaluate unmatched path, %u rules", ruleCount);
+        FSGuardBenchmark(name, kIterations, [&](uint64_t iteration) {
+            const std::string &path = unmatched[iteration % unmatched.size()];
+            FSGuardKeep(policy.evaluate(path.data(), static_cast<uint32_t>(path.size()), FSGuardAction::Read));
+        });
+
+        snprintf(name, sizeof(name), "load policy, %u rules", ruleCount);
+        FSGuardBenchmark(name, 20000000 / ruleCount / 10 + 1, [&](uint64_t) {
+            FSGuardKeep(policy.load(blob.data(), blob.size()));
+        });
+    }
+
+    return 0;
+}
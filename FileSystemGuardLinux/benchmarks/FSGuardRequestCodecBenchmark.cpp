@@ -0,0 +1,53 @@
+//
+//  FSGuardRequestCodecBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: encode and decode cost of a request record by path length, the record
+//       carries the real path length instead of PATH_MAX bytes
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardRequestCodec.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+int main()
+{
+    std::vector<uint8_t> buffer(kFGMaxRequestRecordSize);
+
+    for (uint32_t length : { 16u, 64u, 256u, 1024u })
+    {
+        std::string path(length, 'p');
+        path[0] = '/';
+
+        FSGuardRequest request = {};
+        request.pid = 100;
+        request.action = FSGuardAction::Read;
+        request.filePath = path.c_str();
+        request.filePathLength = length;
+        request.processName = "benchmark";
+
+        char name[64];
+        snprintf(name, sizeof(name), "encode+decode, path of %u (record %u)", length, FSGuardRequestRecordSize(length));
+
+        FSGuardBenchmark(name, 2000000, [&](uint64_t) {
+            uint32_t size = 0;
+            FSGuardEncodeRequest(request, buffer.data(), buffer.size(), size);
+
+            FSGuardRequest decoded = {};
+            FSGuardKeep(FSGuardDecodeRequest(buffer.data(), size, decoded));
+            FSGuardKeep(decoded.filePath);
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,106 @@
+//
+//  FSGuardRequestRingBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: publishing cost of the request ring, uncontended and with producer threads
+//       racing for reservations while one consumer pops like the client
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardRequestCodec.h"
+#include "FSGuardRequestRing.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+constexpr uint32_t kRecordSize = FSGuardRequestRecordSize(64);
+
+int main()
+{
+    std::vector<uint64_t> memory((FSGuardRequestRing::memorySize(kFGRequestQueueSize) + 7) / 8);
+
+    FSGuardRequestRing producer;
+    FSGuardRequestRing consumer;
+
+    if (!producer.attach(memory.data(), memory.size() * 8, kFGRequestQueueSize) ||
+        !consumer.attach(memory.data(), memory.size() * 8, kFGRequestQueueSize))
+    {
+        return 1;
+    }
+
+    uint8_t record[kRecordSize] = {};
+
+    FSGuardBenchmark("push+pop, 64 byte path, one thread", 5000000, [&](uint64_t) {
+        producer.push(record, sizeof(record));
+        consumer.pop([](const void *data, uint32_t size) {
+            FSGuardKeep(data);
+            FSGuardKeep(size);
+        });
+    });
+
+    for (uint32_t producerCount : { 1u, 2u, 4u, 8u })
+    {
+        constexpr uint32_t kRecordsPerProducer = 500000;
+
+        std::atomic<bool> go {false};
+        std::vector<std::thread> producers;
+
+        for (uint32_t index = 0; index < producerCount; ++index)
+        {
+            producers.emplace_back([&] {
+                while (!go.load(std::memory_order_acquire))
+                {
+                    std::this_thread::yield();
+                }
+
+                for (uint32_t count = 0; count < kRecordsPerProducer; ++count)
+                {
+                    while (!producer.push(record, sizeof(record)))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        go.store(true, std::memory_order_release);
+
+        for (uint32_t popped = 0; popped < producerCount * kRecordsPerProducer;)
+        {
+            if (consumer.pop([](const void *data, uint32_t) { FSGuardKeep(data); }))
+            {
+                ++popped;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        const auto duration = std::chrono::steady_clock::now() - start;
+
+        for (std::thread &thread : producers)
+        {
+            thread.join();
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "%u producers, one consumer", producerCount);
+
+        printf("%-48s %10.1f ns/record\n", name,
+               std::chrono::duration<double, std::nano>(duration).count() / (producerCount * kRecordsPerProducer));
+    }
+
+    return 0;
+}
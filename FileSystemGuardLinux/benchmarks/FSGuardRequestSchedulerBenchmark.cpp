@@ -0,0 +1,70 @@
+//
+//  FSGuardRequestSchedulerBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardRequestScheduler.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+int main()
+{
+    constexpr uint32_t kIterations = 5000000;
+    constexpr uint32_t kCapacity = 256;
+
+    //
+    // NOTE: steady state with a full backlog, every pop is followed by push of the freed index
+    //
+    for (uint32_t processes : { 1u, 16u, 256u })
+    {
+        FSGuardRequestScheduler<256> scheduler;
+        scheduler.reset(kCapacity);
+
+        uint64_t deadline = 0;
+        for (uint32_t index = 0; index < kCapacity; ++index)
+        {
+            scheduler.push(index, static_cast<FSGuardRequestLane>(index % kFGRequestLaneCount), static_cast<pid_t>(index % processes), ++deadline);
+        }
+
+        char name[64];
+        snprintf(name, sizeof(name), "pop+push, backlog %u, %u processes", kCapacity, processes);
+
+        FSGuardBenchmark(name, kIterations, [&](uint64_t iteration) {
+            uint32_t index = 0;
+            scheduler.pop(index);
+            scheduler.push(index, static_cast<FSGuardRequestLane>(iteration % kFGRequestLaneCount), static_cast<pid_t>(iteration % processes), ++deadline);
+        });
+    }
+
+    //
+    // NOTE: out of order request earlier than the whole backlog of its flow goes to the head
+    //
+    FSGuardRequestScheduler<256> scheduler;
+    scheduler.reset(kCapacity);
+
+    for (uint32_t index = 0; index < kCapacity; ++index)
+    {
+        scheduler.push(index, FSGuardRequestLane::Read, 1, 1000000 + index);
+    }
+
+    FSGuardBenchmark("pop+push, one flow, earliest deadline", kIterations / 10, [&](uint64_t iteration) {
+        uint32_t index = 0;
+        scheduler.pop(index);
+        scheduler.push(index, FSGuardRequestLane::Read, 1, 1000000 - iteration);
+    });
+
+    FSGuardResolutionEstimate estimate;
+    estimate.sample(1000);
+
+    FSGuardBenchmark("resolution estimate expiry check", kIterations, [&](uint64_t iteration) {
+        FSGuardKeep(estimate.isExpired(iteration, iteration - 100, iteration + 5000));
+    });
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+//
+//  FSGuardResolverBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: coroutine resolvers against completion-callback resolvers doing the same
+//       work, callback is a std::function as in resolvers chaining lambdas
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardResolver.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <utility>
+
+static FSGuardVerdictTask Verdict(bool allow)
+{
+    co_return allow;
+}
+
+static FSGuardVerdictTask Nested(bool allow)
+{
+    const bool first = co_await Verdict(allow);
+    const bool second = co_await Verdict(!allow);
+
+    co_return first || second;
+}
+
+static FSGuardVerdictTask Scheduled(FSGuardResolverExecutor &executor, bool allow)
+{
+    co_await executor.schedule();
+    co_return allow;
+}
+
+using VerdictCompletion = std::function<void(bool)>;
+
+//
+// NOTE: callback resolvers are not inlined into the caller, like resolvers of
+//       another translation unit, otherwise the whole std::function is folded away
+//
+__attribute__((noinline)) static void VerdictCallback(bool allow, VerdictCompletion completion)
+{
+    completion(allow);
+}
+
+//
+// NOTE: every step captures the completion of the caller, the capture does not
+//       fit the small buffer of std::function and is allocated
+//
+__attribute__((noinline)) static void NestedCallback(bool allow, VerdictCompletion completion)
+{
+    VerdictCallback(allow, [allow, completion = std::move(completion)](bool first) mutable {
+        VerdictCallback(!allow, [first, completion = std::move(completion)](bool second) {
+            completion(first || second);
+        });
+    });
+}
+
+//
+// NOTE: without a suspended frame to hold the node, the work is allocated per call
+//
+struct CallbackWork : FSGuardDeferredWork
+{
+    bool              allow;
+    VerdictCompletion completion;
+};
+
+static void ScheduledCallback(FSGuardResolverExecutor &executor, bool allow, VerdictCompletion completion)
+{
+    CallbackWork *work = new CallbackWork {};
+    work->allow = allow;
+    work->completion = std::move(completion);
+    work->run = [](FSGuardDeferredWork &work) {
+        CallbackWork *callbackWork = static_cast<CallbackWork *>(&work);
+        callbackWork->completion(callbackWork->allow);
+        delete callbackWork;
+    };
+
+    executor.post(*work);
+}
+
+struct EmptyItem
+{
+};
+
+int main()
+{
+    constexpr uint32_t kIterations = 2000000;
+
+    bool allow = false;
+
+    FSGuardBenchmark("resolver completing without suspension", kIterations, [&](uint64_t iteration) {
+        Verdict(iteration & 1).start([&](bool verdict) noexcept { allow = verdict; });
+    });
+
+    FSGuardBenchmark("callback completing immediately", kIterations, [&](uint64_t iteration) {
+        VerdictCallback(iteration & 1, [&](bool verdict) { allow = verdict; });
+    });
+
+    FSGuardBenchmark("resolver awaiting two resolvers", kIterations, [&](uint64_t iteration) {
+        Nested(iteration & 1).start([&](bool verdict) noexcept { allow = verdict; });
+    });
+
+    FSGuardBenchmark("callback chaining two callbacks", kIterations, [&](uint64_t iteration) {
+        NestedCallback(iteration & 1, [&](bool verdict) { allow = verdict; });
+    });
+
+    FSGuardKeep(allow);
+
+    //
+    // NOTE: hand-off to a resolver thread and back through the completion
+    //
+    FSGuardResolverPool<EmptyItem> pool;
+    if (!pool.start(1, 1, [](EmptyItem &) {}))
+    {
+        return 1;
+    }
+
+    FSGuardResolverExecutor executor(pool);
+    std::atomic<uint64_t> completed {0};
+    uint64_t started = 0;
+
+    FSGuardBenchmark("resolver rescheduled on resolver thread", kIterations / 10, [&](uint64_t iteration) {
+        Scheduled(executor, iteration & 1).start([&](bool) noexcept {
+            completed.fetch_add(1, std::memory_order_release);
+        });
+
+        ++started;
+        while (completed.load(std::memory_order_acquire) < started)
+        {
+            std::this_thread::yield();
+        }
+    });
+
+    FSGuardBenchmark("callback posted to resolver thread", kIterations / 10, [&](uint64_t iteration) {
+        ScheduledCallback(executor, iteration & 1, [&](bool) {
+            completed.fetch_add(1, std::memory_order_release);
+        });
+
+        ++started;
+        while (completed.load(std::memory_order_acquire) < started)
+        {
+            std::this_thread::yield();
+        }
+    });
+
+    pool.stop();
+
+    return 0;
+}
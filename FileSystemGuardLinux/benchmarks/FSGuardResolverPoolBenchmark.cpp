@@ -0,0 +1,177 @@
+//
+//  FSGuardResolverPoolBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: dispatch cost of the resolver pool, acquire, submit, hand-off to a worker
+//       and release of items which need no resolution work, and latency from
+//       submit until a worker handles the item, against a thread per request
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardResolverPool.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchmarkItem
+{
+    uint32_t          index;
+    Clock::time_point submitted;
+};
+
+static void PrintResult(const char *name, Clock::duration duration, std::vector<uint64_t> &latencies)
+{
+    std::sort(latencies.begin(), latencies.end());
+
+    auto percentile = [&](double value) {
+        return latencies[std::min(latencies.size() - 1, static_cast<size_t>(value * latencies.size() / 100))] / 1000.0;
+    };
+
+    printf("%-48s %10.1f ns/item  p50 %8.1f us  p99 %8.1f us  p99.9 %8.1f us\n", name,
+           std::chrono::duration<double, std::nano>(duration).count() / latencies.size(),
+           percentile(50), percentile(99), percentile(99.9));
+}
+
+static uint64_t Since(Clock::time_point start)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+int main()
+{
+    constexpr uint32_t kItems = 500000;
+
+    for (uint32_t concurrency : { 1u, 2u, 4u })
+    {
+        std::vector<uint64_t> latencies(kItems);
+
+        FSGuardResolverPool<BenchmarkItem> pool;
+        if (!pool.start(concurrency, 256, [&](BenchmarkItem &item) {
+            latencies[item.index] = Since(item.submitted);
+        }))
+        {
+            return 1;
+        }
+
+        const auto start = Clock::now();
+
+        for (uint32_t index = 0; index < kItems; ++index)
+        {
+            BenchmarkItem *item = pool.acquire();
+            item->index = index;
+            item->submitted = Clock::now();
+
+            pool.submit(item, FSGuardRequestLane::Read, static_cast<pid_t>(index % 64), 0);
+        }
+
+        pool.stop();
+
+        const auto duration = Clock::now() - start;
+
+        char name[64];
+        snprintf(name, sizeof(name), "acquire+submit+handle, %u workers", concurrency);
+
+        PrintResult(name, duration, latencies);
+    }
+
+    //
+    // NOTE: one request in flight, latency is the wake up of an idle worker
+    //       without queueing behind other items
+    //
+    for (uint32_t concurrency : { 1u, 4u })
+    {
+        constexpr uint32_t kPacedItems = 20000;
+
+        std::vector<uint64_t> latencies(kPacedItems);
+        std::atomic<uint32_t> handled {0};
+
+        FSGuardResolverPool<BenchmarkItem> pool;
+        if (!pool.start(concurrency, 256, [&](BenchmarkItem &item) {
+            latencies[item.index] = Since(item.submitted);
+            handled.fetch_add(1, std::memory_order_release);
+        }))
+        {
+            return 1;
+        }
+
+        const auto start = Clock::now();
+
+        for (uint32_t index = 0; index < kPacedItems; ++index)
+        {
+            BenchmarkItem *item = pool.acquire();
+            item->index = index;
+            item->submitted = Clock::now();
+
+            pool.submit(item, FSGuardRequestLane::Read, static_cast<pid_t>(index % 64), 0);
+
+            while (handled.load(std::memory_order_acquire) <= index)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        pool.stop();
+
+        char name[64];
+        snprintf(name, sizeof(name), "one in flight, %u workers", concurrency);
+
+        PrintResult(name, Clock::now() - start, latencies);
+    }
+
+    //
+    // NOTE: naive baseline, every request gets its own thread like a dispatch
+    //       of a block per request does without a bounded pool, threads are
+    //       joined in batches so their number stays bounded
+    //
+    {
+        constexpr uint32_t kThreadItems = 20000;
+        constexpr uint32_t kBatch = 64;
+
+        std::vector<uint64_t> latencies(kThreadItems);
+        std::vector<std::thread> threads;
+
+        const auto start = Clock::now();
+
+        for (uint32_t index = 0; index < kThreadItems; ++index)
+        {
+            const Clock::time_point submitted = Clock::now();
+
+            threads.emplace_back([&latencies, index, submitted] {
+                latencies[index] = Since(submitted);
+            });
+
+            if (kBatch == threads.size())
+            {
+                for (std::thread &thread : threads)
+                {
+                    thread.join();
+                }
+
+                threads.clear();
+            }
+        }
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        PrintResult("thread per request", Clock::now() - start, latencies);
+    }
+
+    return 0;
+}
@@ -0,0 +1,160 @@
+//
+//  FSGuardRuleIndexBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: rule lookup of the daemon and the app, against the linear
+//       first-prefix scan FileGuard.findRule did before
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardRuleIndex.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// NOTE: synthetic rules shaped like real ones: most under user homes a few
+//       levels deep, the rest under applications, shared volumes and system folders
+//
+static std::string RulePath(uint32_t index)
+{
+    const std::string number = std::to_string(index);
+
+    switch (index % 8)
+    {
+    case 0:
+        return "/Applications/App" + number + ".app";
+    case 1:
+        return "/Volumes/Shared/Team" + std::to_string(index % 64) + "/Project" + number;
+    case 2:
+        return "/Library/Application Support/Vendor" + std::to_string(index % 32) + "/Component" + number;
+    default:
+        return "/Users/user" + std::to_string(index % 16) + "/Documents/Folder" + std::to_string(index % 256) + "/Item" + number;
+    }
+}
+
+int main()
+{
+    constexpr uint32_t kIterations = 2000000;
+    constexpr uint32_t kQueryCount = 65536;
+
+    for (uint32_t ruleCount : { 1000u, 100000u })
+    {
+        FSGuardRuleIndex<uint32_t> index;
+        std::vector<std::pair<std::string, uint32_t>> rules;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t rule = 0; rule < ruleCount; ++rule)
+        {
+            index.insert(RulePath(rule), rule);
+        }
+
+        const auto duration = std::chrono::steady_clock::now() - start;
+
+        for (uint32_t rule = 0; rule < ruleCount; ++rule)
+        {
+            rules.emplace_back(RulePath(rule), rule);
+        }
+
+        //
+        // NOTE: accesses are skewed, a few hot rules get most of them (Zipf, s = 1),
+        //       files are one to four levels below the rule, a third of paths has no rule
+        //
+        std::mt19937 random(ruleCount);
+        std::vector<double> weights;
+        for (uint32_t rule = 0; rule < ruleCount; ++rule)
+        {
+            weights.push_back(1.0 / (rule + 1));
+        }
+
+        std::discrete_distribution<uint32_t> popularity(weights.begin(), weights.end());
+        std::vector<uint32_t> shuffled(ruleCount);
+        for (uint32_t rule = 0; rule < ruleCount; ++rule)
+        {
+            shuffled[rule] = rule;
+        }
+
+        std::shuffle(shuffled.begin(), shuffled.end(), random);
+
+        std::vector<std::string> hits;
+        std::vector<std::string> misses;
+
+        for (uint32_t query = 0; query < kQueryCount; ++query)
+        {
+            std::string path = RulePath(shuffled[popularity(random)]);
+            const uint32_t depth = 1 + random() % 4;
+
+            for (uint32_t level = 1; level < depth; ++level)
+            {
+                path += "/dir" + std::to_string(random() % 8);
+            }
+
+            hits.push_back(path + "/file" + std::to_string(query) + ".txt");
+            misses.push_back("/Users/user" + std::to_string(query % 16) + "/Library/Caches/com.example.app" +
+                             std::to_string(query % 32) + "/Cache" + std::to_string(query) + ".db");
+        }
+
+        std::vector<std::string> mixed;
+        for (uint32_t query = 0; query < kQueryCount; ++query)
+        {
+            mixed.push_back(query % 3 ? hits[query] : misses[query]);
+        }
+
+        char name[64];
+
+        snprintf(name, sizeof(name), "insert, %u rules", ruleCount);
+        printf("%-48s %10.1f ns/op\n", name, std::chrono::duration<double, std::nano>(duration).count() / ruleCount);
+
+        snprintf(name, sizeof(name), "trie match hit, %u rules", ruleCount);
+        FSGuardBenchmark(name, kIterations, [&](uint64_t iteration) {
+            FSGuardKeep(index.match(hits[iteration % kQueryCount]));
+        });
+
+        snprintf(name, sizeof(name), "trie match miss, %u rules", ruleCount);
+        FSGuardBenchmark(name, kIterations, [&](uint64_t iteration) {
+            FSGuardKeep(index.match(misses[iteration % kQueryCount]));
+        });
+
+        snprintf(name, sizeof(name), "trie match 2/3 hits, %u rules", ruleCount);
+        FSGuardBenchmark(name, kIterations, [&](uint64_t iteration) {
+            FSGuardKeep(index.match(mixed[iteration % kQueryCount]));
+        });
+
+        //
+        // NOTE: first rule whose path is a string prefix, as findRule did,
+        //       which also matches "/data" against "/database"
+        //
+        snprintf(name, sizeof(name), "linear scan 2/3 hits, %u rules", ruleCount);
+        FSGuardBenchmark(name, 10000000 / ruleCount, [&](uint64_t iteration) {
+            const std::string &path = mixed[iteration % kQueryCount];
+            const uint32_t *found = nullptr;
+
+            for (const auto &rule : rules)
+            {
+                if (0 == path.compare(0, rule.first.size(), rule.first))
+                {
+                    found = &rule.second;
+                    break;
+                }
+            }
+
+            FSGuardKeep(found);
+        });
+    }
+
+    return 0;
+}
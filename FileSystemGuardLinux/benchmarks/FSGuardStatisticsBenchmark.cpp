@@ -0,0 +1,81 @@
+//
+//  FSGuardStatisticsBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardStatistics.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+int main()
+{
+    constexpr uint32_t kIterations = 5000000;
+
+    auto recorder = std::make_unique<FSGuardStatisticsRecorder<16>>();
+    auto statistics = std::make_unique<FSGuardStatistics>();
+
+    FSGuardBenchmark("histogram bucket", kIterations, [](uint64_t iteration) {
+        FSGuardKeep(FSGuardHistogramBucket(iteration * 7919));
+    });
+
+    FSGuardBenchmark("counter increment", kIterations, [&](uint64_t iteration) {
+        recorder->increment(static_cast<uint32_t>(iteration), FSGuardStatisticsCounter::Requests);
+    });
+
+    FSGuardBenchmark("stage record", kIterations, [&](uint64_t iteration) {
+        recorder->record(static_cast<uint32_t>(iteration), FSGuardStatisticsStage::Resolution, iteration * 7919 & 0xFFFFFF);
+    });
+
+    FSGuardBenchmark("snapshot of 16 shards", 2000, [&](uint64_t) {
+        recorder->snapshot(*statistics);
+        FSGuardKeep(statistics->counters[0]);
+    });
+
+    recorder->snapshot(*statistics);
+
+    FSGuardBenchmark("p99.9 quantile", 200000, [&](uint64_t) {
+        FSGuardKeep(FSGuardHistogramQuantile(statistics->histograms[static_cast<uint32_t>(FSGuardStatisticsStage::Resolution)], 999, 1000));
+    });
+
+    //
+    // NOTE: per-thread shards against all threads sharing one shard
+    //
+    for (uint32_t shardMask : { 15u, 0u })
+    {
+        const uint32_t threadCount = 4;
+        std::vector<std::thread> threads;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t thread = 0; thread < threadCount; ++thread)
+        {
+            threads.emplace_back([&recorder, thread, shardMask] {
+                for (uint32_t index = 0; index < kIterations / 4; ++index)
+                {
+                    recorder->record(thread & shardMask, FSGuardStatisticsStage::Resolution, index & 0xFFFF);
+                }
+            });
+        }
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        const auto duration = std::chrono::steady_clock::now() - start;
+
+        printf("%-48s %10.1f ns/op\n", shardMask ? "record, 4 threads on own shards" : "record, 4 threads on one shard",
+               std::chrono::duration<double, std::nano>(duration).count() / (kIterations / 4 * threadCount));
+    }
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+//
+//  OverloadControllerBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "OverloadController.h"
+
+#include <stdint.h>
+
+int main()
+{
+    constexpr uint32_t kIterations = 10000000;
+
+    OverloadController controller;
+
+    FSGuardBenchmark("admit+complete", kIterations, [&](uint64_t iteration) {
+        if (controller.admit())
+        {
+            controller.complete(1000000 + (iteration & 0xFFFF), true);
+        }
+    });
+
+    FSGuardBenchmark("verdict timeout", kIterations, [&](uint64_t) {
+        FSGuardKeep(controller.verdictTimeout());
+    });
+
+    //
+    // NOTE: rejected admission while shedding
+    //
+    for (uint32_t index = 0; index < controller.policy().shedHighWatermark; ++index)
+    {
+        controller.admit();
+    }
+
+    FSGuardBenchmark("admit while shedding", kIterations, [&](uint64_t) {
+        FSGuardKeep(controller.admit());
+    });
+
+    return 0;
+}
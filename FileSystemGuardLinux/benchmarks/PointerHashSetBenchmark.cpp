@@ -0,0 +1,163 @@
+//
+//  PointerHashSetBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: wait list operations with requests in flight, the hash set against
+//       the LIST_HEAD list of malloc'ed entries the wait list used before
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "PointerHashSet.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/queue.h>
+
+#include <memory>
+
+//
+// NOTE: copy of the old WaitList, entry is allocated on add and freed on remove
+//
+struct WaitListEntry
+{
+    LIST_ENTRY(WaitListEntry) entry;
+    void *event;
+};
+
+class LinkedWaitList
+{
+public:
+    LinkedWaitList()
+    {
+        LIST_INIT(&m_list);
+    }
+
+    ~LinkedWaitList()
+    {
+        while (!LIST_EMPTY(&m_list))
+        {
+            WaitListEntry *waitListEntry = LIST_FIRST(&m_list);
+            LIST_REMOVE(waitListEntry, entry);
+            free(waitListEntry);
+        }
+    }
+
+    void add(void *event)
+    {
+        WaitListEntry *waitListEntry = static_cast<WaitListEntry *>(malloc(sizeof(WaitListEntry)));
+        if (waitListEntry)
+        {
+            waitListEntry->event = event;
+
+            LIST_INSERT_HEAD(&m_list, waitListEntry, entry);
+        }
+    }
+
+    void remove(void *event)
+    {
+        WaitListEntry *waitListEntry = nullptr;
+
+        LIST_FOREACH(waitListEntry, &m_list, entry)
+        {
+            if (waitListEntry->event == event)
+            {
+                LIST_REMOVE(waitListEntry, entry);
+                free(waitListEntry);
+
+                return;
+            }
+        }
+    }
+
+    bool contains(void *event) const
+    {
+        const WaitListEntry *waitListEntry = nullptr;
+
+        LIST_FOREACH(waitListEntry, &m_list, entry)
+        {
+            if (waitListEntry->event == event)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    LIST_HEAD(WaitListData, WaitListEntry) m_list;
+};
+
+using WaitSet = PointerHashSet<2048>;
+
+//
+// NOTE: requests are slab objects, addresses are a request size apart
+//
+static void * Key(uint64_t sequence)
+{
+    return reinterpret_cast<void *>((sequence % 65536 + 1) * 1152);
+}
+
+int main()
+{
+    constexpr uint32_t kIterations = 2000000;
+
+    for (uint32_t inFlight : { 1u, 64u, 1024u })
+    {
+        auto set = std::make_unique<WaitSet>();
+        LinkedWaitList list;
+
+        for (uint64_t sequence = 0; sequence < inFlight; ++sequence)
+        {
+            set->insert(Key(sequence));
+            list.add(Key(sequence));
+        }
+
+        //
+        // NOTE: verdicts come mostly in order, the oldest request is answered
+        //       and leaves while a new one arrives, the window keeps its size
+        //
+        uint64_t setOldest = 0;
+        uint64_t listOldest = 0;
+        char name[64];
+
+        snprintf(name, sizeof(name), "PointerHashSet request cycle, %u in flight", inFlight);
+        FSGuardBenchmark(name, kIterations, [&](uint64_t) {
+            FSGuardKeep(set->contains(Key(setOldest)));
+            set->erase(Key(setOldest));
+            set->insert(Key(setOldest + inFlight));
+            ++setOldest;
+        });
+
+        snprintf(name, sizeof(name), "linked list request cycle, %u in flight", inFlight);
+        FSGuardBenchmark(name, inFlight > 64 ? kIterations / 20 : kIterations, [&](uint64_t) {
+            FSGuardKeep(list.contains(Key(listOldest)));
+            list.remove(Key(listOldest));
+            list.add(Key(listOldest + inFlight));
+            ++listOldest;
+        });
+
+        //
+        // NOTE: lookup anywhere in the window, postResponse checks the request still waits
+        //
+        snprintf(name, sizeof(name), "PointerHashSet contains, %u in flight", inFlight);
+        FSGuardBenchmark(name, kIterations, [&](uint64_t iteration) {
+            FSGuardKeep(set->contains(Key(setOldest + iteration * 7 % inFlight)));
+        });
+
+        snprintf(name, sizeof(name), "linked list contains, %u in flight", inFlight);
+        FSGuardBenchmark(name, inFlight > 64 ? kIterations / 20 : kIterations, [&](uint64_t iteration) {
+            FSGuardKeep(list.contains(Key(listOldest + iteration * 7 % inFlight)));
+        });
+    }
+
+    return 0;
+}
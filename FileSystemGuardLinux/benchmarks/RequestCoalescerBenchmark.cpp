@@ -0,0 +1,74 @@
+//
+//  RequestCoalescerBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "RequestCoalescer.h"
+
+#include <stdint.h>
+
+#include <memory>
+
+int main()
+{
+    constexpr uint32_t kIterations = 2000000;
+
+    auto coalescer = std::make_unique<RequestCoalescer<256>>();
+
+    //
+    // NOTE: leader path, request which nothing else is waiting for
+    //
+    FSGuardBenchmark("leader join+finish+leave", kIterations, [&](uint64_t iteration) {
+        bool leader = false;
+        const VerdictKey key { 1, iteration, 1, 1, 100 };
+
+        const uint32_t slot = coalescer->join(key, nullptr, leader);
+        coalescer->finish(slot, true, true);
+        coalescer->leave(slot);
+        FSGuardKeep(leader);
+    });
+
+    //
+    // NOTE: burst of identical requests joining one leader
+    //
+    FSGuardBenchmark("leader with 7 joined requests", kIterations / 8, [&](uint64_t iteration) {
+        bool leader = false;
+        const VerdictKey key { 1, iteration, 1, 1, 100 };
+
+        const uint32_t slot = coalescer->join(key, nullptr, leader);
+        for (uint32_t index = 0; index < 7; ++index)
+        {
+            coalescer->join(key, nullptr, leader);
+        }
+
+        coalescer->finish(slot, true, true);
+        for (uint32_t index = 0; index < 8; ++index)
+        {
+            coalescer->leave(slot);
+        }
+    }, 8);
+
+    //
+    // NOTE: join lookup with a table of 192 leaders in flight
+    //
+    for (uint64_t fileid = 0; fileid < 192; ++fileid)
+    {
+        bool leader = false;
+        coalescer->join(VerdictKey { 2, fileid, 1, 1, 100 }, nullptr, leader);
+    }
+
+    FSGuardBenchmark("join+leave with 192 leaders in flight", kIterations, [&](uint64_t iteration) {
+        bool leader = false;
+
+        const uint32_t slot = coalescer->join(VerdictKey { 2, iteration % 192, 1, 1, 100 }, nullptr, leader);
+        coalescer->leave(slot);
+        FSGuardKeep(slot);
+    });
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+//
+//  SlabPoolBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "SlabPool.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+//
+// NOTE: size of the driver request object with its inline path buffer
+//
+struct RequestObject
+{
+    uint8_t bytes[1152];
+};
+
+using RequestPool = SlabPool<RequestObject, 1024, 8>;
+
+int main()
+{
+    constexpr uint32_t kIterations = 10000000;
+
+    auto pool = std::make_unique<RequestPool>();
+
+    FSGuardBenchmark("allocate+free, one shard", kIterations, [&](uint64_t) {
+        RequestObject *object = pool->allocate(0);
+        FSGuardKeep(object);
+        pool->free(object, 0);
+    });
+
+    FSGuardBenchmark("new+delete of the same size", kIterations, [&](uint64_t) {
+        RequestObject *object = new RequestObject;
+        FSGuardKeep(object);
+        delete object;
+    });
+
+    //
+    // NOTE: per-thread shards against all threads sharing one shard
+    //
+    for (uint32_t shardMask : { 7u, 0u })
+    {
+        const uint32_t threadCount = 4;
+        std::vector<std::thread> threads;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (uint32_t thread = 0; thread < threadCount; ++thread)
+        {
+            threads.emplace_back([&pool, thread, shardMask] {
+                for (uint32_t index = 0; index < kIterations / 4; ++index)
+                {
+                    RequestObject *object = pool->allocate(thread & shardMask);
+                    FSGuardKeep(object);
+                    pool->free(object, thread & shardMask);
+                }
+            });
+        }
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        const auto duration = std::chrono::steady_clock::now() - start;
+
+        printf("%-48s %10.1f ns/op\n", shardMask ? "allocate+free, 4 threads on own shards" : "allocate+free, 4 threads on one shard",
+               std::chrono::duration<double, std::nano>(duration).count() / (kIterations / 4 * threadCount));
+    }
+
+    return 0;
+}
@@ -0,0 +1,81 @@
+//
+//  TrustedProcessSetBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "ReadMostlyPointer.h"
+#include "TrustedProcessSet.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+struct YieldBackoff
+{
+    static void wait()
+    {
+        std::this_thread::yield();
+    }
+};
+
+int main()
+{
+    constexpr uint32_t kIterations = 10000000;
+
+    auto readName = [](char *name, uint32_t size) {
+        snprintf(name, size, "%s", "backupd");
+    };
+
+    TrustedProcessSet<YieldBackoff> set;
+
+    //
+    // NOTE: nobody trusted, the common configuration
+    //
+    FSGuardBenchmark("contains, empty set", kIterations, [&](uint64_t iteration) {
+        FSGuardKeep(set.contains(static_cast<pid_t>(iteration), readName));
+    });
+
+    std::vector<FSGuardTrustedProcess> processes(64);
+    for (uint32_t index = 0; index < processes.size(); ++index)
+    {
+        processes[index].pid = static_cast<pid_t>(1000 + index * 13);
+        strcpy(processes[index].name, "backupd");
+    }
+
+    set.replace(processes.data(), static_cast<uint32_t>(processes.size()));
+
+    FSGuardBenchmark("contains, 64 processes, miss", kIterations, [&](uint64_t iteration) {
+        FSGuardKeep(set.contains(static_cast<pid_t>(100 + (iteration & 511)), readName));
+    });
+
+    FSGuardBenchmark("contains, 64 processes, hit", kIterations, [&](uint64_t iteration) {
+        FSGuardKeep(set.contains(static_cast<pid_t>(1000 + (iteration & 63) * 13), readName));
+    });
+
+    FSGuardBenchmark("replace 64 processes", 100000, [&](uint64_t) {
+        FSGuardKeep(set.replace(processes.data(), static_cast<uint32_t>(processes.size())));
+    });
+
+    ReadMostlyPointer<uint64_t, YieldBackoff> pointer;
+    uint64_t value = 1;
+    pointer.exchange(&value);
+
+    FSGuardBenchmark("read-mostly pointer read", kIterations, [&](uint64_t) {
+        FSGuardKeep(pointer.read([](const uint64_t *current) { return *current; }));
+    });
+
+    FSGuardBenchmark("read-mostly pointer exchange", 1000000, [&](uint64_t) {
+        FSGuardKeep(pointer.exchange(&value));
+    });
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+//
+//  VerdictCacheBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "VerdictCache.h"
+
+#include <stdint.h>
+
+#include <memory>
+
+//
+// NOTE: same geometry as the driver cache
+//
+using DriverVerdictCache = VerdictCache<1024>;
+
+static VerdictKey MakeKey(uint64_t fileid)
+{
+    return VerdictKey { 0x1000004, fileid, 3, 1, static_cast<int32_t>(100 + fileid % 16) };
+}
+
+int main()
+{
+    constexpr uint32_t kIterations = 20000000;
+
+    auto cache = std::make_unique<DriverVerdictCache>();
+
+    //
+    // NOTE: half of the capacity is cached, keys cycle through it
+    //
+    constexpr uint64_t kCachedKeys = DriverVerdictCache::kCapacity / 2;
+
+    for (uint64_t fileid = 0; fileid < kCachedKeys; ++fileid)
+    {
+        cache->insert(MakeKey(fileid), true, 0, UINT64_MAX / 2);
+    }
+
+    FSGuardBenchmark("lookup hit", kIterations, [&](uint64_t iteration) {
+        bool allow = false;
+        FSGuardKeep(cache->lookup(MakeKey(iteration % kCachedKeys), 1, allow));
+        FSGuardKeep(allow);
+    });
+
+    FSGuardBenchmark("lookup miss", kIterations, [&](uint64_t iteration) {
+        bool allow = false;
+        FSGuardKeep(cache->lookup(MakeKey(kCachedKeys + iteration), 1, allow));
+    });
+
+    FSGuardBenchmark("insert of cached key", kIterations, [&](uint64_t iteration) {
+        cache->insert(MakeKey(iteration % kCachedKeys), true, 1, UINT64_MAX / 2);
+    });
+
+    //
+    // NOTE: every set is full, each insert evicts
+    //
+    FSGuardBenchmark("insert with eviction", kIterations, [&](uint64_t iteration) {
+        cache->insert(MakeKey(kCachedKeys + iteration), false, 1, 1000 + iteration % 64);
+    });
+
+    FSGuardBenchmark("flush", kIterations, [&](uint64_t) {
+        cache->flush();
+        FSGuardKeep(cache->generation());
+    });
+
+    return 0;
+}
@@ -0,0 +1,418 @@
+//
+//  WatchScopeBenchmark.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: scope matching cost, and how much of a path trace the scope keeps from
+//       the client. Trace recorded by FSGuardClient is given as the argument,
+//       otherwise a synthetic one of a desktop session is used
+//
+
+#include "FSGuardBenchmark.h"
+
+#include "FSGuardTrace.h"
+#include "WatchScope.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//
+// NOTE: chain of directories, node 0 is the mount root
+//
+class ChainWalker
+{
+public:
+    using Node = int32_t;
+    static constexpr Node NodeNull = -1;
+
+    uint64_t object(Node node) const
+    {
+        return static_cast<uint64_t>(node) + 1;
+    }
+
+    uint32_t version(Node) const
+    {
+        return 1;
+    }
+
+    bool fileid(Node node, uint64_t &fileid) const
+    {
+        fileid = static_cast<uint64_t>(node) + 100;
+        return true;
+    }
+
+    bool isMountRoot(Node node) const
+    {
+        return 0 == node;
+    }
+
+    Node parent(Node node) const
+    {
+        return node - 1;
+    }
+
+    void release(Node) const
+    {
+    }
+};
+
+//
+// NOTE: directories of the traced paths, parent links stand in for vnodes
+//
+class PathTree
+{
+public:
+    using Node = int32_t;
+    static constexpr Node NodeNull = -1;
+
+    struct Mount
+    {
+        const char *path;
+        uint64_t    fsid;
+    };
+
+    explicit PathTree(const std::vector<Mount> &mounts)
+        : m_mounts(mounts)
+    {
+    }
+
+    //
+    // NOTE: directory of the file and its mount, created on first use
+    //
+    Node directoryOf(const std::string &path, uint64_t &fsid)
+    {
+        const size_t slash = path.rfind('/');
+        const Node node = intern(std::string::npos == slash || 0 == slash ? "/" : path.substr(0, slash));
+
+        fsid = m_directories[node].fsid;
+
+        return node;
+    }
+
+    Node lookup(const char *path)
+    {
+        return intern(path);
+    }
+
+    size_t size() const
+    {
+        return m_directories.size();
+    }
+
+    uint64_t object(Node node) const
+    {
+        return static_cast<uint64_t>(node) + 1;
+    }
+
+    uint32_t version(Node) const
+    {
+        return 1;
+    }
+
+    bool fileid(Node node, uint64_t &fileid) const
+    {
+        fileid = m_directories[node].fileid;
+        return true;
+    }
+
+    bool isMountRoot(Node node) const
+    {
+        return m_directories[node].isMountRoot;
+    }
+
+    Node parent(Node node) const
+    {
+        return m_directories[node].parent;
+    }
+
+    void release(Node) const
+    {
+    }
+
+private:
+    struct Directory
+    {
+        Node     parent;
+        uint64_t fsid;
+        uint64_t fileid;
+        bool     isMountRoot;
+    };
+
+    Node intern(const std::string &path)
+    {
+        const auto found = m_nodes.find(path);
+        if (found != m_nodes.end())
+        {
+            return found->second;
+        }
+
+        Directory directory { NodeNull, 0, 0, false };
+
+        for (const Mount &mount : m_mounts)
+        {
+            if (path == mount.path)
+            {
+                directory.fsid = mount.fsid;
+                directory.isMountRoot = true;
+            }
+        }
+
+        if ("/" != path)
+        {
+            const size_t slash = path.rfind('/');
+            directory.parent = intern(0 == slash ? "/" : path.substr(0, slash));
+
+            if (!directory.isMountRoot)
+            {
+                directory.fsid = m_directories[directory.parent].fsid;
+            }
+        }
+
+        directory.fileid = m_directories.size() + 2;
+
+        m_directories.push_back(directory);
+        m_nodes.emplace(path, static_cast<Node>(m_directories.size() - 1));
+
+        return static_cast<Node>(m_directories.size() - 1);
+    }
+
+private:
+    std::vector<Mount>                    m_mounts;
+    std::vector<Directory>                m_directories;
+    std::unordered_map<std::string, Node> m_nodes;
+};
+
+//
+// NOTE: desktop session, most opened files are caches, libraries and
+//       pseudo file systems, documents and projects are a minority
+//
+static std::vector<std::string> SynthesizePaths(uint32_t count)
+{
+    struct Area
+    {
+        const char *directory;
+        uint32_t    weight;
+        uint32_t    subdirectories;
+    };
+
+    static const Area kAreas[] = {
+        { "/proc/self",                        18, 1 },
+        { "/sys/devices/system/cpu",            6, 16 },
+        { "/usr/lib/x86_64-linux-gnu",         14, 8 },
+        { "/home/user/.cache/browser",         16, 64 },
+        { "/home/user/.local/share/app",        8, 16 },
+        { "/tmp",                               6, 32 },
+        { "/var/log",                           4, 4 },
+        { "/home/user/Documents",               8, 32 },
+        { "/home/user/Desktop",                 3, 1 },
+        { "/home/user/src/project",            10, 128 },
+        { "/data/shared",                       7, 64 }
+    };
+
+    uint32_t totalWeight = 0;
+    for (const Area &area : kAreas)
+    {
+        totalWeight += area.weight;
+    }
+
+    std::mt19937_64 random(21);
+    std::vector<std::string> paths;
+
+    for (uint32_t index = 0; index < count; ++index)
+    {
+        uint32_t pick = random() % totalWeight;
+
+        const Area *area = kAreas;
+        while (pick >= area->weight)
+        {
+            pick -= area->weight;
+            ++area;
+        }
+
+        std::string path = area->directory;
+        if (area->subdirectories > 1)
+        {
+            path += "/dir" + std::to_string(random() % area->subdirectories);
+        }
+
+        path += "/file" + std::to_string(random() % 256);
+        paths.push_back(path);
+    }
+
+    return paths;
+}
+
+static bool LoadTrace(const char *tracePath, std::vector<std::string> &paths)
+{
+    FSGuardTraceReader reader;
+    if (!reader.open(tracePath))
+    {
+        return false;
+    }
+
+    FSGuardTraceEvent event;
+    while (reader.next(event))
+    {
+        if (!event.path.empty() && '/' == event.path[0])
+        {
+            paths.push_back(event.path);
+        }
+    }
+
+    return true;
+}
+
+//
+// NOTE: share of the trace the driver decides without asking the client, split
+//       by the step which rejected it, and the cost per traced file
+//
+static int MeasureTrace(const char *tracePath)
+{
+    std::vector<std::string> paths;
+    if (!tracePath)
+    {
+        paths = SynthesizePaths(200000);
+    }
+    else if (!LoadTrace(tracePath, paths))
+    {
+        fprintf(stderr, "failed to read trace %s\n", tracePath);
+        return 1;
+    }
+
+    if (paths.empty())
+    {
+        fprintf(stderr, "trace has no paths\n");
+        return 1;
+    }
+
+    PathTree tree({ { "/", 1 }, { "/proc", 2 }, { "/sys", 3 }, { "/tmp", 4 }, { "/data", 5 } });
+
+    //
+    // NOTE: one whole mount and watched roots on the root file system
+    //
+    auto input = std::make_unique<FSGuardWatchScope>();
+    input->mounts[input->mountCount++] = 5;
+
+    for (const char *root : { "/home/user/Documents", "/home/user/Desktop", "/home/user/src" })
+    {
+        uint64_t fileid = 0;
+        tree.fileid(tree.lookup(root), fileid);
+        input->roots[input->rootCount++] = { 1, fileid, 0 };
+    }
+
+    auto scope = std::make_unique<WatchScope>();
+    if (!scope->load(*input))
+    {
+        return 1;
+    }
+
+    struct TracedFile
+    {
+        uint64_t       fsid;
+        PathTree::Node directory;
+    };
+
+    std::vector<TracedFile> files;
+    for (const std::string &path : paths)
+    {
+        TracedFile file {};
+        file.directory = tree.directoryOf(path, file.fsid);
+        files.push_back(file);
+    }
+
+    //
+    // NOTE: the same size the driver uses
+    //
+    auto cache = std::make_unique<AncestorCache<1024>>();
+
+    size_t outside = 0;
+    size_t outsideRoots = 0;
+
+    for (const TracedFile &file : files)
+    {
+        const WatchScopeMount mount = scope->classify(file.fsid);
+
+        if (WatchScopeMount::Outside == mount)
+        {
+            ++outside;
+        }
+        else if (WatchScopeMount::Partial == mount && !IsWatchedDirectory(*scope, file.fsid, file.directory, *cache, tree))
+        {
+            ++outsideRoots;
+        }
+    }
+
+    printf("%s trace, %zu files in %zu directories\n", tracePath ? "recorded" : "synthetic", files.size(), tree.size());
+    printf("%-48s %10.1f %%\n", "rejected by mount classification", 100.0 * outside / files.size());
+    printf("%-48s %10.1f %%\n", "rejected by ancestor walk", 100.0 * outsideRoots / files.size());
+    printf("%-48s %10.1f %%\n", "reject ratio", 100.0 * (outside + outsideRoots) / files.size());
+
+    cache->clear();
+
+    FSGuardBenchmark("classify and ancestor walk of traced file", files.size() * 10, [&](uint64_t iteration) {
+        const TracedFile &file = files[iteration % files.size()];
+
+        FSGuardKeep(WatchScopeMount::Partial == scope->classify(file.fsid) &&
+                    IsWatchedDirectory(*scope, file.fsid, file.directory, *cache, tree));
+    });
+
+    return 0;
+}
+
+int main(int argc, const char *argv[])
+{
+    constexpr uint32_t kIterations = 5000000;
+
+    auto input = std::make_unique<FSGuardWatchScope>();
+    for (uint32_t index = 0; index < 32; ++index)
+    {
+        input->mounts[input->mountCount++] = 1000 + index * 2;
+    }
+
+    for (uint32_t index = 0; index < 128; ++index)
+    {
+        input->roots[input->rootCount++] = { 5, 100 + 4 + index * 64, 0 };
+    }
+
+    auto scope = std::make_unique<WatchScope>();
+    if (!scope->load(*input))
+    {
+        return 1;
+    }
+
+    FSGuardBenchmark("classify mount, 33 mounts", kIterations, [&](uint64_t iteration) {
+        FSGuardKeep(scope->classify(1000 + (iteration & 63)));
+    });
+
+    FSGuardBenchmark("is root, 128 roots", kIterations, [&](uint64_t iteration) {
+        FSGuardKeep(scope->isRoot(5, iteration & 8191));
+    });
+
+    auto cache = std::make_unique<AncestorCache<4096>>();
+    ChainWalker walker;
+
+    //
+    // NOTE: walk of 16 directories every time, cache is cleared before each
+    //
+    FSGuardBenchmark("ancestor walk of 16 directories, cold", kIterations / 10, [&](uint64_t) {
+        cache->clear();
+        FSGuardKeep(IsWatchedDirectory(*scope, 5, 19, *cache, walker));
+    });
+
+    FSGuardBenchmark("ancestor walk, cached directory", kIterations, [&](uint64_t) {
+        FSGuardKeep(IsWatchedDirectory(*scope, 5, 19, *cache, walker));
+    });
+
+    return MeasureTrace(argc > 1 ? argv[1] : nullptr);
+}
@@ -0,0 +1,192 @@
+//
+//  fsguardfanotify.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: runs FSGuardFanotifyClient on the given mounts and prints every request
+//       which reaches the delegate. Requests are decided by the compiled policy,
+//       by denied path prefixes or allowed. Needs CAP_SYS_ADMIN
+//
+
+#include "FSGuardFanotifyClient.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+struct FanotifyOptions
+{
+    const char               *policyPath = nullptr;
+    std::vector<std::string>  deniedPrefixes;
+    std::vector<const char *> mounts;
+    uint32_t                  timeout = 0;
+    bool                      quiet = false;
+};
+
+static FSGuardFanotifyClient *g_client = nullptr;
+
+static void HandleSignal(int)
+{
+    if (g_client)
+    {
+        g_client->stop();
+    }
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+            "usage: fsguardfanotify <mount>... [--policy <compiled policy>] [--deny <prefix>]...\n"
+            "                                  [--timeout <ms>] [--quiet]\n"
+            "\n"
+            "  --policy   decide requests with the policy, others reach the delegate\n"
+            "  --deny     delegate denies paths under the prefix, allows the rest\n"
+            "  --timeout  verdict timeout, events without verdict are allowed after it\n"
+            "  --quiet    do not print requests\n");
+}
+
+static bool ParseOptions(int argc, const char *argv[], FanotifyOptions &options)
+{
+    for (int index = 1; index < argc; ++index)
+    {
+        const char *argument = argv[index];
+        const bool hasValue = index + 1 < argc;
+
+        if (0 == strcmp(argument, "--policy") && hasValue)
+        {
+            options.policyPath = argv[++index];
+        }
+        else if (0 == strcmp(argument, "--deny") && hasValue)
+        {
+            options.deniedPrefixes.push_back(argv[++index]);
+        }
+        else if (0 == strcmp(argument, "--timeout") && hasValue)
+        {
+            options.timeout = static_cast<uint32_t>(std::max(0, atoi(argv[++index])));
+        }
+        else if (0 == strcmp(argument, "--quiet"))
+        {
+            options.quiet = true;
+        }
+        else if ('-' != argument[0])
+        {
+            options.mounts.push_back(argument);
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return !options.mounts.empty();
+}
+
+class PrintingDelegate : public FSGuardFanotifyDelegate
+{
+public:
+    explicit PrintingDelegate(const FanotifyOptions &options)
+        : m_options(options)
+    {
+    }
+
+    void setClient(FSGuardFanotifyClient *client)
+    {
+        m_client = client;
+    }
+
+    void resolveRequest(const FSGuardRequest &request) override
+    {
+        const std::string path(request.filePath, request.filePathLength);
+
+        bool allow = true;
+        for (const std::string &prefix : m_options.deniedPrefixes)
+        {
+            //
+            // NOTE: prefix covers itself and paths below it, not siblings sharing its name
+            //
+            if (0 == path.compare(0, prefix.size(), prefix) &&
+                (path.size() == prefix.size() || '/' == path[prefix.size()] || '/' == prefix.back()))
+            {
+                allow = false;
+                break;
+            }
+        }
+
+        if (!m_options.quiet)
+        {
+            printf("%s %-7s pid %d ppid %d uid %u %s %s\n",
+                   allow ? "allow" : "deny ",
+                   FSGuardAction::Execute == request.action ? "execute" : "read",
+                   request.pid, request.ppid, request.uid,
+                   request.processName ? request.processName : "?", path.c_str());
+        }
+
+        m_client->postResponse(FSGuardResponse { request.rid, allow, false, false });
+    }
+
+private:
+    const FanotifyOptions &m_options;
+    FSGuardFanotifyClient *m_client = nullptr;
+};
+
+int main(int argc, const char *argv[])
+{
+    FanotifyOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    PrintingDelegate delegate(options);
+    FSGuardFanotifyClient client(delegate, options.timeout ? options.timeout * 1000000ull : kFGFanotifyVerdictTimeout);
+    delegate.setClient(&client);
+
+    if (options.policyPath)
+    {
+        std::ifstream stream(options.policyPath, std::ios::binary);
+        const std::vector<uint8_t> policy((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        if (!client.loadPolicy(policy.data(), policy.size()))
+        {
+            fprintf(stderr, "invalid policy %s\n", options.policyPath);
+            return 1;
+        }
+    }
+
+    if (!client.open())
+    {
+        return 1;
+    }
+
+    for (const char *mount : options.mounts)
+    {
+        if (!client.addMount(mount))
+        {
+            return 1;
+        }
+    }
+
+    g_client = &client;
+
+    struct sigaction action = {};
+    action.sa_handler = HandleSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    const bool result = client.run();
+
+    g_client = nullptr;
+
+    return result ? 0 : 1;
+}
@@ -0,0 +1,573 @@
+//
+//  fsguardreplay.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+//
+// NOTE: replays a trace recorded by FSGuardClient through the user space part of
+//       the resolution pipeline: request ring, resolver pool and completion ring.
+//       Driver side is emulated by the producer and drainer threads, the delegate
+//       by the loaded policy or by sleeping for the recorded resolution latency.
+//       --synthesize-flood replays a generated trace instead of a recorded one.
+//
+
+#include "FSGuardCompletionRing.h"
+#include "FSGuardPolicy.h"
+#include "FSGuardRequestCodec.h"
+#include "FSGuardRequestRing.h"
+#include "FSGuardRequestScheduler.h"
+#include "FSGuardResolverPool.h"
+#include "FSGuardTrace.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t kReplayTaskCount = 1024;
+
+struct ReplayOptions
+{
+    const char *tracePath = nullptr;
+    const char *policyPath = nullptr;
+    double      speed = 0;
+    uint32_t    concurrency = std::max(1u, std::thread::hardware_concurrency());
+    bool        serviceTime = true;
+    uint32_t    processes = 0;
+    uint32_t    deadline = 0;
+    bool        keepExpired = false;
+    bool        synthesizeFlood = false;
+};
+
+struct ReplayTask
+{
+    alignas(kFGRequestRecordAlignment) uint8_t record[kFGMaxRequestRecordSize];
+    uint32_t size;
+};
+
+static uint64_t Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+            "usage: fsguardreplay <trace> | --synthesize-flood [--speed <factor>] [--concurrency <threads>]\n"
+            "                             [--policy <compiled policy>] [--no-service-time]\n"
+            "                             [--processes <count>] [--deadline <ms>] [--keep-expired]\n"
+            "\n"
+            "  --synthesize-flood flooding and quiet process instead of a recorded trace\n"
+            "  --speed            0 replays as fast as possible (default), 1 keeps original timing\n"
+            "  --concurrency      number of resolver threads\n"
+            "  --policy           decide requests with the policy instead of recorded latency\n"
+            "  --no-service-time  resolve requests immediately\n"
+            "  --processes        latency of the given number of processes with most requests\n"
+            "  --deadline         verdict timeout of the driver, verdicts after it do not count\n"
+            "  --keep-expired     resolve requests which can not make their deadline like old clients did\n");
+}
+
+static bool ParseOptions(int argc, const char *argv[], ReplayOptions &options)
+{
+    for (int index = 1; index < argc; ++index)
+    {
+        const char *argument = argv[index];
+        const bool hasValue = index + 1 < argc;
+
+        if (0 == strcmp(argument, "--speed") && hasValue)
+        {
+            options.speed = atof(argv[++index]);
+        }
+        else if (0 == strcmp(argument, "--concurrency") && hasValue)
+        {
+            options.concurrency = static_cast<uint32_t>(std::max(1, atoi(argv[++index])));
+        }
+        else if (0 == strcmp(argument, "--policy") && hasValue)
+        {
+            options.policyPath = argv[++index];
+        }
+        else if (0 == strcmp(argument, "--processes") && hasValue)
+        {
+            options.processes = static_cast<uint32_t>(std::max(0, atoi(argv[++index])));
+        }
+        else if (0 == strcmp(argument, "--deadline") && hasValue)
+        {
+            options.deadline = static_cast<uint32_t>(std::max(0, atoi(argv[++index])));
+        }
+        else if (0 == strcmp(argument, "--no-service-time"))
+        {
+            options.serviceTime = false;
+        }
+        else if (0 == strcmp(argument, "--keep-expired"))
+        {
+            options.keepExpired = true;
+        }
+        else if (0 == strcmp(argument, "--synthesize-flood"))
+        {
+            options.synthesizeFlood = true;
+        }
+        else if ('-' != argument[0] && !options.tracePath)
+        {
+            options.tracePath = argument;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return (nullptr != options.tracePath) != options.synthesizeFlood && options.speed >= 0;
+}
+
+//
+// NOTE: one second of an indexer reading a file every 10 us next to a quiet process
+//       reading or executing a file every 2 ms, each request is resolved in 50 us.
+//       The flood alone needs five resolver threads busy
+//
+static void SynthesizeFlood(std::vector<FSGuardTraceEvent> &events)
+{
+    constexpr uint64_t kDuration = 1000000000;
+    constexpr uint64_t kFloodInterval = 10000;
+    constexpr uint64_t kQuietInterval = 2000000;
+    constexpr uint64_t kServiceTime = 50000;
+    constexpr pid_t kFloodPid = 4000;
+    constexpr pid_t kQuietPid = 1000;
+
+    for (uint64_t timestamp = 0; timestamp < kDuration; timestamp += kFloodInterval)
+    {
+        if (0 == timestamp % kQuietInterval)
+        {
+            const bool execute = 0 == timestamp / kQuietInterval % 4;
+
+            events.push_back({ timestamp, kServiceTime, kQuietPid,
+                               execute ? FSGuardAction::Execute : FSGuardAction::Read, FSGuardTraceVerdict::Allow,
+                               execute ? "/usr/bin/tool" : "/home/user/Documents/report.txt" });
+        }
+
+        events.push_back({ timestamp, kServiceTime, kFloodPid, FSGuardAction::Read, FSGuardTraceVerdict::Allow,
+                           "/home/user/src/file" + std::to_string(timestamp / kFloodInterval % 50000) });
+    }
+}
+
+static double Percentile(const std::vector<uint64_t> &sorted, double percentile)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+
+    const size_t index = std::min(sorted.size() - 1, static_cast<size_t>(percentile * sorted.size() / 100));
+
+    return sorted[index] / 1000.0;
+}
+
+int main(int argc, const char *argv[])
+{
+    ReplayOptions options;
+    if (!ParseOptions(argc, argv, options))
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    //
+    // NOTE: whole trace is loaded up front, so reading does not skew the timing
+    //
+    std::vector<FSGuardTraceEvent> events;
+    if (options.synthesizeFlood)
+    {
+        SynthesizeFlood(events);
+        options.processes = std::max(options.processes, 2u);
+    }
+    else
+    {
+        FSGuardTraceReader reader;
+        if (!reader.open(options.tracePath))
+        {
+            fprintf(stderr, "failed to open trace %s\n", options.tracePath);
+            return 1;
+        }
+
+        FSGuardTraceEvent event;
+        while (reader.next(event))
+        {
+            events.push_back(event);
+        }
+    }
+
+    if (events.empty())
+    {
+        fprintf(stderr, "trace is empty\n");
+        return 1;
+    }
+
+    std::vector<uint8_t> policyData;
+    FSGuardPolicy policy;
+    if (options.policyPath)
+    {
+        std::ifstream stream(options.policyPath, std::ios::binary);
+        policyData.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+        if (!policy.load(policyData.data(), policyData.size()))
+        {
+            fprintf(stderr, "invalid policy %s\n", options.policyPath);
+            return 1;
+        }
+    }
+
+    //
+    // NOTE: both rings live in process memory, each side has its own view like
+    //       the driver and the client have over the shared mapping
+    //
+    std::vector<uint64_t> requestMemory((FSGuardRequestRing::memorySize(kFGRequestQueueSize) + 7) / 8);
+    std::vector<uint64_t> completionMemory((FSGuardCompletionRing::memorySize(kFGCompletionRingCapacity) + 7) / 8);
+
+    FSGuardRequestRing driverRequestRing;
+    FSGuardRequestRing clientRequestRing;
+    FSGuardCompletionRing clientCompletionRing;
+    FSGuardCompletionRing driverCompletionRing;
+
+    if (!driverRequestRing.attach(requestMemory.data(), requestMemory.size() * 8, kFGRequestQueueSize) ||
+        !clientRequestRing.attach(requestMemory.data(), requestMemory.size() * 8, kFGRequestQueueSize) ||
+        !clientCompletionRing.attach(completionMemory.data(), completionMemory.size() * 8, kFGCompletionRingCapacity) ||
+        !driverCompletionRing.attach(completionMemory.data(), completionMemory.size() * 8, kFGCompletionRingCapacity))
+    {
+        fprintf(stderr, "failed to set up rings\n");
+        return 1;
+    }
+
+    std::vector<uint64_t> enqueueTimes(events.size());
+    std::vector<uint64_t> deadlines(events.size());
+    std::vector<uint64_t> latencies(events.size());
+    std::atomic<size_t> completed {0};
+    std::atomic<size_t> late {0};
+    std::atomic<size_t> expired {0};
+    std::atomic<size_t> mismatches {0};
+    std::atomic<size_t> ringFull {0};
+
+    //
+    // NOTE: notifications replace mach port and driver doorbell of the real pipeline
+    //
+    std::mutex requestLock;
+    std::condition_variable requestAvailable;
+    std::mutex completionLock;
+    std::mutex doorbellLock;
+    std::condition_variable doorbell;
+    bool doorbellRung = false;
+    std::atomic<bool> stopping {false};
+
+    auto ringDoorbell = [&] {
+        std::lock_guard<std::mutex> lock(doorbellLock);
+        doorbellRung = true;
+        doorbell.notify_one();
+    };
+
+    FSGuardResolutionEstimate resolutionEstimate;
+
+    FSGuardResolverPool<ReplayTask> pool;
+    const bool started = pool.start(options.concurrency, std::max(kReplayTaskCount, options.concurrency), [&](ReplayTask &task) {
+        FSGuardRequest request = {};
+        if (!FSGuardDecodeRequest(task.record, task.size, request))
+        {
+            fprintf(stderr, "invalid record in the ring\n");
+            abort();
+        }
+
+        const size_t index = reinterpret_cast<uintptr_t>(request.rid);
+        const FSGuardTraceEvent &event = events[index];
+        bool allow = FSGuardTraceVerdict::Allow == event.verdict;
+
+        //
+        // NOTE: dropped like FSGuardClient does, the driver is told without a verdict
+        //
+        const uint64_t startTime = Now();
+        const bool drop = !options.keepExpired && resolutionEstimate.isExpired(startTime, request.timestamp, request.deadline);
+
+        if (!drop)
+        {
+            const FSGuardPolicyVerdict verdict = policy.evaluate(request.filePath, request.filePathLength, request.action);
+            if (FSGuardPolicyVerdict::Allow == verdict || FSGuardPolicyVerdict::Deny == verdict)
+            {
+                if (allow != (FSGuardPolicyVerdict::Allow == verdict))
+                {
+                    ++mismatches;
+                }
+
+                allow = FSGuardPolicyVerdict::Allow == verdict;
+            }
+            else if (options.serviceTime)
+            {
+                std::this_thread::sleep_for(std::chrono::nanoseconds(event.latency));
+            }
+
+            resolutionEstimate.sample(Now() - startTime);
+        }
+
+        bool pushed = false;
+        while (!pushed)
+        {
+            {
+                std::lock_guard<std::mutex> lock(completionLock);
+                pushed = clientCompletionRing.push(FSGuardResponse { request.rid, allow || drop, false, drop });
+            }
+
+            ringDoorbell();
+
+            if (!pushed)
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    if (!started)
+    {
+        fprintf(stderr, "failed to start resolver pool\n");
+        return 1;
+    }
+
+    //
+    // NOTE: driver side, collects verdicts like extDrainFSGuardResponses
+    //
+    std::thread drainer([&] {
+        while (completed + expired < events.size())
+        {
+            {
+                std::unique_lock<std::mutex> lock(doorbellLock);
+                doorbell.wait(lock, [&] { return doorbellRung; });
+                doorbellRung = false;
+            }
+
+            driverCompletionRing.drain([&](const FSGuardResponse &response) {
+                const size_t index = reinterpret_cast<uintptr_t>(response.rid);
+                const uint64_t now = Now();
+
+                //
+                // NOTE: dropped request gets the default verdict as soon as the driver knows
+                //
+                if (response.expired)
+                {
+                    latencies[index] = now - enqueueTimes[index];
+                    ++expired;
+                    return;
+                }
+
+                //
+                // NOTE: the driver stopped waiting at the deadline and ignores the verdict
+                //
+                if (deadlines[index] && now > deadlines[index])
+                {
+                    latencies[index] = deadlines[index] - enqueueTimes[index];
+                    ++late;
+                }
+                else
+                {
+                    latencies[index] = now - enqueueTimes[index];
+                }
+
+                ++completed;
+            });
+        }
+    });
+
+    //
+    // NOTE: client side, the same loop as FSGuardClient dequeue loop
+    //
+    std::thread consumer([&] {
+        for (;;)
+        {
+            ReplayTask *task = pool.acquire();
+            if (!task)
+            {
+                return;
+            }
+
+            const bool popped = clientRequestRing.pop([task](const void *data, uint32_t size) {
+                task->size = std::min(size, static_cast<uint32_t>(sizeof(task->record)));
+                memcpy(task->record, data, task->size);
+            });
+
+            if (popped)
+            {
+                const FSGuardRequestRecord *record = reinterpret_cast<const FSGuardRequestRecord *>(task->record);
+                pool.submit(task, FSGuardRequestLaneForAction(record->action), record->pid, record->deadline);
+                continue;
+            }
+
+            pool.release(task);
+
+            if (clientRequestRing.isCorrupted())
+            {
+                fprintf(stderr, "request ring is corrupted\n");
+                abort();
+            }
+
+            //
+            // NOTE: notification may be meant for the record popped already, the flag
+            //       is armed before every sleep, otherwise the next record is not notified
+            //
+            std::unique_lock<std::mutex> lock(requestLock);
+            while (!stopping && clientRequestRing.prepareToWait())
+            {
+                requestAvailable.wait(lock);
+            }
+
+            if (stopping && clientRequestRing.empty())
+            {
+                return;
+            }
+        }
+    });
+
+    //
+    // NOTE: driver side, publishes requests at recorded time scaled by speed
+    //
+    std::vector<uint8_t> record(kFGMaxRequestRecordSize);
+    FSGuardRequestRecord *header = reinterpret_cast<FSGuardRequestRecord *>(record.data());
+    const uint64_t verdictTimeout = options.deadline * 1000000ull;
+    const uint64_t firstTimestamp = events.front().timestamp;
+    const uint64_t start = Now();
+
+    for (size_t index = 0; index < events.size(); ++index)
+    {
+        const FSGuardTraceEvent &event = events[index];
+
+        if (options.speed > 0)
+        {
+            const uint64_t offset = static_cast<uint64_t>((event.timestamp - std::min(event.timestamp, firstTimestamp)) / options.speed);
+            std::this_thread::sleep_until(Clock::time_point(std::chrono::nanoseconds(start + offset)));
+        }
+
+        FSGuardRequest request = {};
+        request.rid = reinterpret_cast<void *>(static_cast<uintptr_t>(index));
+        request.pid = event.pid;
+        request.action = event.action;
+        request.filePath = event.path.c_str();
+        request.filePathLength = static_cast<uint32_t>(std::min<size_t>(event.path.size(), PATH_MAX - 1));
+
+        uint32_t size = 0;
+        if (!FSGuardEncodeRequest(request, record.data(), record.size(), size))
+        {
+            fprintf(stderr, "failed to encode request %zu\n", index);
+            return 1;
+        }
+
+        enqueueTimes[index] = Now();
+
+        //
+        // NOTE: stamped on every attempt like RequestQueue does, the driver waits
+        //       for the verdict from publishing the record
+        //
+        for (;;)
+        {
+            header->timestamp = Now();
+            header->deadline = verdictTimeout ? header->timestamp + verdictTimeout : 0;
+            deadlines[index] = header->deadline;
+
+            if (driverRequestRing.push(record.data(), size))
+            {
+                break;
+            }
+
+            ++ringFull;
+            std::this_thread::yield();
+        }
+
+        if (driverRequestRing.takeConsumerWaiting())
+        {
+            std::lock_guard<std::mutex> lock(requestLock);
+            requestAvailable.notify_one();
+        }
+    }
+
+    drainer.join();
+
+    {
+        std::lock_guard<std::mutex> lock(requestLock);
+        stopping = true;
+        requestAvailable.notify_one();
+    }
+
+    consumer.join();
+    pool.stop();
+
+    const double seconds = (Now() - start) / 1e9;
+
+    std::vector<uint64_t> sorted(latencies);
+    std::sort(sorted.begin(), sorted.end());
+
+    printf("requests      %zu\n", events.size());
+    printf("concurrency   %u\n", options.concurrency);
+    printf("duration      %.3f s\n", seconds);
+    printf("throughput    %.0f requests/s\n", events.size() / seconds);
+    printf("latency p50   %.1f us\n", Percentile(sorted, 50));
+    printf("latency p90   %.1f us\n", Percentile(sorted, 90));
+    printf("latency p99   %.1f us\n", Percentile(sorted, 99));
+    printf("latency p99.9 %.1f us\n", Percentile(sorted, 99.9));
+    printf("latency max   %.1f us\n", sorted.back() / 1000.0);
+    printf("ring full     %zu\n", ringFull.load());
+
+    //
+    // NOTE: goodput counts verdicts the driver still waited for
+    //
+    if (options.deadline)
+    {
+        const size_t onTime = completed - late;
+
+        printf("on time       %zu\n", onTime);
+        printf("late          %zu\n", late.load());
+        printf("expired       %zu\n", expired.load());
+        printf("goodput       %.0f verdicts/s\n", onTime / seconds);
+    }
+
+    if (options.policyPath)
+    {
+        printf("mismatches    %zu\n", mismatches.load());
+    }
+
+    //
+    // NOTE: shows whether a flooding process delays the others
+    //
+    if (options.processes)
+    {
+        std::map<pid_t, std::vector<uint64_t>> processLatencies;
+        for (size_t index = 0; index < events.size(); ++index)
+        {
+            processLatencies[events[index].pid].push_back(latencies[index]);
+        }
+
+        std::vector<std::pair<pid_t, std::vector<uint64_t>>> processes(processLatencies.begin(), processLatencies.end());
+        std::sort(processes.begin(), processes.end(), [](const auto &left, const auto &right) {
+            return left.second.size() > right.second.size();
+        });
+
+        printf("\n%8s %10s %12s %12s %12s\n", "pid", "requests", "p50 us", "p99 us", "max us");
+
+        for (size_t index = 0; index < std::min<size_t>(options.processes, processes.size()); ++index)
+        {
+            std::vector<uint64_t> &process = processes[index].second;
+            std::sort(process.begin(), process.end());
+
+            printf("%8d %10zu %12.1f %12.1f %12.1f\n", processes[index].first, process.size(),
+                   Percentile(process, 50), Percentile(process, 99), process.back() / 1000.0);
+        }
+    }
+
+    return 0;
+}
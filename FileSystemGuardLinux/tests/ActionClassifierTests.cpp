@@ -0,0 +1,148 @@
+//
+//  ActionClassifierTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "ActionClassifier.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+//
+// NOTE: values of sys/kauth.h, which is not available here
+//
+constexpr uint32_t KAUTH_VNODE_READ_DATA           = 1u << 1;
+constexpr uint32_t KAUTH_VNODE_LIST_DIRECTORY      = KAUTH_VNODE_READ_DATA;
+constexpr uint32_t KAUTH_VNODE_WRITE_DATA          = 1u << 2;
+constexpr uint32_t KAUTH_VNODE_ADD_FILE            = KAUTH_VNODE_WRITE_DATA;
+constexpr uint32_t KAUTH_VNODE_EXECUTE             = 1u << 3;
+constexpr uint32_t KAUTH_VNODE_SEARCH              = KAUTH_VNODE_EXECUTE;
+constexpr uint32_t KAUTH_VNODE_DELETE              = 1u << 4;
+constexpr uint32_t KAUTH_VNODE_APPEND_DATA         = 1u << 5;
+constexpr uint32_t KAUTH_VNODE_ADD_SUBDIRECTORY    = KAUTH_VNODE_APPEND_DATA;
+constexpr uint32_t KAUTH_VNODE_DELETE_CHILD        = 1u << 6;
+constexpr uint32_t KAUTH_VNODE_READ_ATTRIBUTES     = 1u << 7;
+constexpr uint32_t KAUTH_VNODE_WRITE_ATTRIBUTES    = 1u << 8;
+constexpr uint32_t KAUTH_VNODE_READ_EXTATTRIBUTES  = 1u << 9;
+constexpr uint32_t KAUTH_VNODE_WRITE_EXTATTRIBUTES = 1u << 10;
+constexpr uint32_t KAUTH_VNODE_READ_SECURITY       = 1u << 11;
+constexpr uint32_t KAUTH_VNODE_WRITE_SECURITY      = 1u << 12;
+constexpr uint32_t KAUTH_VNODE_TAKE_OWNERSHIP      = 1u << 13;
+constexpr uint32_t KAUTH_VNODE_SYNCHRONIZE         = 1u << 20;
+constexpr uint32_t KAUTH_VNODE_LINKTARGET          = 1u << 25;
+constexpr uint32_t KAUTH_VNODE_CHECKIMMUTABLE      = 1u << 26;
+constexpr uint32_t KAUTH_VNODE_ACCESS              = 1u << 31;
+
+static_assert(kVnodeReadData == KAUTH_VNODE_READ_DATA);
+static_assert(kVnodeWriteData == KAUTH_VNODE_WRITE_DATA);
+static_assert(kVnodeExecute == KAUTH_VNODE_EXECUTE);
+static_assert(kVnodeDelete == KAUTH_VNODE_DELETE);
+static_assert(kVnodeAppendData == KAUTH_VNODE_APPEND_DATA);
+static_assert(kVnodeDeleteChild == KAUTH_VNODE_DELETE_CHILD);
+static_assert(kVnodeReadAttributes == KAUTH_VNODE_READ_ATTRIBUTES);
+static_assert(kVnodeWriteAttributes == KAUTH_VNODE_WRITE_ATTRIBUTES);
+static_assert(kVnodeReadExtAttributes == KAUTH_VNODE_READ_EXTATTRIBUTES);
+static_assert(kVnodeWriteExtAttributes == KAUTH_VNODE_WRITE_EXTATTRIBUTES);
+static_assert(kVnodeReadSecurity == KAUTH_VNODE_READ_SECURITY);
+static_assert(kVnodeWriteSecurity == KAUTH_VNODE_WRITE_SECURITY);
+static_assert(kVnodeTakeOwnership == KAUTH_VNODE_TAKE_OWNERSHIP);
+static_assert(kVnodeAccess == KAUTH_VNODE_ACCESS);
+
+struct ClassificationCase
+{
+    const char *name;
+    uint32_t    vnodeAction;
+    bool        isDirectory;
+    uint32_t    expected;
+};
+
+static const ClassificationCase kCases[] =
+{
+    { "read",                     KAUTH_VNODE_READ_DATA,                                false, kReadMask },
+    { "list directory",           KAUTH_VNODE_LIST_DIRECTORY,                           true,  kReadMask },
+    { "write",                    KAUTH_VNODE_WRITE_DATA,                               false, kWriteMask },
+    { "add file",                 KAUTH_VNODE_ADD_FILE,                                 true,  kWriteMask },
+    { "execute",                  KAUTH_VNODE_EXECUTE,                                  false, kExecuteMask },
+    { "search",                   KAUTH_VNODE_SEARCH,                                   true,  0 },
+    { "delete file",              KAUTH_VNODE_DELETE,                                   false, kDeleteMask },
+    { "delete directory",         KAUTH_VNODE_DELETE,                                   true,  kDeleteMask },
+    { "append",                   KAUTH_VNODE_APPEND_DATA,                              false, kAppendMask },
+    { "add subdirectory",         KAUTH_VNODE_ADD_SUBDIRECTORY,                         true,  kWriteMask },
+    { "delete child of file",     KAUTH_VNODE_DELETE_CHILD,                             false, 0 },
+    { "delete child",             KAUTH_VNODE_DELETE_CHILD,                             true,  kDeleteMask },
+    { "read attributes",          KAUTH_VNODE_READ_ATTRIBUTES,                          false, kReadMetadataMask },
+    { "write attributes",         KAUTH_VNODE_WRITE_ATTRIBUTES,                         false, kWriteMetadataMask },
+    { "read xattr",               KAUTH_VNODE_READ_EXTATTRIBUTES,                       true,  kReadMetadataMask },
+    { "write xattr",              KAUTH_VNODE_WRITE_EXTATTRIBUTES,                      true,  kWriteMetadataMask },
+    { "read security",            KAUTH_VNODE_READ_SECURITY,                            false, kReadMetadataMask },
+    { "write security",           KAUTH_VNODE_WRITE_SECURITY,                           false, kWriteMetadataMask },
+    { "take ownership",           KAUTH_VNODE_TAKE_OWNERSHIP,                           true,  kWriteMetadataMask },
+    { "open read write",          KAUTH_VNODE_READ_DATA | KAUTH_VNODE_WRITE_DATA,       false, kReadMask | kWriteMask },
+    { "open append",              KAUTH_VNODE_READ_DATA | KAUTH_VNODE_APPEND_DATA,      false, kReadMask | kAppendMask },
+    { "search and list",          KAUTH_VNODE_SEARCH | KAUTH_VNODE_LIST_DIRECTORY,      true,  kReadMask },
+    { "rename into directory",    KAUTH_VNODE_ADD_FILE | KAUTH_VNODE_DELETE_CHILD,      true,  kWriteMask | kDeleteMask },
+    { "chmod and chown",          KAUTH_VNODE_WRITE_SECURITY | KAUTH_VNODE_TAKE_OWNERSHIP, false, kWriteMetadataMask },
+    { "unknown bits",             KAUTH_VNODE_SYNCHRONIZE | KAUTH_VNODE_LINKTARGET | KAUTH_VNODE_CHECKIMMUTABLE, false, 0 },
+    { "unknown with read",        KAUTH_VNODE_SYNCHRONIZE | KAUTH_VNODE_READ_DATA,      false, kReadMask },
+    { "access check",             KAUTH_VNODE_ACCESS | KAUTH_VNODE_READ_DATA,           false, 0 },
+    { "access check of execute",  KAUTH_VNODE_ACCESS | KAUTH_VNODE_EXECUTE,             false, 0 },
+    { "access check of delete",   KAUTH_VNODE_ACCESS | KAUTH_VNODE_DELETE_CHILD,        true,  0 },
+    { "nothing",                  0,                                                    false, 0 },
+};
+
+FG_TEST(VnodeActionsAreClassified)
+{
+    for (const ClassificationCase &test : kCases)
+    {
+        const uint32_t mask = ClassifyVnodeAction(test.vnodeAction, test.isDirectory);
+        if (test.expected != mask)
+        {
+            fprintf(stderr, "%s: 0x%x gives 0x%x, expected 0x%x\n", test.name, test.vnodeAction, mask, test.expected);
+        }
+
+        FG_CHECK(test.expected == mask);
+    }
+}
+
+struct PriorityCase
+{
+    uint32_t                   mask;
+    std::vector<FSGuardAction> expected;
+};
+
+FG_TEST(ActionsAreTakenInPriorityOrder)
+{
+    const PriorityCase cases[] =
+    {
+        { 0, {} },
+        { kReadMask, { FSGuardAction::Read } },
+        { kReadMask | kWriteMask, { FSGuardAction::Write, FSGuardAction::Read } },
+        { kDeleteMask | kWriteMask, { FSGuardAction::Delete, FSGuardAction::Write } },
+        { kExecuteMask | kDeleteMask | kReadMask, { FSGuardAction::Execute, FSGuardAction::Delete, FSGuardAction::Read } },
+        { kReadMetadataMask | kAppendMask | kWriteMetadataMask, { FSGuardAction::Append, FSGuardAction::WriteMetadata, FSGuardAction::ReadMetadata } },
+        { kFGActionMaskAll, { FSGuardAction::Execute, FSGuardAction::Delete, FSGuardAction::Write, FSGuardAction::Append,
+                              FSGuardAction::WriteMetadata, FSGuardAction::Read, FSGuardAction::ReadMetadata } },
+    };
+
+    for (const PriorityCase &test : cases)
+    {
+        uint32_t mask = test.mask;
+        std::vector<FSGuardAction> actions;
+        FSGuardAction action = FSGuardAction::Read;
+
+        while (NextAction(mask, action))
+        {
+            actions.push_back(action);
+        }
+
+        FG_CHECK(test.expected == actions);
+        FG_CHECK(0 == mask);
+    }
+}
@@ -0,0 +1,132 @@
+//
+//  ClientRouterTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "ClientRouter.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+static constexpr uint32_t kRead = FSGuardActionMask(FSGuardAction::Read);
+static constexpr uint32_t kWrite = FSGuardActionMask(FSGuardAction::Write);
+
+FG_TEST(SlotsAreAllocatedUntilFull)
+{
+    ClientRouter<4> router;
+
+    for (uint32_t slot = 0; slot < 4; ++slot)
+    {
+        FG_CHECK(slot == router.add(kRead));
+    }
+
+    FG_CHECK(ClientRouter<4>::kInvalidSlot == router.add(kRead));
+    FG_CHECK(4 == router.count());
+
+    router.remove(2);
+    FG_CHECK(!router.isUsed(2));
+    FG_CHECK(!router.isUsed(4));
+    FG_CHECK(3 == router.count());
+    FG_CHECK(2 == router.add(kWrite));
+}
+
+FG_TEST(MaskIsUnionOfSubscriptions)
+{
+    ClientRouter<4> router;
+
+    FG_CHECK(0 == router.mask());
+
+    const uint32_t reader = router.add(kRead);
+    const uint32_t writer = router.add(kWrite);
+    FG_CHECK((kRead | kWrite) == router.mask());
+
+    router.setMask(reader, ~0u);
+    FG_CHECK(kFGActionMaskAll == router.mask());
+
+    router.remove(reader);
+    router.setMask(writer, 0);
+    FG_CHECK(0 == router.mask());
+}
+
+FG_TEST(RouteChoosesSubscribedClient)
+{
+    ClientRouter<8> router;
+
+    FG_CHECK(ClientRouter<8>::kInvalidSlot == router.route(FSGuardAction::Read, 1));
+
+    const uint32_t reader = router.add(kRead);
+    const uint32_t writer = router.add(kWrite);
+
+    for (uint64_t key = 0; key < 1000; ++key)
+    {
+        FG_REQUIRE(reader == router.route(FSGuardAction::Read, key));
+        FG_REQUIRE(writer == router.route(FSGuardAction::Write, key));
+        FG_REQUIRE(ClientRouter<8>::kInvalidSlot == router.route(FSGuardAction::Execute, key));
+    }
+}
+
+//
+// NOTE: rendezvous hashing spreads keys evenly and moves only keys
+//       of the client which connected or closed
+//
+FG_TEST(MembershipChangeMovesOnlyAffectedKeys)
+{
+    constexpr uint32_t kKeys = 80000;
+
+    ClientRouter<8> router;
+    for (uint32_t index = 0; index < 4; ++index)
+    {
+        router.add(kRead);
+    }
+
+    std::vector<uint32_t> before(kKeys);
+    uint32_t perSlot[8] = {};
+
+    for (uint32_t key = 0; key < kKeys; ++key)
+    {
+        before[key] = router.route(FSGuardAction::Read, key * 0x1000193ull);
+        ++perSlot[before[key]];
+    }
+
+    for (uint32_t slot = 0; slot < 4; ++slot)
+    {
+        FG_CHECK(perSlot[slot] > kKeys / 4 * 9 / 10 && perSlot[slot] < kKeys / 4 * 11 / 10);
+    }
+
+    const uint32_t added = router.add(kRead);
+    uint32_t moved = 0;
+
+    for (uint32_t key = 0; key < kKeys; ++key)
+    {
+        const uint32_t slot = router.route(FSGuardAction::Read, key * 0x1000193ull);
+        if (slot != before[key])
+        {
+            FG_REQUIRE(added == slot);
+            ++moved;
+        }
+    }
+
+    FG_CHECK(moved > kKeys / 5 * 9 / 10 && moved < kKeys / 5 * 11 / 10);
+
+    router.remove(added);
+    router.remove(1);
+
+    for (uint32_t key = 0; key < kKeys; ++key)
+    {
+        const uint32_t slot = router.route(FSGuardAction::Read, key * 0x1000193ull);
+        if (1 != before[key])
+        {
+            FG_REQUIRE(slot == before[key]);
+        }
+        else
+        {
+            FG_REQUIRE(1 != slot);
+        }
+    }
+}
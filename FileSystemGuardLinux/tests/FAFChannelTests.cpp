@@ -0,0 +1,384 @@
+//
+//  FAFChannelTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FAFChannel.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+//
+// NOTE: ring memory aligned like the shared mapping
+//
+static std::vector<uint64_t> RingMemory(uint32_t capacity)
+{
+    return std::vector<uint64_t>((FAFFrameRing::memorySize(capacity) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+}
+
+static bool Write(FAFFrameRing &ring, uint32_t value, uint32_t payloadSize)
+{
+    uint8_t *payload = static_cast<uint8_t *>(ring.allocate(payloadSize));
+    if (!payload)
+    {
+        return false;
+    }
+
+    memset(payload, static_cast<int>(value & 0xFF), payloadSize);
+    memcpy(payload, &value, sizeof(value));
+
+    return true;
+}
+
+FG_TEST(AttachValidatesRing)
+{
+    auto memory = RingMemory(1024);
+    FAFFrameRing ring;
+
+    FG_CHECK(!ring.attach(nullptr, memory.size() * 8, 1024));
+    FG_CHECK(!ring.attach(memory.data(), memory.size() * 8, 1000));
+    FG_CHECK(!ring.attach(memory.data(), memory.size() * 8, 4));
+    FG_CHECK(!ring.attach(memory.data(), FAFFrameRing::memorySize(1024) - 1, 1024));
+    FG_CHECK(ring.attach(memory.data(), memory.size() * 8, 1024));
+}
+
+FG_TEST(FramesAreVisibleAfterCommit)
+{
+    auto memory = RingMemory(1024);
+    FAFFrameRing producer;
+    FAFFrameRing consumer;
+    FG_REQUIRE(producer.attach(memory.data(), memory.size() * 8, 1024));
+    FG_REQUIRE(consumer.attach(memory.data(), memory.size() * 8, 1024));
+
+    FG_CHECK(Write(producer, 1, 4));
+    FG_CHECK(Write(producer, 2, 20));
+    FG_CHECK(consumer.empty());
+
+    producer.commit();
+    FG_CHECK(!consumer.empty());
+
+    std::vector<uint32_t> values;
+    const uint32_t count = consumer.read([&](const void *payload, uint32_t size) {
+        uint32_t value = 0;
+        memcpy(&value, payload, sizeof(value));
+        values.push_back(value);
+        FG_CHECK(size >= sizeof(value) && 0 == size % kFAFFrameAlignment);
+    });
+
+    FG_CHECK(2 == count);
+    FG_CHECK((std::vector<uint32_t> { 1, 2 }) == values);
+    FG_CHECK(consumer.empty());
+}
+
+FG_TEST(FullRingRejectsUntilRelease)
+{
+    constexpr uint32_t kCapacity = 256;
+
+    auto memory = RingMemory(kCapacity);
+    FAFFrameRing producer;
+    FAFFrameRing consumer;
+    FG_REQUIRE(producer.attach(memory.data(), memory.size() * 8, kCapacity));
+    FG_REQUIRE(consumer.attach(memory.data(), memory.size() * 8, kCapacity));
+
+    FG_CHECK(nullptr == producer.allocate(kCapacity));
+
+    uint32_t written = 0;
+    while (Write(producer, written, 24))
+    {
+        ++written;
+    }
+
+    FG_CHECK(kCapacity / FAFFrameRing::frameSize(24) == written);
+    producer.commit();
+
+    //
+    // NOTE: read frames keep their space until release
+    //
+    FG_CHECK(written == consumer.read([](const void *, uint32_t) {}));
+    FG_CHECK(!Write(producer, 0, 24));
+
+    consumer.release();
+    FG_CHECK(Write(producer, 0, 24));
+}
+
+//
+// NOTE: frames of varying sizes never wrap, ring tail is skipped by padding
+//
+FG_TEST(FramesSurviveWrapAround)
+{
+    constexpr uint32_t kCapacity = 512;
+
+    auto memory = RingMemory(kCapacity);
+    FAFFrameRing producer;
+    FAFFrameRing consumer;
+    FG_REQUIRE(producer.attach(memory.data(), memory.size() * 8, kCapacity));
+    FG_REQUIRE(consumer.attach(memory.data(), memory.size() * 8, kCapacity));
+
+    uint32_t next = 0;
+    uint32_t expected = 0;
+
+    for (uint32_t round = 0; round < 2000; ++round)
+    {
+        for (uint32_t index = 0; index < round % 5 + 1; ++index)
+        {
+            if (!Write(producer, next, 4 + next % 61))
+            {
+                break;
+            }
+
+            ++next;
+        }
+
+        producer.commit();
+
+        consumer.read([&](const void *payload, uint32_t size) {
+            uint32_t value = 0;
+            memcpy(&value, payload, sizeof(value));
+
+            FG_CHECK(expected == value);
+            FG_CHECK(size == FAFFrameRing::frameSize(4 + value % 61) - sizeof(FAFFrame));
+            FG_CHECK(static_cast<const uint8_t *>(payload)[3 + value % 61] == (value & 0xFF) || 0 == value % 61);
+            ++expected;
+        });
+
+        consumer.release();
+    }
+
+    FG_CHECK(next == expected);
+    FG_CHECK(next > 2000);
+}
+
+FG_TEST(CommitReportsWaitingConsumer)
+{
+    auto memory = RingMemory(1024);
+    FAFFrameRing producer;
+    FAFFrameRing consumer;
+    FG_REQUIRE(producer.attach(memory.data(), memory.size() * 8, 1024));
+    FG_REQUIRE(consumer.attach(memory.data(), memory.size() * 8, 1024));
+
+    FG_CHECK(!producer.commit());
+
+    FG_CHECK(consumer.prepareToWait());
+    FG_CHECK(Write(producer, 1, 8));
+    FG_CHECK(producer.commit());
+
+    //
+    // NOTE: the flag is consumed by the first commit
+    //
+    FG_CHECK(Write(producer, 2, 8));
+    FG_CHECK(!producer.commit());
+
+    FG_CHECK(!consumer.prepareToWait());
+    FG_CHECK(2 == consumer.read([](const void *, uint32_t) {}));
+    consumer.release();
+    FG_CHECK(consumer.prepareToWait());
+}
+
+//
+// NOTE: the peer is not trusted, cursors and frames in shared memory are validated
+//
+FG_TEST(CorruptedRingIsRejected)
+{
+    constexpr uint32_t kCapacity = 1024;
+
+    auto memory = RingMemory(kCapacity);
+    FAFFrameRingHeader *header = reinterpret_cast<FAFFrameRingHeader *>(memory.data());
+    FAFFrameRing producer;
+    FAFFrameRing consumer;
+    FG_REQUIRE(producer.attach(memory.data(), memory.size() * 8, kCapacity));
+    FG_REQUIRE(consumer.attach(memory.data(), memory.size() * 8, kCapacity));
+
+    header->published = kCapacity * 4;
+    FG_CHECK(0 == consumer.read([](const void *, uint32_t) { FG_CHECK(false); }));
+    header->published = 0;
+
+    header->consumed = UINT64_MAX / 2;
+    FG_CHECK(nullptr == producer.allocate(8));
+    header->consumed = 0;
+
+    FG_CHECK(Write(producer, 1, 8));
+    FG_CHECK(Write(producer, 2, 8));
+    producer.commit();
+
+    FAFFrame *first = reinterpret_cast<FAFFrame *>(header + 1);
+    first->size = 3;
+
+    FG_CHECK(0 == consumer.read([](const void *, uint32_t) { FG_CHECK(false); }));
+    FG_CHECK(consumer.empty());
+}
+
+FG_TEST(ChannelSharesMemoryBetweenSides)
+{
+    const size_t size = FAFChannel::memorySize(4096, 1024);
+    std::vector<uint64_t> memory((size + 7) / 8);
+
+    FAFChannel filter;
+    FAFChannel resolver;
+
+    FG_CHECK(!filter.create(memory.data(), size - 1, 4096, 1024));
+    FG_CHECK(!resolver.attach(memory.data(), size));
+    FG_REQUIRE(filter.create(memory.data(), size, 4096, 1024));
+    FG_CHECK(!resolver.attach(memory.data(), size - 1));
+    FG_REQUIRE(resolver.attach(memory.data(), size));
+
+    FAFRequestFrame *request = static_cast<FAFRequestFrame *>(filter.requests().allocate(sizeof(FAFRequestFrame) + 5));
+    FG_REQUIRE(request);
+    *request = { 42, 100, 1, 4, 0 };
+    memcpy(request + 1, "/tmp", 5);
+    filter.requests().commit();
+
+    uint64_t id = 0;
+    resolver.requests().read([&](const void *payload, uint32_t payloadSize) {
+        const FAFRequestFrame *frame = static_cast<const FAFRequestFrame *>(payload);
+        FG_CHECK(payloadSize >= sizeof(FAFRequestFrame) + frame->pathLength + 1);
+        FG_CHECK(0 == strcmp("/tmp", reinterpret_cast<const char *>(frame + 1)));
+        id = frame->id;
+    });
+    resolver.requests().release();
+
+    FAFVerdictFrame *verdict = static_cast<FAFVerdictFrame *>(resolver.verdicts().allocate(sizeof(FAFVerdictFrame)));
+    FG_REQUIRE(verdict);
+    *verdict = { id, 0, 0 };
+    resolver.verdicts().commit();
+
+    uint32_t verdicts = filter.verdicts().read([&](const void *payload, uint32_t) {
+        const FAFVerdictFrame *frame = static_cast<const FAFVerdictFrame *>(payload);
+        FG_CHECK(42 == frame->id);
+        FG_CHECK(0 == frame->allow);
+    });
+
+    FG_CHECK(1 == verdicts);
+}
+
+FG_TEST(DoorbellWakesAndShutsDown)
+{
+    int filterFd = -1;
+    int resolverFd = -1;
+    FG_REQUIRE(FAFDoorbell::createPair(filterFd, resolverFd));
+
+    FAFDoorbell filter(filterFd);
+    FAFDoorbell resolver(resolverFd);
+
+    filter.ring();
+    filter.ring();
+    FG_CHECK(resolver.wait());
+
+    std::thread waiter([&] { FG_CHECK(!filter.wait()); });
+    filter.shutdown();
+    waiter.join();
+
+    close(filterFd);
+    FG_CHECK(!resolver.wait());
+    close(resolverFd);
+}
+
+//
+// NOTE: requests and verdicts cross threads in batches, consumer sleeps on the doorbell
+//
+FG_TEST(BatchesCrossThreads)
+{
+    constexpr uint32_t kRequests = 100000;
+
+    const size_t size = FAFChannel::memorySize(8192, 4096);
+    std::vector<uint64_t> memory((size + 7) / 8);
+
+    FAFChannel filter;
+    FAFChannel resolver;
+    FG_REQUIRE(filter.create(memory.data(), size, 8192, 4096));
+    FG_REQUIRE(resolver.attach(memory.data(), size));
+
+    int filterFd = -1;
+    int resolverFd = -1;
+    FG_REQUIRE(FAFDoorbell::createPair(filterFd, resolverFd));
+
+    FAFDoorbell filterDoorbell(filterFd);
+    FAFDoorbell resolverDoorbell(resolverFd);
+
+    std::thread resolverThread([&] {
+        uint32_t expected = 0;
+
+        while (expected < kRequests)
+        {
+            if (resolver.requests().empty() && resolver.requests().prepareToWait())
+            {
+                if (!resolverDoorbell.wait())
+                {
+                    break;
+                }
+
+                continue;
+            }
+
+            resolver.requests().read([&](const void *payload, uint32_t) {
+                const FAFRequestFrame *frame = static_cast<const FAFRequestFrame *>(payload);
+                FG_CHECK(expected == frame->id);
+                ++expected;
+            });
+            resolver.requests().release();
+        }
+    });
+
+    uint64_t next = 0;
+    while (next < kRequests)
+    {
+        uint32_t batch = 0;
+        while (next < kRequests && batch < 64)
+        {
+            FAFRequestFrame *frame = static_cast<FAFRequestFrame *>(filter.requests().allocate(sizeof(FAFRequestFrame)));
+            if (!frame)
+            {
+                break;
+            }
+
+            *frame = { next++, 1, 1, 0, 0 };
+            ++batch;
+        }
+
+        if (filter.requests().commit())
+        {
+            filterDoorbell.ring();
+        }
+
+        if (!batch)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    resolverThread.join();
+
+    close(filterFd);
+    close(resolverFd);
+}
+
+FG_TEST(ChannelMemoryIsShareable)
+{
+    const size_t size = FAFChannel::memorySize(kFAFChannelRequestCapacity, kFAFChannelVerdictCapacity);
+
+    const int fd = FAFCreateChannelMemory(size);
+    FG_REQUIRE(-1 != fd);
+
+    void *filterMemory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    void *resolverMemory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    FG_REQUIRE(MAP_FAILED != filterMemory && MAP_FAILED != resolverMemory);
+
+    FAFChannel filter;
+    FAFChannel resolver;
+    FG_CHECK(filter.create(filterMemory, size, kFAFChannelRequestCapacity, kFAFChannelVerdictCapacity));
+    FG_CHECK(resolver.attach(resolverMemory, size));
+
+    munmap(filterMemory, size);
+    munmap(resolverMemory, size);
+}
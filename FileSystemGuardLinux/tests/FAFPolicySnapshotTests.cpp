@@ -0,0 +1,221 @@
+//
+//  FAFPolicySnapshotTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FAFPolicySnapshot.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr uint32_t kRead = FSGuardActionMask(FSGuardAction::Read);
+static constexpr uint32_t kWrite = FSGuardActionMask(FSGuardAction::Write);
+static constexpr uint32_t kExecute = FSGuardActionMask(FSGuardAction::Execute);
+
+using Result = FAFPolicyEvaluator::Result;
+
+static Result Evaluate(const FAFPolicyEvaluator &evaluator, const std::string &path, uint32_t actionMask)
+{
+    return evaluator.evaluate(path.data(), static_cast<uint32_t>(path.size()), actionMask);
+}
+
+static std::vector<uint8_t> Snapshot(uint64_t generation, uint32_t allowMask, uint32_t denyMask)
+{
+    FAFPolicySnapshotBuilder builder;
+    builder.addRule("/data", allowMask, denyMask);
+    builder.addRule("/data/public", kRead | kWrite | kExecute, 0);
+
+    return builder.build(generation);
+}
+
+FG_TEST(LoadRejectsMalformedSnapshot)
+{
+    const std::vector<uint8_t> valid = Snapshot(1, kRead, kWrite);
+    FG_REQUIRE(FAFPolicySnapshot::Load(valid.data(), valid.size()));
+
+    FG_CHECK(!FAFPolicySnapshot::Load(nullptr, valid.size()));
+    FG_CHECK(!FAFPolicySnapshot::Load(valid.data(), sizeof(FAFPolicySnapshotHeader) - 1));
+    FG_CHECK(!FAFPolicySnapshot::Load(valid.data(), valid.size() - 1));
+
+    auto corrupt = [&](size_t offset, uint8_t value) {
+        std::vector<uint8_t> data = valid;
+        data[offset] = value;
+        return FAFPolicySnapshot::Load(data.data(), data.size());
+    };
+
+    FG_CHECK(!corrupt(offsetof(FAFPolicySnapshotHeader, magic), 0));
+    FG_CHECK(!corrupt(offsetof(FAFPolicySnapshotHeader, version), 2));
+    FG_CHECK(!corrupt(offsetof(FAFPolicySnapshotHeader, headerSize), sizeof(FAFPolicySnapshotHeader) + 1));
+    FG_CHECK(!corrupt(offsetof(FAFPolicySnapshotHeader, headerSize), 0xFF));
+}
+
+//
+// NOTE: snapshot comes from another process, random corruption is rejected or loads
+//       into a policy which evaluates without reading outside the copy
+//
+FG_TEST(LoadSurvivesMutations)
+{
+    FAFPolicySnapshotBuilder builder;
+    for (uint32_t index = 0; index < 16; ++index)
+    {
+        builder.addRule("/volume/dir" + std::to_string(index), kRead, kWrite);
+    }
+
+    const std::vector<uint8_t> valid = builder.build(7);
+    std::mt19937_64 random(23);
+
+    for (uint32_t iteration = 0; iteration < 20000; ++iteration)
+    {
+        std::vector<uint8_t> data = valid;
+        const uint32_t mutations = 1 + random() % 4;
+
+        for (uint32_t index = 0; index < mutations; ++index)
+        {
+            data[random() % data.size()] = static_cast<uint8_t>(random());
+        }
+
+        data.resize(data.size() - random() % 3);
+
+        const std::shared_ptr<const FAFPolicySnapshot> snapshot = FAFPolicySnapshot::Load(data.data(), data.size());
+        if (snapshot)
+        {
+            const FSGuardPolicyVerdict verdict = snapshot->evaluate("/volume/dir3/file", 17, kRead);
+            FG_CHECK(verdict <= FSGuardPolicyVerdict::Ask);
+        }
+    }
+}
+
+FG_TEST(SnapshotCombinesActions)
+{
+    FAFPolicySnapshotBuilder builder;
+    builder.addRule("/data", kRead | kWrite, kExecute);
+    builder.addRule("/data/ask", kRead, 0);
+
+    const std::vector<uint8_t> data = builder.build(1);
+    const std::shared_ptr<const FAFPolicySnapshot> snapshot = FAFPolicySnapshot::Load(data.data(), data.size());
+    FG_REQUIRE(snapshot);
+    FG_CHECK(1 == snapshot->generation());
+
+    FG_CHECK(FSGuardPolicyVerdict::Allow == snapshot->evaluate("/data/file", 10, kRead | kWrite));
+    FG_CHECK(FSGuardPolicyVerdict::Deny == snapshot->evaluate("/data/file", 10, kRead | kExecute));
+    FG_CHECK(FSGuardPolicyVerdict::Ask == snapshot->evaluate("/data/ask/file", 14, kRead | kWrite));
+    FG_CHECK(FSGuardPolicyVerdict::Allow == snapshot->evaluate("/data/ask/file", 14, kRead));
+    FG_CHECK(FSGuardPolicyVerdict::NoMatch == snapshot->evaluate("/other", 6, kRead));
+}
+
+FG_TEST(EvaluatorFollowsGenerations)
+{
+    FAFPolicyEvaluator evaluator;
+
+    FG_CHECK(!evaluator.isLoaded());
+    FG_CHECK(Result::Interactive == Evaluate(evaluator, "/data/file", kRead));
+
+    const std::vector<uint8_t> denying = Snapshot(2, kRead, kWrite);
+    const std::vector<uint8_t> allowing = Snapshot(1, kRead | kWrite, 0);
+    const std::vector<uint8_t> asking = Snapshot(2, kRead, 0);
+
+    FG_REQUIRE(evaluator.load(denying.data(), denying.size()));
+    FG_CHECK(Result::Allow == Evaluate(evaluator, "/data/file", kRead));
+    FG_CHECK(Result::Deny == Evaluate(evaluator, "/data/file", kWrite));
+    FG_CHECK(Result::Deny == evaluator.evaluate("/data/file", 10, FSGuardAction::Write));
+    FG_CHECK(Result::Allow == Evaluate(evaluator, "/data/public/file", kWrite));
+    FG_CHECK(Result::Allow == Evaluate(evaluator, "/elsewhere", kWrite));
+
+    //
+    // NOTE: older snapshot is ignored, snapshot of the same generation replaces
+    //
+    FG_CHECK(!evaluator.load(allowing.data(), allowing.size()));
+    FG_CHECK(Result::Deny == Evaluate(evaluator, "/data/file", kWrite));
+
+    FG_CHECK(evaluator.load(asking.data(), asking.size()));
+    FG_CHECK(Result::Interactive == Evaluate(evaluator, "/data/file", kRead | kWrite));
+
+    FG_CHECK(!evaluator.load(asking.data(), asking.size() - 1));
+    FG_CHECK(evaluator.isLoaded());
+
+    evaluator.clear();
+    FG_CHECK(!evaluator.isLoaded());
+    FG_CHECK(evaluator.load(allowing.data(), allowing.size()));
+}
+
+//
+// NOTE: readers never wait for the writer and always see one whole snapshot
+//
+FG_TEST(ReadersSeeWholeSnapshots)
+{
+    constexpr uint32_t kReaders = 3;
+    constexpr uint32_t kLoads = 2000;
+
+    FAFPolicyEvaluator evaluator;
+
+    std::vector<std::vector<uint8_t>> snapshots;
+    for (uint64_t generation = 1; generation <= kLoads; ++generation)
+    {
+        snapshots.push_back(generation & 1 ? Snapshot(generation, kRead, kWrite) : Snapshot(generation, kRead | kWrite, 0));
+    }
+
+    FG_REQUIRE(evaluator.load(snapshots[0].data(), snapshots[0].size()));
+
+    std::atomic<bool> done {false};
+    std::atomic<uint64_t> invalid {0};
+    std::atomic<uint64_t> evaluations {0};
+    std::vector<std::thread> readers;
+
+    for (uint32_t reader = 0; reader < kReaders; ++reader)
+    {
+        readers.emplace_back([&] {
+            uint64_t count = 0;
+
+            while (!done.load(std::memory_order_relaxed))
+            {
+                const Result write = Evaluate(evaluator, "/data/file", kWrite);
+                const Result read = Evaluate(evaluator, "/data/dir/file", kRead);
+                const Result open = Evaluate(evaluator, "/data/public/file", kWrite);
+
+                if (Result::Interactive == write || Result::Allow != read || Result::Allow != open)
+                {
+                    invalid.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                if (0 == ++count % 64)
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            evaluations.fetch_add(count, std::memory_order_relaxed);
+        });
+    }
+
+    for (uint32_t index = 1; index < kLoads; ++index)
+    {
+        FG_CHECK(evaluator.load(snapshots[index].data(), snapshots[index].size()));
+
+        if (0 == index % 16)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    done = true;
+
+    for (std::thread &reader : readers)
+    {
+        reader.join();
+    }
+
+    FG_CHECK(0 == invalid.load());
+    FG_CHECK(evaluations.load() > 0);
+    FG_CHECK(Result::Allow == Evaluate(evaluator, "/data/file", kWrite));
+}
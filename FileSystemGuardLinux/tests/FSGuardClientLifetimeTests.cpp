@@ -0,0 +1,227 @@
+//
+//  FSGuardClientLifetimeTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardClientLifetime.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using LifetimeService = FSGuardLifetimeService<4>;
+
+//
+// NOTE: verdict timeout of the driver, a request which waits for it was not failed over
+//
+constexpr auto kVerdictTimeout = std::chrono::seconds(15);
+
+static double Milliseconds(Clock::duration duration)
+{
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+static void WaitForPending(const FSGuardLifetimeClient &client, uint32_t count)
+{
+    while (client.pendingCount() < count)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+//
+// NOTE: daemon which denies everything, it holds own reference to the client
+//
+static std::thread StartDaemon(FSGuardLifetimeClient *client)
+{
+    client->retain();
+
+    return std::thread([client] {
+        while (FSGuardLifetimeRequest *request = client->nextRequest())
+        {
+            client->postResponse(request, false);
+        }
+
+        client->release();
+    });
+}
+
+//
+// NOTE: daemon restart under load, the old client never answers, the new one
+//       connects while its requests wait and gets all of them once the old closes
+//
+FG_TEST(ReconnectFailsOverInFlightRequests)
+{
+    constexpr uint32_t kRequestCount = 1000;
+
+    std::atomic<uint32_t> liveClients {0};
+    std::vector<std::unique_ptr<FSGuardLifetimeRequest>> requests;
+    std::vector<Clock::time_point> finished(kRequestCount);
+    std::thread daemon;
+
+    {
+        LifetimeService service(kVerdictTimeout);
+
+        FSGuardLifetimeClient *oldClient = new FSGuardLifetimeClient(&liveClients);
+        oldClient->retain();
+
+        const uint32_t oldSlot = service.newUserClient(oldClient);
+        FG_REQUIRE(LifetimeService::kInvalidSlot != oldSlot);
+
+        //
+        // NOTE: requests are created before the threads, growing the vector
+        //       would move it under threads already reading it
+        //
+        for (uint32_t index = 0; index < kRequestCount; ++index)
+        {
+            requests.emplace_back(new FSGuardLifetimeRequest);
+            requests.back()->pid = index;
+        }
+
+        std::vector<std::thread> threads;
+        for (uint32_t index = 0; index < kRequestCount; ++index)
+        {
+            threads.emplace_back([&, index] {
+                service.processRequest(*requests[index]);
+                finished[index] = Clock::now();
+            });
+        }
+
+        WaitForPending(*oldClient, kRequestCount);
+
+        //
+        // NOTE: opening and closing clients does not wait for requests in flight
+        //
+        FSGuardLifetimeClient *newClient = new FSGuardLifetimeClient(&liveClients);
+        daemon = StartDaemon(newClient);
+
+        const Clock::time_point connectStart = Clock::now();
+        FG_CHECK(LifetimeService::kInvalidSlot != service.newUserClient(newClient));
+        const Clock::time_point closeStart = Clock::now();
+        service.handleClose(oldSlot);
+        const Clock::time_point closeEnd = Clock::now();
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+
+        Clock::time_point last = closeStart;
+        uint32_t failedOver = 0;
+
+        for (uint32_t index = 0; index < kRequestCount; ++index)
+        {
+            failedOver += requests[index]->resolved && !requests[index]->allow;
+            last = std::max(last, finished[index]);
+        }
+
+        printf("    connect %.3f ms, close %.3f ms, %u requests failed over in %.1f ms\n",
+               Milliseconds(closeStart - connectStart), Milliseconds(closeEnd - closeStart),
+               failedOver, Milliseconds(last - closeStart));
+
+        FG_CHECK(kRequestCount == failedOver);
+        FG_CHECK(last - closeStart < kVerdictTimeout / 10);
+
+        //
+        // NOTE: requests released their references, only the test keeps the old client
+        //
+        FG_CHECK(oldClient->isClosed());
+        FG_CHECK(0 == oldClient->pendingCount());
+        oldClient->release();
+        FG_CHECK(1 == liveClients.load());
+    }
+
+    daemon.join();
+    FG_CHECK(0 == liveClients.load());
+}
+
+//
+// NOTE: without another client, aborted requests keep the default verdict
+//       and return at once instead of waiting for the timeout
+//
+FG_TEST(CloseOfLastClientReleasesWaiters)
+{
+    constexpr uint32_t kRequestCount = 100;
+
+    std::atomic<uint32_t> liveClients {0};
+    LifetimeService service(kVerdictTimeout);
+
+    FSGuardLifetimeClient *client = new FSGuardLifetimeClient(&liveClients);
+    client->retain();
+
+    const uint32_t slot = service.newUserClient(client);
+
+    std::vector<std::unique_ptr<FSGuardLifetimeRequest>> requests;
+    std::vector<std::thread> threads;
+    std::atomic<uint32_t> answered {0};
+
+    for (uint32_t index = 0; index < kRequestCount; ++index)
+    {
+        requests.emplace_back(new FSGuardLifetimeRequest);
+    }
+
+    for (uint32_t index = 0; index < kRequestCount; ++index)
+    {
+        threads.emplace_back([&, index] {
+            answered += service.processRequest(*requests[index]);
+        });
+    }
+
+    WaitForPending(*client, kRequestCount);
+
+    const Clock::time_point start = Clock::now();
+    service.handleClose(slot);
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    FG_CHECK(Clock::now() - start < kVerdictTimeout / 10);
+    FG_CHECK(0 == answered.load());
+
+    for (const auto &request : requests)
+    {
+        FG_CHECK(!request->resolved && request->allow);
+    }
+
+    //
+    // NOTE: closed client sends nothing, late verdict is dropped
+    //
+    FSGuardLifetimeRequest late;
+    client->sendRequest(late, kVerdictTimeout);
+    FG_CHECK(!late.resolved);
+    FG_CHECK(!client->postResponse(requests[0].get(), false));
+    FG_CHECK(nullptr == client->nextRequest());
+
+    client->release();
+    FG_CHECK(0 == liveClients.load());
+
+    FSGuardLifetimeRequest unrouted;
+    FG_CHECK(!service.processRequest(unrouted));
+}
+
+FG_TEST(TimedOutRequestIsNotAnswered)
+{
+    FSGuardLifetimeClient *client = new FSGuardLifetimeClient;
+    FSGuardLifetimeRequest request;
+
+    client->sendRequest(request, std::chrono::milliseconds(5));
+    FG_CHECK(!request.resolved);
+    FG_CHECK(0 == client->pendingCount());
+    FG_CHECK(!client->postResponse(&request, false));
+
+    client->release();
+}
@@ -0,0 +1,177 @@
+//
+//  FSGuardCompletionRingTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardCompletionRing.h"
+
+#include <stdint.h>
+
+#include <thread>
+#include <vector>
+
+constexpr uint32_t kCapacity = 16;
+
+//
+// NOTE: producer and consumer views over the same memory like the client and the driver
+//
+struct CompletionRings
+{
+    CompletionRings()
+        : memory((FSGuardCompletionRing::memorySize(kCapacity) + 7) / 8)
+    {
+        attached = producer.attach(memory.data(), memory.size() * 8, kCapacity) &&
+                   consumer.attach(memory.data(), memory.size() * 8, kCapacity);
+    }
+
+    std::vector<uint64_t>  memory;
+    FSGuardCompletionRing  producer;
+    FSGuardCompletionRing  consumer;
+    bool                   attached = false;
+};
+
+static FSGuardResponse Response(uintptr_t rid, bool allow)
+{
+    FSGuardResponse response = {};
+    response.rid = reinterpret_cast<void *>(rid);
+    response.allow = allow;
+
+    return response;
+}
+
+FG_TEST(AttachValidatesArguments)
+{
+    std::vector<uint64_t> memory((FSGuardCompletionRing::memorySize(kCapacity) + 7) / 8);
+    FSGuardCompletionRing ring;
+
+    FG_CHECK(!ring.attach(nullptr, memory.size() * 8, kCapacity));
+    FG_CHECK(!ring.attach(memory.data(), memory.size() * 8, 0));
+    FG_CHECK(!ring.attach(memory.data(), memory.size() * 8, 12));
+    FG_CHECK(!ring.attach(memory.data(), FSGuardCompletionRing::memorySize(kCapacity) - 1, kCapacity));
+    FG_CHECK(ring.attach(memory.data(), memory.size() * 8, kCapacity));
+    FG_CHECK(ring.isAttached());
+
+    ring.detach();
+    FG_CHECK(!ring.isAttached());
+}
+
+FG_TEST(DrainDeliversResponsesInOrder)
+{
+    CompletionRings rings;
+    FG_REQUIRE(rings.attached);
+
+    for (uintptr_t rid = 1; rid <= 5; ++rid)
+    {
+        FG_CHECK(rings.producer.push(Response(rid, 0 == rid % 2)));
+    }
+
+    std::vector<FSGuardResponse> drained;
+    FG_CHECK(5 == rings.consumer.drain([&](const FSGuardResponse &response) {
+        drained.push_back(response);
+    }));
+
+    FG_REQUIRE(5 == drained.size());
+    for (uintptr_t rid = 1; rid <= 5; ++rid)
+    {
+        FG_CHECK(reinterpret_cast<void *>(rid) == drained[rid - 1].rid);
+        FG_CHECK((0 == rid % 2) == drained[rid - 1].allow);
+    }
+
+    FG_CHECK(rings.producer.empty());
+    FG_CHECK(0 == rings.consumer.drain([](const FSGuardResponse &) {}));
+}
+
+FG_TEST(PushFailsWhenFullAndWrapsAfterDrain)
+{
+    CompletionRings rings;
+    FG_REQUIRE(rings.attached);
+
+    for (uintptr_t rid = 1; rid <= kCapacity; ++rid)
+    {
+        FG_CHECK(rings.producer.push(Response(rid, true)));
+    }
+
+    FG_CHECK(!rings.producer.push(Response(kCapacity + 1, true)));
+
+    uintptr_t expected = 1;
+    bool ordered = true;
+
+    for (uint32_t lap = 0; lap < 5; ++lap)
+    {
+        rings.consumer.drain([&](const FSGuardResponse &response) {
+            ordered = ordered && reinterpret_cast<void *>(expected++) == response.rid;
+        });
+
+        for (uint32_t index = 0; index < kCapacity; ++index)
+        {
+            FG_CHECK(rings.producer.push(Response(kCapacity + 1 + lap * kCapacity + index, true)));
+        }
+    }
+
+    FG_CHECK(ordered);
+}
+
+//
+// NOTE: tail published by the peer more than capacity ahead is skipped
+//       instead of reading entries which were never written
+//
+FG_TEST(CorruptedTailIsSkipped)
+{
+    CompletionRings rings;
+    FG_REQUIRE(rings.attached);
+
+    FSGuardCompletionRingHeader *header = reinterpret_cast<FSGuardCompletionRingHeader *>(rings.memory.data());
+    header->tail = kCapacity * 4;
+
+    uint32_t visited = 0;
+    FG_CHECK(0 == rings.consumer.drain([&](const FSGuardResponse &) {
+        ++visited;
+    }));
+
+    FG_CHECK(0 == visited);
+    FG_CHECK(kCapacity * 4 == header->head);
+}
+
+FG_TEST(ConcurrentProducerAndConsumer)
+{
+    CompletionRings rings;
+    FG_REQUIRE(rings.attached);
+
+    constexpr uintptr_t kCount = 200000;
+
+    std::thread producer([&] {
+        for (uintptr_t rid = 1; rid <= kCount; ++rid)
+        {
+            while (!rings.producer.push(Response(rid, 0 != (rid & 1))))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uintptr_t expected = 1;
+    bool ordered = true;
+
+    while (expected <= kCount)
+    {
+        const uint32_t drained = rings.consumer.drain([&](const FSGuardResponse &response) {
+            ordered = ordered && reinterpret_cast<void *>(expected) == response.rid && (0 != (expected & 1)) == response.allow;
+            ++expected;
+        });
+
+        if (!drained)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+
+    FG_CHECK(ordered);
+    FG_CHECK(kCount + 1 == expected);
+}
@@ -0,0 +1,335 @@
+//
+//  FSGuardFanotifyClientTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardFanotifyClient.h"
+#include "FSGuardPolicyBuilder.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/fanotify.h>
+#include <sys/socket.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// NOTE: the client is attached to one end of a socket pair instead of a fanotify
+//       descriptor, the test writes event batches to the other end and reads
+//       the responses back, so nothing needs CAP_SYS_ADMIN. Sequenced packets keep
+//       batches apart, one read of the client is one written batch
+//
+class RecordingDelegate : public FSGuardFanotifyDelegate
+{
+public:
+    struct Request
+    {
+        void       *rid;
+        std::string path;
+        uint64_t    timestamp;
+        uint64_t    deadline;
+    };
+
+    void resolveRequest(const FSGuardRequest &request) override
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        m_requests.push_back(Request { request.rid, std::string(request.filePath, request.filePathLength),
+                                       request.timestamp, request.deadline });
+        m_changed.notify_all();
+    }
+
+    bool waitForRequests(size_t count, std::vector<Request> &requests)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+
+        const bool received = m_changed.wait_for(lock, std::chrono::seconds(5), [&] { return m_requests.size() >= count; });
+        requests = m_requests;
+
+        return received;
+    }
+
+private:
+    std::mutex              m_lock;
+    std::condition_variable m_changed;
+    std::vector<Request>    m_requests;
+};
+
+class ClientFixture
+{
+public:
+    explicit ClientFixture(uint64_t verdictTimeout = kFGFanotifyVerdictTimeout)
+        : m_client(m_delegate, verdictTimeout)
+    {
+        int descriptors[2] = { -1, -1 };
+        if (0 != socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0, descriptors))
+        {
+            return;
+        }
+
+        m_peer = descriptors[1];
+
+        if (!m_client.attach(descriptors[0]))
+        {
+            ::close(m_peer);
+            m_peer = -1;
+            return;
+        }
+
+        m_reader = std::thread([this] { m_client.run(); });
+    }
+
+    ~ClientFixture()
+    {
+        stop();
+
+        if (-1 != m_peer)
+        {
+            ::close(m_peer);
+        }
+    }
+
+    bool isReady() const
+    {
+        return -1 != m_peer;
+    }
+
+    void stop()
+    {
+        if (m_reader.joinable())
+        {
+            m_client.stop();
+            m_reader.join();
+        }
+    }
+
+    //
+    // NOTE: events about the given files of another process in one batch
+    //
+    std::vector<int> sendEvents(const std::vector<std::string> &paths, uint64_t mask = FAN_OPEN_PERM, pid_t pid = getppid())
+    {
+        std::vector<int> descriptors;
+        std::vector<fanotify_event_metadata> events;
+
+        for (const std::string &path : paths)
+        {
+            fanotify_event_metadata event = {};
+            event.event_len = sizeof(event);
+            event.vers = FANOTIFY_METADATA_VERSION;
+            event.metadata_len = sizeof(event);
+            event.mask = mask;
+            event.fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            event.pid = pid;
+
+            descriptors.push_back(event.fd);
+            events.push_back(event);
+        }
+
+        (void)send(m_peer, events.data(), events.size() * sizeof(fanotify_event_metadata), 0);
+
+        return descriptors;
+    }
+
+    //
+    // NOTE: one write of the client, empty if nothing came in time
+    //
+    std::vector<fanotify_response> receiveResponses(int timeout = 5000)
+    {
+        pollfd descriptor = { m_peer, POLLIN, 0 };
+        if (1 != poll(&descriptor, 1, timeout))
+        {
+            return {};
+        }
+
+        std::vector<fanotify_response> responses(kFGFanotifyMaxBatch);
+        const ssize_t size = recv(m_peer, responses.data(), responses.size() * sizeof(fanotify_response), 0);
+        responses.resize(size > 0 ? static_cast<size_t>(size) / sizeof(fanotify_response) : 0);
+
+        return responses;
+    }
+
+    FSGuardFanotifyClient & client()
+    {
+        return m_client;
+    }
+
+    RecordingDelegate & delegate()
+    {
+        return m_delegate;
+    }
+
+private:
+    static constexpr size_t kFGFanotifyMaxBatch = 1024;
+
+    RecordingDelegate     m_delegate;
+    FSGuardFanotifyClient m_client;
+    int                   m_peer = -1;
+    std::thread           m_reader;
+};
+
+static std::string MakeDirectory()
+{
+    char pattern[] = "/tmp/fsguardfanotifyXXXXXX";
+    char resolved[PATH_MAX] = {};
+
+    if (!mkdtemp(pattern) || !realpath(pattern, resolved))
+    {
+        return std::string();
+    }
+
+    return resolved;
+}
+
+static std::string MakeFile(const std::string &directory, const char *name)
+{
+    const std::string path = directory + "/" + name;
+
+    const int fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_CLOEXEC, 0600);
+    if (-1 != fd)
+    {
+        ::close(fd);
+    }
+
+    return path;
+}
+
+FG_TEST(BatchIsAnsweredInOneWrite)
+{
+    constexpr uint32_t kRead = FSGuardActionMask(FSGuardAction::Read);
+
+    const std::string directory = MakeDirectory();
+    FG_REQUIRE(!directory.empty());
+
+    const std::string allowed = MakeFile(directory, "allowed");
+    const std::string denied = MakeFile(directory, "denied");
+
+    ClientFixture fixture;
+    FG_REQUIRE(fixture.isReady());
+
+    FSGuardPolicyBuilder builder;
+    builder.addRule(allowed, kRead, 0);
+    builder.addRule(denied, 0, kRead);
+
+    const std::vector<uint8_t> policy = builder.build();
+    FG_REQUIRE(fixture.client().loadPolicy(policy.data(), policy.size()));
+
+    std::vector<std::string> paths;
+    for (uint32_t index = 0; index < 64; ++index)
+    {
+        paths.push_back(index % 2 ? denied : allowed);
+    }
+
+    const std::vector<int> descriptors = fixture.sendEvents(paths);
+    const std::vector<fanotify_response> responses = fixture.receiveResponses();
+
+    FG_REQUIRE(paths.size() == responses.size());
+
+    for (size_t index = 0; index < responses.size(); ++index)
+    {
+        FG_CHECK(descriptors[index] == responses[index].fd);
+        FG_CHECK((index % 2 ? FAN_DENY : FAN_ALLOW) == responses[index].response);
+    }
+
+    //
+    // NOTE: own events pass through without asking anyone
+    //
+    const std::vector<int> own = fixture.sendEvents({ allowed, denied }, FAN_OPEN_PERM, getpid());
+    const std::vector<fanotify_response> ownResponses = fixture.receiveResponses();
+
+    FG_REQUIRE(2 == ownResponses.size());
+    FG_CHECK(FAN_ALLOW == ownResponses[0].response && FAN_ALLOW == ownResponses[1].response);
+
+    unlink(allowed.c_str());
+    unlink(denied.c_str());
+    rmdir(directory.c_str());
+}
+
+FG_TEST(DelegateVerdictIsMatchedByRequestId)
+{
+    constexpr uint64_t kTimeout = 60000000000ull;
+
+    ClientFixture fixture(kTimeout);
+    FG_REQUIRE(fixture.isReady());
+
+    const std::vector<int> descriptors = fixture.sendEvents({ "/dev/null", "/dev/zero" }, FAN_OPEN_EXEC_PERM);
+
+    std::vector<RecordingDelegate::Request> requests;
+    FG_REQUIRE(fixture.delegate().waitForRequests(2, requests));
+
+    FG_CHECK("/dev/null" == requests[0].path);
+    FG_CHECK(0 != requests[0].timestamp);
+    FG_CHECK(kTimeout == requests[0].deadline - requests[0].timestamp);
+    FG_CHECK(requests[0].timestamp <= requests[1].timestamp);
+
+    //
+    // NOTE: id of another event on the same descriptor and unknown descriptor
+    //
+    const uintptr_t rid = reinterpret_cast<uintptr_t>(requests[0].rid);
+    FG_CHECK(!fixture.client().postResponse(FSGuardResponse { reinterpret_cast<void *>(rid + (1ull << 32)), false, false, false }));
+    FG_CHECK(!fixture.client().postResponse(FSGuardResponse { reinterpret_cast<void *>(rid + 4096), false, false, false }));
+    FG_CHECK(!fixture.client().postResponse(FSGuardResponse { nullptr, false, false, false }));
+
+    FG_CHECK(fixture.client().postResponse(FSGuardResponse { requests[0].rid, false, false, false }));
+    FG_CHECK(!fixture.client().postResponse(FSGuardResponse { requests[0].rid, true, false, false }));
+
+    std::vector<fanotify_response> responses = fixture.receiveResponses();
+    FG_REQUIRE(1 == responses.size());
+    FG_CHECK(descriptors[0] == responses[0].fd);
+    FG_CHECK(FAN_DENY == responses[0].response);
+
+    //
+    // NOTE: event still pending on stop is allowed
+    //
+    fixture.stop();
+
+    responses = fixture.receiveResponses();
+    FG_REQUIRE(1 == responses.size());
+    FG_CHECK(descriptors[1] == responses[0].fd);
+    FG_CHECK(FAN_ALLOW == responses[0].response);
+
+    FG_CHECK(!fixture.client().postResponse(FSGuardResponse { requests[1].rid, false, false, false }));
+}
+
+FG_TEST(OverdueEventIsAllowed)
+{
+    constexpr uint64_t kTimeout = 50000000;
+
+    ClientFixture fixture(kTimeout);
+    FG_REQUIRE(fixture.isReady());
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<int> descriptors = fixture.sendEvents({ "/dev/null" });
+
+    std::vector<RecordingDelegate::Request> requests;
+    FG_REQUIRE(fixture.delegate().waitForRequests(1, requests));
+
+    const std::vector<fanotify_response> responses = fixture.receiveResponses();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    FG_REQUIRE(1 == responses.size());
+    FG_CHECK(descriptors[0] == responses[0].fd);
+    FG_CHECK(FAN_ALLOW == responses[0].response);
+    FG_CHECK(elapsed >= std::chrono::nanoseconds(kTimeout));
+    FG_CHECK(elapsed < std::chrono::seconds(2));
+
+    //
+    // NOTE: late verdict of the delegate is rejected
+    //
+    FG_CHECK(!fixture.client().postResponse(FSGuardResponse { requests[0].rid, false, false, false }));
+    FG_CHECK(fixture.receiveResponses(100).empty());
+}
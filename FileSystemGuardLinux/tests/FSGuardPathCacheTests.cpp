@@ -0,0 +1,239 @@
+//
+//  FSGuardPathCacheTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardPathCache.h"
+#include "IdentityFilter.h"
+
+#include <stdint.h>
+
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+
+static FSGuardFileIdentity Identity(uint64_t fileid, uint32_t generation = 1)
+{
+    return FSGuardFileIdentity { 3, fileid, generation };
+}
+
+static void Insert(FSGuardPathCache &cache, uint64_t fileid, const std::string &path)
+{
+    cache.insert(Identity(fileid), path.data(), path.size());
+}
+
+static bool Contains(FSGuardPathCache &cache, uint64_t fileid)
+{
+    std::string path;
+    return cache.lookup(Identity(fileid), path);
+}
+
+FG_TEST(LookupReturnsInsertedPath)
+{
+    FSGuardPathCache cache(8);
+    std::string path;
+
+    FG_CHECK(!cache.lookup(Identity(1), path));
+
+    Insert(cache, 1, "/usr/bin/true");
+    FG_CHECK(cache.lookup(Identity(1), path));
+    FG_CHECK("/usr/bin/true" == path);
+
+    //
+    // NOTE: new generation of the file replaces the old path
+    //
+    FG_CHECK(!cache.lookup(Identity(1, 2), path));
+    cache.insert(Identity(1, 2), "/tmp/x", 6);
+    FG_CHECK(cache.lookup(Identity(1, 2), path));
+    FG_CHECK("/tmp/x" == path);
+    FG_CHECK(!cache.lookup(Identity(1, 1), path));
+    FG_CHECK(1 == cache.size());
+
+    cache.erase(Identity(1, 7));
+    FG_CHECK(0 == cache.size());
+    FG_CHECK(!cache.lookup(Identity(1, 2), path));
+}
+
+FG_TEST(LeastRecentlyUsedIsEvicted)
+{
+    FSGuardPathCache cache(3);
+
+    Insert(cache, 1, "/1");
+    Insert(cache, 2, "/2");
+    Insert(cache, 3, "/3");
+
+    //
+    // NOTE: lookup and insert of a known file both refresh it
+    //
+    FG_CHECK(Contains(cache, 1));
+    Insert(cache, 2, "/2b");
+
+    Insert(cache, 4, "/4");
+    FG_CHECK(3 == cache.size());
+    FG_CHECK(!Contains(cache, 3));
+    FG_CHECK(Contains(cache, 1));
+    FG_CHECK(Contains(cache, 2));
+    FG_CHECK(Contains(cache, 4));
+
+    Insert(cache, 5, "/5");
+    FG_CHECK(!Contains(cache, 1));
+}
+
+FG_TEST(EraseSubtreeMatchesWholeComponents)
+{
+    FSGuardPathCache cache(16);
+
+    Insert(cache, 1, "/a");
+    Insert(cache, 2, "/a/b");
+    Insert(cache, 3, "/a/b/c");
+    Insert(cache, 4, "/ab");
+    Insert(cache, 5, "/b/a");
+
+    cache.eraseSubtree("/a/", 3);
+    FG_CHECK(!Contains(cache, 1));
+    FG_CHECK(!Contains(cache, 2));
+    FG_CHECK(!Contains(cache, 3));
+    FG_CHECK(Contains(cache, 4));
+    FG_CHECK(Contains(cache, 5));
+
+    cache.eraseSubtree("/", 1);
+    FG_CHECK(0 == cache.size());
+}
+
+FG_TEST(ClearEmptiesCache)
+{
+    FSGuardPathCache cache(4);
+
+    for (uint64_t fileid = 0; fileid < 10; ++fileid)
+    {
+        Insert(cache, fileid, "/file" + std::to_string(fileid));
+    }
+
+    FG_CHECK(4 == cache.size());
+
+    cache.clear();
+    FG_CHECK(0 == cache.size());
+    FG_CHECK(!Contains(cache, 9));
+
+    Insert(cache, 9, "/9");
+    FG_CHECK(Contains(cache, 9));
+}
+
+//
+// NOTE: random operations against a list based LRU model, small key space
+//       keeps the table full of collisions for backward shift deletion
+//
+FG_TEST(RandomOperationsMatchModel)
+{
+    constexpr uint32_t kCapacity = 32;
+
+    FSGuardPathCache cache(kCapacity);
+    std::list<std::pair<uint64_t, std::string>> model;
+    std::mt19937_64 random(17);
+
+    auto find = [&model](uint64_t fileid) {
+        for (auto iterator = model.begin(); iterator != model.end(); ++iterator)
+        {
+            if (iterator->first == fileid)
+            {
+                return iterator;
+            }
+        }
+
+        return model.end();
+    };
+
+    for (uint32_t step = 0; step < 200000; ++step)
+    {
+        const uint64_t fileid = random() % 80;
+        const uint32_t operation = random() % 8;
+        const auto found = find(fileid);
+
+        if (operation < 4)
+        {
+            const std::string path = "/f" + std::to_string(fileid) + "/" + std::to_string(step);
+
+            if (found != model.end())
+            {
+                model.erase(found);
+            }
+            else if (model.size() == kCapacity)
+            {
+                model.pop_back();
+            }
+
+            model.emplace_front(fileid, path);
+            Insert(cache, fileid, path);
+        }
+        else if (operation < 7)
+        {
+            std::string path;
+            const bool hit = cache.lookup(Identity(fileid), path);
+
+            FG_REQUIRE(hit == (found != model.end()));
+            if (hit)
+            {
+                FG_REQUIRE(found->second == path);
+                model.splice(model.begin(), model, found);
+            }
+        }
+        else
+        {
+            cache.erase(Identity(fileid));
+            if (found != model.end())
+            {
+                model.erase(found);
+            }
+        }
+
+        FG_REQUIRE(model.size() == cache.size());
+    }
+}
+
+FG_TEST(IdentityFilterTracksSentIdentities)
+{
+    auto filter = std::make_unique<IdentityFilter<1024>>();
+
+    FG_CHECK(filter->isEmpty());
+    FG_CHECK(!filter->contains(Identity(1)));
+
+    filter->insert(Identity(1));
+    FG_CHECK(!filter->isEmpty());
+    FG_CHECK(filter->contains(Identity(1)));
+    FG_CHECK(!filter->contains(Identity(1, 2)));
+    FG_CHECK(!filter->contains(Identity(2)));
+
+    //
+    // NOTE: removal ignores the generation
+    //
+    FG_CHECK(filter->remove(Identity(1, 5)));
+    FG_CHECK(!filter->contains(Identity(1)));
+    FG_CHECK(!filter->remove(Identity(1)));
+
+    filter->insert(Identity(2));
+    filter->clear();
+    FG_CHECK(filter->isEmpty());
+    FG_CHECK(!filter->contains(Identity(2)));
+}
+
+//
+// NOTE: colliding identity replaces the previous one, which is then just sent again
+//
+FG_TEST(IdentityFilterCollisionReplaces)
+{
+    IdentityFilter<1> filter;
+
+    filter.insert(Identity(1));
+    filter.insert(Identity(2));
+
+    FG_CHECK(!filter.contains(Identity(1)));
+    FG_CHECK(filter.contains(Identity(2)));
+    FG_CHECK(!filter.remove(Identity(1)));
+}
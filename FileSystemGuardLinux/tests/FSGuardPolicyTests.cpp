@@ -0,0 +1,266 @@
+//
+//  FSGuardPolicyTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardPolicy.h"
+#include "FSGuardPolicyBuilder.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+static constexpr uint32_t kRead = FSGuardActionMask(FSGuardAction::Read);
+static constexpr uint32_t kWrite = FSGuardActionMask(FSGuardAction::Write);
+
+static std::vector<uint8_t> TwoRulePolicy()
+{
+    FSGuardPolicyBuilder builder;
+    builder.addRule("/data", kRead, kWrite);
+    builder.addRule("/home", kRead | kWrite, 0);
+
+    return builder.build();
+}
+
+static bool Load(const std::vector<uint8_t> &blob)
+{
+    FSGuardPolicy policy;
+
+    return policy.load(blob.data(), blob.size());
+}
+
+static void SetHeaderField(std::vector<uint8_t> &blob, size_t offset, uint32_t value, size_t size = sizeof(uint32_t))
+{
+    memcpy(blob.data() + offset, &value, size);
+}
+
+static void SetRuleField(std::vector<uint8_t> &blob, uint32_t index, size_t offset, uint32_t value)
+{
+    memcpy(blob.data() + sizeof(FSGuardPolicyHeader) + index * sizeof(FSGuardPolicyRule) + offset, &value, sizeof(value));
+}
+
+static void SetString(std::vector<uint8_t> &blob, uint32_t ruleCount, const char *string, size_t length)
+{
+    std::copy_n(string, length, blob.begin() + sizeof(FSGuardPolicyHeader) + ruleCount * sizeof(FSGuardPolicyRule));
+}
+
+FG_TEST(BuiltPolicyLoads)
+{
+    const std::vector<uint8_t> blob = TwoRulePolicy();
+
+    FSGuardPolicy policy;
+    FG_REQUIRE(policy.load(blob.data(), blob.size()));
+    FG_CHECK(policy.isLoaded());
+    FG_CHECK(2 == policy.ruleCount());
+    FG_CHECK((kRead | kWrite) == policy.actionMask());
+
+}
+
+FG_TEST(EmptyPolicyLoads)
+{
+    FSGuardPolicyBuilder builder;
+    std::vector<uint8_t> blob = builder.build();
+
+    //
+    // NOTE: rules of the header-only blob are never read, GCC at -O3 can not
+    //       tell from the size of the allocation and warns, grown blob keeps it quiet
+    //
+    blob.reserve(blob.size() + sizeof(FSGuardPolicyRule));
+
+    FSGuardPolicy policy;
+    FG_REQUIRE(policy.load(blob.data(), blob.size()));
+    FG_CHECK(0 == policy.ruleCount());
+    FG_CHECK(0 == policy.actionMask());
+}
+
+FG_TEST(MalformedHeaderIsRejected)
+{
+    const std::vector<uint8_t> valid = TwoRulePolicy();
+
+    FG_CHECK(!Load(std::vector<uint8_t>(valid.begin(), valid.begin() + sizeof(FSGuardPolicyHeader) - 1)));
+    FG_CHECK(!Load(std::vector<uint8_t>(valid.begin(), valid.end() - 1)));
+
+    std::vector<uint8_t> longer = valid;
+    longer.push_back(0);
+    FG_CHECK(!Load(longer));
+
+    const struct
+    {
+        size_t   offset;
+        uint32_t value;
+        size_t   size;
+    } corruptions[] =
+    {
+        { offsetof(FSGuardPolicyHeader, magic),       0x4C504747,                            4 },
+        { offsetof(FSGuardPolicyHeader, version),     kFGPolicyVersion + 1,                  2 },
+        { offsetof(FSGuardPolicyHeader, headerSize),  sizeof(FSGuardPolicyHeader) - 4,       2 },
+        { offsetof(FSGuardPolicyHeader, headerSize),  sizeof(FSGuardPolicyHeader) + 1,       2 },
+        { offsetof(FSGuardPolicyHeader, headerSize),  0xFFF0,                                2 },
+        { offsetof(FSGuardPolicyHeader, ruleSize),    sizeof(FSGuardPolicyRule) + 4,         4 },
+        { offsetof(FSGuardPolicyHeader, ruleCount),   3,                                     4 },
+        { offsetof(FSGuardPolicyHeader, ruleCount),   0xFFFFFFFF,                            4 },
+        { offsetof(FSGuardPolicyHeader, stringsSize), 8,                                     4 },
+    };
+
+    for (const auto &corruption : corruptions)
+    {
+        std::vector<uint8_t> blob = valid;
+        SetHeaderField(blob, corruption.offset, corruption.value, corruption.size);
+
+        FG_CHECK(!Load(blob));
+    }
+
+    FSGuardPolicy policy;
+    FG_CHECK(!policy.load(nullptr, valid.size()));
+    FG_CHECK(!policy.isLoaded());
+
+    //
+    // NOTE: rules are read in place, so the blob must be aligned for them
+    //
+    std::vector<uint8_t> shifted(1);
+    shifted.insert(shifted.end(), valid.begin(), valid.end());
+    FG_CHECK(!policy.load(shifted.data() + 1, valid.size()));
+}
+
+FG_TEST(OutOfRangePathIsRejected)
+{
+    const std::vector<uint8_t> valid = TwoRulePolicy();
+    const uint32_t stringsSize = 10;
+
+    const struct
+    {
+        uint32_t offset;
+        uint32_t length;
+    } ranges[] =
+    {
+        { stringsSize + 1, 0 },
+        { 0, stringsSize + 1 },
+        { 5, 6 },
+        { 0xFFFFFFFF, 2 },
+        { 2, 0xFFFFFFFF },
+    };
+
+    for (const auto &range : ranges)
+    {
+        std::vector<uint8_t> blob = valid;
+        SetRuleField(blob, 1, offsetof(FSGuardPolicyRule, pathOffset), range.offset);
+        SetRuleField(blob, 1, offsetof(FSGuardPolicyRule, pathLength), range.length);
+
+        FG_CHECK(!Load(blob));
+    }
+
+    //
+    // NOTE: last byte of the string table is still in range
+    //
+    std::vector<uint8_t> blob = valid;
+    SetRuleField(blob, 1, offsetof(FSGuardPolicyRule, pathOffset), 5);
+    SetRuleField(blob, 1, offsetof(FSGuardPolicyRule, pathLength), 5);
+    FG_CHECK(Load(blob));
+}
+
+FG_TEST(UnsortedRulesAreRejected)
+{
+    std::vector<uint8_t> blob = TwoRulePolicy();
+
+    //
+    // NOTE: "/data" then "/home", swap the strings the rules point to
+    //
+    SetRuleField(blob, 0, offsetof(FSGuardPolicyRule, pathOffset), 5);
+    SetRuleField(blob, 1, offsetof(FSGuardPolicyRule, pathOffset), 0);
+    FG_CHECK(!Load(blob));
+
+    //
+    // NOTE: duplicate path would make binary search ambiguous
+    //
+    blob = TwoRulePolicy();
+    SetRuleField(blob, 1, offsetof(FSGuardPolicyRule, pathOffset), 0);
+    FG_CHECK(!Load(blob));
+
+    //
+    // NOTE: "/data" precedes "/data/x" precedes "/datab"
+    //
+    FSGuardPolicyBuilder builder;
+    builder.addRule("/datab", kRead, 0);
+    builder.addRule("/data/x", kRead, 0);
+    builder.addRule("/data", kRead, 0);
+    FG_CHECK(Load(builder.build()));
+}
+
+FG_TEST(NonNormalizedPathIsRejected)
+{
+    FSGuardPolicyBuilder builder;
+    builder.addRule("/a/bc", kRead, 0);
+
+    const std::vector<uint8_t> valid = builder.build();
+    FG_REQUIRE(Load(valid));
+
+    const struct
+    {
+        const char *path;
+        bool        valid;
+    } paths[] =
+    {
+        { "/a/bc", true },
+        { "/a/b/", false },
+        { "//abc", false },
+        { "/a//c", false },
+        { "a/bcd", false },
+        { "/a/b\0", false },
+        { "/a\0bc", false },
+    };
+
+    for (const auto &path : paths)
+    {
+        std::vector<uint8_t> blob = valid;
+        SetString(blob, 1, path.path, 5);
+
+        FG_CHECK(path.valid == Load(blob));
+    }
+
+    std::vector<uint8_t> blob = valid;
+    SetRuleField(blob, 0, offsetof(FSGuardPolicyRule, pathLength), 0);
+    FG_CHECK(!Load(blob));
+
+    FG_CHECK(FSGuardPolicy::isNormalized("/", 1));
+    FG_CHECK(!FSGuardPolicy::isNormalized("//", 2));
+}
+
+FG_TEST(MostSpecificRuleDecides)
+{
+    FSGuardPolicyBuilder builder;
+    builder.addRule("/", kRead, 0);
+    builder.addRule("/data", kRead, kWrite);
+    builder.addRule("//data/public/", kRead | kWrite, 0);
+    builder.addRule("/data/ask", 0, 0);
+
+    const std::vector<uint8_t> blob = builder.build();
+
+    FSGuardPolicy policy;
+    FG_REQUIRE(policy.load(blob.data(), blob.size()));
+
+    auto evaluate = [&](const std::string &path, FSGuardAction action) {
+        return policy.evaluate(path.data(), static_cast<uint32_t>(path.size()), action);
+    };
+
+    FG_CHECK(FSGuardPolicyVerdict::Deny == evaluate("/data/file", FSGuardAction::Write));
+    FG_CHECK(FSGuardPolicyVerdict::Allow == evaluate("/data/public/file", FSGuardAction::Write));
+    FG_CHECK(FSGuardPolicyVerdict::Allow == evaluate("/data/public/", FSGuardAction::Write));
+    FG_CHECK(FSGuardPolicyVerdict::Ask == evaluate("/data/ask/file", FSGuardAction::Read));
+    FG_CHECK(FSGuardPolicyVerdict::Deny == evaluate("/data", FSGuardAction::Write));
+
+    //
+    // NOTE: components are whole, "/database" is covered by the root rule only
+    //
+    FG_CHECK(FSGuardPolicyVerdict::Ask == evaluate("/database", FSGuardAction::Write));
+    FG_CHECK(FSGuardPolicyVerdict::Allow == evaluate("/database", FSGuardAction::Read));
+    FG_CHECK(FSGuardPolicyVerdict::NoMatch == evaluate("relative/data", FSGuardAction::Read));
+}
@@ -0,0 +1,243 @@
+//
+//  FSGuardRequestCodecTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardRequestCodec.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+static FSGuardRequest MakeRequest(const std::string &path)
+{
+    FSGuardRequest request = {};
+    request.rid = reinterpret_cast<void *>(0x1234);
+    request.pid = 100;
+    request.action = FSGuardAction::Write;
+    request.filePath = path.c_str();
+    request.filePathLength = static_cast<uint32_t>(path.size());
+    request.flags = kFGRecordFlagIdentity;
+    request.identity = FSGuardFileIdentity { 7, 42, 3 };
+    request.ppid = 1;
+    request.uid = 501;
+    request.processName = "editor";
+    request.timestamp = 1000;
+    request.deadline = 2000;
+
+    return request;
+}
+
+static std::vector<uint8_t> Encode(const FSGuardRequest &request)
+{
+    std::vector<uint8_t> buffer(kFGMaxRequestRecordSize);
+    uint32_t size = 0;
+
+    if (!FSGuardEncodeRequest(request, buffer.data(), buffer.size(), size))
+    {
+        return {};
+    }
+
+    buffer.resize(size);
+    return buffer;
+}
+
+FG_TEST(RoundTripKeepsEveryField)
+{
+    const std::string path = "/Users/user/Documents/report.txt";
+    const FSGuardRequest request = MakeRequest(path);
+
+    const std::vector<uint8_t> record = Encode(request);
+    FG_REQUIRE(!record.empty());
+    FG_CHECK(FSGuardRequestRecordSize(static_cast<uint32_t>(path.size())) == record.size());
+    FG_CHECK(0 == record.size() % kFGRequestRecordAlignment);
+
+    FSGuardRequest decoded = {};
+    FG_REQUIRE(FSGuardDecodeRequest(record.data(), record.size(), decoded));
+
+    FG_CHECK(request.rid == decoded.rid);
+    FG_CHECK(request.pid == decoded.pid);
+    FG_CHECK(request.action == decoded.action);
+    FG_CHECK(path == std::string(decoded.filePath, decoded.filePathLength));
+    FG_CHECK('\0' == decoded.filePath[decoded.filePathLength]);
+    FG_CHECK(request.flags == decoded.flags);
+    FG_CHECK(42 == decoded.identity.fileid && 7 == decoded.identity.fsid && 3 == decoded.identity.generation);
+    FG_CHECK(request.ppid == decoded.ppid);
+    FG_CHECK(request.uid == decoded.uid);
+    FG_CHECK(std::string("editor") == decoded.processName);
+    FG_CHECK(request.timestamp == decoded.timestamp);
+    FG_CHECK(request.deadline == decoded.deadline);
+}
+
+FG_TEST(LongProcessNameIsTruncated)
+{
+    const std::string path = "/tmp/file";
+    FSGuardRequest request = MakeRequest(path);
+
+    const std::string name(100, 'n');
+    request.processName = name.c_str();
+
+    const std::vector<uint8_t> record = Encode(request);
+    FSGuardRequest decoded = {};
+    FG_REQUIRE(FSGuardDecodeRequest(record.data(), record.size(), decoded));
+    FG_CHECK(kFGProcessNameSize - 1 == strlen(decoded.processName));
+}
+
+FG_TEST(EncodeRejectsSmallBuffer)
+{
+    const std::string path(200, 'a');
+    const FSGuardRequest request = MakeRequest(path);
+
+    std::vector<uint8_t> buffer(FSGuardRequestRecordSize(200) - 1);
+    uint32_t size = 0;
+
+    FG_CHECK(!FSGuardEncodeRequest(request, buffer.data(), buffer.size(), size));
+    FG_CHECK(!FSGuardEncodeRequest(request, nullptr, 0, size));
+}
+
+FG_TEST(TruncatedRecordIsRejected)
+{
+    const std::vector<uint8_t> record = Encode(MakeRequest("/var/log/system.log"));
+    FG_REQUIRE(!record.empty());
+
+    for (size_t size = 0; size < record.size(); ++size)
+    {
+        //
+        // NOTE: exact size copy, so reading past it is visible to sanitizers
+        //
+        const std::vector<uint8_t> prefix(record.begin(), record.begin() + size);
+        FSGuardRequest decoded = {};
+
+        FG_CHECK(!FSGuardDecodeRequest(prefix.data(), prefix.size(), decoded));
+    }
+}
+
+FG_TEST(InvalidHeaderFieldsAreRejected)
+{
+    const std::vector<uint8_t> valid = Encode(MakeRequest("/etc/hosts"));
+    FG_REQUIRE(!valid.empty());
+
+    auto decodes = [&](void (*mutate)(FSGuardRequestRecord &)) {
+        std::vector<uint8_t> record = valid;
+        if (record.size() < sizeof(FSGuardRequestRecord))
+        {
+            return true;
+        }
+
+        mutate(*reinterpret_cast<FSGuardRequestRecord *>(record.data()));
+
+        FSGuardRequest decoded = {};
+        return FSGuardDecodeRequest(record.data(), record.size(), decoded);
+    };
+
+    FG_CHECK(!decodes([](FSGuardRequestRecord &record) { record.version = kFGRequestRecordVersion - 1; }));
+    FG_CHECK(!decodes([](FSGuardRequestRecord &record) { record.headerSize = sizeof(FSGuardRequestRecord) - 8; }));
+    FG_CHECK(!decodes([](FSGuardRequestRecord &record) { record.size += kFGRequestRecordAlignment; }));
+    FG_CHECK(!decodes([](FSGuardRequestRecord &record) { record.pathLength = record.size; }));
+    FG_CHECK(!decodes([](FSGuardRequestRecord &record) { record.pathLength -= 1; }));
+    FG_CHECK(!decodes([](FSGuardRequestRecord &record) { record.action = static_cast<FSGuardAction>(kFGActionCount); }));
+    FG_CHECK(!decodes([](FSGuardRequestRecord &record) { std::fill(std::begin(record.processName), std::end(record.processName), 'x'); }));
+    FG_CHECK(!decodes([](FSGuardRequestRecord &record) { record.flags = kFGRecordFlagPathOmitted; }));
+}
+
+//
+// NOTE: newer driver may append header fields, the path follows the longer header
+//
+FG_TEST(LongerHeaderOfNewerVersionIsAccepted)
+{
+    const std::string path = "/Applications/App.app";
+    const std::vector<uint8_t> valid = Encode(MakeRequest(path));
+    FG_REQUIRE(!valid.empty());
+
+    constexpr uint32_t kExtension = 16;
+
+    std::vector<uint8_t> record = valid;
+    record.insert(record.begin() + sizeof(FSGuardRequestRecord), kExtension, 0);
+
+    FSGuardRequestRecord *header = reinterpret_cast<FSGuardRequestRecord *>(record.data());
+    header->version = kFGRequestRecordVersion + 1;
+    header->headerSize = sizeof(FSGuardRequestRecord) + kExtension;
+    header->size = static_cast<uint32_t>(record.size());
+
+    FSGuardRequest decoded = {};
+    FG_REQUIRE(FSGuardDecodeRequest(record.data(), record.size(), decoded));
+    FG_CHECK(path == std::string(decoded.filePath, decoded.filePathLength));
+}
+
+//
+// NOTE: mutation fuzzing with fixed seed, a decoded request must stay inside
+//       the record whatever the peer wrote into it
+//
+FG_TEST(FuzzedRecordsDecodeInsideBuffer)
+{
+    std::mt19937 random(2026);
+    const std::vector<uint8_t> seed = Encode(MakeRequest("/Users/user/Library/Preferences/com.example.plist"));
+    FG_REQUIRE(!seed.empty());
+
+    uint32_t decodedCount = 0;
+
+    for (uint32_t iteration = 0; iteration < 200000; ++iteration)
+    {
+        std::vector<uint8_t> record = seed;
+
+        const uint32_t mutations = 1 + random() % 8;
+        for (uint32_t mutation = 0; mutation < mutations; ++mutation)
+        {
+            const size_t offset = random() % record.size();
+
+            switch (random() % 4)
+            {
+                case 0:
+                    record[offset] ^= static_cast<uint8_t>(1u << (random() % 8));
+                    break;
+
+                case 1:
+                    record[offset] = static_cast<uint8_t>(random());
+                    break;
+
+                case 2:
+                    record[offset] = 0xFF;
+                    break;
+
+                case 3:
+                    record.resize(offset);
+                    break;
+            }
+
+            if (record.empty())
+            {
+                break;
+            }
+        }
+
+        FSGuardRequest decoded = {};
+        if (!FSGuardDecodeRequest(record.data(), record.size(), decoded))
+        {
+            continue;
+        }
+
+        ++decodedCount;
+
+        const char *begin = reinterpret_cast<const char *>(record.data());
+        const char *end = begin + record.size();
+
+        FG_REQUIRE(decoded.filePath >= begin && decoded.filePath + decoded.filePathLength < end);
+        FG_REQUIRE('\0' == decoded.filePath[decoded.filePathLength]);
+        FG_REQUIRE(static_cast<uint32_t>(decoded.action) < kFGActionCount);
+        FG_REQUIRE(decoded.processName >= begin && decoded.processName + strnlen(decoded.processName, end - decoded.processName) < end);
+    }
+
+    //
+    // NOTE: mutations of fields the decoder ignores keep the record valid
+    //
+    FG_CHECK(decodedCount > 0);
+}
@@ -0,0 +1,301 @@
+//
+//  FSGuardRequestRingTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardRequestRing.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <thread>
+#include <vector>
+
+constexpr uint32_t kCapacity = 4096;
+
+//
+// NOTE: producer and consumer views over the same memory like the driver and the client
+//
+struct RequestRings
+{
+    explicit RequestRings(uint32_t capacity = kCapacity)
+        : memory((FSGuardRequestRing::memorySize(capacity) + 7) / 8)
+    {
+        attached = producer.attach(memory.data(), memory.size() * 8, capacity) &&
+                   consumer.attach(memory.data(), memory.size() * 8, capacity);
+    }
+
+    FSGuardRequestRingHeader * header()
+    {
+        return reinterpret_cast<FSGuardRequestRingHeader *>(memory.data());
+    }
+
+    std::vector<uint64_t> memory;
+    FSGuardRequestRing    producer;
+    FSGuardRequestRing    consumer;
+    bool                  attached = false;
+};
+
+struct TestRecord
+{
+    uint32_t producer;
+    uint32_t sequence;
+    uint8_t  payload[40];
+};
+
+FG_TEST(AttachValidatesArguments)
+{
+    std::vector<uint64_t> memory((FSGuardRequestRing::memorySize(kCapacity) + 7) / 8);
+    FSGuardRequestRing ring;
+
+    FG_CHECK(!ring.attach(nullptr, memory.size() * 8, kCapacity));
+    FG_CHECK(!ring.attach(memory.data(), memory.size() * 8, 8));
+    FG_CHECK(!ring.attach(memory.data(), memory.size() * 8, kCapacity - 16));
+    FG_CHECK(!ring.attach(memory.data(), FSGuardRequestRing::memorySize(kCapacity) - 1, kCapacity));
+    FG_CHECK(ring.attach(memory.data(), memory.size() * 8, kCapacity));
+}
+
+FG_TEST(PopReturnsRecordsInOrderWithTheirSize)
+{
+    RequestRings rings;
+    FG_REQUIRE(rings.attached);
+
+    for (uint32_t index = 0; index < 10; ++index)
+    {
+        uint8_t record[64];
+        memset(record, static_cast<int>(index), sizeof(record));
+
+        FG_CHECK(rings.producer.push(record, 8 + index * 4));
+    }
+
+    for (uint32_t index = 0; index < 10; ++index)
+    {
+        bool matches = false;
+
+        FG_CHECK(rings.consumer.pop([&](const void *data, uint32_t size) {
+            const uint8_t *bytes = static_cast<const uint8_t *>(data);
+
+            //
+            // NOTE: slot is padded to alignment, the record is at its start
+            //
+            matches = size >= 8 + index * 4 && bytes[0] == index && bytes[7 + index * 4] == index;
+        }));
+
+        FG_CHECK(matches);
+    }
+
+    FG_CHECK(rings.consumer.empty());
+    FG_CHECK(!rings.consumer.pop([](const void *, uint32_t) {}));
+}
+
+FG_TEST(PushFailsWhenFullAndRecordsNeverWrap)
+{
+    RequestRings rings(256);
+    FG_REQUIRE(rings.attached);
+
+    TestRecord record = {};
+    const uint32_t slotSize = FSGuardRequestRing::slotSize(sizeof(record));
+
+    uint32_t pushed = 0;
+    while (rings.producer.push(&record, sizeof(record)))
+    {
+        ++pushed;
+    }
+
+    FG_CHECK(256 / slotSize == pushed);
+
+    //
+    // NOTE: every lap ends with a padding slot, records keep coming whole
+    //
+    uint32_t sequence = 0;
+    uint32_t expected = 0;
+    bool ordered = true;
+
+    for (uint32_t lap = 0; lap < 100; ++lap)
+    {
+        while (rings.consumer.pop([&](const void *data, uint32_t size) {
+            TestRecord popped;
+            memcpy(&popped, data, sizeof(popped));
+            ordered = ordered && size >= sizeof(popped) && (0 == lap || popped.sequence == expected++);
+        }))
+        {
+        }
+
+        if (0 == lap)
+        {
+            expected = 0;
+        }
+
+        while (true)
+        {
+            record.sequence = sequence;
+            if (!rings.producer.push(&record, sizeof(record)))
+            {
+                break;
+            }
+
+            ++sequence;
+        }
+    }
+
+    FG_CHECK(ordered);
+    FG_CHECK(sequence > 100);
+}
+
+FG_TEST(OversizedRecordIsRejected)
+{
+    RequestRings rings(256);
+    FG_REQUIRE(rings.attached);
+
+    uint8_t record[512] = {};
+
+    FG_CHECK(!rings.producer.push(record, sizeof(record)));
+    FG_CHECK(!rings.producer.push(record, 256));
+}
+
+//
+// NOTE: consumer cursor published by the peer ahead of the producers is not trusted
+//
+FG_TEST(CorruptedConsumerCursorBehavesAsFull)
+{
+    RequestRings rings;
+    FG_REQUIRE(rings.attached);
+
+    TestRecord record = {};
+    FG_CHECK(rings.producer.push(&record, sizeof(record)));
+
+    rings.header()->consumed = UINT64_MAX / 2;
+    FG_CHECK(!rings.producer.push(&record, sizeof(record)));
+}
+
+//
+// NOTE: published slot with invalid size can not be skipped, consumer stops
+//       instead of spinning on it
+//
+FG_TEST(CorruptedSlotSizeStopsConsumer)
+{
+    RequestRings rings;
+    FG_REQUIRE(rings.attached);
+
+    TestRecord record = {};
+    FG_CHECK(rings.producer.push(&record, sizeof(record)));
+    FG_CHECK(rings.producer.push(&record, sizeof(record)));
+
+    FG_CHECK(rings.consumer.pop([](const void *, uint32_t) {}));
+
+    FSGuardRequestRingSlot *slot = reinterpret_cast<FSGuardRequestRingSlot *>(
+        reinterpret_cast<uint8_t *>(rings.header() + 1) + FSGuardRequestRing::slotSize(sizeof(record)));
+    slot->size = 3;
+
+    FG_CHECK(!rings.consumer.pop([](const void *, uint32_t) {}));
+    FG_CHECK(rings.consumer.isCorrupted());
+
+    slot->size = FSGuardRequestRing::slotSize(sizeof(record));
+    FG_CHECK(!rings.consumer.pop([](const void *, uint32_t) {}));
+}
+
+FG_TEST(WaitingAnnouncementsAreTakenOnce)
+{
+    RequestRings rings;
+    FG_REQUIRE(rings.attached);
+
+    TestRecord record = {};
+
+    FG_CHECK(rings.consumer.prepareToWait());
+    FG_CHECK(rings.producer.push(&record, sizeof(record)));
+    FG_CHECK(rings.producer.takeConsumerWaiting());
+    FG_CHECK(!rings.producer.takeConsumerWaiting());
+
+    //
+    // NOTE: consumer does not sleep while a record is published
+    //
+    FG_CHECK(!rings.consumer.prepareToWait());
+    FG_CHECK(!rings.producer.takeConsumerWaiting());
+
+    rings.producer.announceProducerWaiting();
+    FG_CHECK(rings.consumer.pop([](const void *, uint32_t) {}));
+    FG_CHECK(rings.consumer.takeProducerWaiting());
+    FG_CHECK(!rings.consumer.takeProducerWaiting());
+}
+
+//
+// NOTE: every producer publishes its records in order, the consumer gets all of them
+//       and the records of each producer in the order they were pushed
+//
+FG_TEST(ConcurrentProducersAndConsumer)
+{
+    RequestRings rings;
+    FG_REQUIRE(rings.attached);
+
+    constexpr uint32_t kProducers = 4;
+    constexpr uint32_t kRecords = 50000;
+
+    std::vector<std::thread> producers;
+    for (uint32_t producer = 0; producer < kProducers; ++producer)
+    {
+        producers.emplace_back([&rings, producer] {
+            for (uint32_t sequence = 0; sequence < kRecords; ++sequence)
+            {
+                TestRecord record = {};
+                record.producer = producer;
+                record.sequence = sequence;
+                memset(record.payload, static_cast<int>(sequence), sizeof(record.payload));
+
+                //
+                // NOTE: records of different length exercise padding at the end of the ring
+                //
+                const uint32_t size = offsetof(TestRecord, payload) + 1 + sequence % sizeof(record.payload);
+
+                while (!rings.producer.push(&record, size))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    uint32_t next[kProducers] = {};
+    uint32_t received = 0;
+    bool valid = true;
+
+    while (received < kProducers * kRecords)
+    {
+        const bool popped = rings.consumer.pop([&](const void *data, uint32_t size) {
+            TestRecord record = {};
+            memcpy(&record, data, size < sizeof(record) ? size : sizeof(record));
+
+            const uint32_t length = offsetof(TestRecord, payload) + 1 + record.sequence % sizeof(record.payload);
+
+            valid = valid && record.producer < kProducers && next[record.producer] == record.sequence &&
+                    size >= length && static_cast<uint8_t>(record.sequence) == record.payload[length - offsetof(TestRecord, payload) - 1];
+
+            if (record.producer < kProducers)
+            {
+                ++next[record.producer];
+            }
+        });
+
+        if (popped)
+        {
+            ++received;
+        }
+        else
+        {
+            FG_REQUIRE(!rings.consumer.isCorrupted());
+            std::this_thread::yield();
+        }
+    }
+
+    for (std::thread &producer : producers)
+    {
+        producer.join();
+    }
+
+    FG_CHECK(valid);
+    FG_CHECK(rings.consumer.empty());
+}
@@ -0,0 +1,208 @@
+//
+//  FSGuardRequestSchedulerTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardRequestScheduler.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+using Scheduler = FSGuardRequestScheduler<64>;
+
+static std::vector<uint32_t> Drain(Scheduler &scheduler)
+{
+    std::vector<uint32_t> order;
+
+    uint32_t index = 0;
+    while (scheduler.pop(index))
+    {
+        order.push_back(index);
+    }
+
+    return order;
+}
+
+static uint32_t Position(const std::vector<uint32_t> &order, uint32_t index)
+{
+    for (uint32_t position = 0; position < order.size(); ++position)
+    {
+        if (order[position] == index)
+        {
+            return position;
+        }
+    }
+
+    return UINT32_MAX;
+}
+
+FG_TEST(ZeroDeadlineNeverExpires)
+{
+    FSGuardResolutionEstimate estimate;
+
+    FG_CHECK(!estimate.isExpired(UINT64_MAX, 0, 0));
+
+    //
+    // NOTE: without samples the request expires at its deadline
+    //
+    FG_CHECK(!estimate.isExpired(999, 0, 1000));
+    FG_CHECK(estimate.isExpired(1000, 0, 1000));
+}
+
+FG_TEST(EstimateExpiresRequestsEarly)
+{
+    FSGuardResolutionEstimate estimate;
+
+    estimate.sample(100);
+    FG_CHECK(!estimate.isExpired(899, 0, 1000));
+    FG_CHECK(estimate.isExpired(900, 0, 1000));
+
+    //
+    // NOTE: smoothing with gain 1/8
+    //
+    estimate.sample(900);
+    FG_CHECK(!estimate.isExpired(799, 0, 1000));
+    FG_CHECK(estimate.isExpired(800, 0, 1000));
+
+    //
+    // NOTE: slow verdicts count for at most half of the timeout,
+    //       fresh requests are still resolved
+    //
+    for (uint32_t index = 0; index < 64; ++index)
+    {
+        estimate.sample(1000000);
+    }
+
+    FG_CHECK(!estimate.isExpired(1000, 1000, 2000));
+    FG_CHECK(!estimate.isExpired(1499, 1000, 2000));
+    FG_CHECK(estimate.isExpired(1500, 1000, 2000));
+
+    //
+    // NOTE: deadline before the timestamp gets no early expiry
+    //
+    FG_CHECK(!estimate.isExpired(599, 1000, 600));
+    FG_CHECK(estimate.isExpired(600, 1000, 600));
+}
+
+FG_TEST(FlowIsOrderedByDeadline)
+{
+    Scheduler scheduler;
+    scheduler.reset(8);
+
+    uint32_t index = 0;
+    FG_CHECK(!scheduler.pop(index));
+    FG_CHECK(scheduler.empty());
+
+    scheduler.push(0, FSGuardRequestLane::Read, 100, 300);
+    scheduler.push(1, FSGuardRequestLane::Read, 100, 0);
+    scheduler.push(2, FSGuardRequestLane::Read, 100, 100);
+    scheduler.push(3, FSGuardRequestLane::Read, 100, 300);
+    scheduler.push(4, FSGuardRequestLane::Read, 100, 200);
+    FG_CHECK(5 == scheduler.size());
+
+    //
+    // NOTE: equal deadlines keep arrival order, zero deadline is the latest
+    //
+    FG_CHECK((std::vector<uint32_t> { 2, 4, 0, 3, 1 }) == Drain(scheduler));
+    FG_CHECK(scheduler.empty());
+}
+
+//
+// NOTE: deadline does not reorder flows, oldest backlog of a flooding process
+//       would otherwise always go first
+//
+FG_TEST(DeadlineDoesNotOrderFlows)
+{
+    Scheduler scheduler;
+    scheduler.reset(8);
+
+    scheduler.push(0, FSGuardRequestLane::Read, 100, 500);
+    scheduler.push(1, FSGuardRequestLane::Read, 200, 100);
+
+    FG_CHECK((std::vector<uint32_t> { 0, 1 }) == Drain(scheduler));
+}
+
+FG_TEST(FloodingProcessGetsQuantum)
+{
+    constexpr uint32_t kFlood = 200;
+
+    Scheduler scheduler;
+    scheduler.reset(kFlood + 2);
+
+    for (uint32_t index = 0; index < kFlood; ++index)
+    {
+        scheduler.push(index, FSGuardRequestLane::Read, 100, 1000 + index);
+    }
+
+    scheduler.push(kFlood, FSGuardRequestLane::Read, 200, 5000);
+    scheduler.push(kFlood + 1, FSGuardRequestLane::Read, 300, 5000);
+
+    const std::vector<uint32_t> order = Drain(scheduler);
+    FG_REQUIRE(kFlood + 2 == order.size());
+
+    FG_CHECK(kFGRequestSchedulerQuantum == Position(order, kFlood));
+    FG_CHECK(kFGRequestSchedulerQuantum + 1 == Position(order, kFlood + 1));
+
+    //
+    // NOTE: the flood keeps its own order
+    //
+    uint32_t previous = 0;
+    for (uint32_t index : order)
+    {
+        if (index < kFlood)
+        {
+            FG_CHECK(index >= previous);
+            previous = index;
+        }
+    }
+}
+
+FG_TEST(LanesArePrioritizedWithAging)
+{
+    Scheduler scheduler;
+    scheduler.reset(64);
+
+    scheduler.push(0, FSGuardRequestLane::Read, 100, 0);
+    scheduler.push(1, FSGuardRequestLane::Modify, 100, 0);
+
+    for (uint32_t index = 2; index < 40; ++index)
+    {
+        scheduler.push(index, FSGuardRequestLane::Execute, static_cast<pid_t>(index), 0);
+    }
+
+    const std::vector<uint32_t> order = Drain(scheduler);
+    FG_REQUIRE(40 == order.size());
+
+    //
+    // NOTE: every waiting lane gets a request in kFGRequestLaneAgingLimit + 1
+    //
+    FG_CHECK(order[0] >= 2);
+    FG_CHECK(kFGRequestLaneAgingLimit == Position(order, 1));
+    FG_CHECK(Position(order, 0) <= 2 * kFGRequestLaneAgingLimit + 1);
+
+    FG_CHECK(FSGuardRequestLane::Execute == FSGuardRequestLaneForAction(FSGuardAction::Execute));
+    FG_CHECK(FSGuardRequestLane::Read == FSGuardRequestLaneForAction(FSGuardAction::ReadMetadata));
+    FG_CHECK(FSGuardRequestLane::Modify == FSGuardRequestLaneForAction(FSGuardAction::Delete));
+}
+
+FG_TEST(ResetDropsPendingRequests)
+{
+    Scheduler scheduler;
+    scheduler.reset(4);
+
+    scheduler.push(0, FSGuardRequestLane::Read, 1, 0);
+    scheduler.push(1, FSGuardRequestLane::Execute, 2, 0);
+
+    scheduler.reset(4);
+    FG_CHECK(scheduler.empty());
+
+    scheduler.push(3, FSGuardRequestLane::Modify, 1, 0);
+    FG_CHECK((std::vector<uint32_t> { 3 }) == Drain(scheduler));
+}
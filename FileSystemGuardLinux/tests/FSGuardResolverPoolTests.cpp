@@ -0,0 +1,191 @@
+//
+//  FSGuardResolverPoolTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardResolverPool.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct TestItem
+{
+    uint64_t value;
+    pid_t    pid;
+};
+
+FG_TEST(StartValidatesArguments)
+{
+    FSGuardResolverPool<TestItem> pool;
+    auto handler = [](TestItem &) {};
+
+    FG_CHECK(!pool.start(0, 4, handler));
+    FG_CHECK(!pool.start(4, 2, handler));
+    FG_CHECK(!pool.start(2, 4, nullptr));
+    FG_CHECK(pool.start(2, 4, handler));
+    FG_CHECK(!pool.start(2, 4, handler));
+    FG_CHECK(2 == pool.concurrency());
+}
+
+FG_TEST(EveryItemIsHandledOnce)
+{
+    constexpr uint64_t kCount = 100000;
+
+    std::atomic<uint64_t> sum {0};
+    std::atomic<uint64_t> handled {0};
+
+    {
+        FSGuardResolverPool<TestItem> pool;
+        FG_REQUIRE(pool.start(4, 64, [&](TestItem &item) {
+            sum.fetch_add(item.value, std::memory_order_relaxed);
+            handled.fetch_add(1, std::memory_order_relaxed);
+        }));
+
+        for (uint64_t value = 1; value <= kCount; ++value)
+        {
+            TestItem *item = pool.acquire();
+            FG_REQUIRE(item);
+
+            item->value = value;
+            pool.submit(item, static_cast<FSGuardRequestLane>(value % kFGRequestLaneCount), static_cast<pid_t>(value % 13), 0);
+        }
+
+        //
+        // NOTE: stop handles everything submitted before it joins
+        //
+        pool.stop();
+    }
+
+    FG_CHECK(kCount == handled.load());
+    FG_CHECK(kCount * (kCount + 1) / 2 == sum.load());
+}
+
+FG_TEST(AcquireWaitsForReleasedItem)
+{
+    FSGuardResolverPool<TestItem> pool;
+    FG_REQUIRE(pool.start(1, 2, [](TestItem &) {}));
+
+    TestItem *first = pool.acquire();
+    TestItem *second = pool.acquire();
+    FG_REQUIRE(first && second && first != second);
+
+    std::atomic<bool> acquired {false};
+    std::thread waiter([&] {
+        TestItem *item = pool.acquire();
+        acquired = nullptr != item;
+        pool.release(item);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    FG_CHECK(!acquired);
+
+    pool.release(first);
+    waiter.join();
+
+    FG_CHECK(acquired);
+    pool.release(second);
+}
+
+FG_TEST(AcquireFailsAfterStop)
+{
+    FSGuardResolverPool<TestItem> pool;
+    FG_REQUIRE(pool.start(1, 1, [](TestItem &) {}));
+
+    TestItem *item = pool.acquire();
+    FG_REQUIRE(item);
+
+    //
+    // NOTE: producer waiting for an item is released by stop
+    //
+    std::atomic<bool> returned {false};
+    std::thread waiter([&] {
+        FG_CHECK(nullptr == pool.acquire());
+        returned = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    pool.stop();
+    waiter.join();
+
+    FG_CHECK(returned);
+    FG_CHECK(nullptr == pool.acquire());
+}
+
+//
+// NOTE: items of one process go to one queue, the other worker steals the second item
+//       while the first one is blocked in the handler
+//
+FG_TEST(IdleWorkerStealsFromBusyQueue)
+{
+    std::mutex lock;
+    std::condition_variable changed;
+    bool secondHandled = false;
+    bool firstTimedOut = false;
+
+    FSGuardResolverPool<TestItem> pool;
+    FG_REQUIRE(pool.start(2, 4, [&](TestItem &item) {
+        std::unique_lock<std::mutex> guard(lock);
+
+        if (1 == item.value)
+        {
+            firstTimedOut = !changed.wait_for(guard, std::chrono::seconds(5), [&] { return secondHandled; });
+        }
+        else
+        {
+            secondHandled = true;
+            changed.notify_all();
+        }
+    }));
+
+    for (uint64_t value = 1; value <= 2; ++value)
+    {
+        TestItem *item = pool.acquire();
+        FG_REQUIRE(item);
+
+        item->value = value;
+        pool.submit(item, FSGuardRequestLane::Read, 100, 0);
+    }
+
+    pool.stop();
+
+    FG_CHECK(secondHandled);
+    FG_CHECK(!firstTimedOut);
+}
+
+FG_TEST(DeferredWorkIsRun)
+{
+    struct CountedWork : FSGuardDeferredWork
+    {
+        std::atomic<uint32_t> *counter;
+    };
+
+    std::atomic<uint32_t> counter {0};
+
+    FSGuardResolverPool<TestItem> pool;
+    FG_REQUIRE(pool.start(2, 4, [](TestItem &) {}));
+
+    CountedWork works[16];
+    for (CountedWork &work : works)
+    {
+        work.counter = &counter;
+        work.run = [](FSGuardDeferredWork &base) {
+            static_cast<CountedWork &>(base).counter->fetch_add(1);
+        };
+
+        pool.post(work);
+    }
+
+    pool.stop();
+
+    FG_CHECK(16 == counter.load());
+}
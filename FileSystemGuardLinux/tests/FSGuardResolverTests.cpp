@@ -0,0 +1,236 @@
+//
+//  FSGuardResolverTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardResolver.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+//
+// NOTE: counts heap allocations of the calling thread to check frame reuse
+//
+static thread_local uint64_t tAllocations = 0;
+
+void * operator new(size_t size)
+{
+    ++tAllocations;
+
+    if (void *memory = malloc(size ? size : 1))
+    {
+        return memory;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+    free(memory);
+}
+
+static FSGuardVerdictTask Verdict(bool allow)
+{
+    co_return allow;
+}
+
+static FSGuardVerdictTask Throwing()
+{
+    throw std::runtime_error("resolver failed");
+    co_return false;
+}
+
+static FSGuardVerdictTask AllOf(bool first, bool second)
+{
+    const bool firstAllowed = co_await Verdict(first);
+    const bool secondAllowed = co_await Verdict(second);
+
+    co_return firstAllowed && secondAllowed;
+}
+
+FG_TEST(TaskCompletesSynchronously)
+{
+    uint32_t calls = 0;
+    bool allow = true;
+
+    Verdict(false).start([&](bool verdict) noexcept {
+        ++calls;
+        allow = verdict;
+    });
+
+    FG_CHECK(1 == calls);
+    FG_CHECK(!allow);
+}
+
+FG_TEST(AwaitedTasksCombine)
+{
+    const bool cases[][3] = { { true, true, true }, { true, false, false }, { false, true, false } };
+
+    for (const auto &test : cases)
+    {
+        bool allow = !test[2];
+        AllOf(test[0], test[1]).start([&](bool verdict) noexcept { allow = verdict; });
+
+        FG_CHECK(test[2] == allow);
+    }
+}
+
+FG_TEST(ThrowingResolverFailsOpen)
+{
+    bool allow = false;
+    Throwing().start([&](bool verdict) noexcept { allow = verdict; });
+
+    FG_CHECK(allow);
+}
+
+//
+// NOTE: frame of a task which is never started goes back to the pool
+//
+FG_TEST(TaskNotStartedIsDestroyed)
+{
+    bool allow = false;
+    Verdict(true).start([&](bool verdict) noexcept { allow = verdict; });
+
+    const uint64_t allocations = tAllocations;
+
+    {
+        FSGuardVerdictTask task = Verdict(false);
+        FSGuardVerdictTask moved = std::move(task);
+    }
+
+    Verdict(true).start([&](bool verdict) noexcept { allow = verdict; });
+
+    FG_CHECK(allow);
+    FG_CHECK(allocations == tAllocations);
+}
+
+FG_TEST(WarmFramePoolAllocatesNothing)
+{
+    bool allow = false;
+
+    AllOf(true, true).start([&](bool verdict) noexcept { allow = verdict; });
+
+    const uint64_t allocations = tAllocations;
+    for (uint32_t index = 0; index < 1000; ++index)
+    {
+        AllOf(true, true).start([&](bool verdict) noexcept { allow = verdict; });
+    }
+
+    FG_CHECK(allow);
+    FG_CHECK(allocations == tAllocations);
+}
+
+FG_TEST(FramePoolReusesFrames)
+{
+    void *small = FSGuardFramePool::allocate(100);
+    FSGuardFramePool::deallocate(small, 100);
+    FG_CHECK(small == FSGuardFramePool::allocate(128));
+    FSGuardFramePool::deallocate(small, 128);
+
+    //
+    // NOTE: frames larger than the largest class go straight to the heap
+    //
+    const uint64_t allocations = tAllocations;
+    void *large = FSGuardFramePool::allocate(FSGuardFramePool::kMaxFrameSize + 1);
+    FSGuardFramePool::deallocate(large, FSGuardFramePool::kMaxFrameSize + 1);
+    FG_CHECK(allocations + 1 == tAllocations);
+
+    void *again = FSGuardFramePool::allocate(FSGuardFramePool::kMaxFrameSize + 1);
+    FG_CHECK(allocations + 2 == tAllocations);
+    FSGuardFramePool::deallocate(again, FSGuardFramePool::kMaxFrameSize + 1);
+}
+
+struct EmptyItem
+{
+};
+
+static FSGuardVerdictTask OnResolverThread(FSGuardResolverExecutor &executor, std::thread::id caller, bool &switched)
+{
+    co_await executor.schedule();
+
+    switched = caller != std::this_thread::get_id();
+    co_return false;
+}
+
+FG_TEST(ScheduleResumesOnResolverThread)
+{
+    FSGuardResolverPool<EmptyItem> pool;
+    FG_REQUIRE(pool.start(2, 2, [](EmptyItem &) {}));
+
+    FSGuardResolverExecutor executor(pool);
+
+    std::mutex lock;
+    std::condition_variable done;
+    bool finished = false;
+    bool allow = true;
+    bool switched = false;
+
+    OnResolverThread(executor, std::this_thread::get_id(), switched).start([&](bool verdict) noexcept {
+        std::lock_guard<std::mutex> guard(lock);
+
+        allow = verdict;
+        finished = true;
+        done.notify_all();
+    });
+
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        FG_CHECK(done.wait_for(guard, std::chrono::seconds(5), [&] { return finished; }));
+    }
+
+    pool.stop();
+
+    FG_CHECK(!allow);
+    FG_CHECK(switched);
+}
+
+class PathResolver : public FSGuardResolver
+{
+public:
+    FSGuardVerdictTask resolve(const FSGuardRequest &request, FSGuardResolverExecutor &) override
+    {
+        co_return request.filePathLength < 5;
+    }
+};
+
+FG_TEST(ResolverInterfaceProducesVerdict)
+{
+    FSGuardResolverPool<EmptyItem> pool;
+    FG_REQUIRE(pool.start(1, 1, [](EmptyItem &) {}));
+
+    FSGuardResolverExecutor executor(pool);
+    PathResolver resolver;
+    FSGuardRequest request {};
+    bool allow = false;
+
+    request.filePath = "/tmp";
+    request.filePathLength = 4;
+    resolver.resolve(request, executor).start([&](bool verdict) noexcept { allow = verdict; });
+    FG_CHECK(allow);
+
+    request.filePath = "/tmp/file";
+    request.filePathLength = 9;
+    resolver.resolve(request, executor).start([&](bool verdict) noexcept { allow = verdict; });
+    FG_CHECK(!allow);
+
+    pool.stop();
+}
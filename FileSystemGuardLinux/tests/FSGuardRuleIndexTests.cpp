@@ -0,0 +1,193 @@
+//
+//  FSGuardRuleIndexTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardRuleIndex.h"
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using RuleIndex = FSGuardRuleIndex<int>;
+
+static int MatchOf(const RuleIndex &index, const char *path)
+{
+    const int *value = index.match(path);
+
+    return value ? *value : -1;
+}
+
+FG_TEST(LongestPrefixWins)
+{
+    RuleIndex index;
+    FG_CHECK(index.insert("/data", 1));
+    FG_CHECK(index.insert("/data/public/docs", 3));
+    FG_CHECK(index.insert("/data/public", 2));
+
+    FG_CHECK(1 == MatchOf(index, "/data"));
+    FG_CHECK(1 == MatchOf(index, "/data/private/file"));
+    FG_CHECK(2 == MatchOf(index, "/data/public"));
+    FG_CHECK(2 == MatchOf(index, "/data/public/file"));
+    FG_CHECK(3 == MatchOf(index, "/data/public/docs/a/b/c"));
+    FG_CHECK(-1 == MatchOf(index, "/other"));
+
+    //
+    // NOTE: insertion order does not matter, root rule covers everything else
+    //
+    FG_CHECK(index.insert("/", 0));
+    FG_CHECK(0 == MatchOf(index, "/other"));
+    FG_CHECK(3 == MatchOf(index, "/data/public/docs/file"));
+    FG_CHECK(4 == index.size());
+}
+
+FG_TEST(ComponentsAreMatchedWhole)
+{
+    RuleIndex index;
+    index.insert("/data", 1);
+    index.insert("/data/pub", 2);
+
+    FG_CHECK(-1 == MatchOf(index, "/database"));
+    FG_CHECK(-1 == MatchOf(index, "/dat"));
+    FG_CHECK(1 == MatchOf(index, "/data/public"));
+    FG_CHECK(2 == MatchOf(index, "/data/pub/lic"));
+
+    FG_CHECK(nullptr == index.find("/data/public"));
+    FG_CHECK(nullptr == index.find("/database"));
+}
+
+FG_TEST(UnnormalizedPathsMatch)
+{
+    RuleIndex index;
+    FG_CHECK(index.insert("//data///public/", 1));
+    FG_CHECK(!index.insert("data", 2));
+    FG_CHECK(!index.insert("", 2));
+
+    FG_CHECK(1 == MatchOf(index, "/data/public"));
+    FG_CHECK(1 == MatchOf(index, "/data//public//file"));
+    FG_CHECK(index.find("/data/public/"));
+    FG_CHECK(-1 == MatchOf(index, "data/public"));
+}
+
+FG_TEST(EdgesSplitAndMerge)
+{
+    RuleIndex index;
+
+    //
+    // NOTE: one edge "a/b/c/d", inserts split it at "a/b" and at "a"
+    //
+    index.insert("/a/b/c/d", 1);
+    index.insert("/a/b/x", 2);
+    index.insert("/a", 3);
+
+    FG_CHECK(3 == MatchOf(index, "/a/b"));
+    FG_CHECK(nullptr == index.find("/a/b"));
+    FG_CHECK(nullptr == index.find("/a/b/c"));
+    FG_CHECK(1 == MatchOf(index, "/a/b/c/d/e"));
+    FG_CHECK(2 == MatchOf(index, "/a/b/x"));
+    FG_CHECK(3 == MatchOf(index, "/a/b/c/e"));
+
+    //
+    // NOTE: split point without rule is not a rule itself
+    //
+    FG_CHECK(!index.erase("/a/b"));
+    FG_CHECK(!index.erase("/a/b/c"));
+    FG_CHECK(!index.erase("/a/b/c/d/e"));
+    FG_CHECK(3 == index.size());
+
+    //
+    // NOTE: removing "/a/b/x" leaves "a/b" with one child, it merges back into "b/c/d"
+    //
+    FG_CHECK(index.erase("/a/b/x"));
+    FG_CHECK(1 == MatchOf(index, "/a/b/c/d"));
+    FG_CHECK(3 == MatchOf(index, "/a/b/x"));
+    FG_CHECK(3 == MatchOf(index, "/a/b/c"));
+
+    //
+    // NOTE: edge is split again inside the merged label
+    //
+    index.insert("/a/b/c", 4);
+    FG_CHECK(4 == MatchOf(index, "/a/b/c/e"));
+    FG_CHECK(1 == MatchOf(index, "/a/b/c/d"));
+
+    FG_CHECK(index.erase("/a"));
+    FG_CHECK(-1 == MatchOf(index, "/a/b"));
+    FG_CHECK(4 == MatchOf(index, "/a/b/c"));
+
+    FG_CHECK(index.erase("/a/b/c"));
+    FG_CHECK(index.erase("/a/b/c/d"));
+    FG_CHECK(index.empty());
+    FG_CHECK(-1 == MatchOf(index, "/a/b/c/d"));
+
+    index.insert("/a/b", 5);
+    FG_CHECK(5 == MatchOf(index, "/a/b/c/d"));
+}
+
+//
+// NOTE: random inserts and erases against a linear reference of longest prefix
+//
+FG_TEST(MatchesReference)
+{
+    const char *components[] = { "a", "ab", "b", "data", "database", "x" };
+
+    std::mt19937 random(11);
+    RuleIndex index;
+    std::map<std::string, int> reference;
+
+    auto randomPath = [&] {
+        std::string path;
+        const uint32_t depth = 1 + random() % 4;
+
+        for (uint32_t level = 0; level < depth; ++level)
+        {
+            path += "/";
+            path += components[random() % 6];
+        }
+
+        return path;
+    };
+
+    auto referenceMatch = [&](const std::string &path) {
+        int value = -1;
+        size_t longest = 0;
+
+        for (const auto &rule : reference)
+        {
+            const std::string &prefix = rule.first;
+            if (0 == path.compare(0, prefix.size(), prefix) &&
+                (path.size() == prefix.size() || '/' == path[prefix.size()]) &&
+                prefix.size() >= longest)
+            {
+                longest = prefix.size();
+                value = rule.second;
+            }
+        }
+
+        return value;
+    };
+
+    for (int iteration = 0; iteration < 20000; ++iteration)
+    {
+        const std::string path = randomPath();
+
+        if (random() % 3)
+        {
+            index.insert(path, iteration);
+            reference[path] = iteration;
+        }
+        else
+        {
+            FG_CHECK(index.erase(path) == (0 != reference.erase(path)));
+        }
+
+        const std::string query = randomPath();
+        FG_CHECK(referenceMatch(query) == MatchOf(index, query.c_str()));
+        FG_CHECK(reference.size() == index.size());
+    }
+}
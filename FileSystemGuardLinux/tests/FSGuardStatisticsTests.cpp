@@ -0,0 +1,186 @@
+//
+//  FSGuardStatisticsTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardStatistics.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+static_assert(0 == FSGuardHistogramBucket(0));
+static_assert(kFGHistogramBucketCount - 1 == FSGuardHistogramBucket(kFGHistogramMaxValue));
+static_assert(kFGHistogramBucketCount - 1 == FSGuardHistogramBucket(UINT64_MAX));
+
+FG_TEST(BucketsCoverValuesInOrder)
+{
+    uint64_t expectedLower = 0;
+
+    for (uint32_t bucket = 0; bucket < kFGHistogramBucketCount; ++bucket)
+    {
+        const uint64_t lower = FSGuardHistogramBucketLowerBound(bucket);
+        const uint64_t upper = FSGuardHistogramBucketUpperBound(bucket);
+
+        FG_REQUIRE(expectedLower == lower);
+        FG_REQUIRE(lower <= upper);
+        FG_REQUIRE(bucket == FSGuardHistogramBucket(lower));
+        FG_REQUIRE(bucket == FSGuardHistogramBucket(upper));
+
+        expectedLower = upper + 1;
+    }
+
+    FG_CHECK(kFGHistogramMaxValue + 1 == expectedLower);
+}
+
+FG_TEST(BucketRelativeErrorIsBounded)
+{
+    std::mt19937_64 random(5);
+
+    for (uint32_t iteration = 0; iteration < 100000; ++iteration)
+    {
+        const uint64_t value = random() >> (random() % 64);
+        if (value > kFGHistogramMaxValue)
+        {
+            continue;
+        }
+
+        const uint32_t bucket = FSGuardHistogramBucket(value);
+        const uint64_t lower = FSGuardHistogramBucketLowerBound(bucket);
+        const uint64_t upper = FSGuardHistogramBucketUpperBound(bucket);
+
+        FG_REQUIRE(lower <= value && value <= upper);
+        FG_REQUIRE((upper - lower) * kFGHistogramSubBucketCount <= lower || lower < kFGHistogramSubBucketCount);
+    }
+}
+
+FG_TEST(QuantilesMatchExactValues)
+{
+    FSGuardHistogram histogram {};
+    std::vector<uint64_t> values;
+    std::mt19937_64 random(11);
+    std::lognormal_distribution<double> latency(10.0, 1.5);
+
+    for (uint32_t index = 0; index < 100000; ++index)
+    {
+        const uint64_t value = static_cast<uint64_t>(latency(random));
+
+        values.push_back(value);
+        ++histogram.buckets[FSGuardHistogramBucket(value)];
+        ++histogram.count;
+        histogram.sum += value;
+        histogram.max = std::max(histogram.max, value);
+    }
+
+    std::sort(values.begin(), values.end());
+
+    const uint64_t quantiles[][2] = { { 1, 2 }, { 9, 10 }, { 99, 100 }, { 999, 1000 }, { 1, 1 } };
+    for (const auto &quantile : quantiles)
+    {
+        const uint64_t rank = (values.size() * quantile[0] + quantile[1] - 1) / quantile[1];
+        const uint64_t exact = values[rank - 1];
+        const uint64_t estimate = FSGuardHistogramQuantile(histogram, quantile[0], quantile[1]);
+
+        //
+        // NOTE: estimate is the bucket upper bound clamped by max, never below the exact value
+        //
+        FG_CHECK(exact <= estimate);
+        FG_CHECK(estimate - exact <= exact / kFGHistogramSubBucketCount);
+    }
+
+    FG_CHECK(histogram.max == FSGuardHistogramQuantile(histogram, 1, 1));
+}
+
+FG_TEST(QuantileOfEmptyHistogram)
+{
+    FSGuardHistogram histogram {};
+
+    FG_CHECK(0 == FSGuardHistogramQuantile(histogram, 99, 100));
+
+    ++histogram.buckets[FSGuardHistogramBucket(1000)];
+    histogram.count = 1;
+    histogram.max = 1000;
+
+    FG_CHECK(1000 == FSGuardHistogramQuantile(histogram, 0, 100));
+    FG_CHECK(0 == FSGuardHistogramQuantile(histogram, 1, 0));
+}
+
+FG_TEST(SnapshotSumsShards)
+{
+    auto recorder = std::make_unique<FSGuardStatisticsRecorder<4>>();
+
+    recorder->increment(0, FSGuardStatisticsCounter::Requests);
+    recorder->increment(1, FSGuardStatisticsCounter::Requests, 2);
+    recorder->increment(6, FSGuardStatisticsCounter::Denied, 3);
+
+    recorder->record(0, FSGuardStatisticsStage::Resolution, 100);
+    recorder->record(3, FSGuardStatisticsStage::Resolution, 5000);
+    recorder->record(2, FSGuardStatisticsStage::TimeToVerdict, 7);
+
+    auto statistics = std::make_unique<FSGuardStatistics>();
+    recorder->snapshot(*statistics);
+
+    FG_CHECK(kFGStatisticsVersion == statistics->version);
+    FG_CHECK(sizeof(FSGuardStatistics) == statistics->size);
+    FG_CHECK(3 == statistics->counters[static_cast<uint32_t>(FSGuardStatisticsCounter::Requests)]);
+    FG_CHECK(3 == statistics->counters[static_cast<uint32_t>(FSGuardStatisticsCounter::Denied)]);
+    FG_CHECK(0 == statistics->counters[static_cast<uint32_t>(FSGuardStatisticsCounter::Allowed)]);
+
+    const FSGuardHistogram &resolution = statistics->histograms[static_cast<uint32_t>(FSGuardStatisticsStage::Resolution)];
+    FG_CHECK(2 == resolution.count);
+    FG_CHECK(5100 == resolution.sum);
+    FG_CHECK(5000 == resolution.max);
+    FG_CHECK(1 == resolution.buckets[FSGuardHistogramBucket(100)]);
+
+    const FSGuardHistogram &verdict = statistics->histograms[static_cast<uint32_t>(FSGuardStatisticsStage::TimeToVerdict)];
+    FG_CHECK(1 == verdict.count);
+    FG_CHECK(7 == verdict.max);
+}
+
+FG_TEST(ConcurrentRecordersLoseNothing)
+{
+    constexpr uint32_t kThreads = 4;
+    constexpr uint32_t kRecords = 50000;
+
+    auto recorder = std::make_unique<FSGuardStatisticsRecorder<2>>();
+    std::vector<std::thread> threads;
+
+    //
+    // NOTE: more threads than shards, so writers share shards
+    //
+    for (uint32_t thread = 0; thread < kThreads; ++thread)
+    {
+        threads.emplace_back([&recorder, thread] {
+            for (uint32_t index = 1; index <= kRecords; ++index)
+            {
+                recorder->increment(thread, FSGuardStatisticsCounter::Requests);
+                recorder->record(thread, FSGuardStatisticsStage::QueueResidency, index * (thread + 1));
+            }
+        });
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    auto statistics = std::make_unique<FSGuardStatistics>();
+    recorder->snapshot(*statistics);
+
+    const FSGuardHistogram &histogram = statistics->histograms[static_cast<uint32_t>(FSGuardStatisticsStage::QueueResidency)];
+    const uint64_t series = static_cast<uint64_t>(kRecords) * (kRecords + 1) / 2;
+
+    FG_CHECK(kThreads * kRecords == statistics->counters[static_cast<uint32_t>(FSGuardStatisticsCounter::Requests)]);
+    FG_CHECK(kThreads * kRecords == histogram.count);
+    FG_CHECK(series * (1 + 2 + 3 + 4) == histogram.sum);
+    FG_CHECK(kRecords * kThreads == histogram.max);
+}
@@ -0,0 +1,59 @@
+//
+//  FSGuardTest.h
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#ifndef FSGuardTest_h
+#define FSGuardTest_h
+
+#include <stdio.h>
+
+//
+// NOTE: minimal test registry, every test executable links FSGuardTestMain.cpp
+//       which runs the tests registered by FG_TEST and fails if any check failed.
+//       Checks do not depend on NDEBUG
+//
+using FSGuardTestFunction = void (*)();
+
+void FSGuardRegisterTest(const char *name, FSGuardTestFunction function);
+void FSGuardReportFailure(const char *file, int line, const char *expression);
+
+struct FSGuardTestRegistrar
+{
+    FSGuardTestRegistrar(const char *name, FSGuardTestFunction function)
+    {
+        FSGuardRegisterTest(name, function);
+    }
+};
+
+#define FG_TEST(name)                                                   \
+    static void name();                                                 \
+    static const FSGuardTestRegistrar name##Registrar(#name, name);     \
+    static void name()
+
+#define FG_CHECK(expression)                                            \
+    do                                                                  \
+    {                                                                   \
+        if (!(expression))                                              \
+        {                                                               \
+            FSGuardReportFailure(__FILE__, __LINE__, #expression);      \
+        }                                                               \
+    } while (false)
+
+//
+// NOTE: stops the test, following checks depend on this one
+//
+#define FG_REQUIRE(expression)                                          \
+    do                                                                  \
+    {                                                                   \
+        if (!(expression))                                              \
+        {                                                               \
+            FSGuardReportFailure(__FILE__, __LINE__, #expression);      \
+            return;                                                     \
+        }                                                               \
+    } while (false)
+
+#endif /* FSGuardTest_h */
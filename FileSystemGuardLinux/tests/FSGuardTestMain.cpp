@@ -0,0 +1,63 @@
+//
+//  FSGuardTestMain.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include <vector>
+
+namespace
+{
+    struct TestEntry
+    {
+        const char          *name;
+        FSGuardTestFunction  function;
+    };
+
+    //
+    // NOTE: function local, registrars of other translation units run before main
+    //
+    std::vector<TestEntry> & Tests()
+    {
+        static std::vector<TestEntry> tests;
+        return tests;
+    }
+
+    unsigned g_failures = 0;
+}
+
+void FSGuardRegisterTest(const char *name, FSGuardTestFunction function)
+{
+    Tests().push_back(TestEntry { name, function });
+}
+
+void FSGuardReportFailure(const char *file, int line, const char *expression)
+{
+    fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+    ++g_failures;
+}
+
+int main()
+{
+    unsigned failedTests = 0;
+
+    for (const TestEntry &test : Tests())
+    {
+        const unsigned failures = g_failures;
+
+        test.function();
+
+        const bool passed = failures == g_failures;
+        printf("[%s] %s\n", passed ? "  OK  " : "FAILED", test.name);
+
+        failedTests += passed ? 0 : 1;
+    }
+
+    printf("%zu tests, %u failed\n", Tests().size(), failedTests);
+
+    return failedTests ? 1 : 0;
+}
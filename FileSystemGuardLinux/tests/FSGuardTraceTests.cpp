@@ -0,0 +1,368 @@
+//
+//  FSGuardTraceTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "FSGuardTrace.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// NOTE: trace file removed when the test ends
+//
+class TraceFile
+{
+public:
+    TraceFile()
+    {
+        char pattern[] = "/tmp/fsguardtraceXXXXXX";
+
+        const int fd = mkstemp(pattern);
+        if (-1 != fd)
+        {
+            close(fd);
+            m_path = pattern;
+        }
+    }
+
+    ~TraceFile()
+    {
+        if (!m_path.empty())
+        {
+            unlink(m_path.c_str());
+        }
+    }
+
+    const char * path() const
+    {
+        return m_path.c_str();
+    }
+
+    bool isValid() const
+    {
+        return !m_path.empty();
+    }
+
+    std::vector<uint8_t> read() const
+    {
+        std::vector<uint8_t> data;
+
+        if (FILE *file = fopen(path(), "rb"))
+        {
+            uint8_t buffer[4096];
+            size_t count = 0;
+
+            while (0 != (count = fread(buffer, 1, sizeof(buffer), file)))
+            {
+                data.insert(data.end(), buffer, buffer + count);
+            }
+
+            fclose(file);
+        }
+
+        return data;
+    }
+
+    bool write(const uint8_t *data, size_t size) const
+    {
+        FILE *file = fopen(path(), "wb");
+        if (!file)
+        {
+            return false;
+        }
+
+        const bool written = size == fwrite(data, 1, size, file);
+        fclose(file);
+
+        return written;
+    }
+
+private:
+    std::string m_path;
+};
+
+static FSGuardTraceEvent Event(uint32_t index)
+{
+    FSGuardTraceEvent event {};
+    event.timestamp = 1000000ull * index + 17;
+    event.latency = 250 + index * 3;
+    event.pid = static_cast<pid_t>(100 + index);
+    event.action = static_cast<FSGuardAction>(index % kFGActionCount);
+    event.verdict = index % 3 ? FSGuardTraceVerdict::Allow : FSGuardTraceVerdict::Deny;
+
+    //
+    // NOTE: lengths cover every padding size, including no path at all
+    //
+    event.path = "/data";
+    event.path.resize(index % 9 ? 5 + index : 0, 'a' + index % 26);
+
+    return event;
+}
+
+static bool Write(FSGuardTraceWriter &writer, const FSGuardTraceEvent &event)
+{
+    return writer.write(event.timestamp, event.latency, event.pid, event.action, event.verdict,
+                        event.path.data(), static_cast<uint32_t>(event.path.size()));
+}
+
+static bool Equal(const FSGuardTraceEvent &first, const FSGuardTraceEvent &second)
+{
+    return first.timestamp == second.timestamp &&
+           first.latency == second.latency &&
+           first.pid == second.pid &&
+           first.action == second.action &&
+           first.verdict == second.verdict &&
+           first.path == second.path;
+}
+
+FG_TEST(RoundTripKeepsEveryField)
+{
+    constexpr uint32_t kEvents = 64;
+
+    TraceFile file;
+    FG_REQUIRE(file.isValid());
+
+    {
+        FSGuardTraceWriter writer;
+        FG_REQUIRE(writer.open(file.path()));
+        FG_CHECK(!writer.open(file.path()));
+
+        for (uint32_t index = 0; index < kEvents; ++index)
+        {
+            FG_CHECK(Write(writer, Event(index)));
+        }
+    }
+
+    FSGuardTraceReader reader;
+    FG_REQUIRE(reader.open(file.path()));
+
+    FSGuardTraceEvent event;
+    uint32_t count = 0;
+
+    while (reader.next(event))
+    {
+        FG_CHECK(count < kEvents && Equal(Event(count), event));
+        ++count;
+    }
+
+    FG_CHECK(kEvents == count);
+    FG_CHECK(0 == (file.read().size() - sizeof(FSGuardTraceHeader)) % kFGTraceRecordAlignment);
+}
+
+FG_TEST(WriterRejectsWritesWhenClosed)
+{
+    TraceFile file;
+    FG_REQUIRE(file.isValid());
+
+    FSGuardTraceWriter writer;
+    FG_CHECK(!Write(writer, Event(1)));
+
+    FG_REQUIRE(writer.open(file.path()));
+    FG_CHECK(Write(writer, Event(1)));
+
+    writer.close();
+    FG_CHECK(!Write(writer, Event(3)));
+
+    FSGuardTraceReader reader;
+    FG_REQUIRE(reader.open(file.path()));
+
+    FSGuardTraceEvent event;
+    FG_CHECK(reader.next(event) && Equal(Event(1), event));
+    FG_CHECK(!reader.next(event));
+}
+
+FG_TEST(OverlongPathIsTruncated)
+{
+    TraceFile file;
+    FG_REQUIRE(file.isValid());
+
+    const std::string path(UINT16_MAX + 100, 'p');
+
+    {
+        FSGuardTraceWriter writer;
+        FG_REQUIRE(writer.open(file.path()));
+        FG_CHECK(writer.write(1, 2, 3, FSGuardAction::Write, FSGuardTraceVerdict::Deny,
+                              path.data(), static_cast<uint32_t>(path.size())));
+    }
+
+    FSGuardTraceReader reader;
+    FG_REQUIRE(reader.open(file.path()));
+
+    FSGuardTraceEvent event;
+    FG_REQUIRE(reader.next(event));
+    FG_CHECK(path.substr(0, UINT16_MAX) == event.path);
+    FG_CHECK(FSGuardAction::Write == event.action);
+    FG_CHECK(FSGuardTraceVerdict::Deny == event.verdict);
+}
+
+//
+// NOTE: trace cut at any byte, e.g. by a crash of the writer, yields the records
+//       written whole before the cut and nothing made up from the rest
+//
+FG_TEST(TruncatedTraceEndsAtLastWholeRecord)
+{
+    constexpr uint32_t kEvents = 5;
+
+    TraceFile file;
+    FG_REQUIRE(file.isValid());
+
+    std::vector<size_t> recordEnds;
+
+    {
+        FSGuardTraceWriter writer;
+        FG_REQUIRE(writer.open(file.path()));
+
+        size_t offset = sizeof(FSGuardTraceHeader);
+        for (uint32_t index = 0; index < kEvents; ++index)
+        {
+            const FSGuardTraceEvent event = Event(index);
+            FG_CHECK(Write(writer, event));
+
+            //
+            // NOTE: padding of the last record is not needed to read it
+            //
+            recordEnds.push_back(offset + sizeof(FSGuardTraceRecord) + event.path.size());
+            offset += FSGuardTraceRecordSize(static_cast<uint32_t>(event.path.size()));
+        }
+    }
+
+    const std::vector<uint8_t> whole = file.read();
+
+    for (size_t size = 0; size < whole.size(); ++size)
+    {
+        TraceFile truncated;
+        FG_REQUIRE(truncated.isValid());
+        FG_REQUIRE(truncated.write(whole.data(), size));
+
+        FSGuardTraceReader reader;
+        if (!reader.open(truncated.path()))
+        {
+            FG_CHECK(size < sizeof(FSGuardTraceHeader));
+            continue;
+        }
+
+        FG_CHECK(size >= sizeof(FSGuardTraceHeader));
+
+        uint32_t expected = 0;
+        while (expected < kEvents && recordEnds[expected] <= size)
+        {
+            ++expected;
+        }
+
+        FSGuardTraceEvent event;
+        uint32_t count = 0;
+
+        while (reader.next(event))
+        {
+            FG_CHECK(Equal(Event(count), event));
+            ++count;
+        }
+
+        FG_CHECK(expected == count);
+    }
+}
+
+FG_TEST(ReaderRejectsForeignHeader)
+{
+    TraceFile file;
+    FG_REQUIRE(file.isValid());
+
+    {
+        FSGuardTraceWriter writer;
+        FG_REQUIRE(writer.open(file.path()));
+        FG_CHECK(Write(writer, Event(1)));
+    }
+
+    const std::vector<uint8_t> valid = file.read();
+
+    auto opens = [&](size_t offset, uint8_t value) {
+        std::vector<uint8_t> data = valid;
+        data[offset] = value;
+
+        FSGuardTraceReader reader;
+        return file.write(data.data(), data.size()) && reader.open(file.path());
+    };
+
+    FG_CHECK(opens(offsetof(FSGuardTraceHeader, reserved), 0xFF));
+    FG_CHECK(!opens(offsetof(FSGuardTraceHeader, magic), 0));
+    FG_CHECK(!opens(offsetof(FSGuardTraceHeader, version), kFGTraceVersion + 1));
+    FG_CHECK(!opens(offsetof(FSGuardTraceHeader, headerSize), sizeof(FSGuardTraceHeader) - 1));
+
+    //
+    // NOTE: malformed record ends the trace
+    //
+    std::vector<uint8_t> data = valid;
+    data[sizeof(FSGuardTraceHeader) + offsetof(FSGuardTraceRecord, action)] = kFGActionCount;
+    FG_REQUIRE(file.write(data.data(), data.size()));
+
+    FSGuardTraceReader reader;
+    FG_REQUIRE(reader.open(file.path()));
+
+    FSGuardTraceEvent event;
+    FG_CHECK(!reader.next(event));
+}
+
+//
+// NOTE: resolver threads write concurrently, records are never interleaved
+//
+FG_TEST(ConcurrentWritersKeepRecordsWhole)
+{
+    constexpr uint32_t kThreads = 4;
+    constexpr uint32_t kEventsPerThread = 2000;
+
+    TraceFile file;
+    FG_REQUIRE(file.isValid());
+
+    {
+        FSGuardTraceWriter writer;
+        FG_REQUIRE(writer.open(file.path()));
+
+        std::vector<std::thread> threads;
+        for (uint32_t thread = 0; thread < kThreads; ++thread)
+        {
+            threads.emplace_back([&writer, thread] {
+                for (uint32_t index = 0; index < kEventsPerThread; ++index)
+                {
+                    Write(writer, Event(thread * kEventsPerThread + index));
+                }
+            });
+        }
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    FSGuardTraceReader reader;
+    FG_REQUIRE(reader.open(file.path()));
+
+    std::vector<bool> seen(kThreads * kEventsPerThread);
+    FSGuardTraceEvent event;
+    uint32_t count = 0;
+
+    while (reader.next(event))
+    {
+        const uint32_t index = static_cast<uint32_t>(event.pid - 100);
+        FG_REQUIRE(index < seen.size() && !seen[index]);
+        FG_CHECK(Equal(Event(index), event));
+
+        seen[index] = true;
+        ++count;
+    }
+
+    FG_CHECK(kThreads * kEventsPerThread == count);
+}
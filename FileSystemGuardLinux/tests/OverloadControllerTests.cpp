@@ -0,0 +1,234 @@
+//
+//  OverloadControllerTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "OverloadController.h"
+
+#include <stdint.h>
+
+static constexpr uint64_t kMillisecond = 1000 * 1000;
+
+static uint64_t Milliseconds(uint32_t milliseconds)
+{
+    return milliseconds * kMillisecond;
+}
+
+static FSGuardOverloadPolicy SmallPolicy()
+{
+    FSGuardOverloadPolicy policy = kFGDefaultOverloadPolicy;
+
+    policy.shedHighWatermark = 4;
+    policy.shedLowWatermark = 1;
+    policy.stallTimeoutCount = 2;
+
+    return policy;
+}
+
+FG_TEST(PolicyIsValidated)
+{
+    OverloadController controller;
+
+    FG_CHECK(OverloadController::isValidPolicy(kFGDefaultOverloadPolicy));
+
+    FSGuardOverloadPolicy policy = kFGDefaultOverloadPolicy;
+    policy.minVerdictTimeout = 0;
+    FG_CHECK(!controller.setPolicy(policy));
+
+    policy = kFGDefaultOverloadPolicy;
+    policy.minVerdictTimeout = policy.maxVerdictTimeout + 1;
+    FG_CHECK(!controller.setPolicy(policy));
+
+    policy = kFGDefaultOverloadPolicy;
+    policy.shedLowWatermark = policy.shedHighWatermark;
+    FG_CHECK(!controller.setPolicy(policy));
+
+    policy = kFGDefaultOverloadPolicy;
+    policy.stallTimeoutCount = 0;
+    FG_CHECK(!controller.setPolicy(policy));
+
+    policy = kFGDefaultOverloadPolicy;
+    policy.failClosedMask = ~kFGActionMaskAll;
+    FG_CHECK(!controller.setPolicy(policy));
+
+    FG_CHECK(kFGDefaultOverloadPolicy.shedHighWatermark == controller.policy().shedHighWatermark);
+}
+
+FG_TEST(SheddingHasHysteresis)
+{
+    OverloadController controller;
+    FG_REQUIRE(controller.setPolicy(SmallPolicy()));
+
+    for (uint32_t index = 0; index < 4; ++index)
+    {
+        FG_CHECK(controller.admit());
+    }
+
+    //
+    // NOTE: state follows the depth at the next admission
+    //
+    FG_CHECK(!controller.admit());
+    FG_CHECK(OverloadState::Shedding == controller.state());
+    FG_CHECK(4 == controller.depth());
+
+    //
+    // NOTE: still shedding until the depth drops to the low watermark
+    //
+    controller.complete(kMillisecond, true);
+    controller.cancel();
+    FG_CHECK(OverloadState::Shedding == controller.state());
+    FG_CHECK(!controller.admit());
+
+    controller.complete(kMillisecond, true);
+    FG_CHECK(OverloadState::Normal == controller.state());
+    FG_CHECK(controller.admit());
+    FG_CHECK(2 == controller.depth());
+}
+
+FG_TEST(PolicyChangeAppliesToCurrentDepth)
+{
+    OverloadController controller;
+
+    for (uint32_t index = 0; index < 3; ++index)
+    {
+        FG_CHECK(controller.admit());
+    }
+
+    FG_REQUIRE(controller.setPolicy(SmallPolicy()));
+    FG_CHECK(OverloadState::Normal == controller.state());
+
+    FSGuardOverloadPolicy policy = SmallPolicy();
+    policy.shedHighWatermark = 3;
+    FG_REQUIRE(controller.setPolicy(policy));
+    FG_CHECK(OverloadState::Shedding == controller.state());
+}
+
+FG_TEST(StalledClientGetsOneProbe)
+{
+    OverloadController controller;
+    FG_REQUIRE(controller.setPolicy(SmallPolicy()));
+
+    FG_CHECK(controller.admit());
+    FG_CHECK(controller.admit());
+    controller.complete(0, false);
+    FG_CHECK(OverloadState::Normal == controller.state());
+    controller.complete(0, false);
+    FG_CHECK(OverloadState::Stalled == controller.state());
+
+    FG_CHECK(Milliseconds(SmallPolicy().minVerdictTimeout) == controller.verdictTimeout());
+
+    //
+    // NOTE: only one probe is in flight while stalled
+    //
+    FG_CHECK(controller.admit());
+    FG_CHECK(!controller.admit());
+
+    controller.complete(0, false);
+    FG_CHECK(OverloadState::Stalled == controller.state());
+
+    FG_CHECK(controller.admit());
+    controller.complete(2 * kMillisecond, true);
+    FG_CHECK(OverloadState::Normal == controller.state());
+    FG_CHECK(0 == controller.depth());
+}
+
+FG_TEST(VerdictTimeoutFollowsLatency)
+{
+    OverloadController controller;
+    const FSGuardOverloadPolicy &policy = controller.policy();
+
+    FG_CHECK(Milliseconds(policy.maxVerdictTimeout) == controller.verdictTimeout());
+
+    //
+    // NOTE: first sample sets deviation to half of it, timeout is three times the latency
+    //
+    FG_REQUIRE(controller.admit());
+    controller.complete(1000 * kMillisecond, true);
+    FG_CHECK(3000 * kMillisecond == controller.verdictTimeout());
+
+    //
+    // NOTE: steady latency shrinks the deviation until the minimum clamps
+    //
+    for (uint32_t index = 0; index < 100; ++index)
+    {
+        FG_REQUIRE(controller.admit());
+        controller.complete(10 * kMillisecond, true);
+    }
+
+    FG_CHECK(Milliseconds(policy.minVerdictTimeout) == controller.verdictTimeout());
+
+    for (uint32_t index = 0; index < 100; ++index)
+    {
+        FG_REQUIRE(controller.admit());
+        controller.complete(60000 * kMillisecond, true);
+    }
+
+    FG_CHECK(Milliseconds(policy.maxVerdictTimeout) == controller.verdictTimeout());
+    FG_CHECK(Milliseconds(policy.maxEnqueueWait) == controller.enqueueWait());
+}
+
+FG_TEST(DefaultVerdictFollowsFailClosedMask)
+{
+    OverloadController controller;
+
+    FSGuardOverloadPolicy policy = kFGDefaultOverloadPolicy;
+    policy.failClosedMask = FSGuardActionMask(FSGuardAction::Execute);
+    FG_REQUIRE(controller.setPolicy(policy));
+
+    FG_CHECK(!controller.defaultVerdict(FSGuardAction::Execute));
+    FG_CHECK(controller.defaultVerdict(FSGuardAction::Read));
+    FG_CHECK(controller.defaultVerdict(FSGuardAction::Write));
+}
+
+//
+// NOTE: client dropping stale requests is alive, a run of drops neither stalls
+//       the controller nor shortens the verdict timeout
+//
+FG_TEST(ExpiredResponsesDoNotStall)
+{
+    OverloadController controller;
+    FG_REQUIRE(controller.setPolicy(SmallPolicy()));
+
+    FG_REQUIRE(controller.admit());
+    controller.complete(10 * kMillisecond, true);
+    const uint64_t timeout = controller.verdictTimeout();
+
+    for (uint32_t index = 0; index < 4 * SmallPolicy().stallTimeoutCount; ++index)
+    {
+        FG_REQUIRE(controller.admit());
+        controller.dropped();
+
+        FG_CHECK(OverloadState::Normal == controller.state());
+    }
+
+    FG_CHECK(0 == controller.depth());
+    FG_CHECK(timeout == controller.verdictTimeout());
+
+    //
+    // NOTE: drop between timeouts resets their run
+    //
+    FG_REQUIRE(controller.admit());
+    controller.complete(0, false);
+    FG_REQUIRE(controller.admit());
+    controller.dropped();
+    FG_REQUIRE(controller.admit());
+    controller.complete(0, false);
+    FG_CHECK(OverloadState::Normal == controller.state());
+
+    //
+    // NOTE: drop answering the probe of a stalled client returns to normal state
+    //
+    FG_REQUIRE(controller.admit());
+    controller.complete(0, false);
+    FG_CHECK(OverloadState::Stalled == controller.state());
+
+    FG_REQUIRE(controller.admit());
+    controller.dropped();
+    FG_CHECK(OverloadState::Normal == controller.state());
+    FG_CHECK(timeout == controller.verdictTimeout());
+}
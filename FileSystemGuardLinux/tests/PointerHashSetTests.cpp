@@ -0,0 +1,138 @@
+//
+//  PointerHashSetTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "PointerHashSet.h"
+
+#include <stdint.h>
+
+#include <random>
+#include <set>
+
+static void * Key(uintptr_t value)
+{
+    return reinterpret_cast<void *>(value);
+}
+
+FG_TEST(InsertContainsErase)
+{
+    PointerHashSet<64> set;
+
+    FG_CHECK(set.insert(Key(0x1000)));
+    FG_CHECK(set.insert(Key(0x2000)));
+    FG_CHECK(set.contains(Key(0x1000)));
+    FG_CHECK(set.contains(Key(0x2000)));
+    FG_CHECK(!set.contains(Key(0x3000)));
+    FG_CHECK(2 == set.size());
+
+    FG_CHECK(set.erase(Key(0x1000)));
+    FG_CHECK(!set.erase(Key(0x1000)));
+    FG_CHECK(!set.contains(Key(0x1000)));
+    FG_CHECK(set.contains(Key(0x2000)));
+    FG_CHECK(1 == set.size());
+}
+
+FG_TEST(DuplicateInsertKeepsSize)
+{
+    PointerHashSet<64> set;
+
+    FG_CHECK(set.insert(Key(0x1000)));
+    FG_CHECK(set.insert(Key(0x1000)));
+    FG_CHECK(1 == set.size());
+}
+
+FG_TEST(NullKeyIsRejected)
+{
+    PointerHashSet<64> set;
+
+    FG_CHECK(!set.insert(nullptr));
+    FG_CHECK(!set.contains(nullptr));
+    FG_CHECK(!set.erase(nullptr));
+    FG_CHECK(0 == set.size());
+}
+
+FG_TEST(InsertFailsAboveMaxSize)
+{
+    PointerHashSet<64> set;
+
+    for (uintptr_t index = 1; index <= PointerHashSet<64>::kMaxSize; ++index)
+    {
+        FG_CHECK(set.insert(Key(index * 16)));
+    }
+
+    FG_CHECK(!set.insert(Key(0xFFFF0)));
+    FG_CHECK(PointerHashSet<64>::kMaxSize == set.size());
+
+    //
+    // NOTE: key already present is found even when the set is full
+    //
+    FG_CHECK(set.insert(Key(16)));
+}
+
+FG_TEST(ClearVisitsEveryKey)
+{
+    PointerHashSet<64> set;
+    std::set<void *> inserted;
+
+    for (uintptr_t index = 1; index <= 20; ++index)
+    {
+        set.insert(Key(index * 8));
+        inserted.insert(Key(index * 8));
+    }
+
+    std::set<void *> visited;
+    set.clear([&](void *key) {
+        visited.insert(key);
+    });
+
+    FG_CHECK(inserted == visited);
+    FG_CHECK(0 == set.size());
+    FG_CHECK(!set.contains(Key(8)));
+}
+
+//
+// NOTE: backward shift deletion must keep every remaining key reachable,
+//       random operations are compared with std::set
+//
+FG_TEST(RandomOperationsMatchReference)
+{
+    PointerHashSet<256> set;
+    std::set<void *> reference;
+    std::mt19937 random(42);
+
+    for (uint32_t step = 0; step < 200000; ++step)
+    {
+        void *key = Key((random() % 512 + 1) * 64);
+
+        if (random() % 2)
+        {
+            const bool inserted = set.insert(key);
+            if (reference.count(key) || reference.size() < PointerHashSet<256>::kMaxSize)
+            {
+                FG_REQUIRE(inserted);
+                reference.insert(key);
+            }
+            else
+            {
+                FG_REQUIRE(!inserted);
+            }
+        }
+        else
+        {
+            FG_REQUIRE(set.erase(key) == (1 == reference.erase(key)));
+        }
+
+        FG_REQUIRE(set.size() == reference.size());
+    }
+
+    for (uintptr_t index = 1; index <= 512; ++index)
+    {
+        FG_CHECK(set.contains(Key(index * 64)) == (0 != reference.count(Key(index * 64))));
+    }
+}
@@ -0,0 +1,359 @@
+//
+//  RequestCoalescerTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "RequestCoalescer.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+static VerdictKey Key(uint64_t fileid, int32_t pid = 1)
+{
+    return VerdictKey { 7, fileid, 1, 1, pid };
+}
+
+static void * Event(uintptr_t value)
+{
+    return reinterpret_cast<void *>(value);
+}
+
+FG_TEST(IdenticalRequestsJoinLeader)
+{
+    RequestCoalescer<8> coalescer;
+    bool leader = false;
+
+    const uint32_t first = coalescer.join(Key(1), Event(0x10), leader);
+    FG_REQUIRE(RequestCoalescer<8>::kInvalidSlot != first);
+    FG_CHECK(leader);
+
+    const uint32_t second = coalescer.join(Key(1), Event(0x20), leader);
+    FG_CHECK(first == second);
+    FG_CHECK(!leader);
+    FG_CHECK(Event(0x10) == coalescer.event(second));
+
+    const uint32_t other = coalescer.join(Key(1, 2), Event(0x30), leader);
+    FG_CHECK(first != other);
+    FG_CHECK(leader);
+
+    FG_CHECK(2 == coalescer.leaderCount());
+    FG_CHECK(1 == coalescer.joinedCount());
+}
+
+FG_TEST(FinishPublishesVerdict)
+{
+    RequestCoalescer<8> coalescer;
+    bool leader = false;
+    bool allow = true;
+
+    const uint32_t slot = coalescer.join(Key(1), Event(0x10), leader);
+    coalescer.join(Key(1), Event(0x20), leader);
+
+    FG_CHECK(!coalescer.isFinished(slot));
+    FG_CHECK(!coalescer.verdict(slot, allow));
+
+    coalescer.finish(slot, true, false);
+    FG_CHECK(coalescer.isFinished(slot));
+    FG_CHECK(coalescer.verdict(slot, allow));
+    FG_CHECK(!allow);
+
+    //
+    // NOTE: second finish of the same leader is ignored
+    //
+    coalescer.finish(slot, false, true);
+    FG_CHECK(coalescer.verdict(slot, allow));
+    FG_CHECK(!allow);
+}
+
+FG_TEST(FinishedEntryIsNotJoined)
+{
+    RequestCoalescer<8> coalescer;
+    bool leader = false;
+
+    const uint32_t first = coalescer.join(Key(1), Event(0x10), leader);
+    coalescer.join(Key(1), Event(0x20), leader);
+    coalescer.finish(first, false, true);
+
+    //
+    // NOTE: joined request still holds the finished entry, new one starts its own
+    //
+    const uint32_t second = coalescer.join(Key(1), Event(0x30), leader);
+    FG_CHECK(leader);
+    FG_CHECK(first != second);
+    FG_CHECK(coalescer.isFinished(first));
+    FG_CHECK(!coalescer.isFinished(second));
+
+    coalescer.leave(first);
+    coalescer.leave(first);
+
+    FG_CHECK(second == coalescer.join(Key(1), Event(0x40), leader));
+    FG_CHECK(!leader);
+}
+
+FG_TEST(FullTableRejectsNewLeader)
+{
+    RequestCoalescer<4> coalescer;
+    bool leader = false;
+    uint32_t slots[4];
+
+    for (uint32_t index = 0; index < 4; ++index)
+    {
+        slots[index] = coalescer.join(Key(index), Event(index + 1), leader);
+        FG_REQUIRE(RequestCoalescer<4>::kInvalidSlot != slots[index]);
+    }
+
+    FG_CHECK(RequestCoalescer<4>::kInvalidSlot == coalescer.join(Key(100), Event(0x100), leader));
+
+    //
+    // NOTE: joining an existing entry needs no new slot
+    //
+    FG_CHECK(slots[2] == coalescer.join(Key(2), Event(0x200), leader));
+    FG_CHECK(!leader);
+
+    coalescer.leave(slots[0]);
+
+    const uint32_t reused = coalescer.join(Key(100), Event(0x100), leader);
+    FG_CHECK(slots[0] == reused);
+    FG_CHECK(leader);
+    FG_CHECK(Event(0x100) == coalescer.event(reused));
+}
+
+//
+// NOTE: random join, finish and leave checked against a model of live entries
+//
+FG_TEST(RandomOperationsMatchModel)
+{
+    constexpr uint32_t kSlots = 64;
+
+    struct Holder
+    {
+        uint32_t slot;
+        uint64_t fileid;
+    };
+
+    RequestCoalescer<kSlots> coalescer;
+    std::map<uint64_t, uint32_t> linked;
+    std::map<uint32_t, uint32_t> references;
+    std::vector<Holder> holders;
+    std::mt19937_64 random(99);
+
+    uint64_t leaders = 0;
+    uint64_t joined = 0;
+
+    for (uint32_t step = 0; step < 200000; ++step)
+    {
+        const uint32_t operation = random() % 3;
+
+        if (0 == operation || holders.empty())
+        {
+            const uint64_t fileid = random() % 96;
+            bool leader = false;
+
+            const uint32_t slot = coalescer.join(Key(fileid), Event(fileid + 1), leader);
+            const auto found = linked.find(fileid);
+
+            if (found != linked.end())
+            {
+                FG_REQUIRE(slot == found->second);
+                FG_REQUIRE(!leader);
+                ++joined;
+            }
+            else if (references.size() == kSlots)
+            {
+                FG_REQUIRE(RequestCoalescer<kSlots>::kInvalidSlot == slot);
+                continue;
+            }
+            else
+            {
+                FG_REQUIRE(RequestCoalescer<kSlots>::kInvalidSlot != slot);
+                FG_REQUIRE(leader);
+                FG_REQUIRE(0 == references.count(slot));
+                linked[fileid] = slot;
+                ++leaders;
+            }
+
+            ++references[slot];
+            holders.push_back({ slot, fileid });
+        }
+        else
+        {
+            const size_t index = random() % holders.size();
+            const Holder holder = holders[index];
+
+            if (1 == operation)
+            {
+                coalescer.finish(holder.slot, true, 0 != (holder.fileid & 1));
+
+                const auto found = linked.find(holder.fileid);
+                if (found != linked.end() && found->second == holder.slot)
+                {
+                    linked.erase(found);
+                }
+
+                bool allow = false;
+                FG_CHECK(coalescer.verdict(holder.slot, allow));
+                FG_CHECK(allow == (0 != (holder.fileid & 1)));
+            }
+            else
+            {
+                holders[index] = holders.back();
+                holders.pop_back();
+
+                coalescer.leave(holder.slot);
+
+                if (0 == --references[holder.slot])
+                {
+                    references.erase(holder.slot);
+
+                    const auto found = linked.find(holder.fileid);
+                    if (found != linked.end() && found->second == holder.slot)
+                    {
+                        linked.erase(found);
+                    }
+                }
+            }
+        }
+    }
+
+    FG_CHECK(leaders == coalescer.leaderCount());
+    FG_CHECK(joined == coalescer.joinedCount());
+}
+
+//
+// NOTE: thundering herd on one file, threads join under one mutex like they do
+//       under m_waitListLock, the leader asks the client while the others pile up
+//       behind it and every follower must get the verdict of its leader
+//
+FG_TEST(HerdOnOneKeyWaitsForOneLeader)
+{
+    constexpr uint32_t kThreads = 64;
+    constexpr uint32_t kRounds = 10;
+
+    using Coalescer = RequestCoalescer<16>;
+
+    struct Outcome
+    {
+        bool leader;
+        bool resolved;
+        bool allow;
+        bool expected;
+    };
+
+    Coalescer coalescer;
+    std::mutex lock;
+    std::condition_variable finished;
+    std::vector<Outcome> outcomes(kThreads * kRounds);
+
+    //
+    // NOTE: verdict each leader got, per slot, written and read under the lock
+    //
+    bool leaderVerdicts[16] = {};
+
+    for (uint32_t round = 0; round < kRounds; ++round)
+    {
+        std::atomic<uint32_t> ready {0};
+        std::atomic<bool> start {false};
+        std::vector<std::thread> threads;
+
+        for (uint32_t index = 0; index < kThreads; ++index)
+        {
+            threads.emplace_back([&, index] {
+                Outcome &outcome = outcomes[round * kThreads + index];
+                int event = 0;
+
+                ++ready;
+                while (!start.load())
+                {
+                    std::this_thread::yield();
+                }
+
+                std::unique_lock<std::mutex> guard(lock);
+
+                const uint32_t slot = coalescer.join(Key(1), &event, outcome.leader);
+                if (Coalescer::kInvalidSlot == slot)
+                {
+                    return;
+                }
+
+                if (outcome.leader)
+                {
+                    const bool verdict = 0 != coalescer.leaderCount() % 2;
+
+                    guard.unlock();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                    guard.lock();
+
+                    leaderVerdicts[slot] = verdict;
+                    coalescer.finish(slot, true, verdict);
+                    finished.notify_all();
+                }
+                else
+                {
+                    finished.wait(guard, [&] { return coalescer.isFinished(slot); });
+                }
+
+                //
+                // NOTE: verdict of the leader which started this entry
+                //
+                outcome.resolved = coalescer.verdict(slot, outcome.allow);
+                outcome.expected = leaderVerdicts[slot];
+                coalescer.leave(slot);
+            });
+        }
+
+        while (ready.load() < kThreads)
+        {
+            std::this_thread::yield();
+        }
+
+        start = true;
+
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    uint64_t resolved = 0;
+    uint64_t matching = 0;
+    for (const Outcome &outcome : outcomes)
+    {
+        resolved += outcome.resolved;
+        matching += outcome.allow == outcome.expected;
+    }
+
+    //
+    // NOTE: a late thread may start a second entry after the first finished,
+    //       but the herd is coalesced, not sent to the client one by one
+    //
+    FG_CHECK(kThreads * kRounds == resolved);
+    FG_CHECK(kThreads * kRounds == matching);
+    FG_CHECK(coalescer.leaderCount() <= kRounds * 4);
+    FG_CHECK(coalescer.leaderCount() + coalescer.joinedCount() == kThreads * kRounds);
+
+    printf("    %llu leaders for %u requests\n", static_cast<unsigned long long>(coalescer.leaderCount()), kThreads * kRounds);
+
+    //
+    // NOTE: every entry was released, the whole table is free again
+    //
+    bool leader = false;
+    for (uint32_t fileid = 100; fileid < 116; ++fileid)
+    {
+        FG_CHECK(Coalescer::kInvalidSlot != coalescer.join(Key(fileid), Event(fileid), leader) && leader);
+    }
+}
@@ -0,0 +1,176 @@
+//
+//  SlabPoolTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "SlabPool.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+struct PoolObject
+{
+    uint64_t value;
+    uint32_t owner;
+};
+
+FG_TEST(EveryObjectIsHandedOutOnce)
+{
+    auto pool = std::make_unique<SlabPool<PoolObject, 100, 4>>();
+    std::set<PoolObject *> objects;
+
+    for (uint32_t index = 0; index < 100; ++index)
+    {
+        PoolObject *object = pool->allocate(index);
+        FG_REQUIRE(object);
+        FG_CHECK(objects.insert(object).second);
+        FG_CHECK(object == pool->at(pool->indexOf(object)));
+    }
+
+    //
+    // NOTE: exhausted pool, every shard was emptied by the others
+    //
+    FG_CHECK(nullptr == pool->allocate(0));
+    FG_CHECK(nullptr == pool->allocate(3));
+
+    pool->free(*objects.begin(), 2);
+    FG_CHECK(*objects.begin() == pool->allocate(0));
+}
+
+FG_TEST(ShardReusesLastFreedObject)
+{
+    auto pool = std::make_unique<SlabPool<PoolObject, 64, 4>>();
+
+    PoolObject *first = pool->allocate(1);
+    PoolObject *second = pool->allocate(1);
+    FG_REQUIRE(first && second);
+
+    //
+    // NOTE: object goes to the shard of the caller, not to the one it came from
+    //
+    pool->free(first, 3);
+    pool->free(second, 3);
+    FG_CHECK(second == pool->allocate(3));
+    FG_CHECK(first == pool->allocate(3));
+
+    pool->free(first, 1);
+    FG_CHECK(first == pool->allocate(1));
+}
+
+FG_TEST(ForeignObjectsAreIgnored)
+{
+    using SmallPool = SlabPool<PoolObject, 8, 1>;
+
+    auto pool = std::make_unique<SmallPool>();
+    PoolObject foreign {};
+
+    pool->free(&foreign, 0);
+    FG_CHECK(SmallPool::kInvalidIndex == pool->indexOf(&foreign));
+    FG_CHECK(nullptr == pool->at(8));
+    FG_CHECK(nullptr != pool->at(7));
+
+    for (uint32_t index = 0; index < 8; ++index)
+    {
+        FG_CHECK(&foreign != pool->allocate(0));
+    }
+
+    FG_CHECK(nullptr == pool->allocate(0));
+}
+
+//
+// NOTE: threads allocate and free through every shard, object owned by two threads
+//       at once is caught by the owner mark
+//
+FG_TEST(ConcurrentAllocationNeverSharesObject)
+{
+    constexpr uint32_t kThreads = 4;
+    constexpr uint32_t kIterations = 100000;
+
+    auto pool = std::make_unique<SlabPool<PoolObject, 16, 2>>();
+    std::atomic<uint64_t> conflicts {0};
+    std::atomic<uint64_t> exhausted {0};
+    std::vector<std::thread> threads;
+
+    //
+    // NOTE: objects are constructed with the pool, callers reset what they use
+    //
+    for (uint32_t index = 0; index < 16; ++index)
+    {
+        pool->at(index)->owner = 0;
+    }
+
+    for (uint32_t thread = 0; thread < kThreads; ++thread)
+    {
+        threads.emplace_back([&, thread] {
+            PoolObject *held[4] = {};
+
+            for (uint32_t iteration = 0; iteration < kIterations; ++iteration)
+            {
+                PoolObject *&slot = held[iteration & 3];
+
+                if (slot)
+                {
+                    if (thread + 1 != __atomic_exchange_n(&slot->owner, 0, __ATOMIC_RELAXED))
+                    {
+                        conflicts.fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    pool->free(slot, iteration);
+                    slot = nullptr;
+                    continue;
+                }
+
+                slot = pool->allocate(thread + iteration);
+                if (!slot)
+                {
+                    exhausted.fetch_add(1, std::memory_order_relaxed);
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                if (0 != __atomic_exchange_n(&slot->owner, thread + 1, __ATOMIC_RELAXED))
+                {
+                    conflicts.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            for (PoolObject *object : held)
+            {
+                if (object)
+                {
+                    __atomic_store_n(&object->owner, 0, __ATOMIC_RELAXED);
+                    pool->free(object, thread);
+                }
+            }
+        });
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    FG_CHECK(0 == conflicts.load());
+    FG_CHECK(0 == exhausted.load());
+
+    //
+    // NOTE: nothing was lost, the whole capacity is free again
+    //
+    std::set<PoolObject *> objects;
+    while (PoolObject *object = pool->allocate(0))
+    {
+        FG_REQUIRE(objects.insert(object).second);
+    }
+
+    FG_CHECK(16 == objects.size());
+}
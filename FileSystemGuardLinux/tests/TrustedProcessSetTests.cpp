@@ -0,0 +1,260 @@
+//
+//  TrustedProcessSetTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "ReadMostlyPointer.h"
+#include "TrustedProcessSet.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+struct YieldBackoff
+{
+    static void wait()
+    {
+        std::this_thread::yield();
+    }
+};
+
+static FSGuardTrustedProcess Process(pid_t pid, const char *name)
+{
+    FSGuardTrustedProcess process {};
+    process.pid = pid;
+    strncpy(process.name, name, sizeof(process.name) - 1);
+
+    return process;
+}
+
+static auto Name(const char *name)
+{
+    return [name](char *buffer, uint32_t size) {
+        snprintf(buffer, size, "%s", name);
+    };
+}
+
+FG_TEST(PointerExchangeReturnsPrevious)
+{
+    ReadMostlyPointer<int, YieldBackoff> pointer;
+    int first = 1;
+    int second = 2;
+
+    FG_CHECK(pointer.isNull());
+    FG_CHECK(-1 == pointer.read([](const int *value) { return value ? *value : -1; }));
+
+    FG_CHECK(nullptr == pointer.exchange(&first));
+    FG_CHECK(!pointer.isNull());
+    FG_CHECK(1 == pointer.read([](const int *value) { return *value; }));
+
+    FG_CHECK(&first == pointer.exchange(&second));
+    FG_CHECK(2 == pointer.read([](const int *value) { return *value; }));
+    FG_CHECK(&second == pointer.exchange(nullptr));
+}
+
+FG_TEST(ExchangeWaitsForReaders)
+{
+    ReadMostlyPointer<int, YieldBackoff> pointer;
+    int first = 1;
+    int second = 2;
+    pointer.exchange(&first);
+
+    std::atomic<bool> entered {false};
+    std::atomic<bool> leave {false};
+    std::atomic<bool> exchanged {false};
+
+    std::thread reader([&] {
+        pointer.read([&](const int *value) {
+            entered = true;
+            while (!leave)
+            {
+                std::this_thread::yield();
+            }
+
+            FG_CHECK(1 == *value);
+            return 0;
+        });
+    });
+
+    while (!entered)
+    {
+        std::this_thread::yield();
+    }
+
+    std::thread writer([&] {
+        FG_CHECK(&first == pointer.exchange(&second));
+        exchanged = true;
+    });
+
+    //
+    // NOTE: new readers already see the new value while the old one is in use
+    //
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    FG_CHECK(!exchanged);
+    FG_CHECK(2 == pointer.read([](const int *value) { return *value; }));
+
+    leave = true;
+    reader.join();
+    writer.join();
+
+    FG_CHECK(exchanged);
+}
+
+//
+// NOTE: old values are poisoned and freed right after exchange,
+//       readers never see a released value
+//
+FG_TEST(ReadersNeverSeeReleasedValue)
+{
+    struct Value
+    {
+        uint64_t canary;
+        uint64_t sequence;
+    };
+
+    constexpr uint64_t kCanary = 0x5AFEC0DEull;
+
+    ReadMostlyPointer<Value, YieldBackoff> pointer;
+    pointer.exchange(new Value { kCanary, 0 });
+
+    std::atomic<bool> done {false};
+    std::atomic<uint64_t> invalid {0};
+    std::vector<std::thread> readers;
+
+    for (uint32_t index = 0; index < 3; ++index)
+    {
+        readers.emplace_back([&] {
+            uint64_t last = 0;
+
+            while (!done.load(std::memory_order_relaxed))
+            {
+                pointer.read([&](const Value *value) {
+                    if (kCanary != value->canary || value->sequence < last)
+                    {
+                        invalid.fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    last = value->sequence;
+                });
+
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    for (uint64_t sequence = 1; sequence <= 5000; ++sequence)
+    {
+        Value *old = pointer.exchange(new Value { kCanary, sequence });
+
+        old->canary = 0;
+        delete old;
+    }
+
+    done = true;
+    for (std::thread &reader : readers)
+    {
+        reader.join();
+    }
+
+    delete pointer.exchange(nullptr);
+
+    FG_CHECK(0 == invalid.load());
+}
+
+FG_TEST(TrustedProcessNeedsMatchingName)
+{
+    TrustedProcessSet<YieldBackoff> set;
+
+    FG_CHECK(!set.contains(100, Name("backupd")));
+
+    const FSGuardTrustedProcess processes[] = { Process(100, "backupd"), Process(200, "mds") };
+    FG_REQUIRE(set.replace(processes, 2));
+    FG_CHECK(2 == set.count());
+
+    FG_CHECK(set.contains(100, Name("backupd")));
+    FG_CHECK(set.contains(200, Name("mds")));
+    FG_CHECK(!set.contains(100, Name("mds")));
+    FG_CHECK(!set.contains(300, Name("backupd")));
+
+    //
+    // NOTE: name of untrusted pid is never read
+    //
+    uint32_t reads = 0;
+    FG_CHECK(!set.contains(300, [&](char *, uint32_t) { ++reads; }));
+    FG_CHECK(0 == reads);
+
+    //
+    // NOTE: name which fills the buffer without terminator is cut
+    //
+    FG_CHECK(!set.contains(100, [](char *buffer, uint32_t size) { memset(buffer, 'b', size); }));
+
+    FG_REQUIRE(set.replace(nullptr, 0));
+    FG_CHECK(0 == set.count());
+    FG_CHECK(!set.contains(100, Name("backupd")));
+}
+
+FG_TEST(InvalidProcessesAreRejected)
+{
+    TrustedProcessSet<YieldBackoff> set;
+
+    const FSGuardTrustedProcess valid = Process(100, "backupd");
+    FG_REQUIRE(set.replace(&valid, 1));
+
+    FSGuardTrustedProcess unterminated = Process(101, "x");
+    memset(unterminated.name, 'x', sizeof(unterminated.name));
+
+    const FSGuardTrustedProcess invalid[][2] = {
+        { valid, Process(0, "kernel_task") },
+        { valid, Process(-5, "negative") },
+        { valid, Process(102, "") },
+        { valid, unterminated },
+    };
+
+    for (const auto &processes : invalid)
+    {
+        FG_CHECK(!set.replace(processes, 2));
+    }
+
+    FG_CHECK(!set.replace(&valid, kFGMaxTrustedProcesses + 1));
+
+    //
+    // NOTE: rejected update keeps the previous set
+    //
+    FG_CHECK(1 == set.count());
+    FG_CHECK(set.contains(100, Name("backupd")));
+}
+
+FG_TEST(LargeSetWithDuplicates)
+{
+    TrustedProcessSet<YieldBackoff> set;
+    std::vector<FSGuardTrustedProcess> processes;
+
+    for (pid_t pid = 1; pid <= static_cast<pid_t>(kFGMaxTrustedProcesses) - 1; ++pid)
+    {
+        processes.push_back(Process(pid * 7, "agent"));
+    }
+
+    processes.push_back(Process(7, "renamed"));
+
+    FG_REQUIRE(set.replace(processes.data(), static_cast<uint32_t>(processes.size())));
+    FG_CHECK(kFGMaxTrustedProcesses - 1 == set.count());
+
+    for (pid_t pid = 2; pid <= static_cast<pid_t>(kFGMaxTrustedProcesses) - 1; ++pid)
+    {
+        FG_REQUIRE(set.contains(pid * 7, Name("agent")));
+        FG_REQUIRE(!set.contains(pid * 7 + 1, Name("agent")));
+    }
+
+    FG_CHECK(set.contains(7, Name("renamed")));
+    FG_CHECK(!set.contains(7, Name("agent")));
+}
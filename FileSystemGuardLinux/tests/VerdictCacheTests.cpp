@@ -0,0 +1,144 @@
+//
+//  VerdictCacheTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "VerdictCache.h"
+
+#include <stdint.h>
+
+#include <memory>
+
+//
+// NOTE: one set, so every key competes for the same ways
+//
+using SingleSetCache = VerdictCache<1, 4>;
+
+static VerdictKey MakeKey(uint64_t fileid)
+{
+    return VerdictKey { 1, fileid, 7, 1, 100 };
+}
+
+FG_TEST(VerdictIsReturnedUntilItExpires)
+{
+    auto cache = std::make_unique<VerdictCache<16>>();
+    const VerdictKey key = MakeKey(1);
+    bool allow = false;
+
+    FG_CHECK(!cache->lookup(key, 0, allow));
+
+    cache->insert(key, true, 10, 5);
+    FG_CHECK(cache->lookup(key, 10, allow) && allow);
+    FG_CHECK(cache->lookup(key, 14, allow) && allow);
+    FG_CHECK(!cache->lookup(key, 15, allow));
+
+    cache->insert(key, false, 20, 5);
+    FG_CHECK(cache->lookup(key, 20, allow) && !allow);
+}
+
+FG_TEST(EveryKeyFieldIsCompared)
+{
+    auto cache = std::make_unique<VerdictCache<16>>();
+    const VerdictKey key = MakeKey(1);
+    bool allow = false;
+
+    cache->insert(key, true, 0, 100);
+
+    VerdictKey other = key;
+    other.fsid = 2;
+    FG_CHECK(!cache->lookup(other, 0, allow));
+
+    other = key;
+    other.fileid = 2;
+    FG_CHECK(!cache->lookup(other, 0, allow));
+
+    other = key;
+    other.vid = 8;
+    FG_CHECK(!cache->lookup(other, 0, allow));
+
+    other = key;
+    other.actionMask = 3;
+    FG_CHECK(!cache->lookup(other, 0, allow));
+
+    other = key;
+    other.pid = 101;
+    FG_CHECK(!cache->lookup(other, 0, allow));
+
+    FG_CHECK(cache->lookup(key, 0, allow) && allow);
+}
+
+FG_TEST(FlushDropsVerdictsOfOldGeneration)
+{
+    auto cache = std::make_unique<VerdictCache<16>>();
+    const VerdictKey key = MakeKey(1);
+    bool allow = false;
+
+    cache->insert(key, true, 0, 100);
+
+    const uint32_t generation = cache->generation();
+    cache->flush();
+
+    FG_CHECK(generation != cache->generation());
+    FG_CHECK(!cache->lookup(key, 0, allow));
+
+    //
+    // NOTE: decision taken before the flush is not stored after it
+    //
+    FG_CHECK(!cache->insert(key, true, 0, 100, generation));
+    FG_CHECK(!cache->lookup(key, 0, allow));
+
+    FG_CHECK(cache->insert(key, false, 0, 100, cache->generation()));
+    FG_CHECK(cache->lookup(key, 0, allow) && !allow);
+}
+
+FG_TEST(FullSetEvictsEntryWhichExpiresFirst)
+{
+    auto cache = std::make_unique<SingleSetCache>();
+    bool allow = false;
+
+    cache->insert(MakeKey(1), true, 0, 40);
+    cache->insert(MakeKey(2), true, 0, 10);
+    cache->insert(MakeKey(3), true, 0, 30);
+    cache->insert(MakeKey(4), true, 0, 20);
+
+    cache->insert(MakeKey(5), true, 0, 50);
+
+    FG_CHECK(!cache->lookup(MakeKey(2), 0, allow));
+    FG_CHECK(cache->lookup(MakeKey(1), 0, allow));
+    FG_CHECK(cache->lookup(MakeKey(3), 0, allow));
+    FG_CHECK(cache->lookup(MakeKey(4), 0, allow));
+    FG_CHECK(cache->lookup(MakeKey(5), 0, allow));
+
+    //
+    // NOTE: expired entry is reused before any live one
+    //
+    cache->insert(MakeKey(6), true, 25, 50);
+
+    FG_CHECK(!cache->lookup(MakeKey(4), 25, allow));
+    FG_CHECK(cache->lookup(MakeKey(1), 25, allow));
+    FG_CHECK(cache->lookup(MakeKey(3), 25, allow));
+    FG_CHECK(cache->lookup(MakeKey(5), 25, allow));
+    FG_CHECK(cache->lookup(MakeKey(6), 25, allow));
+}
+
+FG_TEST(InsertReplacesLiveEntryInLaterWay)
+{
+    auto cache = std::make_unique<SingleSetCache>();
+    bool allow = false;
+
+    cache->insert(MakeKey(1), true, 0, 10);
+    cache->insert(MakeKey(2), true, 0, 100);
+
+    //
+    // NOTE: first way is free again, the new verdict must still replace
+    //       the live one of the key, otherwise the old verdict outlives it
+    //
+    cache->insert(MakeKey(2), false, 20, 5);
+    FG_CHECK(cache->lookup(MakeKey(2), 20, allow) && !allow);
+    FG_CHECK(!cache->lookup(MakeKey(2), 30, allow));
+}
@@ -0,0 +1,313 @@
+//
+//  WatchScopeTests.cpp
+//  FileSystemGuardLinux
+//
+//  Created by agent on 10/17/26.
+//  Copyright © 2026 agent. All rights reserved.
+//
+
+#include "FSGuardTest.h"
+
+#include "WatchScope.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+//
+// NOTE: directory tree of one mount, node is the index of the directory,
+//       parent references are counted to check every one is released
+//
+class TreeWalker
+{
+public:
+    using Node = int32_t;
+    static constexpr Node NodeNull = -1;
+
+    struct Directory
+    {
+        Node     parent;
+        uint64_t fileid;
+        uint32_t version;
+        bool     identified;
+    };
+
+    Node add(Node parent, uint64_t fileid)
+    {
+        m_directories.push_back({ parent, fileid, 1, true });
+        return static_cast<Node>(m_directories.size() - 1);
+    }
+
+    Directory & directory(Node node)
+    {
+        return m_directories[node];
+    }
+
+    uint64_t object(Node node) const
+    {
+        return 0x1000 + static_cast<uint64_t>(node);
+    }
+
+    uint32_t version(Node node) const
+    {
+        return m_directories[node].version;
+    }
+
+    bool fileid(Node node, uint64_t &fileid)
+    {
+        ++m_visits;
+        fileid = m_directories[node].fileid;
+        return m_directories[node].identified;
+    }
+
+    bool isMountRoot(Node node) const
+    {
+        return 0 == node;
+    }
+
+    Node parent(Node node)
+    {
+        const Node parent = m_directories[node].parent;
+        if (NodeNull != parent)
+        {
+            ++m_references;
+        }
+
+        return parent;
+    }
+
+    void release(Node)
+    {
+        --m_references;
+    }
+
+    int32_t references() const
+    {
+        return m_references;
+    }
+
+    uint32_t takeVisits()
+    {
+        const uint32_t visits = m_visits;
+        m_visits = 0;
+        return visits;
+    }
+
+private:
+    std::vector<Directory> m_directories;
+    int32_t                m_references = 0;
+    uint32_t               m_visits = 0;
+};
+
+static constexpr uint64_t kFsid = 5;
+
+static std::unique_ptr<FSGuardWatchScope> Scope(std::initializer_list<uint64_t> mounts, std::initializer_list<FSGuardFileIdentity> roots)
+{
+    auto scope = std::make_unique<FSGuardWatchScope>();
+
+    for (uint64_t mount : mounts)
+    {
+        scope->mounts[scope->mountCount++] = mount;
+    }
+
+    for (const FSGuardFileIdentity &root : roots)
+    {
+        scope->roots[scope->rootCount++] = root;
+    }
+
+    return scope;
+}
+
+FG_TEST(MountsAreClassified)
+{
+    auto scope = std::make_unique<WatchScope>();
+
+    FG_CHECK(scope->isEmpty());
+    FG_CHECK(WatchScopeMount::Whole == scope->classify(1));
+
+    FG_REQUIRE(scope->load(*Scope({ 30, 10 }, { { 20, 100, 0 }, { 10, 200, 0 }, { 20, 50, 0 } })));
+    FG_CHECK(!scope->isEmpty());
+
+    //
+    // NOTE: whole mount wins over the roots on it
+    //
+    FG_CHECK(WatchScopeMount::Whole == scope->classify(10));
+    FG_CHECK(WatchScopeMount::Whole == scope->classify(30));
+    FG_CHECK(WatchScopeMount::Partial == scope->classify(20));
+    FG_CHECK(WatchScopeMount::Outside == scope->classify(25));
+    FG_CHECK(WatchScopeMount::Outside == scope->classify(0));
+
+    FG_CHECK(scope->isRoot(20, 50));
+    FG_CHECK(scope->isRoot(20, 100));
+    FG_CHECK(!scope->isRoot(20, 75));
+    FG_CHECK(!scope->isRoot(30, 100));
+}
+
+FG_TEST(OversizedScopeIsRejected)
+{
+    auto scope = std::make_unique<WatchScope>();
+    auto input = Scope({}, {});
+
+    input->mountCount = kFGMaxWatchedMounts + 1;
+    FG_CHECK(!scope->load(*input));
+
+    input->mountCount = 0;
+    input->rootCount = kFGMaxWatchedRoots + 1;
+    FG_CHECK(!scope->load(*input));
+
+    //
+    // NOTE: full scope with distinct root mounts fits
+    //
+    input->mountCount = kFGMaxWatchedMounts;
+    input->rootCount = kFGMaxWatchedRoots;
+    for (uint32_t index = 0; index < kFGMaxWatchedMounts; ++index)
+    {
+        input->mounts[index] = 1000 - index;
+    }
+
+    for (uint32_t index = 0; index < kFGMaxWatchedRoots; ++index)
+    {
+        input->roots[index] = { 5000 - index, index, 0 };
+    }
+
+    FG_REQUIRE(scope->load(*input));
+    FG_CHECK(WatchScopeMount::Whole == scope->classify(1000 - 63));
+    FG_CHECK(WatchScopeMount::Partial == scope->classify(5000 - 255));
+    FG_CHECK(scope->isRoot(5000 - 17, 17));
+}
+
+FG_TEST(AncestorCacheFollowsEpochAndVersion)
+{
+    AncestorCache<64> cache;
+    bool watched = false;
+
+    FG_CHECK(!cache.lookup(1, 1, watched));
+
+    cache.insert(1, 1, true, cache.epoch());
+    FG_CHECK(cache.lookup(1, 1, watched));
+    FG_CHECK(watched);
+    FG_CHECK(!cache.lookup(1, 2, watched));
+
+    //
+    // NOTE: result of a walk started before clear is dropped
+    //
+    const uint32_t epoch = cache.epoch();
+    cache.clear();
+    FG_CHECK(!cache.lookup(1, 1, watched));
+
+    cache.insert(2, 1, false, epoch);
+    FG_CHECK(!cache.lookup(2, 1, watched));
+}
+
+//
+// NOTE: tree of the mount
+//       0 /
+//       1 /Users                  2 /tmp
+//       3 /Users/user (root)      4 /tmp/cache
+//       5 /Users/user/Documents
+//       6 /Users/user/Documents/Projects
+//
+struct Fixture
+{
+    Fixture()
+    {
+        const auto root = walker.add(TreeWalker::NodeNull, 2);
+        const auto users = walker.add(root, 10);
+        const auto tmp = walker.add(root, 11);
+        const auto user = walker.add(users, 12);
+        walker.add(tmp, 13);
+        const auto documents = walker.add(user, 14);
+        walker.add(documents, 15);
+
+        scope->load(*Scope({}, { { kFsid, 12, 0 } }));
+    }
+
+    bool isWatched(TreeWalker::Node node)
+    {
+        return IsWatchedDirectory(*scope, kFsid, node, cache, walker);
+    }
+
+    std::unique_ptr<WatchScope> scope = std::make_unique<WatchScope>();
+    AncestorCache<64>           cache;
+    TreeWalker                  walker;
+};
+
+FG_TEST(DirectoriesUnderRootsAreWatched)
+{
+    Fixture fixture;
+
+    FG_CHECK(fixture.isWatched(6));
+    FG_CHECK(fixture.isWatched(3));
+    FG_CHECK(!fixture.isWatched(4));
+    FG_CHECK(!fixture.isWatched(1));
+    FG_CHECK(!fixture.isWatched(0));
+
+    FG_CHECK(0 == fixture.walker.references());
+}
+
+FG_TEST(WalkResultsAreCached)
+{
+    Fixture fixture;
+
+    FG_CHECK(fixture.isWatched(6));
+    FG_CHECK(3 == fixture.walker.takeVisits());
+
+    //
+    // NOTE: every directory on the way was cached
+    //
+    FG_CHECK(fixture.isWatched(6));
+    FG_CHECK(fixture.isWatched(5));
+    FG_CHECK(0 == fixture.walker.takeVisits());
+
+    //
+    // NOTE: directory object reused for another directory misses
+    //
+    fixture.walker.directory(5).version = 2;
+    FG_CHECK(fixture.isWatched(5));
+    FG_CHECK(1 == fixture.walker.takeVisits());
+
+    fixture.cache.clear();
+    FG_CHECK(fixture.isWatched(6));
+    FG_CHECK(1 < fixture.walker.takeVisits());
+
+    FG_CHECK(0 == fixture.walker.references());
+}
+
+FG_TEST(UnknownDirectoryIsWatchedAndNotCached)
+{
+    Fixture fixture;
+
+    fixture.walker.directory(2).identified = false;
+    FG_CHECK(fixture.isWatched(4));
+    FG_CHECK(2 == fixture.walker.takeVisits());
+
+    fixture.walker.directory(2).identified = true;
+    FG_CHECK(!fixture.isWatched(4));
+
+    //
+    // NOTE: directory with unknown parent above the mount root
+    //
+    const auto orphan = fixture.walker.add(TreeWalker::NodeNull, 99);
+    FG_CHECK(fixture.isWatched(fixture.walker.add(orphan, 100)));
+
+    FG_CHECK(0 == fixture.walker.references());
+}
+
+FG_TEST(DeepTreeIsWatched)
+{
+    Fixture fixture;
+
+    TreeWalker::Node node = 4;
+    for (uint32_t depth = 0; depth < kFGWatchScopeMaxDepth; ++depth)
+    {
+        node = fixture.walker.add(node, 1000 + depth);
+    }
+
+    FG_CHECK(fixture.isWatched(node));
+    FG_CHECK(kFGWatchScopeMaxDepth == fixture.walker.takeVisits());
+    FG_CHECK(0 == fixture.walker.references());
+
+    FG_CHECK(fixture.isWatched(node));
+    FG_CHECK(kFGWatchScopeMaxDepth == fixture.walker.takeVisits());
+}